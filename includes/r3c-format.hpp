@@ -0,0 +1,634 @@
+/****************************************************************************
+ * Riley's C++ Commons Library -- Compile-Time Formatting
+ * Copyright (C) 2010, Ryan Robinson
+ *
+ * Ryan Robinson
+ * Web Site:  http://www.riley-man.com/
+ * E-mail: riley@riley-man.com
+ ****************************************************************************/
+
+/*! \file r3c-format.hpp
+ *  
+ *  This is the include file for appending formatted strings whose format
+ *  string is known at compile time.  It requires C++20.
+ *
+ *  Function r3cFormat splits its format string into literals and
+ *  conversions while compiling, following the same rules as
+ *  R3CFormatParser, and checks every argument against the conversion it
+ *  replaces.  The generated code appends each piece in turn, without
+ *  parsing the format string or reading a variable argument list at run
+ *  time:
+ *  \code
+ *  r3cFormat<"%s: %d items, %5.2f%%">(&line, name, count, ratio);
+ *  \endcode
+ *
+ *  Format strings that are only known at run time should continue to use
+ *  R3CString::appendf.
+ */
+
+#ifndef _r3_commons_format_HPP_
+#define _r3_commons_format_HPP_
+
+#if __cplusplus < 202002L
+#error "r3c-format.hpp requires C++20"
+#endif
+
+
+// *** ADDITIONAL INCLUDES *** //
+
+#include "r3c.hpp"
+#include "r3c-string.hpp"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+// *** CLASS DEFINITIONS *** //
+
+/* R3CFormatLiteral */
+
+// Class definition with doxygen comments
+
+/*! Holds a format string literal, so that it can be passed to r3cFormat as a
+ *  template argument.  Literals are converted implicitly, and this class is
+ *  not normally named by calling code.
+ */
+template <size_t N>
+struct R3CFormatLiteral {
+
+    //! Characters of the format string, including the null-terminator.
+    char chars[N];
+
+    /*! Copies the given string literal.
+
+        \param str String literal.
+    */
+    constexpr R3CFormatLiteral(const char (&str)[N]) {
+        for ( size_t i = 0; i < N; i++ ) this->chars[i] = str[i];
+    }
+
+}; // end R3CFormatLiteral
+
+
+/* R3CFormatPlanPiece */
+
+// Class definition with doxygen comments
+
+/*! Describes one piece of a format string parsed at compile time.
+ */
+struct R3CFormatPlanPiece {
+
+    //! Position of the piece in the format string.
+    int startPos;
+
+    //! Number of format string characters represented by the piece.
+    int charCount;
+
+    //! Type of the piece, as identified by the R3C_FORMAT_ constants.
+    int dataType;
+
+    //! Type of argument taken, as identified by the R3C_FORMAT_ARG_
+    //! constants.
+    int argType;
+
+    //! Index of the argument taken, or -1 for a literal.
+    int argIndex;
+
+    //! Null-terminated copy of the conversion, for conversion pieces.
+    char spec[R3C_FORMAT_MAXSPEC];
+
+    //! Decoded conversion, for conversion pieces.
+    R3CFormatSpec format;
+
+}; // end R3CFormatPlanPiece
+
+
+/* R3CFormatPlan */
+
+// Class definition with doxygen comments
+
+/*! Holds every piece of a format string parsed at compile time.
+ */
+template <int PieceCount>
+struct R3CFormatPlan {
+
+    //! Pieces of the format string, in order.
+    R3CFormatPlanPiece pieces[PieceCount > 0 ? PieceCount : 1];
+
+    //! Index of the piece that takes each argument.
+    int argPieces[PieceCount > 0 ? PieceCount : 1];
+
+    //! Number of arguments taken by the format string.
+    int argCount;
+
+    //! Total number of characters appended by the literal pieces.
+    int literalLength;
+
+    //! Flag indicating whether a conversion was too long to be held.
+    bool specTooLong;
+
+}; // end R3CFormatPlan
+
+
+// *** COMPILE-TIME PARSING *** //
+
+/*! Passes over the flags, width, precision and size of the conversion
+    starting at the given position, as R3CFormatParser::passConversion does.
+
+    \param str Format string.
+    \param pos Position of the % character.
+    \return Position of the character that indicates the type of the
+        conversion.
+*/
+constexpr int r3cFormatPassConversion(const char* str, int pos) {
+    pos++;
+    while (
+        (str[pos] == '-') || (str[pos] == '+') ||
+        (str[pos] == '#') || (str[pos] == ' ')
+    ) {
+        pos++;
+    }
+    while ( (str[pos] >= '0') && (str[pos] <= '9') ) pos++;
+    if ( str[pos] == '.' ) {
+        pos++;
+        while ( (str[pos] >= '0') && (str[pos] <= '9') ) pos++;
+    }
+    if ( (str[pos] == 'l') || (str[pos] == 'h') ) {
+        pos++;
+        if ( str[pos] == str[pos - 1] ) pos++;
+    } else if ( (str[pos] == 'L') || (str[pos] == 'z') ) {
+        pos++;
+    }
+    return( pos );
+}
+
+/*! Decodes the given conversion, as r3cFormatDecodeSpec does.
+
+    \param spec Null-terminated conversion, starting with the % character.
+    \return Decoded conversion.
+*/
+constexpr R3CFormatSpec r3cFormatDecode(const char* spec) {
+    R3CFormatSpec result = {};
+    int pos = 1;
+    result.precision = -1;
+    result.valueBits = sizeof(int) * 8;
+    while ( true ) {
+        if ( spec[pos] == '-' ) result.flags |= R3C_FORMAT_FLAG_LEFT;
+        else if ( spec[pos] == '+' ) result.flags |= R3C_FORMAT_FLAG_PLUS;
+        else if ( spec[pos] == ' ' ) result.flags |= R3C_FORMAT_FLAG_SPACE;
+        else if ( spec[pos] == '#' ) result.flags |= R3C_FORMAT_FLAG_ALT;
+        else break;
+        pos++;
+    }
+    if ( spec[pos] == '0' ) result.flags |= R3C_FORMAT_FLAG_ZERO;
+    while ( (spec[pos] >= '0') && (spec[pos] <= '9') ) {
+        if ( result.width <= 65535 ) {
+            result.width = (result.width * 10) + (spec[pos] - '0');
+        }
+        pos++;
+    }
+    if ( spec[pos] == '.' ) {
+        pos++;
+        result.precision = 0;
+        while ( (spec[pos] >= '0') && (spec[pos] <= '9') ) {
+            if ( result.precision <= 65535 ) {
+                result.precision = (result.precision * 10) + (spec[pos] - '0');
+            }
+            pos++;
+        }
+    }
+    if ( (spec[pos] == 'h') && (spec[pos + 1] == 'h') ) {
+        result.valueBits = sizeof(char) * 8;
+        pos += 2;
+    } else if ( spec[pos] == 'h' ) {
+        result.valueBits = sizeof(short) * 8;
+        pos++;
+    } else if ( (spec[pos] == 'l') && (spec[pos + 1] == 'l') ) {
+        result.valueBits = sizeof(long long) * 8;
+        pos += 2;
+    } else if ( spec[pos] == 'l' ) {
+        result.valueBits = sizeof(long) * 8;
+        pos++;
+    } else if ( spec[pos] == 'z' ) {
+        result.valueBits = sizeof(size_t) * 8;
+        pos++;
+    } else if ( spec[pos] == 'L' ) {
+        result.valueBits = sizeof(long double) * 8;
+        pos++;
+    }
+    result.conversion = spec[pos];
+    return( result );
+}
+
+/*! Resolves the type of format entry for the given character, as
+    R3CFormatParser::resolveFormatType does.
+
+    \param curChar Format character.
+    \return Type of format entry, as identified by the corresponding
+        R3C_FORMAT_ constant.
+*/
+constexpr int r3cFormatResolveType(char curChar) {
+    switch ( curChar ) {
+        case 'd': case 'i': case 'c': case 'C':
+        case 'u': case 'x': case 'X': case 'o':
+            return( R3C_FORMAT_INT );
+        case 'f': case 'F': case 'g': case 'G':
+        case 'e': case 'E': case 'a': case 'A':
+            return( R3C_FORMAT_DOUBLE );
+        case 's':
+            return( R3C_FORMAT_STRING );
+        case 'p':
+            return( R3C_FORMAT_POINTER );
+        default:
+            return( R3C_FORMAT_LITERAL );
+    }
+}
+
+/*! Resolves the type of argument taken by a conversion, as
+    R3CFormatParser::resolveArgType does.
+
+    \param dataType Type of format entry.
+    \param sizeChar First character of the size portion, or the conversion
+        character if there is none.
+    \param nextSizeChar Character after sizeChar.
+    \return Type of argument, as identified by the corresponding
+        R3C_FORMAT_ARG_ constant.
+*/
+constexpr int r3cFormatResolveArgType(
+    int dataType, char sizeChar, char nextSizeChar
+) {
+    switch ( dataType ) {
+        case R3C_FORMAT_INT:
+            if ( (sizeChar == 'l') && (nextSizeChar == 'l') ) {
+                return( R3C_FORMAT_ARG_LONGLONG );
+            }
+            if ( sizeChar == 'l' ) return( R3C_FORMAT_ARG_LONG );
+            if ( sizeChar == 'z' ) return( R3C_FORMAT_ARG_SIZE );
+            return( R3C_FORMAT_ARG_INT );
+        case R3C_FORMAT_DOUBLE:
+            if ( sizeChar == 'L' ) return( R3C_FORMAT_ARG_LONGDOUBLE );
+            return( R3C_FORMAT_ARG_DOUBLE );
+        case R3C_FORMAT_STRING:
+            return( R3C_FORMAT_ARG_STRING );
+        case R3C_FORMAT_POINTER:
+            return( R3C_FORMAT_ARG_POINTER );
+        default:
+            return( R3C_FORMAT_ARG_NONE );
+    }
+}
+
+/*! Splits the given format string into pieces, following the same rules as
+    R3CFormatParser::parse.
+
+    \param str Format string.
+    \param pieces Array that receives the pieces, or NULL to only count them.
+    \return Number of pieces.
+*/
+constexpr int r3cFormatSplit(const char* str, R3CFormatPlanPiece* pieces) {
+    int pos = 0;
+    int pieceCount = 0;
+    int percentPos = 0;
+    int conversionPos = 0;
+    int sizePos = 0;
+    int dataType = 0;
+    int charCount = 0;
+    while ( str[pos] != '\0' ) {
+        percentPos = pos;
+        while ( (str[percentPos] != '\0') && (str[percentPos] != '%') ) {
+            percentPos++;
+        }
+        if ( percentPos != pos ) {
+            // A literal up to the next % character, or to the end
+            if ( pieces != NULL ) {
+                pieces[pieceCount] = R3CFormatPlanPiece();
+                pieces[pieceCount].startPos = pos;
+                pieces[pieceCount].charCount = percentPos - pos;
+                pieces[pieceCount].dataType = R3C_FORMAT_LITERAL;
+                pieces[pieceCount].argType = R3C_FORMAT_ARG_NONE;
+                pieces[pieceCount].argIndex = -1;
+            }
+            pieceCount++;
+            pos = percentPos;
+        } else {
+            // A conversion, or an unfinished conversion kept as a literal
+            conversionPos = r3cFormatPassConversion(str, pos);
+            sizePos = conversionPos;
+            while (
+                (sizePos > pos) &&
+                ((str[sizePos - 1] == 'h') || (str[sizePos - 1] == 'l') ||
+                 (str[sizePos - 1] == 'L') || (str[sizePos - 1] == 'z'))
+            ) {
+                sizePos--;
+            }
+            if ( str[conversionPos] == '\0' ) {
+                dataType = R3C_FORMAT_LITERAL;
+                charCount = conversionPos - pos;
+            } else {
+                dataType = r3cFormatResolveType(str[conversionPos]);
+                charCount = conversionPos - pos + 1;
+                if (
+                    (str[conversionPos] == '%') &&
+                    (conversionPos == (pos + 1))
+                ) {
+                    charCount--;
+                }
+            }
+            if ( pieces != NULL ) {
+                pieces[pieceCount] = R3CFormatPlanPiece();
+                pieces[pieceCount].startPos = pos;
+                pieces[pieceCount].charCount = charCount;
+                pieces[pieceCount].dataType = dataType;
+                pieces[pieceCount].argType = r3cFormatResolveArgType(
+                    dataType, str[sizePos],
+                    (str[sizePos] == '\0') ? '\0' : str[sizePos + 1]);
+                pieces[pieceCount].argIndex = -1;
+                if (
+                    (dataType != R3C_FORMAT_LITERAL) &&
+                    (charCount < R3C_FORMAT_MAXSPEC)
+                ) {
+                    for ( int i = 0; i < charCount; i++ ) {
+                        pieces[pieceCount].spec[i] = str[pos + i];
+                    }
+                    pieces[pieceCount].spec[charCount] = '\0';
+                    pieces[pieceCount].format =
+                        r3cFormatDecode(pieces[pieceCount].spec);
+                }
+            }
+            pieceCount++;
+            if ( str[conversionPos] == '\0' ) break;
+            pos = conversionPos + 1;
+        }
+    }
+    return( pieceCount );
+}
+
+/*! Parses the given format string at compile time.
+
+    \return Parsed format string.
+*/
+template <R3CFormatLiteral Format>
+constexpr auto r3cFormatMakePlan() {
+    constexpr int pieceCount = r3cFormatSplit(Format.chars, NULL);
+    R3CFormatPlan<pieceCount> plan = {};
+    r3cFormatSplit(Format.chars, plan.pieces);
+    plan.argCount = 0;
+    plan.literalLength = 0;
+    plan.specTooLong = false;
+    for ( int i = 0; i < pieceCount; i++ ) {
+        if ( plan.pieces[i].argType == R3C_FORMAT_ARG_NONE ) {
+            plan.literalLength += plan.pieces[i].charCount;
+        } else {
+            if ( plan.pieces[i].charCount >= R3C_FORMAT_MAXSPEC ) {
+                plan.specTooLong = true;
+            }
+            plan.pieces[i].argIndex = plan.argCount;
+            plan.argPieces[plan.argCount] = i;
+            plan.argCount++;
+        }
+    }
+    return( plan );
+}
+
+
+// *** ARGUMENT CHECKING *** //
+
+/*! Checks if an argument of the given type can replace a conversion that
+    takes the given type of argument, without losing any part of its value.
+
+    \param argType Type of argument taken, as identified by the
+        R3C_FORMAT_ARG_ constants.
+    \return Flag indicating whether the argument is accepted.
+*/
+template <typename T>
+constexpr bool r3cFormatAccepts(int argType) {
+    typedef typename std::remove_cv<T>::type ArgType;
+    switch ( argType ) {
+        case R3C_FORMAT_ARG_INT:
+            return(
+                std::is_integral<ArgType>::value &&
+                (sizeof(ArgType) <= sizeof(int)) );
+        case R3C_FORMAT_ARG_LONG:
+            return(
+                std::is_integral<ArgType>::value &&
+                (sizeof(ArgType) <= sizeof(long)) );
+        case R3C_FORMAT_ARG_LONGLONG:
+            return(
+                std::is_integral<ArgType>::value &&
+                (sizeof(ArgType) <= sizeof(long long)) );
+        case R3C_FORMAT_ARG_SIZE:
+            return(
+                std::is_integral<ArgType>::value &&
+                (sizeof(ArgType) <= sizeof(size_t)) );
+        case R3C_FORMAT_ARG_DOUBLE:
+            return(
+                std::is_floating_point<ArgType>::value &&
+                (sizeof(ArgType) <= sizeof(double)) );
+        case R3C_FORMAT_ARG_LONGDOUBLE:
+            return( std::is_floating_point<ArgType>::value );
+        case R3C_FORMAT_ARG_STRING:
+            return(
+                std::is_same<ArgType, const char*>::value ||
+                std::is_same<ArgType, char*>::value ||
+                std::is_same<ArgType, R3CString*>::value );
+        case R3C_FORMAT_ARG_POINTER:
+            return(
+                std::is_pointer<ArgType>::value ||
+                std::is_null_pointer<ArgType>::value );
+        default:
+            return( false );
+    }
+}
+
+
+// *** CONVERSIONS *** //
+
+/*! Formats the given argument using the given conversion piece, converting
+    the argument to the exact type the conversion takes.  This behaves like
+    snprintf, so passing a NULL target measures the result, but the
+    null-terminator may not be written.  The conversion kernels are used where
+    they support the conversion, and snprintf otherwise.
+
+    \param target Target characters, or NULL.
+    \param targetSize Size of the target, including the null-terminator.
+    \param piece Conversion piece.
+    \param value Argument.
+    \return Number of characters in the formatted argument.
+*/
+template <int ArgType, typename T>
+inline int r3cFormatConvert(
+    char* target, size_t targetSize, const R3CFormatPlanPiece& piece, T value
+) {
+    const char* spec = piece.spec;
+    int result = -1;
+    if constexpr (
+        (ArgType == R3C_FORMAT_ARG_INT) || (ArgType == R3C_FORMAT_ARG_LONG) ||
+        (ArgType == R3C_FORMAT_ARG_LONGLONG) ||
+        (ArgType == R3C_FORMAT_ARG_SIZE)
+    ) {
+        result = r3cFormatInteger(target, &piece.format, (long long)value);
+    } else if constexpr ( ArgType == R3C_FORMAT_ARG_DOUBLE ) {
+        result = r3cFormatDouble(target, &piece.format, (double)value);
+    } else if constexpr ( ArgType == R3C_FORMAT_ARG_POINTER ) {
+        result = r3cFormatPointer(target, &piece.format, (const void*)value);
+    }
+    if ( result >= 0 ) return( result );
+    if constexpr ( ArgType == R3C_FORMAT_ARG_INT ) {
+        return( snprintf(target, targetSize, spec, (int)value) );
+    } else if constexpr ( ArgType == R3C_FORMAT_ARG_LONG ) {
+        return( snprintf(target, targetSize, spec, (long)value) );
+    } else if constexpr ( ArgType == R3C_FORMAT_ARG_LONGLONG ) {
+        return( snprintf(target, targetSize, spec, (long long)value) );
+    } else if constexpr ( ArgType == R3C_FORMAT_ARG_SIZE ) {
+        return( snprintf(target, targetSize, spec, (size_t)value) );
+    } else if constexpr ( ArgType == R3C_FORMAT_ARG_DOUBLE ) {
+        return( snprintf(target, targetSize, spec, (double)value) );
+    } else if constexpr ( ArgType == R3C_FORMAT_ARG_LONGDOUBLE ) {
+        return( snprintf(target, targetSize, spec, (long double)value) );
+    } else if constexpr ( ArgType == R3C_FORMAT_ARG_POINTER ) {
+        return( snprintf(target, targetSize, spec, (const void*)value) );
+    } else if constexpr ( std::is_same<T, R3CString*>::value ) {
+        return( snprintf(target, targetSize, spec, value->getChars()) );
+    } else {
+        return( snprintf(target, targetSize, spec, (const char*)value) );
+    }
+}
+
+/*! Returns the characters of a string argument.  As with
+    R3CFormatParser::appendString, NULL is treated like an empty string.
+
+    \param value Argument.
+    \return Characters of the argument.
+*/
+template <typename T>
+inline const char* r3cFormatChars(T value) {
+    if constexpr ( std::is_same<T, R3CString*>::value ) {
+        return( (value == NULL) ? R3C_STR_EMPTY : value->getChars() );
+    } else {
+        return( (value == NULL) ? R3C_STR_EMPTY : (const char*)value );
+    }
+}
+
+/*! Measures a single conversion piece.
+
+    \param piece Conversion piece.
+    \param value Argument.
+    \return Number of characters the piece appends.
+*/
+template <int ArgType, typename T>
+inline int r3cFormatMeasure(const R3CFormatPlanPiece& piece, T value) {
+    int result;
+    if constexpr ( ArgType == R3C_FORMAT_ARG_STRING ) {
+        if ( piece.charCount == 2 ) {
+            // A plain %s is copied, rather than formatted
+            return( (int)strlen(r3cFormatChars(value)) );
+        }
+        result = r3cFormatConvert<ArgType>(
+            NULL, 0, piece, r3cFormatChars(value));
+    } else {
+        result = r3cFormatConvert<ArgType>(NULL, 0, piece, value);
+    }
+    return( (result < 0) ? 0 : result );
+}
+
+/*! Writes a single conversion piece, which was measured beforehand.
+
+    \param target Target characters.
+    \param length Length measured for the piece.
+    \param piece Conversion piece.
+    \param value Argument.
+*/
+template <int ArgType, typename T>
+inline void r3cFormatWrite(
+    char* target, int length, const R3CFormatPlanPiece& piece, T value
+) {
+    if ( length == 0 ) return;
+    if constexpr ( ArgType == R3C_FORMAT_ARG_STRING ) {
+        if ( piece.charCount == 2 ) {
+            memcpy(target, r3cFormatChars(value), length);
+            return;
+        }
+        r3cFormatConvert<ArgType>(
+            target, length + 1, piece, r3cFormatChars(value));
+    } else {
+        r3cFormatConvert<ArgType>(target, length + 1, piece, value);
+    }
+}
+
+
+// *** FUNCTIONS *** //
+
+/*! Appends the formatted string to the end of the given string.  The format
+    string is parsed while compiling, and the arguments are checked against
+    the conversions: integers must fit the size of their conversion, %f and
+    similar take floating-point values, %s takes a character string or an
+    R3CString pointer, and %p takes any pointer.  A NULL character string
+    appends nothing.  Conversions using * for the width or precision are not
+    supported.
+
+    \param str Target string.
+    \param args Format parameter replacements.
+    \return Number of characters appended.
+    \throws R3CERR_ILLEGALARGUMENT If str is NULL.
+*/
+template <R3CFormatLiteral Format, typename... Args>
+int r3cFormat(R3CString* str, Args... args) {
+    static constexpr auto plan = r3cFormatMakePlan<Format>();
+    static_assert(
+        !plan.specTooLong,
+        "r3cFormat: a conversion in the format string is too long");
+    static_assert(
+        plan.argCount == (int)sizeof...(Args),
+        "r3cFormat: argument count does not match the format string");
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        static_assert(
+            (r3cFormatAccepts<Args>(
+                plan.pieces[plan.argPieces[I]].argType) && ...),
+            "r3cFormat: argument type does not match its conversion");
+    }(std::index_sequence_for<Args...>());
+
+    int lengths[sizeof...(Args) > 0 ? sizeof...(Args) : 1];
+    int totalLength;
+    char* targetPtr;
+    std::tuple<Args...> argTuple(args...);
+#ifndef R3C_NOERRCHECK
+    if ( str == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+
+    // Measure every conversion, so that the target string grows once
+    totalLength = plan.literalLength;
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        ((lengths[I] =
+            r3cFormatMeasure<plan.pieces[plan.argPieces[I]].argType>(
+                plan.pieces[plan.argPieces[I]], std::get<I>(argTuple)),
+          totalLength += lengths[I]), ...);
+    }(std::index_sequence_for<Args...>());
+
+    // Write every piece directly into the new space, in order
+    targetPtr = str->appendSpace(totalLength);
+    [&]<size_t... P>(std::index_sequence<P...>) {
+        ([&] {
+            constexpr R3CFormatPlanPiece piece = plan.pieces[P];
+            if constexpr ( piece.argType == R3C_FORMAT_ARG_NONE ) {
+                memcpy(
+                    targetPtr, Format.chars + piece.startPos,
+                    piece.charCount);
+                targetPtr += piece.charCount;
+            } else {
+                r3cFormatWrite<piece.argType>(
+                    targetPtr, lengths[piece.argIndex], plan.pieces[P],
+                    std::get<piece.argIndex>(argTuple));
+                targetPtr += lengths[piece.argIndex];
+            }
+        }(), ...);
+    }(std::make_index_sequence<
+        sizeof(plan.pieces) / sizeof(plan.pieces[0])>());
+    *targetPtr = '\0';
+    return( totalLength );
+}
+
+
+#endif
@@ -22,6 +22,9 @@
 #include "r3c-string.hpp"
 
 #include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
 #include <exception>
 
 
@@ -41,6 +44,13 @@ extern const char* R3CERR_IO_STREAMNOTFOUND;
 //! Exception indicating that an unrecoverable I/O error has occurred.
 extern const char* R3CERR_IO_EXCEPTION;
 
+//! Exception indicating the end of a stream was reached before all of the
+//! requested data could be read.
+extern const char* R3CERR_IO_ENDOFSTREAM;
+
+//! Exception indicating data read from a stream was not correctly encoded.
+extern const char* R3CERR_IO_BADFORMAT;
+
 
 // Interface List
 
@@ -50,14 +60,25 @@ class R3CTextOutputStream;
 class R3CBinaryInputStream;
 class R3CBinaryOutputStream;
 class R3CRandomAccessStream;
+class R3CTextLineHandler;
+class R3CDirectoryEntryHandler;
 
 
 // Class List
 
 class R3CTextInputFile;
+class R3CTextInputMemMap;
 class R3CTextInputMemBlock;
+class R3CTextLineSplitter;
 class R3CTextOutputFile;
 class R3CTextOutputMemBlock;
+class R3CBinaryInputFile;
+class R3CBinaryInputMemBlock;
+class R3CBinaryOutputFile;
+class R3CBinaryOutputMemBlock;
+class R3CRandomAccessFile;
+class R3CUringFileReader;
+class R3CDirectoryWalker;
 
 
 // *** INTERFACE DEFINITIONS *** //
@@ -157,50 +178,357 @@ public:
 }; // end R3CTextInputStream
 
 
-// *** CLASS DEFINITIONS *** //
+/* R3CTextOutputStream */
 
-/* R3CTextInputFile */
+// Class definition with doxygen comments
+
+//! Represents a character output stream.
+class R3CTextOutputStream {
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    virtual ~R3CTextOutputStream() = 0;
+
+public:
+
+    /*! Writes the given character.
+
+        \param charToWrite Character to write.
+        \return Number of characters written (always 1).
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    virtual int writeChar(char charToWrite) = 0;
+
+    /*! Writes the given character string.  If the character string is NULL,
+        nothing is written.
+
+        \param sourceStr Source character string.
+        \return Number of characters written.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    virtual int writeChars(const char* sourceStr) = 0;
+
+    /*! Writes the given string.
+
+        \param sourceStr Source string.
+        \return Number of characters written.
+        \throws R3CERR_ILLEGALARGUMENT If sourceStr is NULL.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    virtual int writeChars(R3CString* sourceStr) = 0;
+
+    /*! Writes the given character string, followed by a newline.  If the
+        character string is NULL, only the newline is written.
+
+        \param sourceStr Source character string.
+        \return Number of characters written, including the newline.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    virtual int writeLine(const char* sourceStr) = 0;
+
+    /*! Writes the given string, followed by a newline.
+
+        \param sourceStr Source string.
+        \return Number of characters written, including the newline.
+        \throws R3CERR_ILLEGALARGUMENT If sourceStr is NULL.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    virtual int writeLine(R3CString* sourceStr) = 0;
+
+    /*! Writes the formatted string.
+
+        \param formatString C-style format string.
+        \param ... Format parameter replacements.
+        \return Number of characters written.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    virtual int writef(const char* formatString, ...) = 0;
+
+    /*! Writes any buffered characters to the underlying stream.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    virtual void flush() = 0;
+
+}; // end R3CTextOutputStream
+
+
+/* R3CBinaryInputStream */
 
 // Class definition with doxygen comments
 
-//! Represents a text file being used as an input stream.
-class R3CTextInputFile :
-    public R3CStream,
-    public R3CTextInputStream
-{
+/*! Represents a binary input stream.
+ *  Values are decoded directly from a read buffer, which the concrete stream
+ *  only has to refill; the decoding itself is shared by all binary input
+ *  streams.
+ *
+ *  Fixed-width values are little-endian.  Variable-width integers are
+ *  LEB128, with signed values zigzag-encoded so that small negative values
+ *  remain short.  Strings are a variable-width length, followed by the
+ *  characters without a null-terminator.
+ */
+class R3CBinaryInputStream {
 
 // Member Variables
 
-private:
+protected:
 
-    //! File handle.
-    FILE* fileHandle;
+    //! Pointer to the next unread byte in the read buffer.
+    const unsigned char* readPtr;
+
+    //! Pointer just past the last byte in the read buffer.
+    const unsigned char* readEndPtr;
 
 
 // Construction
 
+protected:
+
+    //! Creates a new binary input stream with an empty read buffer.
+    R3CBinaryInputStream();
+
+
+// Destruction
+
 public:
 
-    //! Creates a new input stream from an unspecified text file.
-    R3CTextInputFile();
+    //! Destructor.
+    virtual ~R3CBinaryInputStream() = 0;
 
-    /*! Creates and open a new input stream from the given text file.
-        
-        \param inputFilename Path to file.
-        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
-        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
-        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+
+// Read Buffer
+
+protected:
+
+    /*! Refills the read buffer, once every byte in it has been read, by
+        setting readPtr and readEndPtr.
+
+        \return Flag indicating whether any bytes were read; false if the end
+            of the stream has been reached.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
     */
-    R3CTextInputFile(const char* inputFilename);
+    virtual bool fillBuffer() = 0;
 
-    /*! Creates and opens a new input stream from the given text file.
-        
-        \param inputFilename Path to file.
-        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
-        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
-        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    /*! Reads exactly byteCount bytes into the target buffer.
+
+        \param target Target buffer.
+        \param byteCount Number of bytes to read.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_ENDOFSTREAM If the end of the stream was reached
+            first.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
     */
-    R3CTextInputFile(R3CString* inputFilename);
+    void readFully(void* target, size_t byteCount);
+
+    /*! Appends exactly byteCount bytes to the target string, growing it as
+        the bytes are read rather than all at once.
+
+        \param targetStr Target string.
+        \param byteCount Number of bytes to read.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_ENDOFSTREAM If the end of the stream was reached
+            first.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void readAppend(R3CString* targetStr, int byteCount);
+
+
+// Read Bytes from the Stream
+
+public:
+
+    /*! Returns a flag indicating whether the end of the stream has been
+        reached.  This method will block until some input is available.
+
+        \return Flag indicating whether the end of the stream has been
+            reached.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    bool isEndOfStream();
+
+    /*! Reads up to byteCount bytes into the target buffer.
+
+        \param target Target buffer.
+        \param byteCount Number of bytes to read.
+        \return Number of bytes actually read, or EOF if the end of the stream
+            has been reached.
+        \throws R3CERR_ILLEGALARGUMENT If target is NULL, or byteCount is less
+            than 0.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    int readBytes(void* target, int byteCount);
+
+
+// Read Fixed-Width Values
+
+public:
+
+    /*! Reads an unsigned 8-bit integer.  Like the other fixed-width readers,
+        this method throws R3CERR_IO_STREAMNOTOPEN if the stream was not
+        open, R3CERR_IO_ENDOFSTREAM if the end of the stream was reached
+        before the whole value was read, and R3CERR_IO_EXCEPTION if an I/O
+        error occurred.
+
+        \return Value read.
+    */
+    uint8_t readUInt8();
+
+    //! Reads a signed 8-bit integer.
+    int8_t readInt8();
+
+    //! Reads a little-endian unsigned 16-bit integer.
+    uint16_t readUInt16();
+
+    //! Reads a little-endian signed 16-bit integer.
+    int16_t readInt16();
+
+    //! Reads a little-endian unsigned 32-bit integer.
+    uint32_t readUInt32();
+
+    //! Reads a little-endian signed 32-bit integer.
+    int32_t readInt32();
+
+    //! Reads a little-endian unsigned 64-bit integer.
+    uint64_t readUInt64();
+
+    //! Reads a little-endian signed 64-bit integer.
+    int64_t readInt64();
+
+    //! Reads a little-endian IEEE 754 single-precision value.
+    float readFloat();
+
+    //! Reads a little-endian IEEE 754 double-precision value.
+    double readDouble();
+
+
+// Read Arrays of Fixed-Width Values
+
+public:
+
+    /*! Reads count little-endian unsigned 16-bit integers.  On little-endian
+        hosts, the array is read with a single copy.  Signed arrays may be
+        read by casting the target array.
+
+        \param values Target array.
+        \param count Number of values to read.
+        \throws R3CERR_ILLEGALARGUMENT If values is NULL, count is less than
+            0, or the array is larger than the address space.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_ENDOFSTREAM If the end of the stream was reached
+            before every value was read.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void readUInt16s(uint16_t* values, int count);
+
+    //! Reads count little-endian unsigned 32-bit integers, as readUInt16s.
+    void readUInt32s(uint32_t* values, int count);
+
+    //! Reads count little-endian unsigned 64-bit integers, as readUInt16s.
+    void readUInt64s(uint64_t* values, int count);
+
+    //! Reads count little-endian single-precision values, as readUInt16s.
+    void readFloats(float* values, int count);
+
+    //! Reads count little-endian double-precision values, as readUInt16s.
+    void readDoubles(double* values, int count);
+
+
+// Read Variable-Width Values
+
+public:
+
+    /*! Reads an unsigned LEB128 integer.
+
+        \return Value read.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_ENDOFSTREAM If the end of the stream was reached
+            before the whole value was read.
+        \throws R3CERR_IO_BADFORMAT If the value was longer than 10 bytes.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    uint64_t readVarUInt();
+
+    //! Reads a zigzag-encoded signed LEB128 integer, as readVarUInt.
+    int64_t readVarInt();
+
+    /*! Reads a length-prefixed string into the target string, replacing its
+        contents.  Characters are read directly into the target string's
+        storage, which grows as they arrive, so a corrupt length fails at
+        the end of the stream rather than allocating the whole length up
+        front.  Null characters are kept, and the target string's length is
+        the encoded length.
+
+        \param targetStr Target string to receive the characters.
+        \return Number of characters in the encoded string.
+        \throws R3CERR_ILLEGALARGUMENT If targetStr is NULL.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_ENDOFSTREAM If the end of the stream was reached
+            before the whole string was read.
+        \throws R3CERR_IO_BADFORMAT If the length was not a valid string
+            length.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    int readString(R3CString* targetStr);
+
+    /*! Reads a length-prefixed string directly into space allocated from the
+        given string block.
+
+        \param block String block to hold the characters.
+        \return Pointer to the null-terminated characters in the string block.
+        \throws R3CERR_ILLEGALARGUMENT If block is NULL.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_ENDOFSTREAM If the end of the stream was reached
+            before the whole string was read.
+        \throws R3CERR_IO_BADFORMAT If the length was not a valid string
+            length.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    char* readString(R3CStringBlock* block);
+
+}; // end R3CBinaryInputStream
+
+
+/* R3CBinaryOutputStream */
+
+// Class definition with doxygen comments
+
+/*! Represents a binary output stream.
+ *  Values are encoded directly into a write buffer, which the concrete
+ *  stream only has to empty when full.  Values are encoded as described for
+ *  R3CBinaryInputStream.
+ */
+class R3CBinaryOutputStream {
+
+// Member Variables
+
+protected:
+
+    //! Pointer to the next unused byte in the write buffer.
+    unsigned char* writePtr;
+
+    //! Pointer just past the last byte in the write buffer.
+    unsigned char* writeEndPtr;
+
+
+// Construction
+
+protected:
+
+    //! Creates a new binary output stream with no write buffer.
+    R3CBinaryOutputStream();
 
 
 // Destruction
@@ -208,63 +536,2564 @@ public:
 public:
 
     //! Destructor.
-    ~R3CTextInputFile();
+    virtual ~R3CBinaryOutputStream() = 0;
 
 
-// Open Stream
+// Write Buffer
+
+protected:
+
+    /*! Makes room in the write buffer, once it is full, by setting writePtr
+        and writeEndPtr.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    virtual void emptyBuffer() = 0;
+
+    /*! Writes byteCount bytes from the source buffer.
+
+        \param source Source buffer.
+        \param byteCount Number of bytes to write.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void writeFully(const void* source, size_t byteCount);
+
+
+// Write Bytes to the Stream
 
 public:
 
-    /*! Opens the given input file.
-        
-        \param inputFilename Path to file.
-        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
-        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
-        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    /*! Writes byteCount bytes from the source buffer.
+
+        \param source Source buffer.
+        \param byteCount Number of bytes to write.
+        \throws R3CERR_ILLEGALARGUMENT If source is NULL, or byteCount is less
+            than 0.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
     */
-    void open(const char* inputFilename);
+    void writeBytes(const void* source, int byteCount);
 
-    /*! Opens the given input file.
-        
-        \param inputFilename Path to file.
-        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
-        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
-        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    /*! Writes any buffered bytes to the underlying stream.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
     */
-    void open(R3CString* inputFilename);
+    virtual void flush() = 0;
 
 
-// Check For Stream Readiness
+// Write Fixed-Width Values
 
 public:
 
-    bool ready();
+    /*! Writes an unsigned 8-bit integer.  Like the other value writers, this
+        method throws R3CERR_IO_STREAMNOTOPEN if the stream was not open, and
+        R3CERR_IO_EXCEPTION if an I/O error occurred.
+
+        \param value Value to write.
+    */
+    void writeUInt8(uint8_t value);
 
+    //! Writes a signed 8-bit integer.
+    void writeInt8(int8_t value);
 
-// Read Characters from the File
+    //! Writes a little-endian unsigned 16-bit integer.
+    void writeUInt16(uint16_t value);
+
+    //! Writes a little-endian signed 16-bit integer.
+    void writeInt16(int16_t value);
+
+    //! Writes a little-endian unsigned 32-bit integer.
+    void writeUInt32(uint32_t value);
+
+    //! Writes a little-endian signed 32-bit integer.
+    void writeInt32(int32_t value);
+
+    //! Writes a little-endian unsigned 64-bit integer.
+    void writeUInt64(uint64_t value);
+
+    //! Writes a little-endian signed 64-bit integer.
+    void writeInt64(int64_t value);
+
+    //! Writes a little-endian IEEE 754 single-precision value.
+    void writeFloat(float value);
+
+    //! Writes a little-endian IEEE 754 double-precision value.
+    void writeDouble(double value);
+
+
+// Write Arrays of Fixed-Width Values
 
 public:
 
-    int readChar();
+    /*! Writes count little-endian unsigned 16-bit integers.  On
+        little-endian hosts, the array is written with a single copy.  Signed
+        arrays may be written by casting the source array.
 
-    int readChars(R3CString* targetStr, int numChars);
+        \param values Source array.
+        \param count Number of values to write.
+        \throws R3CERR_ILLEGALARGUMENT If values is NULL, count is less than
+            0, or the array is larger than the address space.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void writeUInt16s(const uint16_t* values, int count);
 
-    int readLine(R3CString* targetStr);
+    //! Writes count little-endian unsigned 32-bit integers, as writeUInt16s.
+    void writeUInt32s(const uint32_t* values, int count);
 
+    //! Writes count little-endian unsigned 64-bit integers, as writeUInt16s.
+    void writeUInt64s(const uint64_t* values, int count);
 
-// Close File
+    //! Writes count little-endian single-precision values, as writeUInt16s.
+    void writeFloats(const float* values, int count);
+
+    //! Writes count little-endian double-precision values, as writeUInt16s.
+    void writeDoubles(const double* values, int count);
+
+
+// Write Variable-Width Values
 
 public:
 
-    /*! Closes the input file.
+    //! Writes an unsigned LEB128 integer.
+    void writeVarUInt(uint64_t value);
 
+    //! Writes a zigzag-encoded signed LEB128 integer.
+    void writeVarInt(int64_t value);
+
+    /*! Writes a length-prefixed string.
+
+        \param sourceStr Source character string.
+        \throws R3CERR_ILLEGALARGUMENT If sourceStr is NULL.
         \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
         \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
     */
-    void close();
+    void writeString(const char* sourceStr);
 
+    /*! Writes a length-prefixed string from characters that need not be
+        null-terminated.
 
-}; // end R3CTextInputFile
+        \param sourceStr Source characters.
+        \param length Number of characters to write.
+        \throws R3CERR_ILLEGALARGUMENT If sourceStr is NULL, or length is
+            less than 0.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void writeString(const char* sourceStr, int length);
+
+    /*! Writes a length-prefixed string.
+
+        \param sourceStr Source string.
+        \throws R3CERR_ILLEGALARGUMENT If sourceStr is NULL.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void writeString(R3CString* sourceStr);
+
+}; // end R3CBinaryOutputStream
+
+
+/* R3CRandomAccessStream */
+
+// Class definition with doxygen comments
+
+/*! Represents a byte stream that is read at arbitrary positions.  Reads do
+ *  not share a stream position, so a single stream may be read by many
+ *  threads at once.
+ */
+class R3CRandomAccessStream {
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    virtual ~R3CRandomAccessStream() = 0;
+
+public:
+
+    /*! Returns the number of bytes in the stream.
+
+        \return Number of bytes in the stream.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+    */
+    virtual off_t getSize() = 0;
+
+    /*! Reads up to byteCount bytes, starting at the given position, into the
+        target buffer.  This method may be called from multiple threads at
+        once.
+
+        \param position Position of the first byte to read, where the first
+            byte in the stream is at position 0.
+        \param target Target buffer.
+        \param byteCount Number of bytes to read.
+        \return Number of bytes actually read, or EOF if position is at or
+            past the end of the stream.
+        \throws R3CERR_ILLEGALARGUMENT If target is NULL, or position or
+            byteCount is less than 0.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    virtual int readAt(off_t position, void* target, int byteCount) = 0;
+
+}; // end R3CRandomAccessStream
+
+
+/* R3CTextLineHandler */
+
+// Class definition with doxygen comments
+
+//! Receives the lines of a text file processed by an R3CTextLineSplitter.
+class R3CTextLineHandler {
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    virtual ~R3CTextLineHandler() = 0;
+
+public:
+
+    /*! Handles the next non-blank line of a range.  This method is called
+        from several threads at once, but lines of the same range are always
+        handled by the same worker, in order.  An exception thrown by this
+        method stops processing, and is rethrown to the caller of the
+        splitter.
+
+        \param linePtr Pointer to the first character of the line, which is
+            not null-terminated.
+        \param lineLength Number of characters in the line.  A line longer
+            than INT_MAX is not handed to the handler; processing stops, and
+            the splitter throws R3CERR_OUTOFRANGE.
+        \param workerIndex Index of the worker handling the line, from 0 to
+            one less than the number of workers.
+    */
+    virtual void handleLine(
+        const char* linePtr, int lineLength, int workerIndex) = 0;
+
+}; // end R3CTextLineHandler
+
+
+/* R3CDirectoryEntryHandler */
+
+// Class-related constants
+
+//! Entry type of a regular file.
+#define R3C_IO_ENTRY_FILE 1
+//! Entry type of a folder.
+#define R3C_IO_ENTRY_FOLDER 2
+//! Entry type of a symbolic link, which is never followed.
+#define R3C_IO_ENTRY_LINK 4
+//! Entry type of anything else, such as a device, pipe or socket.
+#define R3C_IO_ENTRY_OTHER 8
+//! Every entry type, for use as a mask.
+#define R3C_IO_ENTRY_ALL 15
+
+// Class definition with doxygen comments
+
+//! Receives the entries of a folder tree walked by an R3CDirectoryWalker.
+class R3CDirectoryEntryHandler {
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    virtual ~R3CDirectoryEntryHandler() = 0;
+
+public:
+
+    /*! Handles the next entry found.  This method is called from several
+        threads at once, and entries are handled in no particular order,
+        except that a folder is always handled before the entries inside it.
+        An exception thrown by this method stops the walk, and is rethrown to
+        the caller of the walker.
+
+        \param path Path of the entry, starting with the root path given to
+            the walker.  The path belongs to the walker, must not be changed,
+            and is only valid until this method returns.
+        \param nameOffset Position of the entry name within the path.
+        \param entryType Type of the entry, one of the R3C_IO_ENTRY_*
+            constants.
+        \param workerIndex Index of the worker handling the entry, from 0 to
+            one less than the number of workers.
+    */
+    virtual void handleEntry(
+        R3CPathString* path, int nameOffset, int entryType,
+        int workerIndex) = 0;
+
+}; // end R3CDirectoryEntryHandler
+
+
+// *** CLASS DEFINITIONS *** //
+
+/* R3CTextInputFile */
+
+// Class-related constants
+
+//! Read method, reading the file through stdio, without stdio buffering.
+#define R3C_IO_READ_STDIO 0
+//! Read method, reading the file through io_uring on Linux, with a read in
+//! flight for each read buffer.  Where io_uring is unavailable, the stdio
+//! read method is used instead.
+#define R3C_IO_READ_URING 1
+
+// Class definition with doxygen comments
+
+/*! Represents a text file being used as an input stream.
+ *  Characters are read from the file in large blocks into an internal read
+ *  buffer, and lines are located by scanning the buffer rather than reading
+ *  one character at a time.  The read buffer defaults to 64 KB, and can be
+ *  changed by calling \ref setBufferSize before the file is opened.
+ *
+ *  Calling \ref setReadAhead before the file is opened enables read-ahead,
+ *  in which a background thread reads the file into a ring of read buffers
+ *  while the caller is working through the previous ones.  The time each
+ *  side spends waiting on the other is recorded: a stream whose reader
+ *  waits mostly for data is I/O-bound, while one whose prefetch thread
+ *  waits mostly for free buffers is bound by the caller's processing.
+ *
+ *  The file may instead be opened with the R3C_IO_READ_URING read method,
+ *  which keeps a read in flight for each buffer in the ring through
+ *  io_uring, without a prefetch thread.  The ring has 4 buffers unless
+ *  read-ahead has set another size.
+ */
+class R3CTextInputFile :
+    public R3CStream,
+    public R3CTextInputStream
+{
+
+// Member Variables
+
+private:
+
+    //! File handle.
+    FILE* fileHandle;
+
+    //! Number of bytes in the read buffer.
+    int bufferSize;
+
+    //! Read buffer, allocated with one extra byte so that the contents can
+    //! always be null-terminated.
+    char* buffer;
+
+    //! Pointer to the next unread character in the read buffer.
+    char* bufferPtr;
+
+    //! Pointer just past the last character read into the read buffer.
+    char* bufferEndPtr;
+
+    //! Number of read buffers in the read-ahead ring, or 0 if read-ahead is
+    //! disabled.
+    int ringSize;
+
+    //! Read buffers in the read-ahead ring, each allocated with one extra
+    //! byte like the read buffer.
+    char** ringBuffers;
+
+    //! Number of characters read into each read buffer in the ring.
+    int* ringLengths;
+
+    //! Index of the read buffer at the head of the ring, which is the one
+    //! being read by the caller once it has been filled.
+    int ringHead;
+
+    //! Number of filled read buffers in the ring, starting at the head.
+    int ringFilled;
+
+    //! Flag indicating whether the caller holds the read buffer at the head
+    //! of the ring.
+    bool ringHeld;
+
+    //! Flag indicating whether the prefetch thread reached the end of the
+    //! file.
+    bool ringAtEnd;
+
+    //! Flag indicating whether the prefetch thread hit an I/O error.
+    bool ringFailed;
+
+    //! Flag asking the prefetch thread to stop.
+    bool ringStopping;
+
+    //! Prefetch thread, which fills the read buffers in the ring.
+    pthread_t prefetchThread;
+
+    //! Mutex guarding the state of the ring.
+    pthread_mutex_t ringLock;
+
+    //! Condition signalled when a read buffer in the ring is filled, or the
+    //! prefetch thread stops.
+    pthread_cond_t ringFilledCond;
+
+    //! Condition signalled when a read buffer in the ring is released.
+    pthread_cond_t ringReleasedCond;
+
+    //! Time, in microseconds, the caller has waited for the prefetch thread.
+    unsigned long readerStallTime;
+
+    //! Time, in microseconds, the prefetch thread has waited for the caller.
+    unsigned long prefetchStallTime;
+
+    //! Read method in use, as identified by the corresponding R3C_IO_READ_
+    //! constant.
+    int readMethod;
+
+    //! Reader used by the io_uring read method, kept between files, or NULL.
+    R3CUringFileReader* uringReader;
+
+
+// Construction
+
+public:
+
+    //! Creates a new input stream from an unspecified text file.
+    R3CTextInputFile();
+
+    /*! Creates and open a new input stream from the given text file.
+        
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    R3CTextInputFile(const char* inputFilename);
+
+    /*! Creates and opens a new input stream from the given text file.
+        
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    R3CTextInputFile(R3CString* inputFilename);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    ~R3CTextInputFile();
+
+
+// Open Stream
+
+public:
+
+    /*! Opens the given input file.
+        
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    void open(const char* inputFilename);
+
+    /*! Opens the given input file.
+        
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    void open(R3CString* inputFilename);
+
+    /*! Opens the given input file with the given read method.
+
+        \param inputFilename Path to file.
+        \param method Read method, as identified by the corresponding
+            R3C_IO_READ_ constant.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL, or method is
+            not a valid read method.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+        \throws R3CERR_IO_EXCEPTION If the read method could not be started.
+    */
+    void open(const char* inputFilename, int method);
+
+    /*! Opens the given input file with the given read method.
+
+        \param inputFilename Path to file.
+        \param method Read method, as identified by the corresponding
+            R3C_IO_READ_ constant.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL, or method is
+            not a valid read method.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+        \throws R3CERR_IO_EXCEPTION If the read method could not be started.
+    */
+    void open(R3CString* inputFilename, int method);
+
+    /*! Returns the read method in use, which may differ from the one
+        requested if io_uring was unavailable.
+
+        \return Read method, as identified by the corresponding R3C_IO_READ_
+            constant.
+    */
+    int getReadMethod();
+
+    /*! Sets the size of the read buffer used for subsequently opened files.
+
+        \param kbPerBuffer Number of kilobytes in the read buffer.
+        \throws R3CERR_ILLEGALARGUMENT If kbPerBuffer is less than 1.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream is already open.
+    */
+    void setBufferSize(int kbPerBuffer);
+
+    /*! Sets the number of read buffers used for read-ahead in subsequently
+        opened files.  Read-ahead is disabled by default.
+
+        \param bufferCount Number of read buffers in the read-ahead ring, at
+            least 2; or 0 to disable read-ahead.
+        \throws R3CERR_ILLEGALARGUMENT If bufferCount is less than 0, or is
+            1.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream is already open.
+    */
+    void setReadAhead(int bufferCount);
+
+
+// Retrieve Read-Ahead Statistics
+
+public:
+
+    /*! Returns the time the caller has spent waiting for the prefetch thread
+        to fill a read buffer since the file was opened.
+
+        \return Stall time, in microseconds.
+    */
+    unsigned long getReaderStallTime();
+
+    /*! Returns the time the prefetch thread has spent waiting for the caller
+        to release a read buffer since the file was opened.
+
+        \return Stall time, in microseconds.
+    */
+    unsigned long getPrefetchStallTime();
+
+
+// Read Ahead
+
+private:
+
+    /*! Entry point of the prefetch thread.
+
+        \param inputFile Stream being read.
+        \return NULL.
+    */
+    static void* runPrefetch(void* inputFile);
+
+    //! Fills read buffers in the ring until the end of the file, an I/O
+    //! error, or the stream is closed.
+    void prefetch();
+
+    /*! Releases the read buffer held by the caller, and waits for the
+        prefetch thread to fill the next one.
+
+        \return Flag indicating whether any characters were read; false if
+            the end of the file has been reached.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    bool nextRingBuffer();
+
+    //! Stops the prefetch thread, and waits for it to finish.
+    void stopPrefetch();
+
+
+// Read Buffer
+
+private:
+
+    /*! Refills the read buffer from the file, discarding its contents.
+
+        \return Flag indicating whether any characters were read; false if
+            the end of the file has been reached.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    bool fillBuffer();
+
+    /*! Appends characters from the read buffer to the target string.
+
+        \param targetStr Target string.
+        \param endPtr Pointer just past the last character to append.
+    */
+    void appendBuffer(R3CString* targetStr, char* endPtr);
+
+
+// Check For Stream Readiness
+
+public:
+
+    bool ready();
+
+
+// Read Characters from the File
+
+public:
+
+    int readChar();
+
+    int readChars(R3CString* targetStr, int numChars);
+
+    int readLine(R3CString* targetStr);
+
+
+// Close File
+
+public:
+
+    /*! Closes the input file.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void close();
+
+
+}; // end R3CTextInputFile
+
+
+/* R3CTextInputMemMap */
+
+// Class definition with doxygen comments
+
+/*! Represents a text file being used as an input stream, read through a
+ *  read-only memory mapping of the entire file.  The kernel is advised that
+ *  the mapping will be read sequentially.
+ *
+ *  In addition to the R3CTextInputStream methods, which copy characters into
+ *  an R3CString, this class provides readChars and readLine methods that
+ *  return a pointer into the mapping instead.  Those pointers remain valid
+ *  until the stream is closed, and the characters they point to are not
+ *  null-terminated.
+ *
+ *  Sizes and positions are expressed as off_t, so files larger than 2 GB can
+ *  be read on platforms with a 64-bit address space.
+ */
+class R3CTextInputMemMap :
+    public R3CStream,
+    public R3CTextInputStream
+{
+
+// Member Variables
+
+private:
+
+    //! File descriptor, or -1 if the stream is not open.
+    int fileDesc;
+
+    //! Start of the memory mapping, or NULL if the file is empty.
+    char* mapPtr;
+
+    //! Number of bytes in the memory mapping.
+    off_t mapSize;
+
+    //! Position of the next unread character in the memory mapping.
+    off_t readPos;
+
+
+// Construction
+
+public:
+
+    //! Creates a new input stream from an unspecified text file.
+    R3CTextInputMemMap();
+
+    /*! Creates and opens a new input stream from the given text file.
+        
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+        \throws R3CERR_IO_EXCEPTION If the file could not be mapped.
+    */
+    R3CTextInputMemMap(const char* inputFilename);
+
+    /*! Creates and opens a new input stream from the given text file.
+        
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+        \throws R3CERR_IO_EXCEPTION If the file could not be mapped.
+    */
+    R3CTextInputMemMap(R3CString* inputFilename);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    ~R3CTextInputMemMap();
+
+
+// Open Stream
+
+public:
+
+    /*! Opens and maps the given input file.
+        
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+        \throws R3CERR_IO_EXCEPTION If the file could not be mapped.
+    */
+    void open(const char* inputFilename);
+
+    /*! Opens and maps the given input file.
+        
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+        \throws R3CERR_IO_EXCEPTION If the file could not be mapped.
+    */
+    void open(R3CString* inputFilename);
+
+
+// Retrieve Stream Information
+
+public:
+
+    /*! Returns the size of the mapped file.
+
+        \return Number of bytes in the file.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+    */
+    off_t getSize();
+
+    /*! Returns the position of the next unread character.
+
+        \return Position of the next unread character, where the first
+            character is at position 0.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+    */
+    off_t getPosition();
+
+    /*! Returns the entire memory mapping, which is not null-terminated.  The
+        pointer remains valid until the stream is closed.
+
+        \return Pointer to the first character of the file, or NULL if the
+            file is empty.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+    */
+    const char* getChars();
+
+
+// Check For Stream Readiness
+
+public:
+
+    bool ready();
+
+
+// Read Characters from the File
+
+public:
+
+    int readChar();
+
+    int readChars(R3CString* targetStr, int numChars);
+
+    /*! Reads the next non-blank line into the target string.
+
+        \param targetStr Target string to receive the input characters.
+        \return Number of characters read, or EOF if the end of the stream
+            has been reached.
+        \throws R3CERR_ILLEGALARGUMENT If targetStr is NULL.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_OUTOFRANGE If the line is longer than INT_MAX
+            characters, in which case it is left unread, and can be read
+            with readLine(const char**).
+    */
+    int readLine(R3CString* targetStr);
+
+    /*! Reads up to numChars characters, without copying them.  Unlike
+        readChars(R3CString*, int), null characters are not skipped.
+
+        \param charsPtr Receives a pointer to the first character read.
+        \param numChars Number of characters to read.
+        \return Number of characters actually read, or EOF if the end of the
+            stream has been reached.
+        \throws R3CERR_ILLEGALARGUMENT If charsPtr is NULL, or numChars is
+            less than 0.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+    */
+    off_t readChars(const char** charsPtr, off_t numChars);
+
+    /*! Reads the next non-blank line, without copying it.
+
+        \param linePtr Receives a pointer to the first character of the line.
+        \return Number of characters in the line, or EOF if the end of the
+            stream has been reached.
+        \throws R3CERR_ILLEGALARGUMENT If linePtr is NULL.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+    */
+    off_t readLine(const char** linePtr);
+
+    /*! Reads the next non-blank line, without copying it.
+
+        \param lineView Receives a view of the line.
+        \return Number of characters in the line, or EOF if the end of the
+            stream has been reached.
+        \throws R3CERR_ILLEGALARGUMENT If lineView is NULL.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_OUTOFRANGE If the line is longer than INT_MAX
+            characters, in which case it is left unread, and can be read
+            with readLine(const char**).
+    */
+    int readLine(R3CStringView* lineView);
+
+
+// Close File
+
+public:
+
+    /*! Unmaps and closes the input file.  All pointers returned by this
+        stream become invalid.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void close();
+
+
+}; // end R3CTextInputMemMap
+
+
+/* R3CTextInputMemBlock */
+
+// Class definition with doxygen comments
+
+/*! Represents a block of memory being used as an input stream.  The memory
+ *  may be a caller-owned character buffer, a character string, or the
+ *  storage blocks of an R3CStringBlock.  The memory is not copied, and must
+ *  remain unchanged while the stream is open.  Reading makes no system calls
+ *  and performs no allocation, other than to expand the target string.
+ *
+ *  Characters are read with the same rules as R3CTextInputFile.  When
+ *  reading from an R3CStringBlock, each string in the block is read as a
+ *  line, in the order the strings were added, including strings that the
+ *  block allocated in their own storage.
+ */
+class R3CTextInputMemBlock :
+    public R3CStream,
+    public R3CTextInputStream
+{
+
+// Member Variables
+
+private:
+
+    //! Flag indicating whether the stream is open.
+    bool isOpen;
+
+    //! Pointer to the next unread character in the current memory segment.
+    const char* readPtr;
+
+    //! Pointer just past the last character in the current memory segment.
+    const char* endPtr;
+
+    //! String block being read, or NULL if reading a single memory segment.
+    R3CStringBlock* sourceBlock;
+
+    //! Index of the storage block in sourceBlock being read.
+    int sourceBlockIndex;
+
+    //! Position in the storage block being read at which the current memory
+    //! segment ends.
+    int sourceBlockPos;
+
+    //! Index of the next string in sourceBlock that was allocated on its
+    //! own, and has not been read.
+    int sourceAloneIndex;
+
+
+// Construction
+
+public:
+
+    //! Creates a new input stream from an unspecified memory block.
+    R3CTextInputMemBlock();
+
+    /*! Creates and opens a new input stream from the given character buffer.
+
+        \param buffer Character buffer, which does not need to be
+            null-terminated.
+        \param length Number of characters in the buffer.
+        \throws R3CERR_ILLEGALARGUMENT If buffer is NULL, or length is less
+            than 0.
+    */
+    R3CTextInputMemBlock(const char* buffer, int length);
+
+    /*! Creates and opens a new input stream from the given string block.
+
+        \param block String block.
+        \throws R3CERR_ILLEGALARGUMENT If block is NULL.
+    */
+    R3CTextInputMemBlock(R3CStringBlock* block);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    ~R3CTextInputMemBlock();
+
+
+// Open Stream
+
+public:
+
+    /*! Opens the given character buffer.
+
+        \param buffer Character buffer, which does not need to be
+            null-terminated.
+        \param length Number of characters in the buffer.
+        \throws R3CERR_ILLEGALARGUMENT If buffer is NULL, or length is less
+            than 0.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+    */
+    void open(const char* buffer, int length);
+
+    /*! Opens the given character string.
+
+        \param str Character string.
+        \throws R3CERR_ILLEGALARGUMENT If str is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+    */
+    void open(const char* str);
+
+    /*! Opens the given string.  The string must not be modified while the
+        stream is open.
+
+        \param str String.
+        \throws R3CERR_ILLEGALARGUMENT If str is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+    */
+    void open(R3CString* str);
+
+    /*! Opens the storage blocks of the given string block.  Strings must not
+        be added to the block while the stream is open.
+
+        \param block String block.
+        \throws R3CERR_ILLEGALARGUMENT If block is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+    */
+    void open(R3CStringBlock* block);
+
+
+// Read Memory Segments
+
+private:
+
+    /*! Moves to the next memory segment, if there is one.
+
+        \return Flag indicating whether there was another memory segment;
+            false if the end of the stream has been reached.
+    */
+    bool nextSegment();
+
+
+// Check For Stream Readiness
+
+public:
+
+    bool ready();
+
+
+// Read Characters from the Memory Block
+
+public:
+
+    int readChar();
+
+    int readChars(R3CString* targetStr, int numChars);
+
+    int readLine(R3CString* targetStr);
+
+    /*! Reads the next non-blank line, without copying it.  A line does not
+        continue past the end of an R3CStringBlock storage block.
+
+        \param linePtr Receives a pointer to the first character of the line,
+            which is not null-terminated.
+        \return Number of characters in the line, or EOF if the end of the
+            stream has been reached.
+        \throws R3CERR_ILLEGALARGUMENT If linePtr is NULL.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+    */
+    int readLine(const char** linePtr);
+
+    /*! Reads the next non-blank line, without copying it.  A line does not
+        continue past the end of an R3CStringBlock storage block.
+
+        \param lineView Receives a view of the line.
+        \return Number of characters in the line, or EOF if the end of the
+            stream has been reached.
+        \throws R3CERR_ILLEGALARGUMENT If lineView is NULL.
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+    */
+    int readLine(R3CStringView* lineView);
+
+
+// Close Stream
+
+public:
+
+    /*! Closes the stream.  The memory block itself is not affected.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+    */
+    void close();
+
+
+}; // end R3CTextInputMemBlock
+
+
+/* R3CTextOutputFile */
+
+// Class-related constants
+
+//! Flush policy, writing buffered characters only when the buffer is full.
+#define R3C_IO_FLUSH_ONFULL 0
+//! Flush policy, writing buffered characters when the buffer is full, or
+//! whenever a newline is written.
+#define R3C_IO_FLUSH_ONNEWLINE 1
+//! Flush policy, writing buffered characters only when flush or close is
+//! called.  The buffer expands as necessary to hold everything written, up
+//! to 256 MB, beyond which buffered characters are written out.
+#define R3C_IO_FLUSH_EXPLICIT 2
+//! Flush policy, writing buffered characters when the buffer is full, or on
+//! the first write made once the oldest buffered character has waited
+//! longer than the flush delay.  Nothing is written while no writes are
+//! made, however long the delay.
+#define R3C_IO_FLUSH_AFTERDELAY 3
+
+// Class definition with doxygen comments
+
+/*! Represents a text file being used as an output stream.
+ *  Characters written are collected in a user-space buffer (64 KB by
+ *  default), and passed to the operating system in large writes according
+ *  to the flush policy, as identified by the corresponding R3C_IO_FLUSH_
+ *  constant.  The default policy is R3C_IO_FLUSH_ONFULL.
+ *
+ *  There is no background thread, so under R3C_IO_FLUSH_AFTERDELAY the
+ *  delay is only checked when characters are written.  Callers that may
+ *  stop writing for a while should call flush themselves.
+ */
+class R3CTextOutputFile :
+    public R3CStream,
+    public R3CTextOutputStream
+{
+
+// Member Variables
+
+private:
+
+    //! File descriptor, or -1 if the stream is not open.
+    int fileDesc;
+
+    //! Number of bytes in the write buffer.
+    int bufferSize;
+
+    //! Write buffer.
+    char* buffer;
+
+    //! Number of bytes currently held in the write buffer.
+    int bufferUsed;
+
+    //! Flush policy, as identified by the corresponding R3C_IO_FLUSH_
+    //! constant.
+    int flushPolicy;
+
+    //! Time, in milliseconds, after which a write flushes the buffer under
+    //! the delayed flush policy.
+    int flushDelay;
+
+    //! Time, in milliseconds, that the oldest buffered character was
+    //! written.
+    unsigned long bufferedTime;
+
+    //! String used to format the output of writef.
+    R3CString formatStr;
+
+
+// Construction
+
+public:
+
+    //! Creates a new output stream to an unspecified text file.
+    R3CTextOutputFile();
+
+    /*! Creates and opens a new output stream to the given text file.  An
+        existing file is truncated.
+
+        \param outputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If outputFilename is NULL.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    R3CTextOutputFile(const char* outputFilename);
+
+    /*! Creates and opens a new output stream to the given text file.  An
+        existing file is truncated.
+
+        \param outputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If outputFilename is NULL.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    R3CTextOutputFile(R3CString* outputFilename);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.  Any buffered characters are written; errors are
+    //! ignored.
+    ~R3CTextOutputFile();
+
+
+// Open Stream
+
+public:
+
+    /*! Opens the given output file.  An existing file is truncated.
+
+        \param outputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If outputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    void open(const char* outputFilename);
+
+    /*! Opens the given output file.  An existing file is truncated.
+
+        \param outputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If outputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    void open(R3CString* outputFilename);
+
+    /*! Sets the size of the write buffer used for subsequently opened files.
+        Under the R3C_IO_FLUSH_EXPLICIT policy, this is the initial size.
+
+        \param kbPerBuffer Number of kilobytes in the write buffer.
+        \throws R3CERR_ILLEGALARGUMENT If kbPerBuffer is less than 1.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream is already open.
+    */
+    void setBufferSize(int kbPerBuffer);
+
+
+// Manage Flush Policy
+
+public:
+
+    /*! Returns the flush policy.
+
+        \return Flush policy, as identified by the corresponding R3C_IO_FLUSH_
+            constant.
+    */
+    int getFlushPolicy();
+
+    /*! Sets the flush policy.  Characters already buffered are kept.
+
+        \param policy Flush policy, as identified by the corresponding
+            R3C_IO_FLUSH_ constant.
+        \throws R3CERR_ILLEGALARGUMENT If policy is not a valid policy.
+    */
+    void setFlushPolicy(int policy);
+
+    /*! Sets the time after which a write flushes the buffer under the
+        R3C_IO_FLUSH_AFTERDELAY policy, measured from the oldest buffered
+        character.  The default is 1000 milliseconds.
+
+        \param milliseconds Flush delay, in milliseconds.
+        \throws R3CERR_ILLEGALARGUMENT If milliseconds is less than 0.
+    */
+    void setFlushDelay(int milliseconds);
+
+
+// Write Buffer
+
+private:
+
+    /*! Writes the given characters directly to the file.
+
+        \param chars Characters to write.
+        \param charCount Number of characters to write.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void writeFile(const char* chars, int charCount);
+
+    /*! Adds the given characters to the write buffer, writing buffered
+        characters to the file if the buffer is full.
+
+        \param chars Characters to write.
+        \param charCount Number of characters to write.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void writeBuffer(const char* chars, int charCount);
+
+    /*! Writes buffered characters to the file if the flush policy calls for
+        it, after a write has completed.
+
+        \param hasNewline Flag indicating whether the completed write
+            included a newline.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void applyFlushPolicy(bool hasNewline);
+
+
+// Write Characters to the File
+
+public:
+
+    int writeChar(char charToWrite);
+
+    int writeChars(const char* sourceStr);
+
+    int writeChars(R3CString* sourceStr);
+
+    int writeLine(const char* sourceStr);
+
+    int writeLine(R3CString* sourceStr);
+
+    int writef(const char* formatString, ...);
+
+    void flush();
+
+
+// Close File
+
+public:
+
+    /*! Writes any buffered characters, and closes the output file.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void close();
+
+
+}; // end R3CTextOutputFile
+
+
+/* R3CBinaryInputFile */
+
+// Class definition with doxygen comments
+
+/*! Represents a binary file being used as an input stream.
+ *  Bytes are read from the file in large blocks into an internal read
+ *  buffer, 64 KB by default, which can be changed by calling
+ *  \ref setBufferSize before the file is opened.
+ */
+class R3CBinaryInputFile :
+    public R3CStream,
+    public R3CBinaryInputStream
+{
+
+// Member Variables
+
+private:
+
+    //! File descriptor, or -1 if the stream is not open.
+    int fileDesc;
+
+    //! Number of bytes in the read buffer.
+    int bufferSize;
+
+    //! Read buffer.
+    unsigned char* buffer;
+
+
+// Construction
+
+public:
+
+    //! Creates a new input stream from an unspecified binary file.
+    R3CBinaryInputFile();
+
+    /*! Creates and opens a new input stream from the given binary file.
+
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    R3CBinaryInputFile(const char* inputFilename);
+
+    /*! Creates and opens a new input stream from the given binary file.
+
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    R3CBinaryInputFile(R3CString* inputFilename);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    ~R3CBinaryInputFile();
+
+
+// Open Stream
+
+public:
+
+    /*! Opens the given input file.
+
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    void open(const char* inputFilename);
+
+    /*! Opens the given input file.
+
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    void open(R3CString* inputFilename);
+
+    /*! Sets the size of the read buffer used for subsequently opened files.
+
+        \param kbPerBuffer Number of kilobytes in the read buffer.
+        \throws R3CERR_ILLEGALARGUMENT If kbPerBuffer is less than 1.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream is already open.
+    */
+    void setBufferSize(int kbPerBuffer);
+
+
+// Read Buffer
+
+protected:
+
+    bool fillBuffer();
+
+
+// Close File
+
+public:
+
+    /*! Closes the input file.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void close();
+
+
+}; // end R3CBinaryInputFile
+
+
+/* R3CBinaryInputMemBlock */
+
+// Class definition with doxygen comments
+
+/*! Represents a block of memory being used as a binary input stream.  The
+ *  memory is not copied, and must remain unchanged while the stream is
+ *  open.  Reading makes no system calls.
+ */
+class R3CBinaryInputMemBlock :
+    public R3CStream,
+    public R3CBinaryInputStream
+{
+
+// Member Variables
+
+private:
+
+    //! Flag indicating whether the stream is open.
+    bool isOpen;
+
+
+// Construction
+
+public:
+
+    //! Creates a new input stream from an unspecified memory block.
+    R3CBinaryInputMemBlock();
+
+    /*! Creates and opens a new input stream from the given memory block.
+
+        \param buffer Memory block.
+        \param length Number of bytes in the memory block.
+        \throws R3CERR_ILLEGALARGUMENT If buffer is NULL, or length is less
+            than 0.
+    */
+    R3CBinaryInputMemBlock(const void* buffer, int length);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    ~R3CBinaryInputMemBlock();
+
+
+// Open Stream
+
+public:
+
+    /*! Opens the given memory block.
+
+        \param buffer Memory block.
+        \param length Number of bytes in the memory block.
+        \throws R3CERR_ILLEGALARGUMENT If buffer is NULL, or length is less
+            than 0.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+    */
+    void open(const void* buffer, int length);
+
+
+// Read Buffer
+
+protected:
+
+    bool fillBuffer();
+
+
+// Close Stream
+
+public:
+
+    /*! Closes the stream.  The memory block itself is not affected.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+    */
+    void close();
+
+
+}; // end R3CBinaryInputMemBlock
+
+
+/* R3CBinaryOutputFile */
+
+// Class definition with doxygen comments
+
+/*! Represents a binary file being used as an output stream.
+ *  Bytes written are collected in a user-space buffer, 64 KB by default,
+ *  and passed to the operating system whenever the buffer is full, or flush
+ *  is called.
+ */
+class R3CBinaryOutputFile :
+    public R3CStream,
+    public R3CBinaryOutputStream
+{
+
+// Member Variables
+
+private:
+
+    //! File descriptor, or -1 if the stream is not open.
+    int fileDesc;
+
+    //! Number of bytes in the write buffer.
+    int bufferSize;
+
+    //! Write buffer.
+    unsigned char* buffer;
+
+
+// Construction
+
+public:
+
+    //! Creates a new output stream to an unspecified binary file.
+    R3CBinaryOutputFile();
+
+    /*! Creates and opens a new output stream to the given binary file.  An
+        existing file is truncated.
+
+        \param outputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If outputFilename is NULL.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    R3CBinaryOutputFile(const char* outputFilename);
+
+    /*! Creates and opens a new output stream to the given binary file.  An
+        existing file is truncated.
+
+        \param outputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If outputFilename is NULL.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    R3CBinaryOutputFile(R3CString* outputFilename);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.  Any buffered bytes are written; errors are ignored.
+    ~R3CBinaryOutputFile();
+
+
+// Open Stream
+
+public:
+
+    /*! Opens the given output file.  An existing file is truncated.
+
+        \param outputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If outputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    void open(const char* outputFilename);
+
+    /*! Opens the given output file.  An existing file is truncated.
+
+        \param outputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If outputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+    */
+    void open(R3CString* outputFilename);
+
+    /*! Sets the size of the write buffer used for subsequently opened files.
+
+        \param kbPerBuffer Number of kilobytes in the write buffer.
+        \throws R3CERR_ILLEGALARGUMENT If kbPerBuffer is less than 1.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream is already open.
+    */
+    void setBufferSize(int kbPerBuffer);
+
+
+// Write Buffer
+
+protected:
+
+    void emptyBuffer();
+
+
+// Write Bytes to the File
+
+public:
+
+    void flush();
+
+
+// Close File
+
+public:
+
+    /*! Writes any buffered bytes, and closes the output file.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void close();
+
+
+}; // end R3CBinaryOutputFile
+
+
+/* R3CBinaryOutputMemBlock */
+
+// Class definition with doxygen comments
+
+/*! Represents a block of memory being used as a binary output stream.  The
+ *  memory block is owned by the stream, and expands as bytes are written,
+ *  up to INT_MAX bytes; a write beyond that throws R3CERR_OUTOFRANGE.  A new
+ *  stream is already open.  The bytes written remain available after the
+ *  stream is closed, until it is reopened or destroyed.
+ */
+class R3CBinaryOutputMemBlock :
+    public R3CStream,
+    public R3CBinaryOutputStream
+{
+
+// Member Variables
+
+private:
+
+    //! Flag indicating whether the stream is open.
+    bool isOpen;
+
+    //! Number of bytes in the memory block.
+    int bufferSize;
+
+    //! Memory block holding the bytes written.
+    unsigned char* buffer;
+
+
+// Construction
+
+public:
+
+    //! Creates and opens a new output stream to an empty memory block.
+    R3CBinaryOutputMemBlock();
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    ~R3CBinaryOutputMemBlock();
+
+
+// Open Stream
+
+public:
+
+    /*! Reopens the stream, discarding any bytes already written.
+
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+    */
+    void open();
+
+
+// Retrieve Memory Block
+
+public:
+
+    /*! Returns the bytes written.  The pointer is invalidated by subsequent
+        writes.
+
+        \return Pointer to the first byte written.
+    */
+    const char* getBytes();
+
+    /*! Returns the number of bytes written.
+
+        \return Number of bytes written.
+    */
+    int getLength();
+
+
+// Write Buffer
+
+protected:
+
+    /*! Expands the memory block, doubling its size up to INT_MAX bytes.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_OUTOFRANGE If the memory block already holds INT_MAX
+            bytes.
+    */
+    void emptyBuffer();
+
+
+// Write Bytes to the Memory Block
+
+public:
+
+    void flush();
+
+
+// Close Stream
+
+public:
+
+    /*! Closes the stream.  The bytes written remain available.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+    */
+    void close();
+
+
+}; // end R3CBinaryOutputMemBlock
+
+
+/* R3CRandomAccessFile */
+
+// Class definition with doxygen comments
+
+/*! Represents a file being read at arbitrary positions.
+ *  Each read is made with pread, so no file position is shared between
+ *  threads, through a cache of fixed-size pages that is shared by all
+ *  threads and managed in least-recently-used order.  By default the cache
+ *  holds 64 pages of 16 KB; this can be changed by calling
+ *  \ref setCacheSize before the file is opened.
+ *
+ *  The cache is guarded by a mutex, which is not held while pages are read
+ *  from the file.  The size of the file is taken when it is opened, and
+ *  the file is assumed not to change while it is open.  Opening and closing
+ *  the file are not thread-safe.
+ */
+class R3CRandomAccessFile :
+    public R3CStream,
+    public R3CRandomAccessStream
+{
+
+// Member Variables
+
+private:
+
+    //! Page held in the cache.
+    struct CachePage {
+
+        //! Index of the page within the file.
+        off_t pageIndex;
+
+        //! Number of valid bytes in the page, which is less than the page
+        //! size only for the last page of the file.
+        int length;
+
+        //! Next page in the same hash bucket, or -1.
+        int hashNext;
+
+        //! More recently used page, or -1.
+        int lruPrev;
+
+        //! Less recently used page, or -1.
+        int lruNext;
+
+        //! Page contents.
+        char* data;
+    };
+
+    //! File descriptor, or -1 if the stream is not open.
+    int fileDesc;
+
+    //! Number of bytes in the file.
+    off_t fileSize;
+
+    //! Number of bytes in each page.
+    int pageSize;
+
+    //! Maximum number of pages held in the cache.
+    int pageCapacity;
+
+    //! Number of cache pages that have been filled.
+    int pagesUsed;
+
+    //! Storage for the contents of every cache page.
+    char* pageData;
+
+    //! Cache pages.
+    CachePage* pages;
+
+    //! Hash table of cache pages, keyed by page index.
+    int* hashBuckets;
+
+    //! Number of bits in a hash bucket index.
+    int hashBits;
+
+    //! Most recently used cache page, or -1.
+    int lruHead;
+
+    //! Least recently used cache page, or -1.
+    int lruTail;
+
+    //! Number of page lookups found in the cache.
+    unsigned long hitCount;
+
+    //! Number of page lookups read from the file.
+    unsigned long missCount;
+
+    //! Mutex guarding the cache.
+    pthread_mutex_t cacheLock;
+
+
+// Construction
+
+public:
+
+    //! Creates a new stream from an unspecified file.
+    R3CRandomAccessFile();
+
+    /*! Creates and opens a new stream from the given file.
+
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+        \throws R3CERR_IO_EXCEPTION If the file size could not be read.
+    */
+    R3CRandomAccessFile(const char* inputFilename);
+
+    /*! Creates and opens a new stream from the given file.
+
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+        \throws R3CERR_IO_EXCEPTION If the file size could not be read.
+    */
+    R3CRandomAccessFile(R3CString* inputFilename);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    ~R3CRandomAccessFile();
+
+
+// Open Stream
+
+public:
+
+    /*! Opens the given file.  The cache starts empty.
+
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+        \throws R3CERR_IO_EXCEPTION If the file size could not be read.
+    */
+    void open(const char* inputFilename);
+
+    /*! Opens the given file.  The cache starts empty.
+
+        \param inputFilename Path to file.
+        \throws R3CERR_ILLEGALARGUMENT If inputFilename is NULL.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream was already open.
+        \throws R3CERR_IO_STREAMNOTFOUND If the file could not be opened.
+        \throws R3CERR_IO_EXCEPTION If the file size could not be read.
+    */
+    void open(R3CString* inputFilename);
+
+    /*! Sets the size of the page cache used for subsequently opened files.
+
+        \param kbPerPage Number of kilobytes in each page.
+        \param pageCount Maximum number of pages held in the cache.
+        \throws R3CERR_ILLEGALARGUMENT If kbPerPage or pageCount is less than
+            1.
+        \throws R3CERR_IO_STREAMALREADYOPEN If the stream is already open.
+    */
+    void setCacheSize(int kbPerPage, int pageCount);
+
+
+// Retrieve Cache Statistics
+
+public:
+
+    /*! Returns the number of page lookups found in the cache since the file
+        was opened.
+
+        \return Number of cache hits.
+    */
+    unsigned long getCacheHits();
+
+    /*! Returns the number of page lookups read from the file since it was
+        opened.
+
+        \return Number of cache misses.
+    */
+    unsigned long getCacheMisses();
+
+
+// Manage Page Cache
+
+private:
+
+    /*! Returns the hash bucket for the given page.
+
+        \param pageIndex Index of the page within the file.
+        \return Hash bucket index.
+    */
+    int hashPage(off_t pageIndex);
+
+    /*! Finds the given page in the cache.  The cache must be locked.
+
+        \param pageIndex Index of the page within the file.
+        \return Cache page holding the page, or -1 if it is not cached.
+    */
+    int findPage(off_t pageIndex);
+
+    /*! Marks the given cache page as the most recently used.  The cache must
+        be locked.
+
+        \param slot Cache page.
+    */
+    void touchPage(int slot);
+
+    /*! Adds a page to the cache, replacing the least recently used page if
+        the cache is full.  The cache must be locked.
+
+        \param pageIndex Index of the page within the file.
+        \param data Page contents.
+        \param length Number of valid bytes in the page.
+    */
+    void insertPage(off_t pageIndex, const char* data, int length);
+
+
+// Read Bytes from the File
+
+public:
+
+    off_t getSize();
+
+    int readAt(off_t position, void* target, int byteCount);
+
+
+// Close File
+
+public:
+
+    /*! Closes the file, and empties the cache.
+
+        \throws R3CERR_IO_STREAMNOTOPEN If the stream was not open.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred.
+    */
+    void close();
+
+
+}; // end R3CRandomAccessFile
+
+
+/* R3CUringFileReader */
+
+// Class definition with doxygen comments
+
+/*! Reads a file sequentially through io_uring, into a ring of fixed-size
+ *  buffers registered with the kernel.  A read is kept in flight for every
+ *  buffer not held by the caller, and each buffer released by the caller
+ *  is immediately resubmitted for the next unread part of the file.
+ *
+ *  The io_uring interface is used directly through its system calls, so no
+ *  additional library is needed.  If the buffers cannot be registered, for
+ *  example because of the locked memory limit, unregistered reads are used.
+ *  On platforms other than Linux, or kernels without io_uring, the reader
+ *  cannot be started, and callers are expected to fall back to plain reads.
+ *
+ *  The ring and buffers are kept between files, so a single reader can scan
+ *  many files without setting up io_uring again.  A reader is not
+ *  thread-safe.
+ */
+class R3CUringFileReader {
+
+// Member Variables
+
+private:
+
+    //! io_uring file descriptor, or -1 if io_uring is not set up.
+    int ringDesc;
+
+    //! Flag indicating whether io_uring setup has already failed.
+    bool ringUnavailable;
+
+    //! Flag indicating whether the buffers are registered with the kernel.
+    bool buffersRegistered;
+
+    //! Mapping of the submission queue shared with the kernel.
+    void* sqRingPtr;
+
+    //! Number of bytes in the submission queue mapping.
+    size_t sqRingSize;
+
+    //! Mapping of the completion queue shared with the kernel, which may be
+    //! the submission queue mapping.
+    void* cqRingPtr;
+
+    //! Number of bytes in the completion queue mapping.
+    size_t cqRingSize;
+
+    //! Mapping of the submission queue entries.
+    void* sqEntries;
+
+    //! Number of bytes in the submission queue entries mapping.
+    size_t sqEntriesSize;
+
+    //! Submission queue head, advanced by the kernel.
+    unsigned* sqHead;
+
+    //! Submission queue tail, advanced by this reader.
+    unsigned* sqTail;
+
+    //! Mask applied to submission queue indexes.
+    unsigned* sqMask;
+
+    //! Submission queue array of entry indexes.
+    unsigned* sqArray;
+
+    //! Completion queue head, advanced by this reader.
+    unsigned* cqHead;
+
+    //! Completion queue tail, advanced by the kernel.
+    unsigned* cqTail;
+
+    //! Mask applied to completion queue indexes.
+    unsigned* cqMask;
+
+    //! Completion queue entries.
+    void* cqEntries;
+
+    //! Number of submission queue entries filled but not yet submitted.
+    int unsubmitted;
+
+    //! Number of buffers in the ring.
+    int bufferCount;
+
+    //! Number of bytes read into each buffer.
+    int bufferSize;
+
+    //! Buffers, each allocated with one extra byte so that the contents can
+    //! always be null-terminated.
+    char** buffers;
+
+    //! Position in the file of the first byte of each buffer.
+    off_t* bufferOffsets;
+
+    //! Number of bytes read so far into each buffer.
+    int* bufferLengths;
+
+    //! State of each buffer: empty, reading, ready or failed.
+    int* bufferStates;
+
+    //! I/O vectors used for unregistered reads.
+    void* bufferVecs;
+
+    //! File descriptor being read, or -1.
+    int fileDesc;
+
+    //! Position in the file of the next unrequested byte.
+    off_t nextOffset;
+
+    //! Number of reads in flight.
+    int readsInFlight;
+
+    //! Index of the buffer at the head of the ring.
+    int headIndex;
+
+    //! Flag indicating whether the caller holds the buffer at the head of
+    //! the ring.
+    bool headHeld;
+
+    //! Flag indicating whether a read has reached the end of the file.
+    bool atEnd;
+
+
+// Construction
+
+public:
+
+    /*! Creates a new reader.  Neither io_uring nor the buffers are set up
+        until the first file is started.
+
+        \param bufferCount Number of buffers in the ring.
+        \param bufferSize Number of bytes in each buffer.
+        \throws R3CERR_ILLEGALARGUMENT If bufferCount or bufferSize is less
+            than 1.
+    */
+    R3CUringFileReader(int bufferCount, int bufferSize);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.  Any file being read is stopped first.
+    ~R3CUringFileReader();
+
+
+// Manage Reads
+
+public:
+
+    /*! Starts reading the given file from its beginning, submitting a read
+        for every buffer.
+
+        \param fileDesc File descriptor, which remains owned by the caller.
+        \return Flag indicating whether reading started; false if io_uring
+            is unavailable.
+        \throws R3CERR_IO_STREAMALREADYOPEN If a file is already being read.
+    */
+    bool start(int fileDesc);
+
+    /*! Releases the buffer held by the caller, and waits for the next buffer
+        in the ring to be filled.
+
+        \param bufferPtr Receives a pointer to the buffer.
+        \param length Receives the number of bytes in the buffer.
+        \return Flag indicating whether any bytes were read; false if the end
+            of the file has been reached.
+        \throws R3CERR_IO_STREAMNOTOPEN If no file is being read.
+        \throws R3CERR_IO_EXCEPTION If an I/O error occurred reading the next
+            buffer.  Every buffer before it is handed out first, and every
+            later call throws again, so the file is never cut short
+            silently.
+    */
+    bool nextBuffer(char** bufferPtr, int* length);
+
+    //! Stops reading the current file, waiting for any reads in flight to
+    //! complete.  The file descriptor is not closed.
+    void stop();
+
+
+// Manage Ring
+
+private:
+
+    /*! Sets up io_uring, and registers the buffers.
+
+        \return Flag indicating whether io_uring is available.
+    */
+    bool setupRing();
+
+    /*! Queues a read for the unfilled part of the given buffer.
+
+        \param bufferIndex Buffer to read into.
+    */
+    void queueRead(int bufferIndex);
+
+    /*! Submits all queued reads.
+
+        \throws R3CERR_IO_EXCEPTION If the reads could not be submitted.
+    */
+    void submitReads();
+
+    /*! Waits for a read to complete, and updates the state of its buffer.
+
+        \return Result of the read: bytes read, or a negated error number.
+        \throws R3CERR_IO_EXCEPTION If no completion could be collected.
+    */
+    int completeRead();
+
+
+}; // end R3CUringFileReader
+
+
+/* R3CTextLineSplitter */
+
+// Class definition with doxygen comments
+
+/*! Splits a text file, or a block of characters, into byte ranges that
+ *  begin and end on line boundaries, and hands each range to its own worker
+ *  thread.  Lines are found with the same rules as readLine: a line ends at
+ *  any of R3C_STR_NEWLINE or a null character, and blank lines are skipped.
+ *
+ *  Ranges are roughly equal in size; each range boundary is moved forward
+ *  past the next newline.  The calling thread processes the first range
+ *  itself, so processing with one worker starts no threads at all.
+ */
+class R3CTextLineSplitter {
+
+// Member Variables
+
+private:
+
+    //! Argument passed to each worker thread.
+    struct WorkerTask {
+
+        //! Splitter running the worker.
+        R3CTextLineSplitter* splitter;
+
+        //! Index of the worker, and of the range it processes.
+        int workerIndex;
+    };
+
+    //! Number of worker threads, and of ranges.
+    int workerCount;
+
+    //! Boundaries of the ranges: range i is from rangeBounds[i] up to
+    //! rangeBounds[i + 1].
+    off_t* rangeBounds;
+
+    //! Characters being processed.
+    const char* sourceChars;
+
+    //! Handler receiving the lines being processed.
+    R3CTextLineHandler* lineHandler;
+
+    //! First exception thrown by a worker, or NULL.
+    const char* workerError;
+
+#if __cplusplus >= 201103L
+    //! First exception thrown by a worker, if it was not a character
+    //! string; otherwise null.
+    std::exception_ptr workerException;
+#endif
+
+    //! Flag asking workers to stop early, set after an exception.
+    int stopping;
+
+    //! Mutex guarding the worker exceptions.
+    pthread_mutex_t errorLock;
+
+
+// Construction
+
+public:
+
+    /*! Creates a new splitter.
+
+        \param workerCount Number of worker threads, and of ranges.
+        \throws R3CERR_ILLEGALARGUMENT If workerCount is less than 1.
+    */
+    R3CTextLineSplitter(int workerCount);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    ~R3CTextLineSplitter();
+
+
+// Split Ranges
+
+public:
+
+    /*! Splits the given characters into ranges aligned to line boundaries.
+        Some ranges may be empty if the characters hold only a few long
+        lines.
+
+        \param chars Characters to split.
+        \param length Number of characters.
+        \throws R3CERR_ILLEGALARGUMENT If chars is NULL while length is
+            greater than 0, or length is less than 0.
+    */
+    void split(const char* chars, off_t length);
+
+    /*! Returns the number of ranges.
+
+        \return Number of ranges.
+    */
+    int getRangeCount();
+
+    /*! Returns the position of the first character of the given range, as
+        of the last split.
+
+        \param rangeIndex Index of the range.
+        \return Position of the start of the range.
+        \throws R3CERR_OUTOFRANGE If rangeIndex is not a valid range.
+    */
+    off_t getRangeStart(int rangeIndex);
+
+    /*! Returns the position just past the last character of the given range,
+        as of the last split.
+
+        \param rangeIndex Index of the range.
+        \return Position of the end of the range.
+        \throws R3CERR_OUTOFRANGE If rangeIndex is not a valid range.
+    */
+    off_t getRangeEnd(int rangeIndex);
+
+
+// Process Lines
+
+public:
+
+    /*! Splits the given characters, and hands every non-blank line to the
+        given handler from the worker threads.  This method returns once
+        every worker has finished.
+
+        \param chars Characters to process.
+        \param length Number of characters.
+        \param handler Handler receiving the lines.
+        \throws R3CERR_ILLEGALARGUMENT If chars is NULL while length is
+            greater than 0, length is less than 0, or handler is NULL.
+        \throws R3CERR_OUTOFRANGE If a line is longer than INT_MAX
+            characters.
+        \throws R3CERR_IO_EXCEPTION If a worker thread could not be started,
+            or, before C++11, if the handler threw anything other than a
+            character string.
+        \throws Any exception thrown by the handler, once every worker has
+            stopped.
+    */
+    void process(
+        const char* chars, off_t length, R3CTextLineHandler* handler);
+
+    /*! Splits the given memory-mapped file, and hands every non-blank line
+        to the given handler from the worker threads.  The stream position
+        is not used or changed.
+
+        \param inputFile Open memory-mapped file.
+        \param handler Handler receiving the lines.
+        \throws R3CERR_ILLEGALARGUMENT If inputFile or handler is NULL.
+        \throws R3CERR_IO_STREAMNOTOPEN If the file was not open.
+        \throws R3CERR_OUTOFRANGE If a line is longer than INT_MAX
+            characters.
+        \throws R3CERR_IO_EXCEPTION If a worker thread could not be started,
+            or, before C++11, if the handler threw anything other than a
+            character string.
+        \throws Any exception thrown by the handler, once every worker has
+            stopped.
+    */
+    void process(R3CTextInputMemMap* inputFile, R3CTextLineHandler* handler);
+
+
+// Run Workers
+
+private:
+
+    /*! Entry point of a worker thread.
+
+        \param workerTask WorkerTask identifying the worker.
+        \return NULL.
+    */
+    static void* runWorker(void* workerTask);
+
+    /*! Hands every non-blank line of the given range to the handler,
+        recording any exception thrown.
+
+        \param workerIndex Index of the worker, and of its range.
+    */
+    void processRange(int workerIndex);
+
+    /*! Records the given exception, unless one was already recorded, and
+        asks every worker to stop.
+
+        \param error Exception to record, or NULL.
+    */
+    void stopWorkers(const char* error);
+
+
+}; // end R3CTextLineSplitter
+
+
+/* R3CDirectoryWalker */
+
+// Class-related constants
+
+//! Default number of folders that can wait in the shared folder queue.
+#define R3C_IO_WALKQUEUE 4096
+
+//! Number of bytes of folder entries read at a time.
+#define R3C_IO_WALKBUFFER 32768
+
+// Class-related data types
+
+struct R3CWalkFolder;
+
+// Class definition with doxygen comments
+
+/*! Walks a folder tree with several worker threads, handing every entry
+ *  found to a handler.  On Linux, folders are opened with openat and read
+ *  with the getdents64 system call, so entry types come from the folder
+ *  itself and most entries need no stat call; elsewhere, readdir is used.
+ *
+ *  Folders waiting to be read are kept in a queue shared by the workers,
+ *  which holds a fixed number of folders.  When the queue is full, a
+ *  worker reads the folder it has found itself, before going on, so memory
+ *  and open files stay bounded however wide the tree is.  The calling
+ *  thread acts as the first worker, so walking with one worker starts no
+ *  threads at all.
+ *
+ *  Entries can be excluded with filename patterns, as used by r3cPathMatch.
+ *  A pattern containing R3C_PATH_SEPARATOR is matched against the path of
+ *  the entry relative to the root folder; any other pattern is matched
+ *  against the entry name.  Excluded entries are not handled, and excluded
+ *  folders are not read, so whole subtrees are pruned during the walk.
+ *  Symbolic links are handled as entries, but never followed, and folders
+ *  that cannot be opened or read, for example for lack of permission, are
+ *  skipped.
+ */
+class R3CDirectoryWalker {
+
+// Member Variables
+
+private:
+
+    //! Argument passed to each worker thread.
+    struct WorkerTask {
+
+        //! Walker running the worker.
+        R3CDirectoryWalker* walker;
+
+        //! Index of the worker.
+        int workerIndex;
+    };
+
+    //! Number of worker threads.
+    int workerCount;
+
+    //! Number of folders that the queue can hold.
+    int queueCapacity;
+
+    //! Ring of folders waiting to be read.
+    R3CWalkFolder* queue;
+
+    //! Index of the first folder in the queue.
+    int queueHead;
+
+    //! Number of folders in the queue.
+    int queueCount;
+
+    //! Number of workers reading a folder taken from the queue.
+    int activeCount;
+
+    //! Patterns matched against entry names.
+    R3CPathPatternSet nameExcludes;
+
+    //! Patterns matched against paths relative to the root folder.
+    R3CPathPatternSet pathExcludes;
+
+    //! Position, within each path, of the path relative to the root folder.
+    int relativeOffset;
+
+    //! Handler receiving the entries being walked.
+    R3CDirectoryEntryHandler* entryHandler;
+
+    //! First exception thrown by a worker, or NULL.
+    const char* workerError;
+
+#if __cplusplus >= 201103L
+    //! First exception thrown by a worker, if it was not a character
+    //! string; otherwise null.
+    std::exception_ptr workerException;
+#endif
+
+    //! Flag asking workers to stop early, set after an exception.
+    int stopping;
+
+    //! Mutex guarding the queue, activeCount and the worker exceptions.
+    pthread_mutex_t queueLock;
+
+    //! Condition signalled when a folder is queued, or the walk ends.
+    pthread_cond_t queueReady;
+
+
+// Construction
+
+public:
+
+    /*! Creates a new walker, with a queue of R3C_IO_WALKQUEUE folders.
+
+        \param workerCount Number of worker threads.
+        \throws R3CERR_ILLEGALARGUMENT If workerCount is less than 1.
+    */
+    R3CDirectoryWalker(int workerCount);
+
+    /*! Creates a new walker.
+
+        \param workerCount Number of worker threads.
+        \param queueCapacity Number of folders that can wait in the queue.
+        \throws R3CERR_ILLEGALARGUMENT If workerCount or queueCapacity is
+            less than 1.
+    */
+    R3CDirectoryWalker(int workerCount, int queueCapacity);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    ~R3CDirectoryWalker();
+
+
+// Manage Exclusions
+
+public:
+
+    /*! Excludes the entries matching the given filename pattern from every
+        later walk.
+
+        \param pattern Filename pattern, which may contain * and ?
+            wildcards.
+        \throws R3CERR_ILLEGALARGUMENT If pattern is NULL.
+    */
+    void exclude(const char* pattern);
+
+
+// Walk Folders
+
+public:
+
+    /*! Walks the folder tree under the given root folder, and hands every
+        entry that is not excluded to the given handler from the worker
+        threads.  The root folder itself is not handled.  This method
+        returns once every worker has finished.
+
+        \param rootPath Path of the root folder.
+        \param handler Handler receiving the entries.
+        \throws R3CERR_ILLEGALARGUMENT If rootPath or handler is NULL.
+        \throws R3CERR_IO_STREAMNOTFOUND If the root folder could not be
+            opened.
+        \throws R3CERR_IO_EXCEPTION If a worker thread could not be started,
+            or, before C++11, if the handler threw anything other than a
+            character string.
+        \throws Any exception thrown by the handler, once every worker has
+            stopped.
+    */
+    void walk(const char* rootPath, R3CDirectoryEntryHandler* handler);
+
+    /*! Walks the folder tree under the given root folder, and adds the path
+        of every entry of the given types that is not excluded to the given
+        string block.  Paths are added in no particular order.
+
+        \param rootPath Path of the root folder.
+        \param targetBlock String block receiving the paths.
+        \param entryTypes Types of the entries to add, as a combination of
+            the R3C_IO_ENTRY_* constants.
+        \return Number of paths added.
+        \throws R3CERR_ILLEGALARGUMENT If rootPath or targetBlock is NULL.
+        \throws R3CERR_IO_STREAMNOTFOUND If the root folder could not be
+            opened.
+        \throws R3CERR_IO_EXCEPTION If a worker thread could not be started.
+    */
+    int walk(
+        const char* rootPath, R3CStringBlock* targetBlock, int entryTypes);
+
+
+// Run Workers
+
+private:
+
+    /*! Entry point of a worker thread.
+
+        \param workerTask WorkerTask identifying the worker.
+        \return NULL.
+    */
+    static void* runWorker(void* workerTask);
+
+    /*! Reads folders from the queue until the walk ends, recording any
+        exception thrown.
+
+        \param workerIndex Index of the worker.
+    */
+    void processQueue(int workerIndex);
+
+    /*! Records the given exception, unless one was already recorded, and
+        asks every worker to stop.
+
+        \param error Exception to record, or NULL.
+        \param wasActive Flag indicating whether the worker was reading a
+            folder taken from the queue.
+    */
+    void stopWorkers(const char* error, bool wasActive);
+
+    /*! Reads every entry of the given open folder, and closes it.
+
+        \param folderDesc File descriptor of the folder.
+        \param path Path of the folder, which is extended with the name of
+            each entry in turn.
+        \param buffer Buffer of R3C_IO_WALKBUFFER bytes for reading entries.
+        \param workerIndex Index of the worker.
+    */
+    void walkFolder(
+        int folderDesc, R3CPathString* path, char* buffer, int workerIndex);
+
+    /*! Handles one entry of a folder, and queues or reads it if it is a
+        folder.
+
+        \param folderDesc File descriptor of the folder holding the entry.
+        \param path Path of the folder, which is restored before returning.
+        \param name Name of the entry.
+        \param entryType Type of the entry, or 0 if it is not known.
+        \param workerIndex Index of the worker.
+    */
+    void visitEntry(
+        int folderDesc, R3CPathString* path, const char* name, int entryType,
+        int workerIndex);
+
+    /*! Adds the given folder path to the queue, unless the queue is full.
+
+        \param path Path of the folder.
+        \return Flag indicating whether the folder was queued.
+    */
+    bool queueFolder(R3CPathString* path);
+
+
+}; // end R3CDirectoryWalker
 
 
 #endif
@@ -16,9 +16,23 @@
  *  against character strings, such as changing case, trimming (typically
  *  whitespace), and matching path patterns.
  *  
+ *  Class R3CCharSet holds a set of characters that character strings can be
+ *  scanned against, many characters at a time.
+ *  
+ *  Class R3CPathPattern compiles a filename pattern once, so that it can be
+ *  matched against many path strings quickly.  Class R3CPathPatternSet
+ *  matches a string against many such patterns at once.
+ *  
  *  Class R3CFormatParser provides a means to create functions that use
  *  C-style format strings.
  *  
+ *  Class R3CStringView refers to a run of characters owned by someone else,
+ *  such as a memory-mapped file, without copying or modifying them.
+ *  
+ *  Class R3CAllocator lets strings take their storage from somewhere other
+ *  than the heap.  Class R3CStringArena hands out storage that is all freed
+ *  in one step, and class R3CStringPool reuses storage by size class.
+ *  
  *  Class R3CString provides management of variable-length strings.  Class
  *  R3CPathString provides some convenience methods for managing directory
  *  path and filename strings.  Class R3CUnicode provides management of
@@ -37,6 +51,7 @@
 // *** ADDITIONAL INCLUDES *** //
 
 #include <string.h>
+#include <stdarg.h>
 
 
 // *** DECLARATIONS *** //
@@ -71,9 +86,16 @@ extern const char* R3C_STR_WHITESPACE;
 
 // Class List
 
+class R3CCharSet;
 class R3CFormatParser;
+class R3CStringView;
+class R3CAllocator;
+class R3CStringArena;
+class R3CStringPool;
 class R3CString;
 class R3CPathString;
+class R3CPathPattern;
+class R3CPathPatternSet;
 class R3CStringBlock;
 class R3CStringBlockStack;
 class R3CUnicode;
@@ -95,6 +117,55 @@ int r3cStrUpper(char* str);
 */
 int r3cStrLower(char* str);
 
+/*! Converts the given characters to upper-case.  The characters do not need
+    to be null-terminated, and null-terminators are passed over.  Where the
+    processor supports it, 16 to 64 characters are converted at a time.
+
+    \param str Characters to convert.
+    \param strLength Number of characters to convert.
+    \return Number of characters converted to upper-case.
+    \throws R3CERR_ILLEGALARGUMENT If strLength is less than 0.
+*/
+int r3cStrUpper(char* str, int strLength);
+
+/*! Converts the given characters to lower-case.  The characters do not need
+    to be null-terminated, and null-terminators are passed over.  Where the
+    processor supports it, 16 to 64 characters are converted at a time.
+
+    \param str Characters to convert.
+    \param strLength Number of characters to convert.
+    \return Number of characters converted to lower-case.
+    \throws R3CERR_ILLEGALARGUMENT If strLength is less than 0.
+*/
+int r3cStrLower(char* str, int strLength);
+
+/*! Compares the given characters, ignoring the case of letters (A to Z).
+    The characters do not need to be null-terminated.  Characters are
+    compared as lower-case, unsigned values; if one run of characters starts
+    with the other, the shorter one is less.
+
+    \param str1 First characters to compare.
+    \param length1 Number of characters in str1.
+    \param str2 Second characters to compare.
+    \param length2 Number of characters in str2.
+    \return Value that is less than 0, equal to 0, or greater than 0; as str1
+        is less than, equal to, or greater than str2.
+    \throws R3CERR_ILLEGALARGUMENT If either length is less than 0.
+*/
+int r3cStrCompareNoCase(
+    const char* str1, int length1, const char* str2, int length2);
+
+/*! Computes a hash of the given characters, ignoring the case of letters (A
+    to Z), so that characters that r3cStrCompareNoCase finds equal have the
+    same hash.  The characters do not need to be null-terminated.
+
+    \param str Characters to hash.
+    \param strLength Number of characters to hash.
+    \return Hash of the characters.
+    \throws R3CERR_ILLEGALARGUMENT If strLength is less than 0.
+*/
+unsigned int r3cStrHashNoCase(const char* str, int strLength);
+
 /*! Left-trims the given character string.
 
     \param str Character string.
@@ -125,6 +196,66 @@ int r3cStrRTrim(char* str, const char* trimChars);
 */
 int r3cStrTrim(char* str, const char* trimChars);
 
+/*! Left-trims the given characters, whose length is already known.  The
+    characters do not need to be null-terminated; if any are trimmed, a
+    null-terminator is written after those that remain.
+
+    \param str Characters to trim.
+    \param strLength Number of characters.
+    \param trimChars Characters that should be trimmed, typically
+        R3C_STR_SPACE (to trim only spaces) or R3C_STR_LINESPACE (to trim
+        spaces and tabs).
+    \return Number of characters trimmed.
+    \throws R3CERR_ILLEGALARGUMENT If strLength is less than 0.
+*/
+int r3cStrLTrim(char* str, int strLength, const char* trimChars);
+
+/*! Right-trims the given characters, whose length is already known.  The
+    characters do not need to be null-terminated; if any are trimmed, a
+    null-terminator is written after those that remain.
+
+    \param str Characters to trim.
+    \param strLength Number of characters.
+    \param trimChars Characters that should be trimmed, typically
+        R3C_STR_SPACE (to trim only spaces) or R3C_STR_LINESPACE (to trim
+        spaces and tabs).
+    \return Number of characters trimmed.
+    \throws R3CERR_ILLEGALARGUMENT If strLength is less than 0.
+*/
+int r3cStrRTrim(char* str, int strLength, const char* trimChars);
+
+/*! Fully trims the given characters, whose length is already known.  The
+    characters do not need to be null-terminated; if any are trimmed, a
+    null-terminator is written after those that remain.
+
+    \param str Characters to trim.
+    \param strLength Number of characters.
+    \param trimChars Characters that should be trimmed, typically
+        R3C_STR_SPACE (to trim only spaces) or R3C_STR_LINESPACE (to trim
+        spaces and tabs).
+    \return Number of characters trimmed.
+    \throws R3CERR_ILLEGALARGUMENT If strLength is less than 0.
+*/
+int r3cStrTrim(char* str, int strLength, const char* trimChars);
+
+/*! Finds the characters that would remain if the given characters were fully
+    trimmed, without moving or changing them.  The characters do not need to
+    be null-terminated.
+
+    \param str Characters to trim.
+    \param strLength Number of characters.
+    \param trimChars Characters that should be trimmed, typically
+        R3C_STR_SPACE (to trim only spaces) or R3C_STR_LINESPACE (to trim
+        spaces and tabs).
+    \param startPos Receives the position of the first remaining character.
+    \param trimLength Receives the number of remaining characters.
+    \throws R3CERR_ILLEGALARGUMENT If trimChars, startPos or trimLength is
+        NULL; or strLength is less than 0.
+*/
+void r3cStrTrimBounds(
+    const char* str, int strLength, const char* trimChars,
+    int* startPos, int* trimLength);
+
 /*! Passes over the given passable character in the target character string,
     until another character is reached.
 
@@ -293,7 +424,33 @@ const char* r3cStrReachChars(
 const char* r3cStrReachChars(
     const char* targetStr, const char reachGroups[][2], int groupCount);
 
-/*! Checks if the given character string matches a filename pattern.
+/*! Passes over all newline characters (see R3C_STR_NEWLINE) and
+    null-terminators in the target character buffer, until another character
+    is reached or endStr is reached.  The buffer does not need to be
+    null-terminated.
+
+    \param targetStr Target character buffer.
+    \param endStr Pointer just past the last character in the buffer.
+    \return Pointer to the next character that is not a newline character or
+        null-terminator, or endStr.
+*/
+const char* r3cStrPassNewlines(const char* targetStr, const char* endStr);
+
+/*! Passes over all characters in the target character buffer, until it finds
+    a newline character (see R3C_STR_NEWLINE) or a null-terminator, or until
+    endStr is reached.  The buffer does not need to be null-terminated.  The
+    buffer is scanned a machine word at a time.
+
+    \param targetStr Target character buffer.
+    \param endStr Pointer just past the last character in the buffer.
+    \return Pointer to the next newline character or null-terminator, or
+        endStr.
+*/
+const char* r3cStrReachNewline(const char* targetStr, const char* endStr);
+
+/*! Checks if the given character string matches a filename pattern.  To
+    match many strings against the same pattern, compile it once with
+    R3CPathPattern instead.
     
     \param str Character string.
     \param pattern String containing the filename mattern.
@@ -303,9 +460,247 @@ const char* r3cStrReachChars(
 */
 bool r3cPathMatch(const char* str, const char* pattern);
 
+/*! Checks if the given characters match a filename pattern.  The characters
+    do not need to be null-terminated.
+
+    \param str Characters to match.
+    \param strLength Number of characters to match.
+    \param pattern String containing the filename pattern.
+    \return Flag indicating whether the characters match the filename
+        pattern.
+    \throws R3CERR_ILLEGALARGUMENT If either str or pattern is NULL, or
+        strLength is less than 0.
+*/
+bool r3cPathMatch(const char* str, int strLength, const char* pattern);
+
 
 // *** CLASS DEFINITIONS *** //
 
+/* R3CCharSet */
+
+// Class definition with doxygen comments
+
+/*! A set of characters, held as a 256-bit map, that character strings can be
+ *  scanned against.  Building a set once and reusing it is cheaper than
+ *  passing the same characters to r3cStrPassChars or r3cStrReachChars on
+ *  every call.  Where the processor supports it (as found at run time),
+ *  strings are scanned 32 or 16 characters at a time.
+ */
+class R3CCharSet {
+
+// Member Variables
+
+protected:
+
+    //! Map of the characters in the set.  The bit for character c is bit
+    //! ((c >> 4) & 7) of entry ((c & 15) + 16 * (c >= 128)), treating c as
+    //! unsigned; this layout lets a whole block of characters be looked up
+    //! with two table shuffles.
+    unsigned char rows[32];
+
+
+// Construction
+
+public:
+
+    //! Creates a new, empty character set.
+    R3CCharSet();
+
+    /*! Creates a new character set, holding the given characters.
+
+        \param chars Character string.
+        \throws R3CERR_ILLEGALARGUMENT If chars is NULL.
+    */
+    explicit R3CCharSet(const char* chars);
+
+    /*! Creates a new character set, holding the given character range
+        (inclusive).
+
+        \param firstChar First character in the range.
+        \param lastChar Last character in the range.
+        \throws R3CERR_ILLEGALARGUMENT If firstChar is greater than lastChar.
+    */
+    R3CCharSet(char firstChar, char lastChar);
+
+    /*! Creates a new character set, holding the given character ranges (each
+        inclusive).
+
+        \param groups Array of character ranges.
+        \param groupCount Number of character ranges.
+        \throws R3CERR_ILLEGALARGUMENT If the first character in any group is
+            greater than the second character; groupCount is less than 0; or
+            groups is NULL and groupCount is greater than 0.
+    */
+    R3CCharSet(const char groups[][2], int groupCount);
+
+
+// Shared Sets
+
+public:
+
+    /*! Returns a set holding the given characters.  For R3C_STR_SPACE,
+        R3C_STR_LINESPACE, R3C_STR_NEWLINE and R3C_STR_WHITESPACE, a set that
+        is built once and shared is returned, and must not be changed; for
+        any other characters, the set is built in buildSet.
+
+        \param chars Character string.
+        \param buildSet Set to build into, if there is no shared set.
+        \return The shared set, or buildSet.
+        \throws R3CERR_ILLEGALARGUMENT If chars or buildSet is NULL.
+    */
+    static R3CCharSet* getSet(const char* chars, R3CCharSet* buildSet);
+
+
+// Update Set
+
+public:
+
+    /*! Adds the given character to this set.
+
+        \param c Character.
+    */
+    void add(char c);
+
+    /*! Adds the given characters to this set.
+
+        \param chars Character string.
+        \throws R3CERR_ILLEGALARGUMENT If chars is NULL.
+    */
+    void add(const char* chars);
+
+    /*! Adds the given character range (inclusive) to this set.
+
+        \param firstChar First character in the range.
+        \param lastChar Last character in the range.
+        \throws R3CERR_ILLEGALARGUMENT If firstChar is greater than lastChar.
+    */
+    void add(char firstChar, char lastChar);
+
+    /*! Adds the given character ranges (each inclusive) to this set.
+
+        \param groups Array of character ranges.
+        \param groupCount Number of character ranges.
+        \throws R3CERR_ILLEGALARGUMENT If the first character in any group is
+            greater than the second character; groupCount is less than 0; or
+            groups is NULL and groupCount is greater than 0.
+    */
+    void add(const char groups[][2], int groupCount);
+
+    /*! Removes the given character from this set.
+
+        \param c Character.
+    */
+    void remove(char c);
+
+    //! Replaces this set with every character that it does not hold.
+    void invert();
+
+    //! Removes all characters from this set.
+    void clear();
+
+
+// Retrieve Set Info
+
+public:
+
+    /*! Checks if this set holds the given character.
+
+        \param c Character.
+        \return Flag indicating whether this set holds the character.
+    */
+    bool contains(char c);
+
+
+// Scan Strings
+
+public:
+
+    /*! Passes over all characters in the target character string that are
+        in this set.  The null-terminator is never passed over.
+
+        \param targetStr Target character string.
+        \return Pointer to the next character in targetStr that is not in this
+            set, or the null-terminator.
+    */
+    const char* passChars(const char* targetStr);
+
+    /*! Passes over all characters in the target character string that are
+        in this set, or until charCount characters have been passed.  The
+        null-terminator is never passed over.
+
+        \param targetStr Target character string.
+        \param charCount Maximum number of characters to pass.
+        \return Pointer to the next character in targetStr that is not in this
+            set, or the null-terminator, or (targetStr + charCount), whichever
+            is first.
+        \throws R3CERR_ILLEGALARGUMENT If charCount is less than 0.
+    */
+    const char* passChars(const char* targetStr, int charCount);
+
+    /*! Passes over all characters in the target character buffer that are in
+        this set, until endStr is reached.  The buffer does not need to be
+        null-terminated; null-terminators are treated like any other
+        character.
+
+        \param targetStr Target character buffer.
+        \param endStr Pointer just past the last character in the buffer.
+        \return Pointer to the next character that is not in this set, or
+            endStr.
+        \throws R3CERR_ILLEGALARGUMENT If endStr is before targetStr.
+    */
+    const char* passChars(const char* targetStr, const char* endStr);
+
+    /*! Passes over all characters in the target character string, until it
+        finds one that is in this set.
+
+        \param targetStr Target character string.
+        \return Pointer to the next character in targetStr that is in this
+            set, or the null-terminator.
+    */
+    const char* reachChars(const char* targetStr);
+
+    /*! Passes over all characters in the target character string, until it
+        finds one that is in this set, or until charCount characters have been
+        passed.
+
+        \param targetStr Target character string.
+        \param charCount Maximum number of characters to pass.
+        \return Pointer to the next character in targetStr that is in this
+            set, or the null-terminator, or (targetStr + charCount), whichever
+            is first.
+        \throws R3CERR_ILLEGALARGUMENT If charCount is less than 0.
+    */
+    const char* reachChars(const char* targetStr, int charCount);
+
+    /*! Passes over all characters in the target character buffer, until it
+        finds one that is in this set, or until endStr is reached.  The
+        buffer does not need to be null-terminated; null-terminators are
+        treated like any other character.
+
+        \param targetStr Target character buffer.
+        \param endStr Pointer just past the last character in the buffer.
+        \return Pointer to the next character that is in this set, or endStr.
+        \throws R3CERR_ILLEGALARGUMENT If endStr is before targetStr.
+    */
+    const char* reachChars(const char* targetStr, const char* endStr);
+
+    /*! Passes backwards over all characters in the target character buffer
+        that are in this set, starting with the one just before endStr, until
+        targetStr is reached.  The buffer does not need to be
+        null-terminated.
+
+        \param targetStr Target character buffer.
+        \param endStr Pointer just past the last character in the buffer.
+        \return Pointer just past the last character that is not in this set,
+            or targetStr.
+        \throws R3CERR_ILLEGALARGUMENT If endStr is before targetStr.
+    */
+    const char* passCharsBack(const char* targetStr, const char* endStr);
+
+
+}; // end R3CCharSet
+
+
 /* R3CFormatParser */
 
 // Class-related constants
@@ -321,21 +716,126 @@ bool r3cPathMatch(const char* str, const char* pattern);
 //! Type of format piece, indicating a generic pointer.
 #define R3C_FORMAT_POINTER 4
 
+//! Type of argument for a format piece that takes none.
+#define R3C_FORMAT_ARG_NONE 0
+//! Type of argument for a conversion that takes an int.
+#define R3C_FORMAT_ARG_INT 1
+//! Type of argument for a conversion that takes a long.
+#define R3C_FORMAT_ARG_LONG 2
+//! Type of argument for a conversion that takes a long long.
+#define R3C_FORMAT_ARG_LONGLONG 3
+//! Type of argument for a conversion that takes a size_t.
+#define R3C_FORMAT_ARG_SIZE 4
+//! Type of argument for a conversion that takes a double.
+#define R3C_FORMAT_ARG_DOUBLE 5
+//! Type of argument for a conversion that takes a long double.
+#define R3C_FORMAT_ARG_LONGDOUBLE 6
+//! Type of argument for a conversion that takes a character string.
+#define R3C_FORMAT_ARG_STRING 7
+//! Type of argument for a conversion that takes a generic pointer.
+#define R3C_FORMAT_ARG_POINTER 8
+
+//! Size of the longest conversion that can be parsed, including the
+//! null-terminator.
+#define R3C_FORMAT_MAXSPEC 32
+
+//! Conversion flag, indicating the result is left-justified (-).
+#define R3C_FORMAT_FLAG_LEFT 1
+//! Conversion flag, indicating a sign is always written (+).
+#define R3C_FORMAT_FLAG_PLUS 2
+//! Conversion flag, indicating a space is written in place of a plus sign.
+#define R3C_FORMAT_FLAG_SPACE 4
+//! Conversion flag, indicating the alternate form is used (#).
+#define R3C_FORMAT_FLAG_ALT 8
+//! Conversion flag, indicating the result is padded with zeros (0).
+#define R3C_FORMAT_FLAG_ZERO 16
+
 // Class-related data types
 
 struct R3CFormatPiece;
 
+/*! Describes a single conversion, such as "%-8.3f", in decoded form.
+ */
+struct R3CFormatSpec {
+
+    //! Combination of R3C_FORMAT_FLAG_ constants.
+    int flags;
+
+    //! Minimum number of characters written.
+    int width;
+
+    //! Precision, or -1 if none was given.
+    int precision;
+
+    //! Number of bits in the argument, according to the size portion.
+    int valueBits;
+
+    //! Conversion character, such as 'd' or 'f'.
+    char conversion;
+
+}; // end R3CFormatSpec
+
+// Class-related functions
+
+/*! Decodes the given conversion, which must follow the rules used by
+    R3CFormatParser::parse.
+
+    \param spec Null-terminated conversion, starting with the % character.
+    \param result Decoded conversion.
+*/
+void r3cFormatDecodeSpec(const char* spec, R3CFormatSpec* result);
+
+/*! Formats an integer or character in the same way as snprintf, without
+    writing a null-terminator.  Passing a NULL target measures the result.
+
+    \param target Target characters, or NULL.
+    \param spec Decoded conversion, for one of d, i, u, x, X, o or c.
+    \param value Integer value; only the bits indicated by the conversion are
+        used.
+    \return Number of characters in the result, or -1 if the conversion is not
+        supported, in which case snprintf should be used instead.
+*/
+int r3cFormatInteger(char* target, const R3CFormatSpec* spec, long long value);
+
+/*! Formats a floating-point number in the same way as snprintf, without
+    writing a null-terminator.  Passing a NULL target measures the result.
+    The result is rounded exactly, as the C library does.
+
+    \param target Target characters, or NULL.
+    \param spec Decoded conversion, for one of f, F, e, E, g or G.
+    \param value Floating-point value.
+    \return Number of characters in the result, or -1 if the conversion or
+        value is not supported, in which case snprintf should be used instead.
+*/
+int r3cFormatDouble(char* target, const R3CFormatSpec* spec, double value);
+
+/*! Formats a generic pointer in the same way as snprintf, without writing a
+    null-terminator.  Passing a NULL target measures the result.
+
+    \param target Target characters, or NULL.
+    \param spec Decoded conversion, for p.
+    \param value Generic pointer.
+    \return Number of characters in the result, or -1 if the conversion is not
+        supported, in which case snprintf should be used instead.
+*/
+int r3cFormatPointer(
+    char* target, const R3CFormatSpec* spec, const void* value);
+
 // Class definition with doxygen comments
 
 /*! Represents a C-style format string.
  *  This is used to build a formatted string from a C-style format string.
  *  Parse a new string by calling \ref parse.  Once the format string has been
- *  parsed, loop through the pieces of the string using the va_start, va_arg,
+ *  parsed, either call \ref vappend to append the whole formatted string at
+ *  once, or loop through the pieces of the string using the va_start, va_arg,
  *  and va_end macros:
  *  - Call \ref getPieceType to determine the current piece's data type.
  *  - Call the corresponding <b>append</b> method to append the piece to an
  *    R3CString object.
  *  .
+ *
+ *  Parsed format strings can be shared through \ref lookup, so that a format
+ *  string used repeatedly is only parsed once.
  */
 class R3CFormatParser {
 
@@ -358,11 +858,11 @@ protected:
     //! String delimiter character.
     char stringDelimiter;
 
-    //! Current format string, used by appendPiece methods.
-    char formatter[28];
+    //! Format string pointer this parser was cached under by \ref lookup.
+    const char* cacheKey;
 
-    //! Current result of format conversion, used by appendPiece methods.
-    char formatResult[96];
+    //! Copy of the format string owned by this parser, or NULL.
+    char* formatCopy;
 
 
 // Construction
@@ -414,7 +914,7 @@ protected:
     const char* passPrecision(const char* strPtr);
 
     /*! Passes over the size portion of a format entry in the format string.
-        This includes the letter "l".
+        This includes the letters "h", "hh", "l", "ll", "L", and "z".
 
         \param strPtr Pointer to the current position in the format string.
         \return Pointer to the new position in the format string.
@@ -440,15 +940,50 @@ protected:
     */
     int resolveFormatType(char curChar);
 
+    /*! Resolves the type of argument taken by a conversion.
+
+        \param dataType Type of format entry, as identified by the
+            corresponding R3C_FORMAT_ constant.
+        \param sizePtr Pointer to the size portion of the format entry.
+        \return Type of argument, as identified by the corresponding
+            R3C_FORMAT_ARG_ constant.
+    */
+    int resolveArgType(int dataType, const char* sizePtr);
+
 
 public:
 
-    /*! Parses the given format string into its component parts.
+    /*! Parses the given format string into its component parts.  The format
+        string is not copied, and must remain valid while this parser is in
+        use.  Conversions using * for the width or precision are not
+        supported.
     
         \param formatString Format string.
+        \throws R3CERR_ILLEGALARGUMENT If formatString is NULL, or contains a
+            conversion longer than 31 characters.
     */
     void parse(const char* formatString);
 
+    /*! Returns a parser for the given format string, shared by all callers.
+        The first call for a format string parses a copy of it, and later
+        calls with the same pointer and contents return the same parser,
+        for as long as it stays in the cache.  The cache holds a few parsers
+        for each group of pointers, and replaces them as other format
+        strings are looked up.  Shared parsers, including replaced ones, are
+        kept until the program ends, and must only be used through \ref
+        vappend, \ref getPieceCount and \ref getPieceType.  Since replaced
+        parsers are kept, only a limited number are replaced, after which
+        format strings that are not already cached are left to the caller.
+        This method is thread-safe.
+
+        \param formatString Format string.
+        \return Shared parser, or NULL if the format string could not be
+            cached, in which case the caller should parse it itself.
+        \throws R3CERR_ILLEGALARGUMENT If formatString is NULL, or contains a
+            conversion longer than 31 characters.
+    */
+    static R3CFormatParser* lookup(const char* formatString);
+
 
 // Retrieve format piece information
 
@@ -471,15 +1006,6 @@ public:
 
 // Append format conversions to a string
 
-protected:
-
-    /*! Sets \ref formatter to the format string represented by the piece at
-        the given index.
-
-        \param index Piece index, where the first index is 0.
-    */
-    void setFormatter(int index);
-
 public:
 
     /*! Retrieves the delimiter character to output, used by the \ref
@@ -514,7 +1040,7 @@ public:
     void appendInt(R3CString *str, int index, long int value);
 
     /*! Appends the piece at the given index, which is expected to be of type
-        R3C_FORMAT_FLOAT, using the given floating-point value as the
+        R3C_FORMAT_DOUBLE, using the given floating-point value as the
         replacement.
 
         \param str Target string.
@@ -547,119 +1073,795 @@ public:
     */
     void appendPointer(R3CString *str, int index, const void* value);
 
+    /*! Appends the whole formatted string, taking the format parameter
+        replacements from a variable argument list.  The replacements are
+        measured first, so the target string grows at most once, and each
+        conversion is written directly into the target string.  This method
+        does not modify the parser, so a parser may be shared by several
+        threads.
+
+        \param str Target string.
+        \param varArgs Format parameter replacements.
+        \return Number of characters appended.
+        \throws R3CERR_ILLEGALARGUMENT If str is NULL.
+    */
+    int vappend(R3CString *str, va_list varArgs);
+
 }; // end R3CFormatParser
 
 
-/* R3CString */
+/* R3CStringView */
 
 // Class definition with doxygen comments
 
-/*! Stores a dynamically allocated character string.
- *  String objects will expand in size as necessary.  Note that subsequent
- *  calls to \ref getChars are not guaranteed to return the same pointer.
+/*! Refers to a run of characters stored elsewhere, by pointer and length.
+ *  A view never allocates storage and never writes to the characters, so it
+ *  can be used on read-only data such as memory-mapped files or the contents
+ *  of a string block.  The characters are not necessarily null-terminated.
  *
- *  The current implementation allocates storage in multiples of 128.  If a
- *  string is expected to grow larger than 128, it is good practice to specify
- *  the expected capacity during construction.
+ *  A view is only valid while the storage it refers to is unchanged.  Views
+ *  are small, and are typically passed and returned by value.
  */
-class R3CString {
+class R3CStringView {
 
 // Member Variables
 
 protected:
 
-    //! Character string.
-    char* str;
-
-    //! Current length of string, not including the zero-terminator.
-    int curLength;
+    //! First character of the view.
+    const char* chars;
 
-    //! Current maximum length of string, not including the zero-terminator.
-    int maxLength;
+    //! Number of characters in the view.
+    int length;
 
 
 // Construction
 
-private:
-
-    /*! Initializes the storage capacity.
-        
-        \param capacity New storage capacity.
-    */
-    void initMaxLength(int capacity);
-
 public:
 
-    //! Creates a new empty string.
-    R3CString();
+    //! Creates a new empty view.
+    R3CStringView();
 
-    /*! Creates a new empty string, with the given storage capacity.
-        
-        \param capacity Storage capacity.
-        \throws R3CERR_ILLEGALARGUMENT If capacity is less than 1.
-    */
-    R3CString(int capacity);
+    /*! Creates a new view of the given character string, not including its
+        null-terminator.  If the character string is NULL, the view is empty.
 
-    /*! Creates a new string, copied from the source character string.  If the
-        source character string is NULL, the new string will be empty.
-        
-        \param sourceStr Source character string.
+        \param str Character string.
     */
-    R3CString(const char* sourceStr);
+    explicit R3CStringView(const char* str);
 
-    /*! Creates a new string, copied from the source string, with the given
-        storage capacity.  If the source character string is NULL, the new
-        string will be empty.
+    /*! Creates a new view of charCount characters, starting at chars.
 
-        \param sourceStr Source character string.
-        \param capacity Storage capacity.
-        \throws R3CERR_ILLEGALARGUMENT If capacity is less than the length of
-            sourceStr, or less than 1.
+        \param chars First character.
+        \param charCount Number of characters.
+        \throws R3CERR_ILLEGALARGUMENT If charCount is less than 0, or chars
+            is NULL and charCount is greater than 0.
     */
-    R3CString(const char* sourceStr, int capacity);
+    R3CStringView(const char* chars, int charCount);
 
-    /*! Creates a new string, copied from the source string.
+    /*! Creates a new view of the current contents of the given string.
 
-        \param sourceStr Source string.
-        \throws R3CERR_ILLEGALARGUMENT If sourceStr is NULL.
+        \param str String.
+        \throws R3CERR_ILLEGALARGUMENT If str is NULL.
     */
-    R3CString(R3CString* sourceStr);
+    explicit R3CStringView(R3CString* str);
 
 
-// Destruction
+// Retrieve View Information
 
 public:
 
-    //! Destructor.
-    ~R3CString();
-
-
-// Retrieve String Information
-
-public:
+    /*! Returns the first character of this view.  The characters are not
+        necessarily null-terminated.
 
-    /*! Returns the underlying character string.
-        This method is available with the understanding that calling code
-        should not perform write operations that affect the length of the
-        string.  It is preferred that calling code use the returned character
-        string for read-only purposes.
-        
-        \return Character string.
+        \return Pointer to the first character.
     */
-    char* getChars();
+    const char* getChars();
 
-    /*! Returns the length of this string, not including the zero-terminator.
-        
-        \return Length of this string.
+    /*! Returns the number of characters in this view.
+
+        \return Number of characters.
     */
     int getLength();
 
-    /*! Returns the current storage capacity.
-        
-        \return Current storage capacity.
+    /*! Checks if this view contains no characters.
+
+        \return Flag indicating whether this view is empty.
+    */
+    bool isEmpty();
+
+
+// Finding Sub-Strings
+
+public:
+
+    /*! Returns the character at the given character position.
+
+        \param pos Character position, where the first character is at
+            position 0.
+        \return Character.
+        \throws R3CERR_OUTOFRANGE If pos is less than 0, or greater or equal
+            to the view length.
+    */
+    char getCharAt(int pos);
+
+    /*! Finds the first occurrence of the given character.
+
+        \param charToFind Character to find.
+        \return Position of the given character, or -1 if the character was
+            not found.
+    */
+    int find(char charToFind);
+
+    /*! Finds the first occurrence of the given sub-string.
+
+        \param strToFind Sub-string to find.
+        \return Position of the given sub-string, or -1 if the sub-string was
+            not found.
+        \throws R3CERR_ILLEGALARGUMENT If strToFind is NULL.
+    */
+    int find(const char* strToFind);
+
+    /*! Finds the first occurrence of the given sub-string view.
+
+        \param viewToFind Sub-string to find.
+        \return Position of the given sub-string, or -1 if the sub-string was
+            not found.
+    */
+    int find(R3CStringView viewToFind);
+
+    /*! Finds the last occurrence of the given character.
+
+        \param charToFind Character to find.
+        \return Position of the given character, or -1 if the character was
+            not found.
+    */
+    int findReverse(char charToFind);
+
+    /*! Returns a view of up to charCount characters, starting at startPos.
+        Only characters up to the end of this view are included.
+
+        \param startPos Starting character position.
+        \param charCount Number of characters.
+        \return Narrowed view.
+        \throws R3CERR_OUTOFRANGE If startPos is less than 0, or greater than
+            the view length.
+        \throws R3CERR_ILLEGALARGUMENT If charCount is less than 0.
+    */
+    R3CStringView subView(int startPos, int charCount);
+
+
+// Comparing Strings
+
+public:
+
+    /*! Compares this view to the given character string.  Note that NULL is
+        treated like an empty string.
+
+        \param str Character string to compare to.
+        \return Value that is less than 0, equal to 0, or greater than 0; as
+            the passed string is less than, equal to, or greater than this
+            view.
+    */
+    int compare(const char* str);
+
+    /*! Compares this view to the given view.
+
+        \param view View to compare to.
+        \return Value that is less than 0, equal to 0, or greater than 0; as
+            the passed view is less than, equal to, or greater than this
+            view.
+    */
+    int compare(R3CStringView view);
+
+    /*! Compares this view to the given view, ignoring the case of letters (A
+        to Z).
+
+        \param view View to compare to.
+        \return Value that is less than 0, equal to 0, or greater than 0; as
+            this view is less than, equal to, or greater than the passed
+            view.
+    */
+    int compareNoCase(R3CStringView view);
+
+    /*! Computes a hash of this view, ignoring the case of letters (A to Z).
+        Views that compareNoCase finds equal have the same hash.
+
+        \return Hash of this view.
+    */
+    unsigned int hashNoCase();
+
+    /*! Checks if this view matches the given filename pattern.
+
+        \param pattern Filename pattern.
+        \return Flag indicating whether this view matches the given filename
+            pattern.
+        \throws R3CERR_ILLEGALARGUMENT If pattern is NULL.
+    */
+    bool pathMatch(const char* pattern);
+
+
+// Trim Whitespace
+
+public:
+
+    /*! Returns this view without any leading trimmable characters.
+
+        \param trimChars Characters that should be trimmed, typically
+            R3C_STR_SPACE (to trim only spaces) or R3C_STR_WHITESPACE (to trim
+            spaces, tabs, carriage returns, newlines, and form feeds).
+        \return Narrowed view.
+        \throws R3CERR_ILLEGALARGUMENT If trimChars is NULL.
+    */
+    R3CStringView trimLeft(const char* trimChars);
+
+    /*! Returns this view without any trailing trimmable characters.
+
+        \param trimChars Characters that should be trimmed, typically
+            R3C_STR_SPACE (to trim only spaces) or R3C_STR_LINESPACE (to trim
+            spaces and tabs).
+        \return Narrowed view.
+        \throws R3CERR_ILLEGALARGUMENT If trimChars is NULL.
+    */
+    R3CStringView trimRight(const char* trimChars);
+
+    /*! Returns this view without any leading or trailing trimmable
+        characters.
+
+        \param trimChars Characters that should be trimmed, typically
+            R3C_STR_SPACE (to trim only spaces) or R3C_STR_LINESPACE (to trim
+            spaces and tabs).
+        \return Narrowed view.
+        \throws R3CERR_ILLEGALARGUMENT If trimChars is NULL.
+    */
+    R3CStringView trim(const char* trimChars);
+
+
+// Split Views
+
+public:
+
+    /*! Splits this view into pieces separated by the given delimiter.  Each
+        delimiter ends a piece, so n delimiters always give n + 1 pieces,
+        some of which may be empty.  If there are more pieces than maxPieces,
+        the last piece stored holds the rest of this view, delimiters
+        included.
+
+        \param delimiter Delimiter character.
+        \param pieces Array that receives the pieces.
+        \param maxPieces Number of pieces the array can hold.
+        \return Number of pieces stored.
+        \throws R3CERR_ILLEGALARGUMENT If pieces is NULL, or maxPieces is less
+            than 1.
+    */
+    int split(char delimiter, R3CStringView* pieces, int maxPieces);
+
+}; // end R3CStringView
+
+
+/* R3CAllocator */
+
+// Class definition with doxygen comments
+
+/*! Provides storage for strings.  Strings that are given an allocator take
+ *  all of their storage from it, and give the storage back to it when they
+ *  no longer need it.  An allocator must outlive every string that uses it.
+ */
+class R3CAllocator {
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    virtual ~R3CAllocator();
+
+
+// Manage Storage
+
+public:
+
+    /*! Allocates storage for the given number of bytes.
+
+        \param byteCount Number of bytes.
+        \return Pointer to the allocated storage.
+        \throws R3CERR_ILLEGALARGUMENT If byteCount is less than 1.
+    */
+    virtual char* allocate(int byteCount) = 0;
+
+    /*! Gives back storage that was returned by allocate.
+
+        \param storage Pointer to the storage.
+        \param byteCount Number of bytes, as passed to allocate.
+    */
+    virtual void deallocate(char* storage, int byteCount) = 0;
+
+    /*! Returns the number of bytes that allocate actually provides when asked
+        for the given number.  Strings use this to make use of the whole
+        allocation.  The default implementation returns byteCount.
+
+        \param byteCount Number of bytes.
+        \return Number of usable bytes.
+    */
+    virtual int getUsableSize(int byteCount);
+
+
+}; // end R3CAllocator
+
+
+/* R3CStringArena */
+
+// Class-related data types
+
+struct R3CArenaChunk;
+
+// Class definition with doxygen comments
+
+/*! Allocates storage by moving forward through large chunks, so that the
+ *  storage of many strings can be freed in one step by calling \ref reset.
+ *  This suits strings that only live for the duration of a single task, such
+ *  as the handling of one request.
+ *
+ *  Storage given back is only reused if it was the most recent allocation.
+ *  An arena is not thread-safe, so each thread should use its own.
+ */
+class R3CStringArena :
+    public R3CAllocator
+{
+
+// Member Variables
+
+protected:
+
+    //! Number of bytes in each chunk.
+    int bytesPerChunk;
+
+    //! First chunk, which is the start of a list of chunks kept for reuse.
+    R3CArenaChunk* firstChunk;
+
+    //! Chunk in which storage is currently allocated.
+    R3CArenaChunk* currChunk;
+
+    //! List of allocations that were too large to share a chunk.
+    R3CArenaChunk* largeChunks;
+
+    //! Pointer to the next available byte in the current chunk.
+    char* nextPtr;
+
+    //! Pointer to the end of the current chunk.
+    char* endPtr;
+
+
+// Construction
+
+public:
+
+    //! Creates a new arena, with 16 kilobytes per chunk.
+    R3CStringArena();
+
+    /*! Creates a new arena, with the given chunk size.
+
+        \param kbPerChunk Number of kilobytes per chunk.
+        \throws R3CERR_ILLEGALARGUMENT If kbPerChunk is less than 1.
+    */
+    R3CStringArena(int kbPerChunk);
+
+private:
+
+    //! Not supported.
+    R3CStringArena(const R3CStringArena& sourceArena);
+
+    //! Not supported.
+    R3CStringArena& operator=(const R3CStringArena& sourceArena);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    virtual ~R3CStringArena();
+
+
+// Manage Storage
+
+public:
+
+    virtual char* allocate(int byteCount);
+
+    virtual void deallocate(char* storage, int byteCount);
+
+    /*! Frees all storage allocated from this arena at once.  Chunks are kept
+        for reuse, except those holding large allocations.  No string may use
+        the storage afterward.
+    */
+    void reset();
+
+
+}; // end R3CStringArena
+
+
+/* R3CStringPool */
+
+// Class-related constants
+
+//! Number of size classes kept by a string pool, starting at 64 bytes and
+//! doubling for each class.
+#define R3C_POOL_CLASSCOUNT 7
+
+// Class definition with doxygen comments
+
+/*! Allocates storage in size classes of 64, 128, 256 and so on up to 4096
+ *  bytes, keeping storage that is given back for reuse by the next request
+ *  of the same class.  Larger requests go to the heap.  Storage is carved
+ *  from large slabs, which are only freed when the pool is destroyed.
+ *
+ *  A pool is not thread-safe, so each thread should use its own.
+ */
+class R3CStringPool :
+    public R3CAllocator
+{
+
+// Member Variables
+
+protected:
+
+    //! List of free storage for each size class.
+    char* freeLists[R3C_POOL_CLASSCOUNT];
+
+    //! List of slabs from which storage has been carved.
+    char* slabs;
+
+    //! Pointer to the next unused byte in the current slab.
+    char* nextPtr;
+
+    //! Pointer to the end of the current slab.
+    char* endPtr;
+
+
+// Construction
+
+public:
+
+    //! Creates a new, empty string pool.
+    R3CStringPool();
+
+private:
+
+    //! Not supported.
+    R3CStringPool(const R3CStringPool& sourcePool);
+
+    //! Not supported.
+    R3CStringPool& operator=(const R3CStringPool& sourcePool);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    virtual ~R3CStringPool();
+
+
+// Manage Storage
+
+protected:
+
+    /*! Returns the size class for the given number of bytes.
+
+        \param byteCount Number of bytes.
+        \return Size class, or R3C_POOL_CLASSCOUNT if the request is too
+            large for any class.
+    */
+    int getSizeClass(int byteCount);
+
+public:
+
+    virtual char* allocate(int byteCount);
+
+    virtual void deallocate(char* storage, int byteCount);
+
+    virtual int getUsableSize(int byteCount);
+
+
+}; // end R3CStringPool
+
+
+/* R3CString */
+
+// Class-related constants
+
+//! Size of the storage kept inside each string, including the zero-terminator.
+#define R3C_STR_LOCALSIZE 32
+
+/*! \def R3C_STR_THREADPOOL
+    If defined when building the library, strings without an allocator keep
+    the heap storage they free in a cache for the current thread, and reuse
+    it for later strings of a similar size.
+*/
+
+#ifndef R3C_STR_CACHECOUNT
+//! Maximum number of buffers of each size that the cache of each thread
+//! keeps, when R3C_STR_THREADPOOL is defined.
+#define R3C_STR_CACHECOUNT 256
+#endif
+
+// Class-related data types
+
+/*! Statistics of the string storage cache of a single thread.  These are
+    only gathered when R3C_STR_THREADPOOL is defined.
+*/
+struct R3CStringCacheStats {
+
+    //! Number of buffers that were reused from the cache.
+    long hits;
+
+    //! Number of buffers that had to be allocated from the heap.
+    long misses;
+
+    //! Number of freed buffers that were kept in the cache.
+    long recycled;
+
+    //! Number of freed buffers that were returned to the heap, because the
+    //! cache was full.
+    long discarded;
+
+    //! Number of bytes currently held in the cache.
+    long cachedBytes;
+
+}; // end R3CStringCacheStats
+
+// Class-related functions
+
+/*! Retrieves the statistics of the string storage cache of the current
+    thread.  All statistics are 0 unless R3C_STR_THREADPOOL is defined.
+
+    \param stats Target statistics.
+    \throws R3CERR_ILLEGALARGUMENT If stats is NULL.
+*/
+void r3cStrGetCacheStats(R3CStringCacheStats* stats);
+
+/*! Returns all storage held by the string storage cache of the current
+    thread to the heap.  The statistics other than cachedBytes are kept.
+*/
+void r3cStrClearCache();
+
+
+// Class definition with doxygen comments
+
+/*! Stores a dynamically allocated character string.
+ *  String objects will expand in size as necessary.  Note that subsequent
+ *  calls to \ref getChars are not guaranteed to return the same pointer.
+ *
+ *  Strings of up to R3C_STR_LOCALSIZE - 1 characters are stored inside the
+ *  string object itself, and only longer strings allocate storage from the
+ *  heap.  If a string is expected to grow larger than that, it is good
+ *  practice to specify the expected capacity during construction.
+ *
+ *  A string can be given an R3CAllocator during construction, in which case
+ *  it takes any storage it needs from the allocator rather than the heap.
+ *  The allocator moves with the storage when strings are moved or swapped.
+ */
+class R3CString {
+
+// Member Variables
+
+protected:
+
+    //! Character string, which points to localStr until storage is allocated.
+    char* str;
+
+    //! Current length of string, not including the zero-terminator.
+    int curLength;
+
+    //! Current maximum length of string, not including the zero-terminator.
+    int maxLength;
+
+    //! Storage for short strings, used to avoid a heap allocation.
+    char localStr[R3C_STR_LOCALSIZE];
+
+    //! Allocator for storage, or NULL to use the heap.
+    R3CAllocator* allocator;
+
+
+// Construction
+
+private:
+
+    /*! Initializes the storage capacity, and points the character string at
+        either the local storage or newly allocated storage.
+        
+        \param capacity New storage capacity.
+    */
+    void initMaxLength(int capacity);
+
+    /*! Returns the storage capacity that is actually provided when storage
+        is allocated for the given capacity.
+
+        \param capacity Minimum storage capacity.
+        \return Usable storage capacity.
+    */
+    int fitCapacity(int capacity);
+
+    /*! Allocates storage for a string of up to the given length, from the
+        allocator or the heap.
+
+        \param capacity Storage capacity, not including the zero-terminator.
+        \return Pointer to the storage.
+    */
+    char* allocStorage(int capacity);
+
+    /*! Frees the given storage, unless it is the local storage.
+
+        \param storage Pointer to the storage.
+        \param capacity Storage capacity, not including the zero-terminator.
+    */
+    void freeStorage(char* storage, int capacity);
+
+public:
+
+    //! Creates a new empty string.
+    R3CString();
+
+    /*! Creates a new empty string, which takes its storage from the given
+        allocator.
+
+        \param allocator Allocator, or NULL to use the heap.
+    */
+    explicit R3CString(R3CAllocator* allocator);
+
+    /*! Creates a new empty string, with the given storage capacity, which
+        takes its storage from the given allocator.
+
+        \param capacity Storage capacity.
+        \param allocator Allocator, or NULL to use the heap.
+        \throws R3CERR_ILLEGALARGUMENT If capacity is less than 0.
+    */
+    R3CString(int capacity, R3CAllocator* allocator);
+
+    /*! Creates a new empty string, with the given storage capacity.
+        
+        \param capacity Storage capacity.
+        \throws R3CERR_ILLEGALARGUMENT If capacity is less than 1.
+    */
+    R3CString(int capacity);
+
+    /*! Creates a new string, copied from the source character string.  If the
+        source character string is NULL, the new string will be empty.
+        
+        \param sourceStr Source character string.
+    */
+    R3CString(const char* sourceStr);
+
+    /*! Creates a new string, copied from the source string, with the given
+        storage capacity.  If the source character string is NULL, the new
+        string will be empty.
+
+        \param sourceStr Source character string.
+        \param capacity Storage capacity.
+        \throws R3CERR_ILLEGALARGUMENT If capacity is less than the length of
+            sourceStr, or less than 1.
+    */
+    R3CString(const char* sourceStr, int capacity);
+
+    /*! Creates a new string, copied from the source string.
+
+        \param sourceStr Source string.
+        \throws R3CERR_ILLEGALARGUMENT If sourceStr is NULL.
+    */
+    R3CString(R3CString* sourceStr);
+
+#if __cplusplus >= 201103L
+    /*! Creates a new string, taking over the storage and allocator of the
+        source string.  The source string is left empty, without an
+        allocator.
+
+        \param sourceStr Source string.
+    */
+    R3CString(R3CString&& sourceStr) noexcept;
+
+    /*! Replaces this string, taking over the storage and allocator of the
+        source string.  This string's own storage is freed.  The source
+        string is left empty, without an allocator.
+
+        \param sourceStr Source string.
+        \return This string.
+    */
+    R3CString& operator=(R3CString&& sourceStr) noexcept;
+#endif
+
+private:
+
+    // Strings are copied explicitly, through R3CString(R3CString*) or set,
+    // so that copies are never made by accident.
+    R3CString(const R3CString& sourceStr);
+    R3CString& operator=(const R3CString& sourceStr);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    ~R3CString();
+
+
+// Transfer Storage
+
+public:
+
+    /*! Exchanges the contents of this string and the given string, without
+        copying any heap storage.
+
+        \param otherStr String to exchange with.
+        \throws R3CERR_ILLEGALARGUMENT If otherStr is NULL.
+    */
+    void swap(R3CString* otherStr);
+
+    /*! Releases the character string to the caller, who becomes responsible
+        for freeing it with delete[].  If the string is stored inside this
+        object, or was taken from an allocator, a heap copy is returned
+        instead.  This string is left empty.
+
+        \return Character string, allocated with new[].
+    */
+    char* release();
+
+    /*! Replaces this string with the given character string, taking
+        ownership of it without copying.  The character string must have been
+        allocated with new[], and is later freed with delete[].  A
+        zero-terminator is written after the given length.  If this string
+        uses an allocator, the character string is copied into storage from
+        the allocator and freed instead.
+
+        \param buffer Character string, allocated with new[].
+        \param length Length of the character string.
+        \param capacity Storage capacity of the character string, not
+            including the zero-terminator.
+        \throws R3CERR_ILLEGALARGUMENT If buffer is NULL, if length is less
+            than 0, or if capacity is less than length.
+    */
+    void adopt(char* buffer, int length, int capacity);
+
+
+// Retrieve String Information
+
+public:
+
+    /*! Returns the underlying character string.
+        This method is available with the understanding that calling code
+        should not perform write operations that affect the length of the
+        string.  It is preferred that calling code use the returned character
+        string for read-only purposes.
+        
+        \return Character string.
+    */
+    char* getChars();
+
+    /*! Returns the length of this string, not including the zero-terminator.
+        
+        \return Length of this string.
+    */
+    int getLength();
+
+    /*! Returns the current storage capacity.
+        
+        \return Current storage capacity.
     */
     int getCapacity();
 
+    /*! Returns the allocator this string takes its storage from.
+
+        \return Allocator, or NULL if the string uses the heap.
+    */
+    R3CAllocator* getAllocator();
+
+    /*! Returns a view of the current contents of this string.  The view is
+        only valid until this string is next modified.
+
+        \return View of this string.
+    */
+    R3CStringView getView();
+
 
 // Finding Sub-Strings
 
@@ -725,6 +1927,15 @@ public:
     */
     int compare(R3CString* str);
 
+    /*! Compares this string to the given view.
+
+        \param view View to compare to.
+        \return Value that is less than 0, equal to 0, or greater than 0; as
+            the passed view is less than, equal to, or greater than this
+            string.
+    */
+    int compare(R3CStringView view);
+
 public:
     
     /*! Checks if this string matches the given filename pattern.
@@ -758,6 +1969,16 @@ public:
     */
     int resetLength();
 
+    /*! Extends this string by charCount characters, to be filled in by the
+        caller.  The new characters are not initialized, and the string is
+        null-terminated after them.
+
+        \param charCount Number of characters to add.
+        \return Pointer to the first new character.
+        \throws R3CERR_ILLEGALARGUMENT If charCount is less than 0.
+    */
+    char* appendSpace(int charCount);
+
     /*! Replaces this string with the source character string.  If the source
         character string is NULL, the string is cleared.
         
@@ -766,6 +1987,17 @@ public:
     */
     int set(const char* sourceStr);
 
+    /*! Replaces this string with charCount characters from sourceChars,
+        which need not be null-terminated.  If sourceChars is NULL, the string
+        is cleared.
+
+        \param sourceChars Source characters.
+        \param charCount Number of characters to copy.
+        \return Length of the string.
+        \throws R3CERR_ILLEGALARGUMENT If charCount is less than 0.
+    */
+    int set(const char* sourceChars, int charCount);
+
     /*! Replaces this string with the source string.
         
         \param sourceStr Source string.
@@ -774,6 +2006,13 @@ public:
     */
     int set(R3CString* sourceStr);
 
+    /*! Replaces this string with the characters of the source view.
+
+        \param sourceView Source view.
+        \return Length of the string.
+    */
+    int set(R3CStringView sourceView);
+
     /*! Appends the given character to the end of this string.
 
         \param charToAppend Character to append.
@@ -790,6 +2029,17 @@ public:
     */
     int append(const char* sourceStr);
 
+    /*! Appends charCount characters from sourceChars, which need not be
+        null-terminated, to the end of this string.  If sourceChars is NULL,
+        0 is returned.
+
+        \param sourceChars Source characters.
+        \param charCount Number of characters to append.
+        \return Number of characters appended.
+        \throws R3CERR_ILLEGALARGUMENT If charCount is less than 0.
+    */
+    int append(const char* sourceChars, int charCount);
+
     /*! Appends charCount characters, starting at startPos, from sourceStr
         into this string.  If sourceStr is NULL, 0 is returned.  If startPos
         is greater than the length of sourceStr, no characters are appended.
@@ -801,15 +2051,54 @@ public:
         \return Number of characters actually appended.
         \throws R3CERR_ILLEGALARGUMENT If startPos is less than 0.
     */
-    int append(const char* sourceStr, int startPos, int charCount);
+    int append(const char* sourceStr, int startPos, int charCount);
+
+    /*! Appends the source string to the end of this string.
+        
+        \param sourceStr Source string.
+        \return Number of characters appended.
+        \throws R3CERR_ILLEGALARGUMENT If sourceStr is NULL.
+    */
+    int append(R3CString* sourceStr);
+
+    /*! Appends the characters of the source view to the end of this string.
+
+        \param sourceView Source view.
+        \return Number of characters appended.
+    */
+    int append(R3CStringView sourceView);
+
+    /*! Appends every fragment, in order, to the end of this string.  The
+        string grows at most once, so this is faster than appending the
+        fragments one at a time.  Fragments may refer to the characters of
+        this string.
+
+        \param fragments Fragments to append.
+        \param fragmentCount Number of fragments.
+        \return Number of characters appended.
+        \throws R3CERR_ILLEGALARGUMENT If fragmentCount is less than 0, or
+            fragments is NULL and fragmentCount is greater than 0.
+        \throws R3CERR_OUTOFRANGE If the string would be longer than INT_MAX
+            characters, in which case it is left unchanged.
+    */
+    int appendAll(R3CStringView* fragments, int fragmentCount);
 
-    /*! Appends the source string to the end of this string.
-        
-        \param sourceStr Source string.
+    /*! Appends every fragment, in order, to the end of this string, with the
+        delimiter character between each pair of fragments.  This is suited
+        to building delimited records, such as CSV rows.  The string grows at
+        most once, and fragments may refer to the characters of this string.
+
+        \param fragments Fragments to append.
+        \param fragmentCount Number of fragments.
+        \param delimiter Delimiter character.
         \return Number of characters appended.
-        \throws R3CERR_ILLEGALARGUMENT If sourceStr is NULL.
+        \throws R3CERR_ILLEGALARGUMENT If fragmentCount is less than 0,
+            fragments is NULL and fragmentCount is greater than 0, or
+            delimiter is a null-terminator.
+        \throws R3CERR_OUTOFRANGE If the string would be longer than INT_MAX
+            characters, in which case it is left unchanged.
     */
-    int append(R3CString* sourceStr);
+    int appendAll(R3CStringView* fragments, int fragmentCount, char delimiter);
 
     /*! Appends the formatted string to the end of this string.
         
@@ -819,6 +2108,15 @@ public:
     */
     int appendf(const char* formatString, ...);
 
+    /*! Appends the formatted string to the end of this string, taking the
+        format parameter replacements from a variable argument list.
+
+        \param formatString C-style format string.
+        \param varArgs Format parameter replacements.
+        \return Number of characters appended.
+    */
+    int vappendf(const char* formatString, va_list varArgs);
+
     /*! Inserts the given character at the given position in this string.
         
         \param pos Position to insert into this string.
@@ -841,6 +2139,20 @@ public:
     */
     int insert(int pos, const char* sourceStr);
 
+    /*! Inserts charCount characters from sourceChars, which need not be
+        null-terminated, at the given position in this string.  If
+        sourceChars is NULL, 0 is returned.
+
+        \param pos Position to insert into this string.
+        \param sourceChars Source characters.
+        \param charCount Number of characters to insert.
+        \return Number of characters inserted.
+        \throws R3CERR_OUTOFRANGE If pos is less than 0, or greater than the
+            length of this string.
+        \throws R3CERR_ILLEGALARGUMENT If charCount is less than 0.
+    */
+    int insert(int pos, const char* sourceChars, int charCount);
+
     /*! Inserts charCount characters, starting at startPos, from sourceStr
         into this string at pos.  If sourceStr is NULL, 0 is returned.  If
         startPos is greater than the length of sourceStr, no characters are
@@ -868,6 +2180,16 @@ public:
     */
     int insert(int pos, R3CString* sourceStr);
 
+    /*! Inserts the characters of the source view into this string.
+
+        \param pos Position to insert into this string.
+        \param sourceView Source view.
+        \return Number of characters inserted.
+        \throws R3CERR_OUTOFRANGE If pos is less than 0, or greater than the
+            length of this string.
+    */
+    int insert(int pos, R3CStringView sourceView);
+
     /*! Removes the character at the given position from this string.
         
         \param pos Position of character in this string.
@@ -939,7 +2261,7 @@ public:
 
     /*! Converts this string to lower-case.
 
-        \return Number of characters converted to upper-case.
+        \return Number of characters converted to lower-case.
     */
     int toLower();
 
@@ -949,6 +2271,23 @@ public:
 
 /* R3CPathString */
 
+// Class-related constants
+
+#ifdef _WIN32
+//! Path separator character.
+#define R3C_PATH_SEPARATOR '\\'
+//! Path separator character, as a character string.
+#define R3C_PATH_SEPARATORSTR "\\"
+#else
+//! Path separator character.
+#define R3C_PATH_SEPARATOR '/'
+//! Path separator character, as a character string.
+#define R3C_PATH_SEPARATORSTR "/"
+#endif
+
+//! Number of path components that join keeps on the stack.
+#define R3C_PATH_LOCALJOIN 16
+
 // Class definition with doxygen comments
 
 /*! Stores a dynamically allocated file or folder path string.
@@ -1031,6 +2370,21 @@ public:
     */
     void appendPath(R3CString* path, bool trailingSlash);
 
+    /*! Appends the given path components to this string, with a single path
+        separator between each pair of components, and between this string
+        and the first component.  Separators at either end of a component are
+        dropped, and empty components are skipped, except that a leading
+        separator is kept when this string is empty, so that absolute paths
+        can be built.  The string grows at most once.
+
+        \param components Path components.
+        \param componentCount Number of path components.
+        \return Number of characters appended.
+        \throws R3CERR_ILLEGALARGUMENT If componentCount is less than 0, or
+            components is NULL and componentCount is greater than 0.
+    */
+    int join(R3CStringView* components, int componentCount);
+
 
 // Retrieve Path Components
 
@@ -1047,18 +2401,24 @@ public:
 
         \param targetStr Target string.
         \param folderIndex Folder index.
+        \throws R3CERR_ILLEGALARGUMENT If targetStr is NULL.
+        \throws R3CERR_OUTOFRANGE If folderIndex is less than 0, or not less
+            than the number of folders.
     */
     void getFolder(R3CString* targetStr, int folderIndex);
 
-    /*! Retrieves the full path string, not including the filename.
+    /*! Retrieves the full path string, not including the filename.  The
+        result ends in a path separator, unless it is empty.
 
         \param targetStr Target string.
+        \throws R3CERR_ILLEGALARGUMENT If targetStr is NULL.
     */
     void getFolder(R3CString* targetStr);
 
     /*! Retrieves the filename from this path string.
 
         \param targetStr Target string.
+        \throws R3CERR_ILLEGALARGUMENT If targetStr is NULL.
     */
     void getFilename(R3CString* targetStr);
 
@@ -1066,8 +2426,366 @@ public:
 }; // end R3CPathString
 
 
+/* R3CPathPattern */
+
+// Class-related constants
+
+//! Longest segment of a pattern, containing ? wildcards, that is searched for
+//! with a bit-parallel search.
+#define R3C_PATTERN_MAXBITSEGMENT 64
+
+// Class-related data types
+
+struct R3CPatternSegment;
+
+// Class definition with doxygen comments
+
+/*! A filename pattern, as accepted by r3cPathMatch, compiled so that it can
+ *  be matched against many strings quickly.  In a pattern, * matches any run
+ *  of characters (including none), and ? matches any single character.
+ *
+ *  The pattern is split at its * wildcards into segments.  Without a *, the
+ *  whole string is compared with the single segment.  Otherwise, the first
+ *  and last segments are compared with the start and end of the string, and
+ *  then the segments between them are found in order, each at its earliest
+ *  position, which is enough for * and ? wildcards.  Segments without a ?
+ *  are found with memmem (or memchr, where memmem is not available); those
+ *  with a ? are found with a bit-parallel (shift-and) search, so that
+ *  matching takes time linear in the length of the string.  Segments longer
+ *  than R3C_PATTERN_MAXBITSEGMENT that contain a ? are tried at each
+ *  position instead.
+ */
+class R3CPathPattern {
+
+// Member Variables
+
+protected:
+
+    //! Copy of the pattern string, which the segments point into.
+    char* pattern;
+
+    //! Segments of the pattern, between its * wildcards.
+    R3CPatternSegment* segments;
+
+    //! Number of segments.  With no * wildcard, this is 1; otherwise, the
+    //! first and last segments (which may be empty) are fixed to the start
+    //! and end of the string.
+    int segmentCount;
+
+    //! Flag indicating whether the pattern contains a * wildcard.
+    bool hasStar;
+
+    //! Number of characters that a matching string has, at least.
+    int minLength;
+
+
+// Construction
+
+public:
+
+    //! Creates a new pattern, which only matches the empty string.
+    R3CPathPattern();
+
+    /*! Creates a new pattern, compiled from the given filename pattern.
+
+        \param pattern Filename pattern.
+        \throws R3CERR_ILLEGALARGUMENT If pattern is NULL.
+    */
+    explicit R3CPathPattern(const char* pattern);
+
+private:
+
+    //! Not supported.
+    R3CPathPattern(const R3CPathPattern& sourcePattern);
+
+    //! Not supported.
+    R3CPathPattern& operator=(const R3CPathPattern& sourcePattern);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    ~R3CPathPattern();
+
+
+// Compile Pattern
+
+public:
+
+    /*! Replaces this pattern with one compiled from the given filename
+        pattern.
+
+        \param pattern Filename pattern.
+        \throws R3CERR_ILLEGALARGUMENT If pattern is NULL.
+    */
+    void compile(const char* pattern);
+
+
+// Retrieve Pattern Info
+
+public:
+
+    /*! Retrieves the filename pattern that this pattern was compiled from.
+
+        \return Filename pattern.
+    */
+    const char* getPattern();
+
+    /*! Retrieves the number of characters that a matching string has, at
+        least.
+
+        \return Minimum number of characters.
+    */
+    int getMinLength();
+
+
+// Matching
+
+public:
+
+    /*! Checks if the given character string matches this pattern.
+
+        \param str Character string.
+        \return Flag indicating whether the character string matches.
+        \throws R3CERR_ILLEGALARGUMENT If str is NULL.
+    */
+    bool match(const char* str);
+
+    /*! Checks if the given characters match this pattern.  The characters do
+        not need to be null-terminated.
+
+        \param str Characters to match.
+        \param strLength Number of characters to match.
+        \return Flag indicating whether the characters match.
+        \throws R3CERR_ILLEGALARGUMENT If str is NULL, or strLength is less
+            than 0.
+    */
+    bool match(const char* str, int strLength);
+
+
+}; // end R3CPathPattern
+
+
+/* R3CPathPatternSet */
+
+// Class-related constants
+
+//! Number of patterns that can be matched without allocating memory for the
+//! match state.
+#define R3C_PATTERNSET_LOCALCOUNT 1024
+
+// Class-related data types
+
+struct R3CPatternFragment;
+
+// Class definition with doxygen comments
+
+/*! A set of filename patterns, as accepted by r3cPathMatch, that a string can
+ *  be matched against in one pass.  Each pattern added is given an ID, which
+ *  is its position in the order that patterns were added.
+ *
+ *  The longest literal run of characters (without wildcards) of each pattern
+ *  is added to an Aho-Corasick automaton, which finds every run present in a
+ *  string in a single pass over it.  Runs that start or end the pattern only
+ *  count at the start or end of the string, which buckets patterns such as
+ *  "*.txt" by their suffix; for patterns that are just such a run and a *, or
+ *  have no wildcards, finding the run is enough.  Any other pattern whose run
+ *  is found (or that has no literal characters) is then checked with its
+ *  R3CPathPattern.
+ *
+ *  The set is prepared on the first match after patterns are added (see
+ *  \ref prepare).  Many threads can match at once, including that first
+ *  match, but patterns must not be added while any thread is matching.
+ */
+class R3CPathPatternSet {
+
+// Member Variables
+
+protected:
+
+    //! Compiled patterns, by ID.
+    R3CPathPattern** patterns;
+
+    //! Literal run chosen for each pattern, by ID.
+    R3CPatternFragment* fragments;
+
+    //! Number of patterns in the set.
+    int patternCount;
+
+    //! Number of patterns that memory is allocated for.
+    int patternsAlloc;
+
+    //! State of the automaton: out of date, being built, or up to date.
+    int prepareState;
+
+    //! Class of each character in the automaton; characters that are not in
+    //! any literal run share class 0.
+    unsigned char charClasses[256];
+
+    //! Number of character classes.
+    int classCount;
+
+    //! Number of states in the automaton.
+    int stateCount;
+
+    //! Next state, by state and character class.
+    int* transitions;
+
+    //! For each state, the nearest state (itself or a suffix) at which runs
+    //! end, or -1.
+    int* outputStates;
+
+    //! For each state, the next shorter suffix state at which runs end, or
+    //! -1.
+    int* outputLinks;
+
+    //! For each state, the position in outputPatterns of the first pattern
+    //! whose run ends there; the patterns for state N end at the position
+    //! for state N + 1.
+    int* outputStarts;
+
+    //! IDs of patterns, grouped by the state at which their runs end.
+    int* outputPatterns;
+
+    //! IDs of patterns without a literal run, which are always checked.
+    int* unfilteredPatterns;
+
+    //! Number of patterns without a literal run.
+    int unfilteredCount;
+
+
+// Construction
+
+public:
+
+    //! Creates a new, empty pattern set.
+    R3CPathPatternSet();
+
+private:
+
+    //! Not supported.
+    R3CPathPatternSet(const R3CPathPatternSet& sourceSet);
+
+    //! Not supported.
+    R3CPathPatternSet& operator=(const R3CPathPatternSet& sourceSet);
+
+
+// Destruction
+
+public:
+
+    //! Destructor.
+    ~R3CPathPatternSet();
+
+
+// Update Set
+
+public:
+
+    /*! Adds the given filename pattern to this set.
+
+        \param pattern Filename pattern.
+        \return ID of the pattern.
+        \throws R3CERR_ILLEGALARGUMENT If pattern is NULL.
+    */
+    int add(const char* pattern);
+
+    /*! Builds the automaton for the patterns in this set, unless it is
+        already up to date.  This is done by the first match after patterns
+        are added, so calling it is optional; it only moves the work ahead
+        of matching.  If several threads call it at once, one builds the
+        automaton while the others wait for it.
+    */
+    void prepare();
+
+protected:
+
+    //! Builds the automaton, replacing any previous one.
+    void buildAutomaton();
+
+    //! Frees the automaton.
+    void freeAutomaton();
+
+
+// Retrieve Set Info
+
+public:
+
+    /*! Retrieves the number of patterns in this set.
+
+        \return Number of patterns.
+    */
+    int getPatternCount();
+
+    /*! Retrieves the pattern with the given ID.
+
+        \param patternId ID of the pattern.
+        \return Compiled pattern.
+        \throws R3CERR_OUTOFRANGE If patternId is not the ID of a pattern.
+    */
+    R3CPathPattern* getPattern(int patternId);
+
+
+// Matching
+
+public:
+
+    /*! Finds the first pattern (with the lowest ID) that the given character
+        string matches.
+
+        \param str Character string.
+        \return ID of the first matching pattern, or -1 if there is none.
+        \throws R3CERR_ILLEGALARGUMENT If str is NULL.
+    */
+    int matchFirst(const char* str);
+
+    /*! Finds the first pattern (with the lowest ID) that the given characters
+        match.  The characters do not need to be null-terminated.
+
+        \param str Characters to match.
+        \param strLength Number of characters to match.
+        \return ID of the first matching pattern, or -1 if there is none.
+        \throws R3CERR_ILLEGALARGUMENT If str is NULL, or strLength is less
+            than 0.
+    */
+    int matchFirst(const char* str, int strLength);
+
+    /*! Finds every pattern that the given characters match.  The characters
+        do not need to be null-terminated.
+
+        \param str Characters to match.
+        \param strLength Number of characters to match.
+        \param patternIds Array that receives the IDs of the matching
+            patterns, in order; may be NULL if maxIds is 0.
+        \param maxIds Number of IDs that patternIds can hold.
+        \return Number of matching patterns, which may be more than maxIds.
+        \throws R3CERR_ILLEGALARGUMENT If str is NULL; strLength or maxIds is
+            less than 0; or patternIds is NULL and maxIds is greater than 0.
+    */
+    int matchAll(
+        const char* str, int strLength, int* patternIds, int maxIds);
+
+protected:
+
+    //! Finds the patterns whose runs occur in the given characters, and
+    //! marks them in matchBits (if finding the run is enough) or in
+    //! checkBits.
+    void findRuns(
+        const char* str, int strLength,
+        unsigned long* matchBits, unsigned long* checkBits);
+
+
+}; // end R3CPathPatternSet
+
+
 /* R3CStringBlock */
 
+// Class-related data types
+
+struct R3CAloneString;
+
 // Class definition with doxygen comments
 
 /*! Provides a large, expandable block of memory for storage of character
@@ -1108,6 +2826,15 @@ protected:
     //! Number of bytes already used in the current storage block.
     int bytesUsedInBlock;
 
+    //! Strings allocated in their own storage, in the order they were added.
+    R3CAloneString* aloneStr;
+
+    //! Number of strings in aloneStr.
+    int aloneStrCount;
+
+    //! Number of entries currently allocated in aloneStr.
+    int aloneStrAlloc;
+
 
 // Construction
 
@@ -1170,6 +2897,21 @@ protected:
     */
     char* insertString(const char* str, int charsToAlloc);
 
+    /*! Allocates storage of its own for a string, and records it after the
+        strings already added.
+
+        \param charsToAlloc Number of characters.
+        \return Pointer to the allocated storage.
+    */
+    char* allocAlone(int charsToAlloc);
+
+    /*! Frees the strings allocated in their own storage, other than the
+        first keepCount.
+
+        \param keepCount Number of strings to keep.
+    */
+    void freeAlone(int keepCount);
+
 
 public:
 
@@ -1205,6 +2947,110 @@ public:
     */
     char* addString(R3CString* str, int maxLength);
 
+    /*! Adds the characters of the given view to this string block, as a
+        null-terminated character string.
+
+        \param view View to be copied.
+        \return Pointer to character string as stored in this string block.
+    */
+    char* addString(R3CStringView view);
+
+    /*! Allocates space in this string block for a character string of up to
+        maxLength characters, to be filled in by the caller.  The space is
+        filled with null-terminators.
+
+        \param maxLength Maximum length of the character string.
+        \return Pointer to the allocated space.
+        \throws R3CERR_ILLEGALARGUMENT If maxLength is less than 0.
+    */
+    char* allocString(int maxLength);
+
+
+// Retrieve Storage Blocks
+
+public:
+
+    /*! Returns the number of storage blocks currently in use.
+
+        \return Number of storage blocks in use.
+    */
+    int getBlockCount();
+
+    /*! Returns the contents of the storage block at the given index.  The
+        strings in a storage block are separated by null-terminators, and
+        any unused space is filled with null-terminators.  Strings that were
+        allocated in their own storage are not part of any storage block;
+        see \ref getAloneCount.
+
+        \param blockIndex Storage block index, where the first index is 0.
+        \return Pointer to the start of the storage block.
+        \throws R3CERR_OUTOFRANGE If blockIndex is less than 0, or greater
+            or equal to the number of storage blocks in use.
+    */
+    const char* getBlockChars(int blockIndex);
+
+    /*! Returns the number of bytes in use within the storage block at the
+        given index.  Every block before the current block is reported as
+        fully used.
+
+        \param blockIndex Storage block index, where the first index is 0.
+        \return Number of bytes in use.
+        \throws R3CERR_OUTOFRANGE If blockIndex is less than 0, or greater
+            or equal to the number of storage blocks in use.
+    */
+    int getBlockLength(int blockIndex);
+
+    /*! Returns the number of strings that were allocated in their own
+        storage, rather than in a storage block.
+
+        \return Number of strings allocated in their own storage.
+    */
+    int getAloneCount();
+
+    /*! Returns the storage of a string that was allocated on its own.  The
+        strings are numbered in the order they were added.  The string is
+        followed by null-terminators up to the length of its storage.
+
+        \param aloneIndex String index, where the first index is 0.
+        \return Pointer to the storage of the string.
+        \throws R3CERR_OUTOFRANGE If aloneIndex is less than 0, or greater or
+            equal to the number of strings allocated on their own.
+    */
+    const char* getAloneChars(int aloneIndex);
+
+    /*! Returns the number of bytes in the storage of a string that was
+        allocated on its own, including its null-terminators.
+
+        \param aloneIndex String index, where the first index is 0.
+        \return Number of bytes of storage.
+        \throws R3CERR_OUTOFRANGE If aloneIndex is less than 0, or greater or
+            equal to the number of strings allocated on their own.
+    */
+    int getAloneLength(int aloneIndex);
+
+    /*! Returns the index of the storage block that was current when a string
+        was allocated on its own.  Together with \ref getAloneBlockPos, this
+        places the string among the strings of the storage blocks.
+
+        \param aloneIndex String index, where the first index is 0.
+        \return Storage block index.
+        \throws R3CERR_OUTOFRANGE If aloneIndex is less than 0, or greater or
+            equal to the number of strings allocated on their own.
+    */
+    int getAloneBlockIndex(int aloneIndex);
+
+    /*! Returns the number of bytes that were in use within the current
+        storage block when a string was allocated on its own.  The string was
+        added after the strings before this position, and before the strings
+        at or after it.
+
+        \param aloneIndex String index, where the first index is 0.
+        \return Position within the storage block.
+        \throws R3CERR_OUTOFRANGE If aloneIndex is less than 0, or greater or
+            equal to the number of strings allocated on their own.
+    */
+    int getAloneBlockPos(int aloneIndex);
+
 
 }; // end R3CStringBlock
 
@@ -1234,6 +3080,10 @@ protected:
 
     //! Number of stack pointers currently allocated.
     int stackStartPtrAlloc;
+
+    //! Array of the number of strings allocated on their own at the start of
+    //! each stack level, allocated alongside stackStartPtr.
+    int* stackAloneCount;
     
 
 // Construction
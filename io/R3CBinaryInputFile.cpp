@@ -0,0 +1,111 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+// *** CONSTANTS *** //
+
+#define DEFAULT_BUFFER_KB 64
+
+
+// *** CONSTRUCTION *** //
+
+R3CBinaryInputFile::R3CBinaryInputFile() :
+    fileDesc(-1),
+    bufferSize(DEFAULT_BUFFER_KB << 10),
+    buffer(NULL)
+{
+}
+
+R3CBinaryInputFile::R3CBinaryInputFile(const char *inputFilename) :
+    fileDesc(-1),
+    bufferSize(DEFAULT_BUFFER_KB << 10),
+    buffer(NULL)
+{
+    this->open(inputFilename);
+}
+
+R3CBinaryInputFile::R3CBinaryInputFile(R3CString *inputFilename) :
+    fileDesc(-1),
+    bufferSize(DEFAULT_BUFFER_KB << 10),
+    buffer(NULL)
+{
+    this->open(inputFilename);
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CBinaryInputFile::~R3CBinaryInputFile() {
+    if ( this->fileDesc != -1 ) ::close(this->fileDesc);
+    if ( this->buffer != NULL ) delete[] this->buffer;
+}
+
+
+// *** OPEN STREAM *** //
+
+void R3CBinaryInputFile::open(const char *inputFilename) {
+#ifndef R3C_NOERRCHECK
+    if ( inputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc != -1 ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    this->fileDesc = ::open(inputFilename, O_RDONLY);
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTFOUND;
+    if ( this->buffer == NULL ) {
+        this->buffer = new unsigned char [this->bufferSize];
+    }
+    this->readPtr = this->buffer;
+    this->readEndPtr = this->buffer;
+}
+
+void R3CBinaryInputFile::open(R3CString *inputFilename) {
+#ifndef R3C_NOERRCHECK
+    if ( inputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->open(inputFilename->getChars());
+}
+
+void R3CBinaryInputFile::setBufferSize(int kbPerBuffer) {
+#ifndef R3C_NOERRCHECK
+    if ( kbPerBuffer < 1 ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc != -1 ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    if ( this->buffer != NULL ) delete[] this->buffer;
+    this->buffer = NULL;
+    this->bufferSize = kbPerBuffer << 10;
+}
+
+
+// *** READ BUFFER *** //
+
+bool R3CBinaryInputFile::fillBuffer() {
+    ssize_t bytesRead;
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+    do {
+        bytesRead = ::read(this->fileDesc, this->buffer, this->bufferSize);
+    } while ( (bytesRead < 0) && (errno == EINTR) );
+    if ( bytesRead < 0 ) throw R3CERR_IO_EXCEPTION;
+    this->readPtr = this->buffer;
+    this->readEndPtr = this->buffer + bytesRead;
+    return( bytesRead > 0 );
+}
+
+
+// *** CLOSE FILE *** //
+
+void R3CBinaryInputFile::close() {
+    int closeResult;
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    closeResult = ::close(this->fileDesc);
+    this->fileDesc = -1;
+    this->readPtr = NULL;
+    this->readEndPtr = NULL;
+    if ( closeResult != 0 ) throw R3CERR_IO_EXCEPTION;
+}
@@ -0,0 +1,61 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+
+// *** CONSTRUCTION *** //
+
+R3CBinaryInputMemBlock::R3CBinaryInputMemBlock() :
+    isOpen(false)
+{
+}
+
+R3CBinaryInputMemBlock::R3CBinaryInputMemBlock(
+    const void *buffer, int length
+) :
+    isOpen(false)
+{
+    this->open(buffer, length);
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CBinaryInputMemBlock::~R3CBinaryInputMemBlock() {
+}
+
+
+// *** OPEN STREAM *** //
+
+void R3CBinaryInputMemBlock::open(const void *buffer, int length) {
+#ifndef R3C_NOERRCHECK
+    if ( (buffer == NULL) || (length < 0) ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->isOpen ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    this->readPtr = (const unsigned char*)buffer;
+    this->readEndPtr = this->readPtr + length;
+    this->isOpen = true;
+}
+
+
+// *** READ BUFFER *** //
+
+// The whole memory block is the read buffer, so once it has been read the
+// end of the stream has been reached.
+bool R3CBinaryInputMemBlock::fillBuffer() {
+    if ( !this->isOpen ) throw R3CERR_IO_STREAMNOTOPEN;
+    return( false );
+}
+
+
+// *** CLOSE STREAM *** //
+
+void R3CBinaryInputMemBlock::close() {
+#ifndef R3C_NOERRCHECK
+    if ( !this->isOpen ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    this->isOpen = false;
+    this->readPtr = NULL;
+    this->readEndPtr = NULL;
+}
@@ -0,0 +1,384 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+
+// *** CONSTANTS *** //
+
+#define MAX_VARINT_BYTES 10
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define HOST_LITTLE_ENDIAN
+#endif
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Decodes a little-endian unsigned 16-bit integer.
+static inline uint16_t decodeUInt16(const unsigned char* bytes) {
+#ifdef HOST_LITTLE_ENDIAN
+    uint16_t result;
+    memcpy(&result, bytes, sizeof(result));
+    return( result );
+#else
+    return( (uint16_t)(bytes[0] | (bytes[1] << 8)) );
+#endif
+}
+
+// Decodes a little-endian unsigned 32-bit integer.
+static inline uint32_t decodeUInt32(const unsigned char* bytes) {
+#ifdef HOST_LITTLE_ENDIAN
+    uint32_t result;
+    memcpy(&result, bytes, sizeof(result));
+    return( result );
+#else
+    return(
+        (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+        ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24) );
+#endif
+}
+
+// Decodes a little-endian unsigned 64-bit integer.
+static inline uint64_t decodeUInt64(const unsigned char* bytes) {
+#ifdef HOST_LITTLE_ENDIAN
+    uint64_t result;
+    memcpy(&result, bytes, sizeof(result));
+    return( result );
+#else
+    return(
+        (uint64_t)decodeUInt32(bytes) |
+        ((uint64_t)decodeUInt32(bytes + 4) << 32) );
+#endif
+}
+
+// Validates a string length read from the stream.
+static int checkLength(uint64_t length) {
+    if ( length > (uint64_t)(INT_MAX - 1) ) throw R3CERR_IO_BADFORMAT;
+    return( (int)length );
+}
+
+// Returns the number of bytes in an array of count values of the given
+// width.
+static size_t getArrayBytes(int count, size_t width) {
+    if ( (size_t)count > ((size_t)-1) / width ) throw R3CERR_ILLEGALARGUMENT;
+    return( (size_t)count * width );
+}
+
+
+// *** CONSTRUCTION *** //
+
+R3CBinaryInputStream::R3CBinaryInputStream() :
+    readPtr(NULL),
+    readEndPtr(NULL)
+{
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CBinaryInputStream::~R3CBinaryInputStream() {
+}
+
+
+// *** READ BUFFER *** //
+
+// Reads exactly byteCount bytes into the target buffer.
+void R3CBinaryInputStream::readFully(void *target, size_t byteCount) {
+    unsigned char* targetPtr;
+    size_t bytesAvailable;
+    targetPtr = (unsigned char*)target;
+    while ( byteCount > 0 ) {
+        if ( (this->readPtr == this->readEndPtr) && !this->fillBuffer() ) {
+            throw R3CERR_IO_ENDOFSTREAM;
+        }
+        bytesAvailable = (size_t)(this->readEndPtr - this->readPtr);
+        if ( bytesAvailable > byteCount ) bytesAvailable = byteCount;
+        memcpy(targetPtr, this->readPtr, bytesAvailable);
+        this->readPtr += bytesAvailable;
+        targetPtr += bytesAvailable;
+        byteCount -= bytesAvailable;
+    }
+}
+
+// Appends exactly byteCount bytes to the target string.  The string only
+// grows as the bytes arrive, so a corrupt length cannot claim more memory
+// than the stream actually holds.
+void R3CBinaryInputStream::readAppend(R3CString *targetStr, int byteCount) {
+    int bytesAvailable;
+    while ( byteCount > 0 ) {
+        if ( (this->readPtr == this->readEndPtr) && !this->fillBuffer() ) {
+            throw R3CERR_IO_ENDOFSTREAM;
+        }
+        bytesAvailable = (int)(this->readEndPtr - this->readPtr);
+        if ( bytesAvailable > byteCount ) bytesAvailable = byteCount;
+        memcpy(
+            targetStr->appendSpace(bytesAvailable), this->readPtr,
+            bytesAvailable);
+        this->readPtr += bytesAvailable;
+        byteCount -= bytesAvailable;
+    }
+}
+
+
+// *** READ BYTES FROM THE STREAM *** //
+
+bool R3CBinaryInputStream::isEndOfStream() {
+    return( (this->readPtr == this->readEndPtr) && !this->fillBuffer() );
+}
+
+int R3CBinaryInputStream::readBytes(void *target, int byteCount) {
+    unsigned char* targetPtr;
+    int bytesRead;
+    int bytesAvailable;
+#ifndef R3C_NOERRCHECK
+    if ( (target == NULL) || (byteCount < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    targetPtr = (unsigned char*)target;
+    bytesRead = 0;
+    while ( bytesRead < byteCount ) {
+        if ( (this->readPtr == this->readEndPtr) && !this->fillBuffer() ) {
+            if ( bytesRead == 0 ) bytesRead = EOF;
+            break;
+        }
+        bytesAvailable = (int)(this->readEndPtr - this->readPtr);
+        if ( bytesAvailable > (byteCount - bytesRead) ) {
+            bytesAvailable = byteCount - bytesRead;
+        }
+        memcpy(targetPtr + bytesRead, this->readPtr, bytesAvailable);
+        this->readPtr += bytesAvailable;
+        bytesRead += bytesAvailable;
+    }
+    return( bytesRead );
+}
+
+
+// *** READ FIXED-WIDTH VALUES *** //
+
+uint8_t R3CBinaryInputStream::readUInt8() {
+    if ( (this->readPtr == this->readEndPtr) && !this->fillBuffer() ) {
+        throw R3CERR_IO_ENDOFSTREAM;
+    }
+    return( *this->readPtr++ );
+}
+
+int8_t R3CBinaryInputStream::readInt8() {
+    return( (int8_t)this->readUInt8() );
+}
+
+uint16_t R3CBinaryInputStream::readUInt16() {
+    unsigned char bytes[2];
+    uint16_t result;
+    if ( (this->readEndPtr - this->readPtr) >= 2 ) {
+        result = decodeUInt16(this->readPtr);
+        this->readPtr += 2;
+    } else {
+        this->readFully(bytes, 2);
+        result = decodeUInt16(bytes);
+    }
+    return( result );
+}
+
+int16_t R3CBinaryInputStream::readInt16() {
+    return( (int16_t)this->readUInt16() );
+}
+
+uint32_t R3CBinaryInputStream::readUInt32() {
+    unsigned char bytes[4];
+    uint32_t result;
+    if ( (this->readEndPtr - this->readPtr) >= 4 ) {
+        result = decodeUInt32(this->readPtr);
+        this->readPtr += 4;
+    } else {
+        this->readFully(bytes, 4);
+        result = decodeUInt32(bytes);
+    }
+    return( result );
+}
+
+int32_t R3CBinaryInputStream::readInt32() {
+    return( (int32_t)this->readUInt32() );
+}
+
+uint64_t R3CBinaryInputStream::readUInt64() {
+    unsigned char bytes[8];
+    uint64_t result;
+    if ( (this->readEndPtr - this->readPtr) >= 8 ) {
+        result = decodeUInt64(this->readPtr);
+        this->readPtr += 8;
+    } else {
+        this->readFully(bytes, 8);
+        result = decodeUInt64(bytes);
+    }
+    return( result );
+}
+
+int64_t R3CBinaryInputStream::readInt64() {
+    return( (int64_t)this->readUInt64() );
+}
+
+float R3CBinaryInputStream::readFloat() {
+    uint32_t bits;
+    float result;
+    bits = this->readUInt32();
+    memcpy(&result, &bits, sizeof(result));
+    return( result );
+}
+
+double R3CBinaryInputStream::readDouble() {
+    uint64_t bits;
+    double result;
+    bits = this->readUInt64();
+    memcpy(&result, &bits, sizeof(result));
+    return( result );
+}
+
+
+// *** READ ARRAYS OF FIXED-WIDTH VALUES *** //
+
+// On little-endian hosts, each array is copied directly from the stream;
+// otherwise each value is decoded in place after the copy.
+
+void R3CBinaryInputStream::readUInt16s(uint16_t *values, int count) {
+#ifndef R3C_NOERRCHECK
+    if ( (values == NULL) || (count < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->readFully(values, getArrayBytes(count, 2));
+#ifndef HOST_LITTLE_ENDIAN
+    for ( int i = 0; i < count; i++ ) {
+        values[i] = decodeUInt16((const unsigned char*)&values[i]);
+    }
+#endif
+}
+
+void R3CBinaryInputStream::readUInt32s(uint32_t *values, int count) {
+#ifndef R3C_NOERRCHECK
+    if ( (values == NULL) || (count < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->readFully(values, getArrayBytes(count, 4));
+#ifndef HOST_LITTLE_ENDIAN
+    for ( int i = 0; i < count; i++ ) {
+        values[i] = decodeUInt32((const unsigned char*)&values[i]);
+    }
+#endif
+}
+
+void R3CBinaryInputStream::readUInt64s(uint64_t *values, int count) {
+#ifndef R3C_NOERRCHECK
+    if ( (values == NULL) || (count < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->readFully(values, getArrayBytes(count, 8));
+#ifndef HOST_LITTLE_ENDIAN
+    for ( int i = 0; i < count; i++ ) {
+        values[i] = decodeUInt64((const unsigned char*)&values[i]);
+    }
+#endif
+}
+
+void R3CBinaryInputStream::readFloats(float *values, int count) {
+#ifndef R3C_NOERRCHECK
+    if ( (values == NULL) || (count < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->readFully(values, getArrayBytes(count, 4));
+#ifndef HOST_LITTLE_ENDIAN
+    uint32_t bits;
+    for ( int i = 0; i < count; i++ ) {
+        bits = decodeUInt32((const unsigned char*)&values[i]);
+        memcpy(&values[i], &bits, sizeof(bits));
+    }
+#endif
+}
+
+void R3CBinaryInputStream::readDoubles(double *values, int count) {
+#ifndef R3C_NOERRCHECK
+    if ( (values == NULL) || (count < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->readFully(values, getArrayBytes(count, 8));
+#ifndef HOST_LITTLE_ENDIAN
+    uint64_t bits;
+    for ( int i = 0; i < count; i++ ) {
+        bits = decodeUInt64((const unsigned char*)&values[i]);
+        memcpy(&values[i], &bits, sizeof(bits));
+    }
+#endif
+}
+
+
+// *** READ VARIABLE-WIDTH VALUES *** //
+
+uint64_t R3CBinaryInputStream::readVarUInt() {
+    const unsigned char* bytePtr;
+    uint64_t result;
+    unsigned int curByte;
+    int shift;
+    result = 0;
+    shift = 0;
+    if ( (this->readEndPtr - this->readPtr) >= MAX_VARINT_BYTES ) {
+        // The longest value is already buffered, so decode it in place
+        bytePtr = this->readPtr;
+        do {
+            curByte = *bytePtr++;
+            result |= (uint64_t)(curByte & 0x7F) << shift;
+            shift += 7;
+        } while ( (curByte & 0x80) && (shift < MAX_VARINT_BYTES * 7) );
+        this->readPtr = bytePtr;
+    } else {
+        do {
+            curByte = this->readUInt8();
+            result |= (uint64_t)(curByte & 0x7F) << shift;
+            shift += 7;
+        } while ( (curByte & 0x80) && (shift < MAX_VARINT_BYTES * 7) );
+    }
+    if ( curByte & 0x80 ) throw R3CERR_IO_BADFORMAT;
+    return( result );
+}
+
+int64_t R3CBinaryInputStream::readVarInt() {
+    uint64_t encoded;
+    encoded = this->readVarUInt();
+    return( (int64_t)(encoded >> 1) ^ -(int64_t)(encoded & 1) );
+}
+
+int R3CBinaryInputStream::readString(R3CString *targetStr) {
+    int length;
+#ifndef R3C_NOERRCHECK
+    if ( targetStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    length = checkLength(this->readVarUInt());
+    targetStr->clear();
+    try {
+        this->readAppend(targetStr, length);
+    } catch ( ... ) {
+        targetStr->clear();
+        throw;
+    }
+    return( length );
+}
+
+char* R3CBinaryInputStream::readString(R3CStringBlock *block) {
+    R3CString chars;
+    int length;
+    char* result;
+#ifndef R3C_NOERRCHECK
+    if ( block == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    length = checkLength(this->readVarUInt());
+
+    // A string that is already buffered is copied straight into the block;
+    // otherwise it is collected first, so that nothing is allocated from the
+    // block for a length the stream does not hold
+    if ( (this->readEndPtr - this->readPtr) >= length ) {
+        result = block->allocString(length);
+        memcpy(result, this->readPtr, length);
+        this->readPtr += length;
+    } else {
+        this->readAppend(&chars, length);
+        result = block->allocString(length);
+        memcpy(result, chars.getChars(), length);
+    }
+    return( result );
+}
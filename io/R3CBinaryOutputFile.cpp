@@ -0,0 +1,145 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+// *** CONSTANTS *** //
+
+#define DEFAULT_BUFFER_KB 64
+#define CREATE_MODE 0666
+
+
+// *** CONSTRUCTION *** //
+
+R3CBinaryOutputFile::R3CBinaryOutputFile() :
+    fileDesc(-1),
+    bufferSize(DEFAULT_BUFFER_KB << 10),
+    buffer(NULL)
+{
+}
+
+R3CBinaryOutputFile::R3CBinaryOutputFile(const char *outputFilename) :
+    fileDesc(-1),
+    bufferSize(DEFAULT_BUFFER_KB << 10),
+    buffer(NULL)
+{
+    this->open(outputFilename);
+}
+
+R3CBinaryOutputFile::R3CBinaryOutputFile(R3CString *outputFilename) :
+    fileDesc(-1),
+    bufferSize(DEFAULT_BUFFER_KB << 10),
+    buffer(NULL)
+{
+    this->open(outputFilename);
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CBinaryOutputFile::~R3CBinaryOutputFile() {
+    if ( this->fileDesc != -1 ) {
+        try {
+            this->flush();
+        } catch ( const char* ) {
+            // Errors cannot be reported from the destructor
+        }
+        ::close(this->fileDesc);
+    }
+    if ( this->buffer != NULL ) delete[] this->buffer;
+}
+
+
+// *** OPEN STREAM *** //
+
+void R3CBinaryOutputFile::open(const char *outputFilename) {
+#ifndef R3C_NOERRCHECK
+    if ( outputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc != -1 ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    this->fileDesc = ::open(
+        outputFilename, O_WRONLY | O_CREAT | O_TRUNC, CREATE_MODE);
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTFOUND;
+    if ( this->buffer == NULL ) {
+        this->buffer = new unsigned char [this->bufferSize];
+    }
+    this->writePtr = this->buffer;
+    this->writeEndPtr = this->buffer + this->bufferSize;
+}
+
+void R3CBinaryOutputFile::open(R3CString *outputFilename) {
+#ifndef R3C_NOERRCHECK
+    if ( outputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->open(outputFilename->getChars());
+}
+
+void R3CBinaryOutputFile::setBufferSize(int kbPerBuffer) {
+#ifndef R3C_NOERRCHECK
+    if ( kbPerBuffer < 1 ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc != -1 ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    if ( this->buffer != NULL ) delete[] this->buffer;
+    this->buffer = NULL;
+    this->bufferSize = kbPerBuffer << 10;
+}
+
+
+// *** WRITE BUFFER *** //
+
+void R3CBinaryOutputFile::emptyBuffer() {
+    this->flush();
+}
+
+
+// *** WRITE BYTES TO THE FILE *** //
+
+void R3CBinaryOutputFile::flush() {
+    const unsigned char* flushPtr;
+    ssize_t bytesWritten;
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+
+    // The buffer is emptied even on failure, so a failed write is not
+    // repeated by the destructor
+    flushPtr = this->buffer;
+    while ( flushPtr < this->writePtr ) {
+        bytesWritten = ::write(
+            this->fileDesc, flushPtr, this->writePtr - flushPtr);
+        if ( bytesWritten < 0 ) {
+            if ( errno != EINTR ) {
+                this->writePtr = this->buffer;
+                throw R3CERR_IO_EXCEPTION;
+            }
+        } else {
+            flushPtr += bytesWritten;
+        }
+    }
+    this->writePtr = this->buffer;
+}
+
+
+// *** CLOSE FILE *** //
+
+void R3CBinaryOutputFile::close() {
+    int closeResult;
+    bool flushFailed;
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    flushFailed = false;
+    try {
+        this->flush();
+    } catch ( const char* ) {
+        flushFailed = true;
+    }
+    closeResult = ::close(this->fileDesc);
+    this->fileDesc = -1;
+    this->writePtr = NULL;
+    this->writeEndPtr = NULL;
+    if ( flushFailed || (closeResult != 0) ) throw R3CERR_IO_EXCEPTION;
+}
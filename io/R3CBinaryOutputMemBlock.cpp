@@ -0,0 +1,103 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <string.h>
+#include <limits.h>
+
+
+// *** CONSTANTS *** //
+
+#define INITIAL_BLOCK_SIZE 4096
+#define MAX_BLOCK_SIZE INT_MAX
+
+
+// *** CONSTRUCTION *** //
+
+R3CBinaryOutputMemBlock::R3CBinaryOutputMemBlock() :
+    isOpen(true),
+    bufferSize(0),
+    buffer(NULL)
+{
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CBinaryOutputMemBlock::~R3CBinaryOutputMemBlock() {
+    if ( this->buffer != NULL ) delete[] this->buffer;
+}
+
+
+// *** OPEN STREAM *** //
+
+void R3CBinaryOutputMemBlock::open() {
+#ifndef R3C_NOERRCHECK
+    if ( this->isOpen ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    this->isOpen = true;
+    this->writePtr = this->buffer;
+    this->writeEndPtr = this->buffer + this->bufferSize;
+}
+
+
+// *** RETRIEVE MEMORY BLOCK *** //
+
+const char* R3CBinaryOutputMemBlock::getBytes() {
+    return( (const char*)this->buffer );
+}
+
+int R3CBinaryOutputMemBlock::getLength() {
+    return( (int)(this->writePtr - this->buffer) );
+}
+
+
+// *** WRITE BUFFER *** //
+
+// Doubles the size of the memory block, up to the number of bytes that
+// getLength can report.
+void R3CBinaryOutputMemBlock::emptyBuffer() {
+    unsigned char* oldBuffer;
+    int usedSize;
+    if ( !this->isOpen ) throw R3CERR_IO_STREAMNOTOPEN;
+    if ( this->bufferSize >= MAX_BLOCK_SIZE ) throw R3CERR_OUTOFRANGE;
+    oldBuffer = this->buffer;
+    usedSize = (int)(this->writePtr - oldBuffer);
+    if ( oldBuffer == NULL ) {
+        this->bufferSize = INITIAL_BLOCK_SIZE;
+    } else if ( this->bufferSize > (MAX_BLOCK_SIZE >> 1) ) {
+        this->bufferSize = MAX_BLOCK_SIZE;
+    } else {
+        this->bufferSize <<= 1;
+    }
+    this->buffer = new unsigned char [this->bufferSize];
+    if ( oldBuffer != NULL ) {
+        memcpy(this->buffer, oldBuffer, usedSize);
+        delete[] oldBuffer;
+    }
+    this->writePtr = this->buffer + usedSize;
+    this->writeEndPtr = this->buffer + this->bufferSize;
+}
+
+
+// *** WRITE BYTES TO THE MEMORY BLOCK *** //
+
+void R3CBinaryOutputMemBlock::flush() {
+#ifndef R3C_NOERRCHECK
+    if ( !this->isOpen ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+}
+
+
+// *** CLOSE STREAM *** //
+
+// The write buffer is left with no room, so that further writes reach
+// emptyBuffer, and fail.
+void R3CBinaryOutputMemBlock::close() {
+#ifndef R3C_NOERRCHECK
+    if ( !this->isOpen ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    this->isOpen = false;
+    this->writeEndPtr = this->writePtr;
+}
@@ -0,0 +1,328 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <string.h>
+
+
+// *** CONSTANTS *** //
+
+#define MAX_VARINT_BYTES 10
+#define ARRAY_CHUNK_BYTES 256
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define HOST_LITTLE_ENDIAN
+#endif
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Encodes a little-endian unsigned 16-bit integer.
+static inline void encodeUInt16(unsigned char* bytes, uint16_t value) {
+#ifdef HOST_LITTLE_ENDIAN
+    memcpy(bytes, &value, sizeof(value));
+#else
+    bytes[0] = (unsigned char)value;
+    bytes[1] = (unsigned char)(value >> 8);
+#endif
+}
+
+// Encodes a little-endian unsigned 32-bit integer.
+static inline void encodeUInt32(unsigned char* bytes, uint32_t value) {
+#ifdef HOST_LITTLE_ENDIAN
+    memcpy(bytes, &value, sizeof(value));
+#else
+    bytes[0] = (unsigned char)value;
+    bytes[1] = (unsigned char)(value >> 8);
+    bytes[2] = (unsigned char)(value >> 16);
+    bytes[3] = (unsigned char)(value >> 24);
+#endif
+}
+
+// Encodes a little-endian unsigned 64-bit integer.
+static inline void encodeUInt64(unsigned char* bytes, uint64_t value) {
+#ifdef HOST_LITTLE_ENDIAN
+    memcpy(bytes, &value, sizeof(value));
+#else
+    encodeUInt32(bytes, (uint32_t)value);
+    encodeUInt32(bytes + 4, (uint32_t)(value >> 32));
+#endif
+}
+
+// Returns the number of bytes in an array of count values of the given
+// width.
+static size_t getArrayBytes(int count, size_t width) {
+    if ( (size_t)count > ((size_t)-1) / width ) throw R3CERR_ILLEGALARGUMENT;
+    return( (size_t)count * width );
+}
+
+
+// *** CONSTRUCTION *** //
+
+R3CBinaryOutputStream::R3CBinaryOutputStream() :
+    writePtr(NULL),
+    writeEndPtr(NULL)
+{
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CBinaryOutputStream::~R3CBinaryOutputStream() {
+}
+
+
+// *** WRITE BUFFER *** //
+
+// Writes byteCount bytes from the source buffer.
+void R3CBinaryOutputStream::writeFully(
+    const void *source, size_t byteCount
+) {
+    const unsigned char* sourcePtr;
+    size_t bytesAvailable;
+    sourcePtr = (const unsigned char*)source;
+    while ( byteCount > 0 ) {
+        if ( this->writePtr == this->writeEndPtr ) this->emptyBuffer();
+        bytesAvailable = (size_t)(this->writeEndPtr - this->writePtr);
+        if ( bytesAvailable > byteCount ) bytesAvailable = byteCount;
+        memcpy(this->writePtr, sourcePtr, bytesAvailable);
+        this->writePtr += bytesAvailable;
+        sourcePtr += bytesAvailable;
+        byteCount -= bytesAvailable;
+    }
+}
+
+
+// *** WRITE BYTES TO THE STREAM *** //
+
+void R3CBinaryOutputStream::writeBytes(const void *source, int byteCount) {
+#ifndef R3C_NOERRCHECK
+    if ( (source == NULL) || (byteCount < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->writeFully(source, byteCount);
+}
+
+
+// *** WRITE FIXED-WIDTH VALUES *** //
+
+void R3CBinaryOutputStream::writeUInt8(uint8_t value) {
+    if ( this->writePtr == this->writeEndPtr ) this->emptyBuffer();
+    *this->writePtr++ = value;
+}
+
+void R3CBinaryOutputStream::writeInt8(int8_t value) {
+    this->writeUInt8((uint8_t)value);
+}
+
+void R3CBinaryOutputStream::writeUInt16(uint16_t value) {
+    unsigned char bytes[2];
+    if ( (this->writeEndPtr - this->writePtr) >= 2 ) {
+        encodeUInt16(this->writePtr, value);
+        this->writePtr += 2;
+    } else {
+        encodeUInt16(bytes, value);
+        this->writeFully(bytes, 2);
+    }
+}
+
+void R3CBinaryOutputStream::writeInt16(int16_t value) {
+    this->writeUInt16((uint16_t)value);
+}
+
+void R3CBinaryOutputStream::writeUInt32(uint32_t value) {
+    unsigned char bytes[4];
+    if ( (this->writeEndPtr - this->writePtr) >= 4 ) {
+        encodeUInt32(this->writePtr, value);
+        this->writePtr += 4;
+    } else {
+        encodeUInt32(bytes, value);
+        this->writeFully(bytes, 4);
+    }
+}
+
+void R3CBinaryOutputStream::writeInt32(int32_t value) {
+    this->writeUInt32((uint32_t)value);
+}
+
+void R3CBinaryOutputStream::writeUInt64(uint64_t value) {
+    unsigned char bytes[8];
+    if ( (this->writeEndPtr - this->writePtr) >= 8 ) {
+        encodeUInt64(this->writePtr, value);
+        this->writePtr += 8;
+    } else {
+        encodeUInt64(bytes, value);
+        this->writeFully(bytes, 8);
+    }
+}
+
+void R3CBinaryOutputStream::writeInt64(int64_t value) {
+    this->writeUInt64((uint64_t)value);
+}
+
+void R3CBinaryOutputStream::writeFloat(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    this->writeUInt32(bits);
+}
+
+void R3CBinaryOutputStream::writeDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    this->writeUInt64(bits);
+}
+
+
+// *** WRITE ARRAYS OF FIXED-WIDTH VALUES *** //
+
+// On little-endian hosts, each array is copied directly to the stream;
+// otherwise values are encoded a chunk at a time.
+
+void R3CBinaryOutputStream::writeUInt16s(const uint16_t *values, int count) {
+#ifndef R3C_NOERRCHECK
+    if ( (values == NULL) || (count < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+#ifdef HOST_LITTLE_ENDIAN
+    this->writeFully(values, getArrayBytes(count, 2));
+#else
+    unsigned char bytes[ARRAY_CHUNK_BYTES];
+    int chunkCount;
+    while ( count > 0 ) {
+        chunkCount = count < (ARRAY_CHUNK_BYTES / 2) ?
+            count : (ARRAY_CHUNK_BYTES / 2);
+        for ( int i = 0; i < chunkCount; i++ ) {
+            encodeUInt16(bytes + (i * 2), values[i]);
+        }
+        this->writeFully(bytes, chunkCount * 2);
+        values += chunkCount;
+        count -= chunkCount;
+    }
+#endif
+}
+
+void R3CBinaryOutputStream::writeUInt32s(const uint32_t *values, int count) {
+#ifndef R3C_NOERRCHECK
+    if ( (values == NULL) || (count < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+#ifdef HOST_LITTLE_ENDIAN
+    this->writeFully(values, getArrayBytes(count, 4));
+#else
+    unsigned char bytes[ARRAY_CHUNK_BYTES];
+    int chunkCount;
+    while ( count > 0 ) {
+        chunkCount = count < (ARRAY_CHUNK_BYTES / 4) ?
+            count : (ARRAY_CHUNK_BYTES / 4);
+        for ( int i = 0; i < chunkCount; i++ ) {
+            encodeUInt32(bytes + (i * 4), values[i]);
+        }
+        this->writeFully(bytes, chunkCount * 4);
+        values += chunkCount;
+        count -= chunkCount;
+    }
+#endif
+}
+
+void R3CBinaryOutputStream::writeUInt64s(const uint64_t *values, int count) {
+#ifndef R3C_NOERRCHECK
+    if ( (values == NULL) || (count < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+#ifdef HOST_LITTLE_ENDIAN
+    this->writeFully(values, getArrayBytes(count, 8));
+#else
+    unsigned char bytes[ARRAY_CHUNK_BYTES];
+    int chunkCount;
+    while ( count > 0 ) {
+        chunkCount = count < (ARRAY_CHUNK_BYTES / 8) ?
+            count : (ARRAY_CHUNK_BYTES / 8);
+        for ( int i = 0; i < chunkCount; i++ ) {
+            encodeUInt64(bytes + (i * 8), values[i]);
+        }
+        this->writeFully(bytes, chunkCount * 8);
+        values += chunkCount;
+        count -= chunkCount;
+    }
+#endif
+}
+
+void R3CBinaryOutputStream::writeFloats(const float *values, int count) {
+#ifndef R3C_NOERRCHECK
+    if ( (values == NULL) || (count < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+#ifdef HOST_LITTLE_ENDIAN
+    this->writeFully(values, getArrayBytes(count, 4));
+#else
+    uint32_t bits;
+    for ( int i = 0; i < count; i++ ) {
+        memcpy(&bits, &values[i], sizeof(bits));
+        this->writeUInt32(bits);
+    }
+#endif
+}
+
+void R3CBinaryOutputStream::writeDoubles(const double *values, int count) {
+#ifndef R3C_NOERRCHECK
+    if ( (values == NULL) || (count < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+#ifdef HOST_LITTLE_ENDIAN
+    this->writeFully(values, getArrayBytes(count, 8));
+#else
+    uint64_t bits;
+    for ( int i = 0; i < count; i++ ) {
+        memcpy(&bits, &values[i], sizeof(bits));
+        this->writeUInt64(bits);
+    }
+#endif
+}
+
+// *** WRITE VARIABLE-WIDTH VALUES *** //
+
+void R3CBinaryOutputStream::writeVarUInt(uint64_t value) {
+    unsigned char bytes[MAX_VARINT_BYTES];
+    unsigned char* bytePtr;
+    int byteCount;
+
+    // Encode directly into the write buffer if the longest value will fit
+    if ( (this->writeEndPtr - this->writePtr) >= MAX_VARINT_BYTES ) {
+        bytePtr = this->writePtr;
+    } else {
+        bytePtr = bytes;
+    }
+    byteCount = 0;
+    while ( value >= 0x80 ) {
+        bytePtr[byteCount++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    bytePtr[byteCount++] = (unsigned char)value;
+    if ( bytePtr == bytes ) {
+        this->writeFully(bytes, byteCount);
+    } else {
+        this->writePtr += byteCount;
+    }
+}
+
+void R3CBinaryOutputStream::writeVarInt(int64_t value) {
+    this->writeVarUInt(
+        ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+void R3CBinaryOutputStream::writeString(const char *sourceStr) {
+#ifndef R3C_NOERRCHECK
+    if ( sourceStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->writeString(sourceStr, (int)strlen(sourceStr));
+}
+
+void R3CBinaryOutputStream::writeString(const char *sourceStr, int length) {
+#ifndef R3C_NOERRCHECK
+    if ( (sourceStr == NULL) || (length < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->writeVarUInt((uint64_t)length);
+    this->writeFully(sourceStr, length);
+}
+
+void R3CBinaryOutputStream::writeString(R3CString *sourceStr) {
+#ifndef R3C_NOERRCHECK
+    if ( sourceStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->writeString(sourceStr->getChars(), sourceStr->getLength());
+}
@@ -0,0 +1,590 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <string.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+
+// *** CONSTANTS *** //
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+#ifndef O_DIRECTORY
+#define O_DIRECTORY 0
+#endif
+
+#ifndef O_NOFOLLOW
+#define O_NOFOLLOW 0
+#endif
+
+
+// *** WALK FOLDERS *** //
+
+// Folder waiting in the queue to be read.
+struct R3CWalkFolder {
+
+    // Path of the folder
+    char* path;
+
+    // Number of characters in the path
+    int length;
+
+};
+
+#ifdef __linux__
+
+// Folder entry, as returned by the getdents64 system call.
+struct R3CLinuxDirent {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+#endif
+
+// Handler adding the paths it receives to a string block.
+class R3CWalkCollector :
+    public R3CDirectoryEntryHandler
+{
+
+public:
+
+    // String block receiving the paths
+    R3CStringBlock* targetBlock;
+
+    // Types of the entries to add
+    int entryTypes;
+
+    // Number of paths added
+    int pathCount;
+
+    // Mutex guarding the string block
+    pthread_mutex_t blockLock;
+
+    R3CWalkCollector(R3CStringBlock* targetBlock, int entryTypes) :
+        targetBlock(targetBlock),
+        entryTypes(entryTypes),
+        pathCount(0)
+    {
+        pthread_mutex_init(&this->blockLock, NULL);
+    }
+
+    ~R3CWalkCollector() {
+        pthread_mutex_destroy(&this->blockLock);
+    }
+
+    void handleEntry(
+        R3CPathString* path, int nameOffset, int entryType, int workerIndex
+    ) {
+        (void)nameOffset;
+        (void)workerIndex;
+        if ( (entryType & this->entryTypes) == 0 ) return;
+        pthread_mutex_lock(&this->blockLock);
+        try {
+            this->targetBlock->addString(path);
+        } catch ( ... ) {
+            pthread_mutex_unlock(&this->blockLock);
+            throw;
+        }
+        this->pathCount++;
+        pthread_mutex_unlock(&this->blockLock);
+    }
+
+};
+
+
+// *** HELPER FUNCTIONS *** //
+
+#if defined(__linux__) || defined(DT_UNKNOWN)
+
+// Returns the entry type for the given folder entry type, or 0 if the folder
+// did not record it.
+static int getEntryType(unsigned char dirType) {
+    switch ( dirType ) {
+        case DT_REG: return( R3C_IO_ENTRY_FILE );
+        case DT_DIR: return( R3C_IO_ENTRY_FOLDER );
+        case DT_LNK: return( R3C_IO_ENTRY_LINK );
+        case DT_UNKNOWN: return( 0 );
+        default: return( R3C_IO_ENTRY_OTHER );
+    }
+}
+
+#endif
+
+// Returns the entry type for the given file mode.
+static int getModeType(mode_t fileMode) {
+    if ( S_ISREG(fileMode) ) return( R3C_IO_ENTRY_FILE );
+    if ( S_ISDIR(fileMode) ) return( R3C_IO_ENTRY_FOLDER );
+    if ( S_ISLNK(fileMode) ) return( R3C_IO_ENTRY_LINK );
+    return( R3C_IO_ENTRY_OTHER );
+}
+
+// Checks if the given entry name is "." or "..".
+static bool isDotName(const char* name) {
+    return(
+        (name[0] == '.') &&
+        ((name[1] == '\0') || ((name[1] == '.') && (name[2] == '\0'))) );
+}
+
+// Cuts the given path back to the given length.
+static void cutPath(R3CPathString* path, int length) {
+    path->getChars()[length] = '\0';
+    path->resetLength();
+}
+
+
+// *** CONSTRUCTION *** //
+
+R3CDirectoryWalker::R3CDirectoryWalker(int workerCount) :
+    workerCount(workerCount),
+    queueCapacity(R3C_IO_WALKQUEUE),
+    queue(NULL),
+    queueHead(0),
+    queueCount(0),
+    activeCount(0),
+    relativeOffset(0),
+    entryHandler(NULL),
+    workerError(NULL),
+    stopping(0)
+{
+#ifndef R3C_NOERRCHECK
+    if ( workerCount < 1 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->queue = new R3CWalkFolder [this->queueCapacity];
+    pthread_mutex_init(&this->queueLock, NULL);
+    pthread_cond_init(&this->queueReady, NULL);
+}
+
+R3CDirectoryWalker::R3CDirectoryWalker(int workerCount, int queueCapacity) :
+    workerCount(workerCount),
+    queueCapacity(queueCapacity),
+    queue(NULL),
+    queueHead(0),
+    queueCount(0),
+    activeCount(0),
+    relativeOffset(0),
+    entryHandler(NULL),
+    workerError(NULL),
+    stopping(0)
+{
+#ifndef R3C_NOERRCHECK
+    if ( (workerCount < 1) || (queueCapacity < 1) ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+#endif
+    this->queue = new R3CWalkFolder [this->queueCapacity];
+    pthread_mutex_init(&this->queueLock, NULL);
+    pthread_cond_init(&this->queueReady, NULL);
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CDirectoryWalker::~R3CDirectoryWalker() {
+    delete[] this->queue;
+    pthread_mutex_destroy(&this->queueLock);
+    pthread_cond_destroy(&this->queueReady);
+}
+
+
+// *** MANAGE EXCLUSIONS *** //
+
+void R3CDirectoryWalker::exclude(const char* pattern) {
+#ifndef R3C_NOERRCHECK
+    if ( pattern == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( strchr(pattern, R3C_PATH_SEPARATOR) != NULL ) {
+        this->pathExcludes.add(pattern);
+    } else {
+        this->nameExcludes.add(pattern);
+    }
+}
+
+
+// *** WALK FOLDERS *** //
+
+void R3CDirectoryWalker::walk(
+    const char* rootPath, R3CDirectoryEntryHandler* handler
+) {
+    pthread_t* threads;
+    WorkerTask* tasks;
+    int threadsStarted;
+    int rootDesc;
+    int rootLength;
+#ifndef R3C_NOERRCHECK
+    if ( (rootPath == NULL) || (handler == NULL) ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+#endif
+    rootDesc = open(rootPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if ( rootDesc < 0 ) throw R3CERR_IO_STREAMNOTFOUND;
+    close(rootDesc);
+
+    // Drop trailing separators from the root path, other than a lone one
+    rootLength = (int)strlen(rootPath);
+    while (
+        (rootLength > 1) && (rootPath[rootLength - 1] == R3C_PATH_SEPARATOR)
+    ) {
+        rootLength--;
+    }
+    this->relativeOffset = rootLength;
+    if ( rootPath[rootLength - 1] != R3C_PATH_SEPARATOR ) {
+        this->relativeOffset++;
+    }
+
+    // Prepare the patterns now, as the workers only read them
+    if ( this->nameExcludes.getPatternCount() > 0 ) {
+        this->nameExcludes.prepare();
+    }
+    if ( this->pathExcludes.getPatternCount() > 0 ) {
+        this->pathExcludes.prepare();
+    }
+
+    // Queue the root folder
+    this->queue[0].path = new char [rootLength + 1];
+    memcpy(this->queue[0].path, rootPath, rootLength);
+    this->queue[0].path[rootLength] = '\0';
+    this->queue[0].length = rootLength;
+    this->queueHead = 0;
+    this->queueCount = 1;
+    this->activeCount = 0;
+    this->entryHandler = handler;
+    this->workerError = NULL;
+#if __cplusplus >= 201103L
+    this->workerException = std::exception_ptr();
+#endif
+    this->stopping = 0;
+
+    // Start a thread for every worker but the first, which is run by the
+    // calling thread
+    threads = new pthread_t [this->workerCount];
+    tasks = new WorkerTask [this->workerCount];
+    threadsStarted = 0;
+    for ( int i = 1; i < this->workerCount; i++ ) {
+        tasks[i].walker = this;
+        tasks[i].workerIndex = i;
+        if (
+            pthread_create(
+                &threads[i], NULL, R3CDirectoryWalker::runWorker,
+                &tasks[i]) != 0
+        ) {
+            pthread_mutex_lock(&this->queueLock);
+            if ( this->workerError == NULL ) {
+                this->workerError = R3CERR_IO_EXCEPTION;
+            }
+            __atomic_store_n(&this->stopping, 1, __ATOMIC_RELAXED);
+            pthread_cond_broadcast(&this->queueReady);
+            pthread_mutex_unlock(&this->queueLock);
+            break;
+        }
+        threadsStarted++;
+    }
+    if ( threadsStarted == this->workerCount - 1 ) this->processQueue(0);
+    for ( int i = 1; i <= threadsStarted; i++ ) {
+        pthread_join(threads[i], NULL);
+    }
+    delete[] threads;
+    delete[] tasks;
+
+    // Free any folders left behind by a walk that stopped early
+    while ( this->queueCount > 0 ) {
+        delete[] this->queue[this->queueHead].path;
+        this->queueHead = (this->queueHead + 1) % this->queueCapacity;
+        this->queueCount--;
+    }
+    this->entryHandler = NULL;
+#if __cplusplus >= 201103L
+    if ( this->workerException ) {
+        std::exception_ptr error;
+        error = this->workerException;
+        this->workerException = std::exception_ptr();
+        std::rethrow_exception(error);
+    }
+#endif
+    if ( this->workerError != NULL ) throw this->workerError;
+}
+
+int R3CDirectoryWalker::walk(
+    const char* rootPath, R3CStringBlock* targetBlock, int entryTypes
+) {
+    R3CWalkCollector collector(targetBlock, entryTypes);
+#ifndef R3C_NOERRCHECK
+    if ( targetBlock == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->walk(rootPath, &collector);
+    return( collector.pathCount );
+}
+
+
+// *** RUN WORKERS *** //
+
+// Entry point of a worker thread.
+void* R3CDirectoryWalker::runWorker(void* workerTask) {
+    WorkerTask* task;
+    task = (WorkerTask*)workerTask;
+    task->walker->processQueue(task->workerIndex);
+    return( NULL );
+}
+
+// Reads folders from the queue until it is empty and no other worker can
+// add to it, or the walk is stopped.  Nothing that can throw is done while
+// the queue is locked.
+void R3CDirectoryWalker::processQueue(int workerIndex) {
+    R3CPathString path;
+    char* folderPath;
+    char* buffer;
+    int folderLength;
+    int folderDesc;
+    bool isActive;
+    buffer = NULL;
+    isActive = false;
+    try {
+        buffer = new char [R3C_IO_WALKBUFFER];
+        while ( true ) {
+            pthread_mutex_lock(&this->queueLock);
+            while (
+                (this->queueCount == 0) && (this->activeCount > 0) &&
+                !this->stopping
+            ) {
+                pthread_cond_wait(&this->queueReady, &this->queueLock);
+            }
+            if ( (this->queueCount == 0) || this->stopping ) {
+                pthread_cond_broadcast(&this->queueReady);
+                pthread_mutex_unlock(&this->queueLock);
+                break;
+            }
+            folderPath = this->queue[this->queueHead].path;
+            folderLength = this->queue[this->queueHead].length;
+            this->queueHead = (this->queueHead + 1) % this->queueCapacity;
+            this->queueCount--;
+            this->activeCount++;
+            isActive = true;
+            pthread_mutex_unlock(&this->queueLock);
+
+            try {
+                path.set(folderPath, folderLength);
+            } catch ( ... ) {
+                delete[] folderPath;
+                throw;
+            }
+            delete[] folderPath;
+            folderDesc = open(
+                path.getChars(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if ( folderDesc >= 0 ) {
+                this->walkFolder(folderDesc, &path, buffer, workerIndex);
+            }
+
+            // The last worker to go idle with nothing queued ends the walk
+            pthread_mutex_lock(&this->queueLock);
+            this->activeCount--;
+            isActive = false;
+            if ( (this->activeCount == 0) && (this->queueCount == 0) ) {
+                pthread_cond_broadcast(&this->queueReady);
+            }
+            pthread_mutex_unlock(&this->queueLock);
+        }
+    } catch ( const char* error ) {
+        this->stopWorkers(error, isActive);
+    } catch ( ... ) {
+#if __cplusplus >= 201103L
+        pthread_mutex_lock(&this->queueLock);
+        if ( (this->workerError == NULL) && !this->workerException ) {
+            this->workerException = std::current_exception();
+        }
+        pthread_mutex_unlock(&this->queueLock);
+        this->stopWorkers(NULL, isActive);
+#else
+        this->stopWorkers(R3CERR_IO_EXCEPTION, isActive);
+#endif
+    }
+    delete[] buffer;
+}
+
+// Records the first exception thrown by a worker, and asks every worker to
+// stop.
+void R3CDirectoryWalker::stopWorkers(const char* error, bool wasActive) {
+    pthread_mutex_lock(&this->queueLock);
+#if __cplusplus >= 201103L
+    if (
+        (error != NULL) && (this->workerError == NULL) &&
+        !this->workerException
+    ) {
+        this->workerError = error;
+    }
+#else
+    if ( (error != NULL) && (this->workerError == NULL) ) {
+        this->workerError = error;
+    }
+#endif
+    if ( wasActive ) this->activeCount--;
+    __atomic_store_n(&this->stopping, 1, __ATOMIC_RELAXED);
+    pthread_cond_broadcast(&this->queueReady);
+    pthread_mutex_unlock(&this->queueLock);
+}
+
+// Reads every entry of the given open folder, and closes it.
+void R3CDirectoryWalker::walkFolder(
+    int folderDesc, R3CPathString* path, char* buffer, int workerIndex
+) {
+#ifdef __linux__
+    R3CLinuxDirent* entry;
+    long byteCount;
+    long offset;
+    try {
+        while ( !__atomic_load_n(&this->stopping, __ATOMIC_RELAXED) ) {
+            byteCount = syscall(
+                __NR_getdents64, folderDesc, buffer, R3C_IO_WALKBUFFER);
+            if ( byteCount <= 0 ) break;
+            for ( offset = 0; offset < byteCount; offset += entry->d_reclen ) {
+                entry = (R3CLinuxDirent*)(buffer + offset);
+                if ( isDotName(entry->d_name) ) continue;
+                this->visitEntry(
+                    folderDesc, path, entry->d_name,
+                    getEntryType(entry->d_type), workerIndex);
+            }
+        }
+    } catch ( ... ) {
+        close(folderDesc);
+        throw;
+    }
+    close(folderDesc);
+#else
+    DIR* folder;
+    struct dirent* entry;
+    int entryType;
+    (void)buffer;
+    folder = fdopendir(folderDesc);
+    if ( folder == NULL ) {
+        close(folderDesc);
+        return;
+    }
+    try {
+        while ( !__atomic_load_n(&this->stopping, __ATOMIC_RELAXED) ) {
+            entry = readdir(folder);
+            if ( entry == NULL ) break;
+            if ( isDotName(entry->d_name) ) continue;
+#ifdef DT_UNKNOWN
+            entryType = getEntryType(entry->d_type);
+#else
+            entryType = 0;
+#endif
+            this->visitEntry(
+                folderDesc, path, entry->d_name, entryType, workerIndex);
+        }
+    } catch ( ... ) {
+        closedir(folder);
+        throw;
+    }
+    closedir(folder);
+#endif
+}
+
+// Handles one entry of a folder, and queues or reads it if it is a folder.
+void R3CDirectoryWalker::visitEntry(
+    int folderDesc, R3CPathString* path, const char* name, int entryType,
+    int workerIndex
+) {
+    struct stat entryStat;
+    char* pathChars;
+    char* buffer;
+    int folderLength;
+    int nameOffset;
+    int nameLength;
+    int subDesc;
+
+    // Extend the folder path with the entry name
+    folderLength = path->getLength();
+    nameLength = (int)strlen(name);
+    nameOffset = folderLength;
+    if (
+        (folderLength > 0) &&
+        (path->getChars()[folderLength - 1] != R3C_PATH_SEPARATOR)
+    ) {
+        nameOffset++;
+    }
+    path->appendSpace((nameOffset - folderLength) + nameLength);
+    pathChars = path->getChars();
+    pathChars[folderLength] = R3C_PATH_SEPARATOR;
+    memcpy(pathChars + nameOffset, name, nameLength);
+
+    // Prune excluded entries before anything else is done with them
+    if (
+        ((this->nameExcludes.getPatternCount() > 0) &&
+            (this->nameExcludes.matchFirst(
+                pathChars + nameOffset, nameLength) >= 0)) ||
+        ((this->pathExcludes.getPatternCount() > 0) &&
+            (this->pathExcludes.matchFirst(
+                pathChars + this->relativeOffset,
+                path->getLength() - this->relativeOffset) >= 0))
+    ) {
+        cutPath(path, folderLength);
+        return;
+    }
+
+    // Only look up the type if the folder did not record it
+    if ( entryType == 0 ) {
+        if (
+            fstatat(folderDesc, name, &entryStat, AT_SYMLINK_NOFOLLOW) != 0
+        ) {
+            cutPath(path, folderLength);
+            return;
+        }
+        entryType = getModeType(entryStat.st_mode);
+    }
+    this->entryHandler->handleEntry(path, nameOffset, entryType, workerIndex);
+
+    // Hand folders to other workers, or read them now if the queue is full
+    if ( (entryType == R3C_IO_ENTRY_FOLDER) && !this->queueFolder(path) ) {
+        subDesc = openat(
+            folderDesc, name,
+            O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if ( subDesc >= 0 ) {
+            buffer = new char [R3C_IO_WALKBUFFER];
+            try {
+                this->walkFolder(subDesc, path, buffer, workerIndex);
+            } catch ( ... ) {
+                delete[] buffer;
+                throw;
+            }
+            delete[] buffer;
+        }
+    }
+    cutPath(path, folderLength);
+}
+
+// Adds the given folder path to the queue, unless the queue is full.
+bool R3CDirectoryWalker::queueFolder(R3CPathString* path) {
+    R3CWalkFolder* folder;
+    char* pathCopy;
+    int pathLength;
+    pathLength = path->getLength();
+    pathCopy = new char [pathLength + 1];
+    memcpy(pathCopy, path->getChars(), pathLength + 1);
+    pthread_mutex_lock(&this->queueLock);
+    if ( this->queueCount == this->queueCapacity ) {
+        pthread_mutex_unlock(&this->queueLock);
+        delete[] pathCopy;
+        return( false );
+    }
+    folder = &this->queue[
+        (this->queueHead + this->queueCount) % this->queueCapacity];
+    folder->path = pathCopy;
+    folder->length = pathLength;
+    this->queueCount++;
+    pthread_cond_signal(&this->queueReady);
+    pthread_mutex_unlock(&this->queueLock);
+    return( true );
+}
@@ -0,0 +1,390 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+
+// *** CONSTANTS *** //
+
+#define DEFAULT_PAGE_KB 16
+#define DEFAULT_PAGE_COUNT 64
+#define NO_PAGE -1
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Reads up to byteCount bytes at the given position, stopping early only at
+// the end of the file.
+static int readFile(
+    int fileDesc, char* target, int byteCount, off_t position
+) {
+    ssize_t result;
+    int bytesRead;
+    bytesRead = 0;
+    while ( bytesRead < byteCount ) {
+        result = pread(
+            fileDesc, target + bytesRead, byteCount - bytesRead,
+            position + bytesRead);
+        if ( result < 0 ) {
+            if ( errno != EINTR ) throw R3CERR_IO_EXCEPTION;
+        } else if ( result == 0 ) {
+            break;
+        } else {
+            bytesRead += (int)result;
+        }
+    }
+    return( bytesRead );
+}
+
+
+// *** CONSTRUCTION *** //
+
+R3CRandomAccessFile::R3CRandomAccessFile() :
+    fileDesc(-1),
+    fileSize(0),
+    pageSize(DEFAULT_PAGE_KB << 10),
+    pageCapacity(DEFAULT_PAGE_COUNT),
+    pagesUsed(0),
+    pageData(NULL),
+    pages(NULL),
+    hashBuckets(NULL),
+    hashBits(0),
+    lruHead(NO_PAGE),
+    lruTail(NO_PAGE),
+    hitCount(0),
+    missCount(0)
+{
+    pthread_mutex_init(&this->cacheLock, NULL);
+}
+
+R3CRandomAccessFile::R3CRandomAccessFile(const char *inputFilename) :
+    fileDesc(-1),
+    fileSize(0),
+    pageSize(DEFAULT_PAGE_KB << 10),
+    pageCapacity(DEFAULT_PAGE_COUNT),
+    pagesUsed(0),
+    pageData(NULL),
+    pages(NULL),
+    hashBuckets(NULL),
+    hashBits(0),
+    lruHead(NO_PAGE),
+    lruTail(NO_PAGE),
+    hitCount(0),
+    missCount(0)
+{
+    pthread_mutex_init(&this->cacheLock, NULL);
+    this->open(inputFilename);
+}
+
+R3CRandomAccessFile::R3CRandomAccessFile(R3CString *inputFilename) :
+    fileDesc(-1),
+    fileSize(0),
+    pageSize(DEFAULT_PAGE_KB << 10),
+    pageCapacity(DEFAULT_PAGE_COUNT),
+    pagesUsed(0),
+    pageData(NULL),
+    pages(NULL),
+    hashBuckets(NULL),
+    hashBits(0),
+    lruHead(NO_PAGE),
+    lruTail(NO_PAGE),
+    hitCount(0),
+    missCount(0)
+{
+    pthread_mutex_init(&this->cacheLock, NULL);
+    this->open(inputFilename);
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CRandomAccessFile::~R3CRandomAccessFile() {
+    if ( this->fileDesc != -1 ) ::close(this->fileDesc);
+    if ( this->pageData != NULL ) delete[] this->pageData;
+    if ( this->pages != NULL ) delete[] this->pages;
+    if ( this->hashBuckets != NULL ) delete[] this->hashBuckets;
+    pthread_mutex_destroy(&this->cacheLock);
+}
+
+
+// *** OPEN STREAM *** //
+
+void R3CRandomAccessFile::open(const char *inputFilename) {
+    struct stat fileStat;
+    int bucketCount;
+#ifndef R3C_NOERRCHECK
+    if ( inputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc != -1 ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    this->fileDesc = ::open(inputFilename, O_RDONLY);
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTFOUND;
+    if ( fstat(this->fileDesc, &fileStat) != 0 ) {
+        ::close(this->fileDesc);
+        this->fileDesc = -1;
+        throw R3CERR_IO_EXCEPTION;
+    }
+    this->fileSize = fileStat.st_size;
+
+    // Allocate the cache, with at least twice as many hash buckets as pages
+    if ( this->pages == NULL ) {
+        this->pageData =
+            new char [(size_t)this->pageSize * this->pageCapacity];
+        this->pages = new CachePage [this->pageCapacity];
+        for ( int i = 0; i < this->pageCapacity; i++ ) {
+            this->pages[i].data =
+                this->pageData + ((size_t)this->pageSize * i);
+        }
+        this->hashBits = 1;
+        while ( (1 << this->hashBits) < (this->pageCapacity << 1) ) {
+            this->hashBits++;
+        }
+        this->hashBuckets = new int [1 << this->hashBits];
+    }
+    bucketCount = 1 << this->hashBits;
+    for ( int i = 0; i < bucketCount; i++ ) this->hashBuckets[i] = NO_PAGE;
+    this->pagesUsed = 0;
+    this->lruHead = NO_PAGE;
+    this->lruTail = NO_PAGE;
+    this->hitCount = 0;
+    this->missCount = 0;
+}
+
+void R3CRandomAccessFile::open(R3CString *inputFilename) {
+#ifndef R3C_NOERRCHECK
+    if ( inputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->open(inputFilename->getChars());
+}
+
+void R3CRandomAccessFile::setCacheSize(int kbPerPage, int pageCount) {
+#ifndef R3C_NOERRCHECK
+    if ( (kbPerPage < 1) || (pageCount < 1) ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc != -1 ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    if ( this->pageData != NULL ) delete[] this->pageData;
+    if ( this->pages != NULL ) delete[] this->pages;
+    if ( this->hashBuckets != NULL ) delete[] this->hashBuckets;
+    this->pageData = NULL;
+    this->pages = NULL;
+    this->hashBuckets = NULL;
+    this->pageSize = kbPerPage << 10;
+    this->pageCapacity = pageCount;
+}
+
+
+// *** RETRIEVE CACHE STATISTICS *** //
+
+unsigned long R3CRandomAccessFile::getCacheHits() {
+    unsigned long result;
+    pthread_mutex_lock(&this->cacheLock);
+    result = this->hitCount;
+    pthread_mutex_unlock(&this->cacheLock);
+    return( result );
+}
+
+unsigned long R3CRandomAccessFile::getCacheMisses() {
+    unsigned long result;
+    pthread_mutex_lock(&this->cacheLock);
+    result = this->missCount;
+    pthread_mutex_unlock(&this->cacheLock);
+    return( result );
+}
+
+
+// *** MANAGE PAGE CACHE *** //
+
+// Returns the hash bucket for the given page, using multiplicative hashing
+// so that runs of consecutive pages are spread across the table.
+int R3CRandomAccessFile::hashPage(off_t pageIndex) {
+    return( (int)(
+        ((uint64_t)pageIndex * HASH_MULTIPLIER) >> (64 - this->hashBits)) );
+}
+
+// Finds the given page in the cache.
+int R3CRandomAccessFile::findPage(off_t pageIndex) {
+    int slot;
+    slot = this->hashBuckets[this->hashPage(pageIndex)];
+    while ( (slot != NO_PAGE) && (this->pages[slot].pageIndex != pageIndex) ) {
+        slot = this->pages[slot].hashNext;
+    }
+    return( slot );
+}
+
+// Moves the given cache page to the front of the LRU list.
+void R3CRandomAccessFile::touchPage(int slot) {
+    CachePage* page;
+    if ( slot == this->lruHead ) return;
+    page = &this->pages[slot];
+
+    // Unlink the page; it is not the head, so it has a previous page
+    this->pages[page->lruPrev].lruNext = page->lruNext;
+    if ( page->lruNext != NO_PAGE ) {
+        this->pages[page->lruNext].lruPrev = page->lruPrev;
+    } else {
+        this->lruTail = page->lruPrev;
+    }
+
+    // Link it in at the head
+    page->lruPrev = NO_PAGE;
+    page->lruNext = this->lruHead;
+    this->pages[this->lruHead].lruPrev = slot;
+    this->lruHead = slot;
+}
+
+// Adds a page to the cache.
+void R3CRandomAccessFile::insertPage(
+    off_t pageIndex, const char *data, int length
+) {
+    CachePage* page;
+    int slot;
+    int* linkPtr;
+    int bucket;
+
+    if ( this->pagesUsed < this->pageCapacity ) {
+        slot = this->pagesUsed;
+        this->pagesUsed++;
+        page = &this->pages[slot];
+    } else {
+        // Evict the least recently used page from its hash chain
+        slot = this->lruTail;
+        page = &this->pages[slot];
+        linkPtr = &this->hashBuckets[this->hashPage(page->pageIndex)];
+        while ( *linkPtr != slot ) linkPtr = &this->pages[*linkPtr].hashNext;
+        *linkPtr = page->hashNext;
+
+        // ...and from the LRU list
+        this->lruTail = page->lruPrev;
+        if ( this->lruTail != NO_PAGE ) {
+            this->pages[this->lruTail].lruNext = NO_PAGE;
+        } else {
+            this->lruHead = NO_PAGE;
+        }
+    }
+
+    // Fill the page, and link it in at the head of its hash chain and of the
+    // LRU list
+    page->pageIndex = pageIndex;
+    page->length = length;
+    memcpy(page->data, data, length);
+    bucket = this->hashPage(pageIndex);
+    page->hashNext = this->hashBuckets[bucket];
+    this->hashBuckets[bucket] = slot;
+    page->lruPrev = NO_PAGE;
+    page->lruNext = this->lruHead;
+    if ( this->lruHead != NO_PAGE ) {
+        this->pages[this->lruHead].lruPrev = slot;
+    } else {
+        this->lruTail = slot;
+    }
+    this->lruHead = slot;
+}
+
+
+// *** READ BYTES FROM THE FILE *** //
+
+off_t R3CRandomAccessFile::getSize() {
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    return( this->fileSize );
+}
+
+int R3CRandomAccessFile::readAt(off_t position, void *target, int byteCount) {
+    char* targetPtr;
+    char* scratchPage;
+    const char* pagePtr;
+    off_t pageIndex;
+    int pageOffset;
+    int pageLength;
+    int bytesRead;
+    int chunkSize;
+    int slot;
+#ifndef R3C_NOERRCHECK
+    if ( (target == NULL) || (position < 0) || (byteCount < 0) ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    if ( byteCount == 0 ) return( 0 );
+    if ( position >= this->fileSize ) return( EOF );
+
+    targetPtr = (char*)target;
+    scratchPage = NULL;
+    bytesRead = 0;
+    try {
+        while ( (bytesRead < byteCount) && (position < this->fileSize) ) {
+            pageIndex = position / this->pageSize;
+            pageOffset = (int)(position % this->pageSize);
+            pthread_mutex_lock(&this->cacheLock);
+            slot = this->findPage(pageIndex);
+            if ( slot != NO_PAGE ) {
+                this->hitCount++;
+                this->touchPage(slot);
+                pagePtr = this->pages[slot].data;
+                pageLength = this->pages[slot].length;
+            } else {
+                // Read the page without holding the lock, then add it to
+                // the cache unless another thread got there first
+                this->missCount++;
+                pthread_mutex_unlock(&this->cacheLock);
+                if ( scratchPage == NULL ) {
+                    scratchPage = new char [this->pageSize];
+                }
+                pageLength = readFile(
+                    this->fileDesc, scratchPage, this->pageSize,
+                    pageIndex * this->pageSize);
+                pthread_mutex_lock(&this->cacheLock);
+                if ( this->findPage(pageIndex) == NO_PAGE ) {
+                    this->insertPage(pageIndex, scratchPage, pageLength);
+                }
+                pagePtr = scratchPage;
+            }
+
+            // Copy out of the page while it cannot be replaced
+            chunkSize = pageLength - pageOffset;
+            if ( chunkSize > (byteCount - bytesRead) ) {
+                chunkSize = byteCount - bytesRead;
+            }
+            if ( chunkSize > 0 ) {
+                memcpy(targetPtr + bytesRead, pagePtr + pageOffset, chunkSize);
+            }
+            pthread_mutex_unlock(&this->cacheLock);
+
+            // A short page ends the file
+            if ( chunkSize <= 0 ) break;
+            bytesRead += chunkSize;
+            position += chunkSize;
+            if ( pageLength < this->pageSize ) break;
+        }
+    } catch ( const char* ) {
+        if ( scratchPage != NULL ) delete[] scratchPage;
+        throw;
+    }
+    if ( scratchPage != NULL ) delete[] scratchPage;
+    return( bytesRead > 0 ? bytesRead : EOF );
+}
+
+
+// *** CLOSE FILE *** //
+
+void R3CRandomAccessFile::close() {
+    int closeResult;
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    closeResult = ::close(this->fileDesc);
+    this->fileDesc = -1;
+    this->fileSize = 0;
+    this->pagesUsed = 0;
+    this->lruHead = NO_PAGE;
+    this->lruTail = NO_PAGE;
+    if ( closeResult != 0 ) throw R3CERR_IO_EXCEPTION;
+}
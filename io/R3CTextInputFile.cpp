@@ -4,29 +4,112 @@
 #include "../includes/r3c-io.hpp"
 
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 
 // *** CONSTANTS *** //
 
 const char* READ_MODE = "r";
 
+#define DEFAULT_BUFFER_KB 64
+#define DEFAULT_URING_BUFFERS 4
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Returns the current time from a monotonic clock, in microseconds.
+static unsigned long currentMicros() {
+    struct timespec curTime;
+    clock_gettime(CLOCK_MONOTONIC, &curTime);
+    return(
+        (unsigned long)curTime.tv_sec * 1000000 +
+        (unsigned long)(curTime.tv_nsec / 1000) );
+}
+
+// Deletes the read buffers in a read-ahead ring.
+static void deleteRing(char** ringBuffers, int ringSize) {
+    for ( int i = 0; i < ringSize; i++ ) delete[] ringBuffers[i];
+    delete[] ringBuffers;
+}
+
 
 // *** CONSTRUCTION *** //
 
 R3CTextInputFile::R3CTextInputFile() :
-    fileHandle(NULL)
+    fileHandle(NULL),
+    bufferSize(DEFAULT_BUFFER_KB << 10),
+    buffer(NULL),
+    bufferPtr(NULL),
+    bufferEndPtr(NULL),
+    ringSize(0),
+    ringBuffers(NULL),
+    ringLengths(NULL),
+    ringHead(0),
+    ringFilled(0),
+    ringHeld(false),
+    ringAtEnd(false),
+    ringFailed(false),
+    ringStopping(false),
+    readerStallTime(0),
+    prefetchStallTime(0),
+    readMethod(R3C_IO_READ_STDIO),
+    uringReader(NULL)
 {
+    pthread_mutex_init(&this->ringLock, NULL);
+    pthread_cond_init(&this->ringFilledCond, NULL);
+    pthread_cond_init(&this->ringReleasedCond, NULL);
 }
 
 R3CTextInputFile::R3CTextInputFile(const char *inputFilename) :
-    fileHandle(NULL)
+    fileHandle(NULL),
+    bufferSize(DEFAULT_BUFFER_KB << 10),
+    buffer(NULL),
+    bufferPtr(NULL),
+    bufferEndPtr(NULL),
+    ringSize(0),
+    ringBuffers(NULL),
+    ringLengths(NULL),
+    ringHead(0),
+    ringFilled(0),
+    ringHeld(false),
+    ringAtEnd(false),
+    ringFailed(false),
+    ringStopping(false),
+    readerStallTime(0),
+    prefetchStallTime(0),
+    readMethod(R3C_IO_READ_STDIO),
+    uringReader(NULL)
 {
+    pthread_mutex_init(&this->ringLock, NULL);
+    pthread_cond_init(&this->ringFilledCond, NULL);
+    pthread_cond_init(&this->ringReleasedCond, NULL);
     this->open(inputFilename);
 }
 
 R3CTextInputFile::R3CTextInputFile(R3CString *inputFilename) :
-    fileHandle(NULL)
+    fileHandle(NULL),
+    bufferSize(DEFAULT_BUFFER_KB << 10),
+    buffer(NULL),
+    bufferPtr(NULL),
+    bufferEndPtr(NULL),
+    ringSize(0),
+    ringBuffers(NULL),
+    ringLengths(NULL),
+    ringHead(0),
+    ringFilled(0),
+    ringHeld(false),
+    ringAtEnd(false),
+    ringFailed(false),
+    ringStopping(false),
+    readerStallTime(0),
+    prefetchStallTime(0),
+    readMethod(R3C_IO_READ_STDIO),
+    uringReader(NULL)
 {
+    pthread_mutex_init(&this->ringLock, NULL);
+    pthread_cond_init(&this->ringFilledCond, NULL);
+    pthread_cond_init(&this->ringReleasedCond, NULL);
     this->open(inputFilename);
 }
 
@@ -35,29 +118,317 @@ R3CTextInputFile::R3CTextInputFile(R3CString *inputFilename) :
 
 R3CTextInputFile::~R3CTextInputFile() {
     if ( this->fileHandle != NULL ) {
+        if ( this->readMethod == R3C_IO_READ_URING ) {
+            this->uringReader->stop();
+        } else if ( this->ringSize > 0 ) {
+            this->stopPrefetch();
+        }
         fclose(this->fileHandle);
     }
+    if ( this->uringReader != NULL ) delete this->uringReader;
+    if ( this->buffer != NULL ) delete[] this->buffer;
+    if ( this->ringBuffers != NULL ) {
+        deleteRing(this->ringBuffers, this->ringSize);
+        delete[] this->ringLengths;
+    }
+    pthread_cond_destroy(&this->ringReleasedCond);
+    pthread_cond_destroy(&this->ringFilledCond);
+    pthread_mutex_destroy(&this->ringLock);
 }
 
 
 // *** OPEN STREAM *** //
 
 void R3CTextInputFile::open(const char *inputFilename) {
+    this->open(inputFilename, R3C_IO_READ_STDIO);
+}
+
+void R3CTextInputFile::open(R3CString *inputFilename) {
+#ifndef R3C_NOERRCHECK
+    if ( inputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileHandle != NULL ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    this->open(inputFilename->getChars(), R3C_IO_READ_STDIO);
+}
+
+void R3CTextInputFile::open(const char *inputFilename, int method) {
+    bool started;
 #ifndef R3C_NOERRCHECK
     if ( inputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( (method != R3C_IO_READ_STDIO) && (method != R3C_IO_READ_URING) ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
     if ( this->fileHandle != NULL ) throw R3CERR_IO_STREAMALREADYOPEN;
 #endif
     this->fileHandle = fopen(inputFilename, READ_MODE);
     if ( this->fileHandle == NULL ) throw R3CERR_IO_STREAMNOTFOUND;
+
+    // Reads bypass the stdio buffer, since they go through the read buffer
+    setvbuf(this->fileHandle, NULL, _IONBF, 0);
+    this->readMethod = R3C_IO_READ_STDIO;
+
+    // The io_uring reader keeps its own ring of read buffers, and falls back
+    // to stdio if io_uring is unavailable
+    if ( method == R3C_IO_READ_URING ) {
+        if ( this->uringReader == NULL ) {
+            this->uringReader = new R3CUringFileReader(
+                (this->ringSize > 0) ? this->ringSize : DEFAULT_URING_BUFFERS,
+                this->bufferSize);
+        }
+        try {
+            started = this->uringReader->start(fileno(this->fileHandle));
+        } catch ( const char* ) {
+            fclose(this->fileHandle);
+            this->fileHandle = NULL;
+            throw;
+        }
+        if ( started ) {
+            this->readMethod = R3C_IO_READ_URING;
+            this->bufferPtr = NULL;
+            this->bufferEndPtr = NULL;
+            return;
+        }
+    }
+
+    if ( this->ringSize == 0 ) {
+        if ( this->buffer == NULL ) {
+            this->buffer = new char [this->bufferSize + 1];
+        }
+        this->bufferPtr = this->buffer;
+        this->bufferEndPtr = this->buffer;
+    } else {
+        if ( this->ringBuffers == NULL ) {
+            this->ringBuffers = new char* [this->ringSize];
+            for ( int i = 0; i < this->ringSize; i++ ) {
+                this->ringBuffers[i] = new char [this->bufferSize + 1];
+            }
+            this->ringLengths = new int [this->ringSize];
+        }
+        this->bufferPtr = NULL;
+        this->bufferEndPtr = NULL;
+        this->ringHead = 0;
+        this->ringFilled = 0;
+        this->ringHeld = false;
+        this->ringAtEnd = false;
+        this->ringFailed = false;
+        this->ringStopping = false;
+        this->readerStallTime = 0;
+        this->prefetchStallTime = 0;
+        if (
+            pthread_create(
+                &this->prefetchThread, NULL, R3CTextInputFile::runPrefetch,
+                this) != 0
+        ) {
+            fclose(this->fileHandle);
+            this->fileHandle = NULL;
+            throw R3CERR_IO_EXCEPTION;
+        }
+    }
 }
 
-void R3CTextInputFile::open(R3CString *inputFilename) {
+void R3CTextInputFile::open(R3CString *inputFilename, int method) {
 #ifndef R3C_NOERRCHECK
     if ( inputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->open(inputFilename->getChars(), method);
+}
+
+int R3CTextInputFile::getReadMethod() {
+    return( this->readMethod );
+}
+
+void R3CTextInputFile::setBufferSize(int kbPerBuffer) {
+#ifndef R3C_NOERRCHECK
+    if ( kbPerBuffer < 1 ) throw R3CERR_ILLEGALARGUMENT;
     if ( this->fileHandle != NULL ) throw R3CERR_IO_STREAMALREADYOPEN;
 #endif
-    this->fileHandle = fopen(inputFilename->getChars(), READ_MODE);
-    if ( this->fileHandle == NULL ) throw R3CERR_IO_STREAMNOTFOUND;
+    if ( (kbPerBuffer << 10) != this->bufferSize ) {
+        if ( this->buffer != NULL ) delete[] this->buffer;
+        this->buffer = NULL;
+        if ( this->ringBuffers != NULL ) {
+            deleteRing(this->ringBuffers, this->ringSize);
+            delete[] this->ringLengths;
+            this->ringBuffers = NULL;
+            this->ringLengths = NULL;
+        }
+        if ( this->uringReader != NULL ) delete this->uringReader;
+        this->uringReader = NULL;
+        this->bufferSize = kbPerBuffer << 10;
+    }
+}
+
+void R3CTextInputFile::setReadAhead(int bufferCount) {
+#ifndef R3C_NOERRCHECK
+    if ( (bufferCount < 0) || (bufferCount == 1) ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+    if ( this->fileHandle != NULL ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    if ( bufferCount != this->ringSize ) {
+        if ( this->ringBuffers != NULL ) {
+            deleteRing(this->ringBuffers, this->ringSize);
+            delete[] this->ringLengths;
+            this->ringBuffers = NULL;
+            this->ringLengths = NULL;
+        }
+        if ( this->uringReader != NULL ) delete this->uringReader;
+        this->uringReader = NULL;
+        this->ringSize = bufferCount;
+    }
+}
+
+
+// *** RETRIEVE READ-AHEAD STATISTICS *** //
+
+unsigned long R3CTextInputFile::getReaderStallTime() {
+    unsigned long result;
+    pthread_mutex_lock(&this->ringLock);
+    result = this->readerStallTime;
+    pthread_mutex_unlock(&this->ringLock);
+    return( result );
+}
+
+unsigned long R3CTextInputFile::getPrefetchStallTime() {
+    unsigned long result;
+    pthread_mutex_lock(&this->ringLock);
+    result = this->prefetchStallTime;
+    pthread_mutex_unlock(&this->ringLock);
+    return( result );
+}
+
+
+// *** READ AHEAD *** //
+
+// Entry point of the prefetch thread.
+void* R3CTextInputFile::runPrefetch(void *inputFile) {
+    ((R3CTextInputFile*)inputFile)->prefetch();
+    return( NULL );
+}
+
+// Fills read buffers in the ring.  The file is only read by this thread
+// while read-ahead is enabled.
+void R3CTextInputFile::prefetch() {
+    unsigned long waitStart;
+    int fillIndex;
+    size_t bytesRead;
+    bool failed;
+
+    pthread_mutex_lock(&this->ringLock);
+    while ( !this->ringStopping ) {
+        // Wait for the caller to release a read buffer
+        if ( this->ringFilled == this->ringSize ) {
+            waitStart = currentMicros();
+            while (
+                (this->ringFilled == this->ringSize) &&
+                !this->ringStopping
+            ) {
+                pthread_cond_wait(&this->ringReleasedCond, &this->ringLock);
+            }
+            this->prefetchStallTime += currentMicros() - waitStart;
+            if ( this->ringStopping ) break;
+        }
+
+        // Fill the next read buffer without holding the lock
+        fillIndex = (this->ringHead + this->ringFilled) % this->ringSize;
+        pthread_mutex_unlock(&this->ringLock);
+        bytesRead = fread(
+            this->ringBuffers[fillIndex], 1, this->bufferSize,
+            this->fileHandle);
+        failed = (ferror(this->fileHandle) != 0);
+        pthread_mutex_lock(&this->ringLock);
+
+        if ( failed ) {
+            this->ringFailed = true;
+        } else if ( bytesRead == 0 ) {
+            this->ringAtEnd = true;
+        } else {
+            this->ringLengths[fillIndex] = (int)bytesRead;
+            this->ringFilled++;
+        }
+        pthread_cond_signal(&this->ringFilledCond);
+        if ( this->ringFailed || this->ringAtEnd ) break;
+    }
+    pthread_mutex_unlock(&this->ringLock);
+}
+
+// Releases the read buffer held by the caller, and moves to the next one.
+bool R3CTextInputFile::nextRingBuffer() {
+    unsigned long waitStart;
+    bool result;
+
+    pthread_mutex_lock(&this->ringLock);
+    if ( this->ringHeld ) {
+        this->ringHead = (this->ringHead + 1) % this->ringSize;
+        this->ringFilled--;
+        this->ringHeld = false;
+        pthread_cond_signal(&this->ringReleasedCond);
+    }
+    if (
+        (this->ringFilled == 0) &&
+        !this->ringAtEnd &&
+        !this->ringFailed
+    ) {
+        waitStart = currentMicros();
+        while (
+            (this->ringFilled == 0) &&
+            !this->ringAtEnd &&
+            !this->ringFailed
+        ) {
+            pthread_cond_wait(&this->ringFilledCond, &this->ringLock);
+        }
+        this->readerStallTime += currentMicros() - waitStart;
+    }
+
+    // Buffers filled before an error are still read
+    result = (this->ringFilled > 0);
+    if ( result ) {
+        this->ringHeld = true;
+        this->bufferPtr = this->ringBuffers[this->ringHead];
+        this->bufferEndPtr =
+            this->bufferPtr + this->ringLengths[this->ringHead];
+    }
+    pthread_mutex_unlock(&this->ringLock);
+    if ( !result && this->ringFailed ) throw R3CERR_IO_EXCEPTION;
+    return( result );
+}
+
+// Stops the prefetch thread.
+void R3CTextInputFile::stopPrefetch() {
+    pthread_mutex_lock(&this->ringLock);
+    this->ringStopping = true;
+    pthread_cond_signal(&this->ringReleasedCond);
+    pthread_mutex_unlock(&this->ringLock);
+    pthread_join(this->prefetchThread, NULL);
+}
+
+
+// *** READ BUFFER *** //
+
+// Refills the read buffer from the file.
+bool R3CTextInputFile::fillBuffer() {
+    size_t bytesRead;
+    char* uringBuffer;
+    int uringLength;
+    if ( this->readMethod == R3C_IO_READ_URING ) {
+        if ( !this->uringReader->nextBuffer(&uringBuffer, &uringLength) ) {
+            return( false );
+        }
+        this->bufferPtr = uringBuffer;
+        this->bufferEndPtr = uringBuffer + uringLength;
+        return( true );
+    }
+    if ( this->ringSize > 0 ) return( this->nextRingBuffer() );
+    bytesRead = fread(this->buffer, 1, this->bufferSize, this->fileHandle);
+    if ( ferror(this->fileHandle) != 0 ) throw R3CERR_IO_EXCEPTION;
+    this->bufferPtr = this->buffer;
+    this->bufferEndPtr = this->buffer + bytesRead;
+    return( bytesRead > 0 );
+}
+
+// Appends characters from the read buffer to the target string.
+void R3CTextInputFile::appendBuffer(R3CString *targetStr, char *endPtr) {
+    targetStr->append(this->bufferPtr, (int)(endPtr - this->bufferPtr));
+    this->bufferPtr = endPtr;
 }
 
 
@@ -78,14 +449,18 @@ int R3CTextInputFile::readChar() {
 #ifndef R3C_NOERRCHECK
     if ( this->fileHandle == NULL ) throw R3CERR_IO_STREAMNOTOPEN;
 #endif
-    result = getc(this->fileHandle);
-    if ( ferror(this->fileHandle) != 0 ) throw R3CERR_IO_EXCEPTION;
+    if ( (this->bufferPtr == this->bufferEndPtr) && !this->fillBuffer() ) {
+        return( EOF );
+    }
+    result = (unsigned char)*this->bufferPtr;
+    this->bufferPtr++;
     return( result );
 }
 
 int R3CTextInputFile::readChars(R3CString *targetStr, int numChars) {
     int charsRead;
-    int curChar;
+    char* endPtr;
+    char* nullPtr;
     bool done;
 #ifndef R3C_NOERRCHECK
     if ( (targetStr == NULL) || (numChars < 0) ) throw R3CERR_ILLEGALARGUMENT;
@@ -96,17 +471,26 @@ int R3CTextInputFile::readChars(R3CString *targetStr, int numChars) {
         targetStr->clear();
         done = false;
         while ( !done ) {
-            curChar = getc(this->fileHandle);
-            if ( ferror(this->fileHandle) != 0 ) throw R3CERR_IO_EXCEPTION;
-            if ( curChar == EOF ) {
+            if (
+                (this->bufferPtr == this->bufferEndPtr) &&
+                !this->fillBuffer()
+            ) {
                 if ( charsRead == 0 ) charsRead = EOF;
                 done = true;
             } else {
-                if ( curChar != 0 ) {
-                    targetStr->append((char)curChar);
-                    charsRead++;
-                    if ( charsRead >= numChars ) done = true;
+                // Append the buffered characters still needed, up to the next
+                // null-terminator, which is skipped
+                endPtr = this->bufferEndPtr;
+                if ( (endPtr - this->bufferPtr) > (numChars - charsRead) ) {
+                    endPtr = this->bufferPtr + (numChars - charsRead);
                 }
+                nullPtr = (char*)memchr(
+                    this->bufferPtr, '\0', endPtr - this->bufferPtr);
+                if ( nullPtr != NULL ) endPtr = nullPtr;
+                charsRead += (int)(endPtr - this->bufferPtr);
+                this->appendBuffer(targetStr, endPtr);
+                if ( nullPtr != NULL ) this->bufferPtr++;
+                if ( charsRead >= numChars ) done = true;
             }
         }
     }
@@ -115,7 +499,7 @@ int R3CTextInputFile::readChars(R3CString *targetStr, int numChars) {
 
 int R3CTextInputFile::readLine(R3CString *targetStr) {
     int charsRead;
-    int curChar;
+    char* endPtr;
     bool done;
     bool pastNewlines;
 #ifndef R3C_NOERRCHECK
@@ -126,21 +510,23 @@ int R3CTextInputFile::readLine(R3CString *targetStr) {
     done = false;
     pastNewlines = false;
     while ( !done ) {
-        curChar = getc(this->fileHandle);
-        if ( ferror(this->fileHandle) != 0 ) throw R3CERR_IO_EXCEPTION;
-        if ( curChar == EOF ) {
+        if ( (this->bufferPtr == this->bufferEndPtr) && !this->fillBuffer() ) {
             if ( charsRead == 0 ) charsRead = EOF;
             done = true;
+        } else if ( !pastNewlines ) {
+            // Skip blank lines
+            this->bufferPtr = (char*)r3cStrPassNewlines(
+                this->bufferPtr, this->bufferEndPtr);
+            if ( this->bufferPtr < this->bufferEndPtr ) pastNewlines = true;
         } else {
-            if (
-                (curChar == '\0') || 
-                (strchr(R3C_STR_NEWLINE, curChar) != NULL)
-            ) {
-                if ( pastNewlines ) done = true;
-            } else {
-                pastNewlines = true;
-                targetStr->append((char)curChar);
-                charsRead++;
+            // Append everything up to the next newline, which is consumed
+            endPtr = (char*)r3cStrReachNewline(
+                this->bufferPtr, this->bufferEndPtr);
+            charsRead += (int)(endPtr - this->bufferPtr);
+            this->appendBuffer(targetStr, endPtr);
+            if ( endPtr < this->bufferEndPtr ) {
+                this->bufferPtr++;
+                done = true;
             }
         }
     }
@@ -155,7 +541,14 @@ void R3CTextInputFile::close() {
 #ifndef R3C_NOERRCHECK
     if ( this->fileHandle == NULL ) throw R3CERR_IO_STREAMNOTOPEN;
 #endif
+    if ( this->readMethod == R3C_IO_READ_URING ) {
+        this->uringReader->stop();
+    } else if ( this->ringSize > 0 ) {
+        this->stopPrefetch();
+    }
     closeResult = fclose(this->fileHandle);
     this->fileHandle = NULL;
+    this->bufferPtr = this->buffer;
+    this->bufferEndPtr = this->buffer;
     if ( closeResult == EOF ) throw R3CERR_IO_EXCEPTION;
 }
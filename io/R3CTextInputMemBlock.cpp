@@ -0,0 +1,278 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+
+// *** CONSTRUCTION *** //
+
+R3CTextInputMemBlock::R3CTextInputMemBlock() :
+    isOpen(false),
+    readPtr(NULL),
+    endPtr(NULL),
+    sourceBlock(NULL),
+    sourceBlockIndex(0),
+    sourceBlockPos(0),
+    sourceAloneIndex(0)
+{
+}
+
+R3CTextInputMemBlock::R3CTextInputMemBlock(const char *buffer, int length) :
+    isOpen(false),
+    readPtr(NULL),
+    endPtr(NULL),
+    sourceBlock(NULL),
+    sourceBlockIndex(0),
+    sourceBlockPos(0),
+    sourceAloneIndex(0)
+{
+    this->open(buffer, length);
+}
+
+R3CTextInputMemBlock::R3CTextInputMemBlock(R3CStringBlock *block) :
+    isOpen(false),
+    readPtr(NULL),
+    endPtr(NULL),
+    sourceBlock(NULL),
+    sourceBlockIndex(0),
+    sourceBlockPos(0),
+    sourceAloneIndex(0)
+{
+    this->open(block);
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CTextInputMemBlock::~R3CTextInputMemBlock() {
+}
+
+
+// *** OPEN STREAM *** //
+
+void R3CTextInputMemBlock::open(const char *buffer, int length) {
+#ifndef R3C_NOERRCHECK
+    if ( (buffer == NULL) || (length < 0) ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->isOpen ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    this->readPtr = buffer;
+    this->endPtr = buffer + length;
+    this->sourceBlock = NULL;
+    this->sourceBlockIndex = 0;
+    this->sourceBlockPos = 0;
+    this->sourceAloneIndex = 0;
+    this->isOpen = true;
+}
+
+void R3CTextInputMemBlock::open(const char *str) {
+#ifndef R3C_NOERRCHECK
+    if ( str == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->open(str, (int)strlen(str));
+}
+
+void R3CTextInputMemBlock::open(R3CString *str) {
+#ifndef R3C_NOERRCHECK
+    if ( str == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->open(str->getChars(), str->getLength());
+}
+
+void R3CTextInputMemBlock::open(R3CStringBlock *block) {
+#ifndef R3C_NOERRCHECK
+    if ( block == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->isOpen ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    this->sourceBlock = block;
+    this->sourceBlockIndex = 0;
+    this->sourceBlockPos = 0;
+    this->sourceAloneIndex = 0;
+    this->readPtr = NULL;
+    this->endPtr = NULL;
+    this->nextSegment();
+    this->isOpen = true;
+}
+
+
+// *** READ MEMORY SEGMENTS *** //
+
+// Moves to the next memory segment, if there is one.
+bool R3CTextInputMemBlock::nextSegment() {
+    R3CStringBlock* block;
+    const char* blockChars;
+    int segmentEndPos;
+    bool isAloneInBlock;
+    block = this->sourceBlock;
+    if ( block == NULL ) return( false );
+    while ( true ) {
+        // A string allocated on its own is read when the storage block is
+        // read up to the position at which it was added
+        isAloneInBlock =
+            (this->sourceAloneIndex < block->getAloneCount()) &&
+            (block->getAloneBlockIndex(this->sourceAloneIndex) ==
+                this->sourceBlockIndex);
+        if (
+            isAloneInBlock &&
+            (block->getAloneBlockPos(this->sourceAloneIndex) <=
+                this->sourceBlockPos)
+        ) {
+            this->readPtr = block->getAloneChars(this->sourceAloneIndex);
+            this->endPtr =
+                this->readPtr + block->getAloneLength(this->sourceAloneIndex);
+            this->sourceAloneIndex++;
+            return( true );
+        }
+
+        // Otherwise, read the storage block up to the next such string
+        if ( isAloneInBlock ) {
+            segmentEndPos = block->getAloneBlockPos(this->sourceAloneIndex);
+        } else {
+            segmentEndPos = block->getBlockLength(this->sourceBlockIndex);
+        }
+        if ( this->sourceBlockPos < segmentEndPos ) {
+            blockChars = block->getBlockChars(this->sourceBlockIndex);
+            this->readPtr = blockChars + this->sourceBlockPos;
+            this->endPtr = blockChars + segmentEndPos;
+            this->sourceBlockPos = segmentEndPos;
+            return( true );
+        }
+
+        // Move to the next storage block
+        if ( this->sourceBlockIndex + 1 >= block->getBlockCount() ) {
+            return( false );
+        }
+        this->sourceBlockIndex++;
+        this->sourceBlockPos = 0;
+    }
+}
+
+
+// *** CHECK FOR STREAM READINESS *** //
+
+bool R3CTextInputMemBlock::ready() {
+#ifndef R3C_NOERRCHECK
+    if ( !this->isOpen ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    return( true );
+}
+
+
+// *** READ CHARACTERS FROM THE MEMORY BLOCK *** //
+
+int R3CTextInputMemBlock::readChar() {
+    int result;
+#ifndef R3C_NOERRCHECK
+    if ( !this->isOpen ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    while ( this->readPtr == this->endPtr ) {
+        if ( !this->nextSegment() ) return( EOF );
+    }
+    result = (unsigned char)*this->readPtr;
+    this->readPtr++;
+    return( result );
+}
+
+int R3CTextInputMemBlock::readChars(R3CString *targetStr, int numChars) {
+    int charsRead;
+    const char* segmentEndPtr;
+    const char* nullPtr;
+    bool done;
+#ifndef R3C_NOERRCHECK
+    if ( (targetStr == NULL) || (numChars < 0) ) throw R3CERR_ILLEGALARGUMENT;
+    if ( !this->isOpen ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    charsRead = 0;
+    if ( numChars > 0 ) {
+        targetStr->clear();
+        done = false;
+        while ( !done ) {
+            if ( (this->readPtr == this->endPtr) && !this->nextSegment() ) {
+                if ( charsRead == 0 ) charsRead = EOF;
+                done = true;
+            } else {
+                // Append the characters still needed, up to the next
+                // null-terminator, which is skipped
+                segmentEndPtr = this->endPtr;
+                if (
+                    (segmentEndPtr - this->readPtr) > (numChars - charsRead)
+                ) {
+                    segmentEndPtr = this->readPtr + (numChars - charsRead);
+                }
+                nullPtr = (const char*)memchr(
+                    this->readPtr, '\0', segmentEndPtr - this->readPtr);
+                if ( nullPtr != NULL ) segmentEndPtr = nullPtr;
+                targetStr->append(
+                    this->readPtr, (int)(segmentEndPtr - this->readPtr));
+                charsRead += (int)(segmentEndPtr - this->readPtr);
+                this->readPtr = segmentEndPtr;
+                if ( nullPtr != NULL ) this->readPtr++;
+                if ( charsRead >= numChars ) done = true;
+            }
+        }
+    }
+    return( charsRead );
+}
+
+int R3CTextInputMemBlock::readLine(R3CString *targetStr) {
+    const char* linePtr;
+    int lineLength;
+#ifndef R3C_NOERRCHECK
+    if ( targetStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    lineLength = this->readLine(&linePtr);
+    if ( lineLength != EOF ) targetStr->append(linePtr, lineLength);
+    return( lineLength );
+}
+
+int R3CTextInputMemBlock::readLine(const char **linePtr) {
+    const char* lineEndPtr;
+#ifndef R3C_NOERRCHECK
+    if ( linePtr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( !this->isOpen ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+
+    // Skip blank lines, including any unused space at the end of each
+    // storage block
+    this->readPtr = r3cStrPassNewlines(this->readPtr, this->endPtr);
+    while ( this->readPtr == this->endPtr ) {
+        if ( !this->nextSegment() ) return( EOF );
+        this->readPtr = r3cStrPassNewlines(this->readPtr, this->endPtr);
+    }
+
+    // Find the end of the line, and consume the newline that ends it
+    lineEndPtr = r3cStrReachNewline(this->readPtr, this->endPtr);
+    *linePtr = this->readPtr;
+    this->readPtr = lineEndPtr;
+    if ( this->readPtr < this->endPtr ) this->readPtr++;
+    return( (int)(lineEndPtr - *linePtr) );
+}
+
+int R3CTextInputMemBlock::readLine(R3CStringView *lineView) {
+    const char* linePtr;
+    int lineLength;
+#ifndef R3C_NOERRCHECK
+    if ( lineView == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    lineLength = this->readLine(&linePtr);
+    if ( lineLength != EOF ) *lineView = R3CStringView(linePtr, lineLength);
+    return( lineLength );
+}
+
+
+// *** CLOSE STREAM *** //
+
+void R3CTextInputMemBlock::close() {
+#ifndef R3C_NOERRCHECK
+    if ( !this->isOpen ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    this->isOpen = false;
+    this->readPtr = NULL;
+    this->endPtr = NULL;
+    this->sourceBlock = NULL;
+    this->sourceBlockIndex = 0;
+    this->sourceBlockPos = 0;
+    this->sourceAloneIndex = 0;
+}
@@ -0,0 +1,276 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+// *** CONSTRUCTION *** //
+
+R3CTextInputMemMap::R3CTextInputMemMap() :
+    fileDesc(-1),
+    mapPtr(NULL),
+    mapSize(0),
+    readPos(0)
+{
+}
+
+R3CTextInputMemMap::R3CTextInputMemMap(const char *inputFilename) :
+    fileDesc(-1),
+    mapPtr(NULL),
+    mapSize(0),
+    readPos(0)
+{
+    this->open(inputFilename);
+}
+
+R3CTextInputMemMap::R3CTextInputMemMap(R3CString *inputFilename) :
+    fileDesc(-1),
+    mapPtr(NULL),
+    mapSize(0),
+    readPos(0)
+{
+    this->open(inputFilename);
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CTextInputMemMap::~R3CTextInputMemMap() {
+    if ( this->mapPtr != NULL ) munmap(this->mapPtr, (size_t)this->mapSize);
+    if ( this->fileDesc != -1 ) ::close(this->fileDesc);
+}
+
+
+// *** OPEN STREAM *** //
+
+void R3CTextInputMemMap::open(const char *inputFilename) {
+    struct stat fileStat;
+    void* mapAddr;
+#ifndef R3C_NOERRCHECK
+    if ( inputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc != -1 ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    this->fileDesc = ::open(inputFilename, O_RDONLY);
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTFOUND;
+    if ( fstat(this->fileDesc, &fileStat) != 0 ) {
+        ::close(this->fileDesc);
+        this->fileDesc = -1;
+        throw R3CERR_IO_EXCEPTION;
+    }
+    this->mapSize = fileStat.st_size;
+    this->mapPtr = NULL;
+    this->readPos = 0;
+
+    // An empty file cannot be mapped, and is simply treated as being at the
+    // end of the stream
+    if ( this->mapSize > 0 ) {
+        mapAddr = mmap(
+            NULL, (size_t)this->mapSize, PROT_READ, MAP_PRIVATE,
+            this->fileDesc, 0);
+        if ( mapAddr == MAP_FAILED ) {
+            ::close(this->fileDesc);
+            this->fileDesc = -1;
+            this->mapSize = 0;
+            throw R3CERR_IO_EXCEPTION;
+        }
+        this->mapPtr = (char*)mapAddr;
+        madvise(this->mapPtr, (size_t)this->mapSize, MADV_SEQUENTIAL);
+    }
+}
+
+void R3CTextInputMemMap::open(R3CString *inputFilename) {
+#ifndef R3C_NOERRCHECK
+    if ( inputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->open(inputFilename->getChars());
+}
+
+
+// *** RETRIEVE STREAM INFORMATION *** //
+
+off_t R3CTextInputMemMap::getSize() {
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    return( this->mapSize );
+}
+
+off_t R3CTextInputMemMap::getPosition() {
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    return( this->readPos );
+}
+
+const char* R3CTextInputMemMap::getChars() {
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    return( this->mapPtr );
+}
+
+
+// *** CHECK FOR STREAM READINESS *** //
+
+bool R3CTextInputMemMap::ready() {
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    return( true );
+}
+
+
+// *** READ CHARACTERS FROM THE FILE *** //
+
+int R3CTextInputMemMap::readChar() {
+    int result;
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    if ( this->readPos >= this->mapSize ) return( EOF );
+    result = (unsigned char)this->mapPtr[this->readPos];
+    this->readPos++;
+    return( result );
+}
+
+int R3CTextInputMemMap::readChars(R3CString *targetStr, int numChars) {
+    int charsRead;
+    const char* startPtr;
+    const char* endPtr;
+    const char* nullPtr;
+#ifndef R3C_NOERRCHECK
+    if ( (targetStr == NULL) || (numChars < 0) ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    charsRead = 0;
+    if ( numChars > 0 ) {
+        targetStr->clear();
+        while ( (charsRead < numChars) && (this->readPos < this->mapSize) ) {
+            // Append the characters still needed, up to the next
+            // null-terminator, which is skipped
+            startPtr = this->mapPtr + this->readPos;
+            endPtr = this->mapPtr + this->mapSize;
+            if ( (endPtr - startPtr) > (numChars - charsRead) ) {
+                endPtr = startPtr + (numChars - charsRead);
+            }
+            nullPtr = (const char*)memchr(startPtr, '\0', endPtr - startPtr);
+            if ( nullPtr != NULL ) endPtr = nullPtr;
+            targetStr->append(startPtr, (int)(endPtr - startPtr));
+            charsRead += (int)(endPtr - startPtr);
+            this->readPos = endPtr - this->mapPtr;
+            if ( nullPtr != NULL ) this->readPos++;
+        }
+        if ( charsRead == 0 ) charsRead = EOF;
+    }
+    return( charsRead );
+}
+
+int R3CTextInputMemMap::readLine(R3CString *targetStr) {
+    const char* linePtr;
+    off_t lineLength;
+    off_t startPos;
+#ifndef R3C_NOERRCHECK
+    if ( targetStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    startPos = this->readPos;
+    lineLength = this->readLine(&linePtr);
+    if ( lineLength == EOF ) return( EOF );
+
+    // A line too long for an int is left unread, for readLine(const char**)
+    if ( lineLength > INT_MAX ) {
+        this->readPos = startPos;
+        throw R3CERR_OUTOFRANGE;
+    }
+    targetStr->append(linePtr, (int)lineLength);
+    return( (int)lineLength );
+}
+
+off_t R3CTextInputMemMap::readChars(const char **charsPtr, off_t numChars) {
+    off_t result;
+#ifndef R3C_NOERRCHECK
+    if ( (charsPtr == NULL) || (numChars < 0) ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    if ( numChars == 0 ) return( 0 );
+    if ( this->readPos >= this->mapSize ) return( EOF );
+    result = this->mapSize - this->readPos;
+    if ( result > numChars ) result = numChars;
+    *charsPtr = this->mapPtr + this->readPos;
+    this->readPos += result;
+    return( result );
+}
+
+off_t R3CTextInputMemMap::readLine(const char **linePtr) {
+    const char* startPtr;
+    const char* endPtr;
+    const char* mapEndPtr;
+#ifndef R3C_NOERRCHECK
+    if ( linePtr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    if ( this->readPos >= this->mapSize ) return( EOF );
+
+    // Skip blank lines
+    mapEndPtr = this->mapPtr + this->mapSize;
+    startPtr = r3cStrPassNewlines(this->mapPtr + this->readPos, mapEndPtr);
+    if ( startPtr == mapEndPtr ) {
+        this->readPos = this->mapSize;
+        return( EOF );
+    }
+
+    // Find the end of the line, and consume the newline that ends it
+    endPtr = r3cStrReachNewline(startPtr, mapEndPtr);
+    this->readPos = endPtr - this->mapPtr;
+    if ( endPtr < mapEndPtr ) this->readPos++;
+    *linePtr = startPtr;
+    return( endPtr - startPtr );
+}
+
+int R3CTextInputMemMap::readLine(R3CStringView *lineView) {
+    const char* linePtr;
+    off_t lineLength;
+    off_t startPos;
+#ifndef R3C_NOERRCHECK
+    if ( lineView == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    startPos = this->readPos;
+    lineLength = this->readLine(&linePtr);
+    if ( lineLength == EOF ) return( EOF );
+
+    // A line too long for an int is left unread, for readLine(const char**)
+    if ( lineLength > INT_MAX ) {
+        this->readPos = startPos;
+        throw R3CERR_OUTOFRANGE;
+    }
+    *lineView = R3CStringView(linePtr, (int)lineLength);
+    return( (int)lineLength );
+}
+
+
+// *** CLOSE FILE *** //
+
+void R3CTextInputMemMap::close() {
+    int unmapResult;
+    int closeResult;
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    unmapResult = 0;
+    if ( this->mapPtr != NULL ) {
+        unmapResult = munmap(this->mapPtr, (size_t)this->mapSize);
+    }
+    closeResult = ::close(this->fileDesc);
+    this->fileDesc = -1;
+    this->mapPtr = NULL;
+    this->mapSize = 0;
+    this->readPos = 0;
+    if ( (unmapResult != 0) || (closeResult != 0) ) throw R3CERR_IO_EXCEPTION;
+}
@@ -0,0 +1,218 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <limits.h>
+
+
+// *** CONSTRUCTION *** //
+
+R3CTextLineSplitter::R3CTextLineSplitter(int workerCount) :
+    workerCount(workerCount),
+    rangeBounds(NULL),
+    sourceChars(NULL),
+    lineHandler(NULL),
+    workerError(NULL),
+    stopping(0)
+{
+#ifndef R3C_NOERRCHECK
+    if ( workerCount < 1 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->rangeBounds = new off_t [workerCount + 1];
+    for ( int i = 0; i <= workerCount; i++ ) this->rangeBounds[i] = 0;
+    pthread_mutex_init(&this->errorLock, NULL);
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CTextLineSplitter::~R3CTextLineSplitter() {
+    delete[] this->rangeBounds;
+    pthread_mutex_destroy(&this->errorLock);
+}
+
+
+// *** SPLIT RANGES *** //
+
+void R3CTextLineSplitter::split(const char *chars, off_t length) {
+    const char* endPtr;
+    const char* boundPtr;
+    off_t bound;
+#ifndef R3C_NOERRCHECK
+    if ( ((chars == NULL) && (length > 0)) || (length < 0) ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+#endif
+    endPtr = chars + length;
+    this->rangeBounds[0] = 0;
+    for ( int i = 1; i < this->workerCount; i++ ) {
+        // Move each even share forward to just past the next newline,
+        // without overlapping the previous range
+        bound = (off_t)(((double)length * i) / this->workerCount);
+        if ( bound < this->rangeBounds[i - 1] ) {
+            bound = this->rangeBounds[i - 1];
+        }
+        if ( bound < length ) {
+            boundPtr = r3cStrReachNewline(chars + bound, endPtr);
+            if ( boundPtr < endPtr ) boundPtr++;
+            bound = boundPtr - chars;
+        }
+        this->rangeBounds[i] = bound;
+    }
+    this->rangeBounds[this->workerCount] = length;
+}
+
+int R3CTextLineSplitter::getRangeCount() {
+    return( this->workerCount );
+}
+
+off_t R3CTextLineSplitter::getRangeStart(int rangeIndex) {
+#ifndef R3C_NOERRCHECK
+    if ( (rangeIndex < 0) || (rangeIndex >= this->workerCount) ) {
+        throw R3CERR_OUTOFRANGE;
+    }
+#endif
+    return( this->rangeBounds[rangeIndex] );
+}
+
+off_t R3CTextLineSplitter::getRangeEnd(int rangeIndex) {
+#ifndef R3C_NOERRCHECK
+    if ( (rangeIndex < 0) || (rangeIndex >= this->workerCount) ) {
+        throw R3CERR_OUTOFRANGE;
+    }
+#endif
+    return( this->rangeBounds[rangeIndex + 1] );
+}
+
+
+// *** PROCESS LINES *** //
+
+void R3CTextLineSplitter::process(
+    const char *chars, off_t length, R3CTextLineHandler *handler
+) {
+    pthread_t* threads;
+    WorkerTask* tasks;
+    int threadsStarted;
+#ifndef R3C_NOERRCHECK
+    if ( handler == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->split(chars, length);
+    this->sourceChars = chars;
+    this->lineHandler = handler;
+    this->workerError = NULL;
+#if __cplusplus >= 201103L
+    this->workerException = std::exception_ptr();
+#endif
+    this->stopping = 0;
+
+    // Start a thread for every range but the first, which is processed by
+    // the calling thread
+    threads = new pthread_t [this->workerCount];
+    tasks = new WorkerTask [this->workerCount];
+    threadsStarted = 0;
+    for ( int i = 1; i < this->workerCount; i++ ) {
+        tasks[i].splitter = this;
+        tasks[i].workerIndex = i;
+        if (
+            pthread_create(
+                &threads[i], NULL, R3CTextLineSplitter::runWorker,
+                &tasks[i]) != 0
+        ) {
+            this->stopWorkers(R3CERR_IO_EXCEPTION);
+            break;
+        }
+        threadsStarted++;
+    }
+    if ( threadsStarted == this->workerCount - 1 ) this->processRange(0);
+    for ( int i = 1; i <= threadsStarted; i++ ) {
+        pthread_join(threads[i], NULL);
+    }
+    delete[] threads;
+    delete[] tasks;
+    this->sourceChars = NULL;
+    this->lineHandler = NULL;
+#if __cplusplus >= 201103L
+    if ( this->workerException ) {
+        std::exception_ptr error;
+        error = this->workerException;
+        this->workerException = std::exception_ptr();
+        std::rethrow_exception(error);
+    }
+#endif
+    if ( this->workerError != NULL ) throw this->workerError;
+}
+
+void R3CTextLineSplitter::process(
+    R3CTextInputMemMap *inputFile, R3CTextLineHandler *handler
+) {
+#ifndef R3C_NOERRCHECK
+    if ( inputFile == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->process(inputFile->getChars(), inputFile->getSize(), handler);
+}
+
+
+// *** RUN WORKERS *** //
+
+// Entry point of a worker thread.
+void* R3CTextLineSplitter::runWorker(void *workerTask) {
+    WorkerTask* task;
+    task = (WorkerTask*)workerTask;
+    task->splitter->processRange(task->workerIndex);
+    return( NULL );
+}
+
+// Hands every non-blank line of the given range to the handler, following
+// the same rules as R3CTextInputMemMap::readLine.
+void R3CTextLineSplitter::processRange(int workerIndex) {
+    const char* linePtr;
+    const char* lineEndPtr;
+    const char* rangeEndPtr;
+    linePtr = this->sourceChars + this->rangeBounds[workerIndex];
+    rangeEndPtr = this->sourceChars + this->rangeBounds[workerIndex + 1];
+    try {
+        while ( !__atomic_load_n(&this->stopping, __ATOMIC_RELAXED) ) {
+            linePtr = r3cStrPassNewlines(linePtr, rangeEndPtr);
+            if ( linePtr == rangeEndPtr ) break;
+            lineEndPtr = r3cStrReachNewline(linePtr, rangeEndPtr);
+            if ( (lineEndPtr - linePtr) > INT_MAX ) throw R3CERR_OUTOFRANGE;
+            this->lineHandler->handleLine(
+                linePtr, (int)(lineEndPtr - linePtr), workerIndex);
+            linePtr = lineEndPtr;
+        }
+    } catch ( const char* error ) {
+        this->stopWorkers(error);
+    } catch ( ... ) {
+#if __cplusplus >= 201103L
+        pthread_mutex_lock(&this->errorLock);
+        if ( (this->workerError == NULL) && !this->workerException ) {
+            this->workerException = std::current_exception();
+        }
+        pthread_mutex_unlock(&this->errorLock);
+        this->stopWorkers(NULL);
+#else
+        this->stopWorkers(R3CERR_IO_EXCEPTION);
+#endif
+    }
+}
+
+// Records the first exception thrown by a worker, and asks every worker to
+// stop.
+void R3CTextLineSplitter::stopWorkers(const char* error) {
+    pthread_mutex_lock(&this->errorLock);
+#if __cplusplus >= 201103L
+    if (
+        (error != NULL) && (this->workerError == NULL) &&
+        !this->workerException
+    ) {
+        this->workerError = error;
+    }
+#else
+    if ( (error != NULL) && (this->workerError == NULL) ) {
+        this->workerError = error;
+    }
+#endif
+    pthread_mutex_unlock(&this->errorLock);
+    __atomic_store_n(&this->stopping, 1, __ATOMIC_RELAXED);
+}
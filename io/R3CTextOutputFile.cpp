@@ -0,0 +1,347 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// *** CONSTANTS *** //
+
+#define DEFAULT_BUFFER_KB 64
+#define DEFAULT_FLUSH_DELAY 1000
+#define MAX_EXPLICIT_BUFFER (256 << 20)
+#define CREATE_MODE 0666
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Returns the current time from a monotonic clock, in milliseconds.
+static unsigned long currentMillis() {
+    struct timespec curTime;
+    clock_gettime(CLOCK_MONOTONIC, &curTime);
+    return(
+        (unsigned long)curTime.tv_sec * 1000 +
+        (unsigned long)(curTime.tv_nsec / 1000000) );
+}
+
+
+// *** CONSTRUCTION *** //
+
+R3CTextOutputFile::R3CTextOutputFile() :
+    fileDesc(-1),
+    bufferSize(DEFAULT_BUFFER_KB << 10),
+    buffer(NULL),
+    bufferUsed(0),
+    flushPolicy(R3C_IO_FLUSH_ONFULL),
+    flushDelay(DEFAULT_FLUSH_DELAY),
+    bufferedTime(0),
+    formatStr()
+{
+}
+
+R3CTextOutputFile::R3CTextOutputFile(const char *outputFilename) :
+    fileDesc(-1),
+    bufferSize(DEFAULT_BUFFER_KB << 10),
+    buffer(NULL),
+    bufferUsed(0),
+    flushPolicy(R3C_IO_FLUSH_ONFULL),
+    flushDelay(DEFAULT_FLUSH_DELAY),
+    bufferedTime(0),
+    formatStr()
+{
+    this->open(outputFilename);
+}
+
+R3CTextOutputFile::R3CTextOutputFile(R3CString *outputFilename) :
+    fileDesc(-1),
+    bufferSize(DEFAULT_BUFFER_KB << 10),
+    buffer(NULL),
+    bufferUsed(0),
+    flushPolicy(R3C_IO_FLUSH_ONFULL),
+    flushDelay(DEFAULT_FLUSH_DELAY),
+    bufferedTime(0),
+    formatStr()
+{
+    this->open(outputFilename);
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CTextOutputFile::~R3CTextOutputFile() {
+    if ( this->fileDesc != -1 ) {
+        try {
+            this->flush();
+        } catch ( const char* ) {
+            // Errors cannot be reported from the destructor
+        }
+        ::close(this->fileDesc);
+    }
+    if ( this->buffer != NULL ) delete[] this->buffer;
+}
+
+
+// *** OPEN STREAM *** //
+
+void R3CTextOutputFile::open(const char *outputFilename) {
+#ifndef R3C_NOERRCHECK
+    if ( outputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc != -1 ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    this->fileDesc = ::open(
+        outputFilename, O_WRONLY | O_CREAT | O_TRUNC, CREATE_MODE);
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTFOUND;
+    if ( this->buffer == NULL ) this->buffer = new char [this->bufferSize];
+    this->bufferUsed = 0;
+}
+
+void R3CTextOutputFile::open(R3CString *outputFilename) {
+#ifndef R3C_NOERRCHECK
+    if ( outputFilename == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->open(outputFilename->getChars());
+}
+
+void R3CTextOutputFile::setBufferSize(int kbPerBuffer) {
+#ifndef R3C_NOERRCHECK
+    if ( kbPerBuffer < 1 ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc != -1 ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    if ( this->buffer != NULL ) delete[] this->buffer;
+    this->buffer = NULL;
+    this->bufferSize = kbPerBuffer << 10;
+}
+
+
+// *** MANAGE FLUSH POLICY *** //
+
+int R3CTextOutputFile::getFlushPolicy() {
+    return( this->flushPolicy );
+}
+
+void R3CTextOutputFile::setFlushPolicy(int policy) {
+#ifndef R3C_NOERRCHECK
+    if (
+        (policy < R3C_IO_FLUSH_ONFULL) || (policy > R3C_IO_FLUSH_AFTERDELAY)
+    ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+#endif
+    this->flushPolicy = policy;
+    if ( this->bufferUsed > 0 ) this->bufferedTime = currentMillis();
+}
+
+void R3CTextOutputFile::setFlushDelay(int milliseconds) {
+#ifndef R3C_NOERRCHECK
+    if ( milliseconds < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->flushDelay = milliseconds;
+}
+
+
+// *** WRITE BUFFER *** //
+
+// Writes the given characters directly to the file.
+void R3CTextOutputFile::writeFile(const char *chars, int charCount) {
+    ssize_t bytesWritten;
+    while ( charCount > 0 ) {
+        bytesWritten = ::write(this->fileDesc, chars, charCount);
+        if ( bytesWritten < 0 ) {
+            if ( errno != EINTR ) throw R3CERR_IO_EXCEPTION;
+        } else {
+            chars += bytesWritten;
+            charCount -= (int)bytesWritten;
+        }
+    }
+}
+
+// Adds the given characters to the write buffer.
+void R3CTextOutputFile::writeBuffer(const char *chars, int charCount) {
+    char* newBuffer;
+    int newSize;
+
+    // Make room in the buffer, if needed
+    if ( charCount > (this->bufferSize - this->bufferUsed) ) {
+        if (
+            (this->flushPolicy == R3C_IO_FLUSH_EXPLICIT) &&
+            (charCount <= (MAX_EXPLICIT_BUFFER - this->bufferUsed))
+        ) {
+            // Expand the buffer to hold everything until flushed, up to the
+            // limit
+            newSize = this->bufferSize;
+            while ( charCount > (newSize - this->bufferUsed) ) newSize <<= 1;
+            if ( newSize > MAX_EXPLICIT_BUFFER ) newSize = MAX_EXPLICIT_BUFFER;
+            newBuffer = new char [newSize];
+            memcpy(newBuffer, this->buffer, this->bufferUsed);
+            delete[] this->buffer;
+            this->buffer = newBuffer;
+            this->bufferSize = newSize;
+        } else {
+            // Write out the buffer; anything too large to buffer is written
+            // directly
+            this->flush();
+            if ( charCount >= this->bufferSize ) {
+                this->writeFile(chars, charCount);
+                return;
+            }
+        }
+    }
+
+    // Buffer the characters
+    if (
+        (this->bufferUsed == 0) &&
+        (this->flushPolicy == R3C_IO_FLUSH_AFTERDELAY)
+    ) {
+        this->bufferedTime = currentMillis();
+    }
+    memcpy(this->buffer + this->bufferUsed, chars, charCount);
+    this->bufferUsed += charCount;
+}
+
+// Writes buffered characters to the file if the flush policy calls for it.
+void R3CTextOutputFile::applyFlushPolicy(bool hasNewline) {
+    if ( this->bufferUsed == 0 ) return;
+    switch ( this->flushPolicy ) {
+        case R3C_IO_FLUSH_ONNEWLINE:
+            if ( hasNewline ) this->flush();
+            break;
+        case R3C_IO_FLUSH_AFTERDELAY:
+            if (
+                (currentMillis() - this->bufferedTime) >=
+                (unsigned long)this->flushDelay
+            ) {
+                this->flush();
+            }
+            break;
+    }
+}
+
+
+// *** WRITE CHARACTERS TO THE FILE *** //
+
+int R3CTextOutputFile::writeChar(char charToWrite) {
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    if ( this->bufferUsed < this->bufferSize ) {
+        if (
+            (this->bufferUsed == 0) &&
+            (this->flushPolicy == R3C_IO_FLUSH_AFTERDELAY)
+        ) {
+            this->bufferedTime = currentMillis();
+        }
+        this->buffer[this->bufferUsed] = charToWrite;
+        this->bufferUsed++;
+    } else {
+        this->writeBuffer(&charToWrite, 1);
+    }
+    this->applyFlushPolicy(charToWrite == '\n');
+    return( 1 );
+}
+
+int R3CTextOutputFile::writeChars(const char *sourceStr) {
+    int charCount;
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    if ( sourceStr == NULL ) return( 0 );
+    charCount = (int)strlen(sourceStr);
+    this->writeBuffer(sourceStr, charCount);
+    this->applyFlushPolicy(
+        (this->flushPolicy == R3C_IO_FLUSH_ONNEWLINE) &&
+        (memchr(sourceStr, '\n', charCount) != NULL));
+    return( charCount );
+}
+
+int R3CTextOutputFile::writeChars(R3CString *sourceStr) {
+#ifndef R3C_NOERRCHECK
+    if ( sourceStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    this->writeBuffer(sourceStr->getChars(), sourceStr->getLength());
+    this->applyFlushPolicy(
+        (this->flushPolicy == R3C_IO_FLUSH_ONNEWLINE) &&
+        (sourceStr->find('\n') != -1));
+    return( sourceStr->getLength() );
+}
+
+int R3CTextOutputFile::writeLine(const char *sourceStr) {
+    int charCount;
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    charCount = 0;
+    if ( sourceStr != NULL ) {
+        charCount = (int)strlen(sourceStr);
+        this->writeBuffer(sourceStr, charCount);
+    }
+    this->writeBuffer("\n", 1);
+    this->applyFlushPolicy(true);
+    return( charCount + 1 );
+}
+
+int R3CTextOutputFile::writeLine(R3CString *sourceStr) {
+#ifndef R3C_NOERRCHECK
+    if ( sourceStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    this->writeBuffer(sourceStr->getChars(), sourceStr->getLength());
+    this->writeBuffer("\n", 1);
+    this->applyFlushPolicy(true);
+    return( sourceStr->getLength() + 1 );
+}
+
+int R3CTextOutputFile::writef(const char *formatString, ...) {
+    va_list varArgs;
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    this->formatStr.clear();
+    va_start(varArgs, formatString);
+    this->formatStr.vappendf(formatString, varArgs);
+    va_end(varArgs);
+    return( this->writeChars(&this->formatStr) );
+}
+
+void R3CTextOutputFile::flush() {
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    if ( this->bufferUsed > 0 ) {
+        // The buffer is emptied even on failure, so a failed write is not
+        // repeated by the destructor
+        try {
+            this->writeFile(this->buffer, this->bufferUsed);
+        } catch ( const char* ) {
+            this->bufferUsed = 0;
+            throw;
+        }
+        this->bufferUsed = 0;
+    }
+}
+
+
+// *** CLOSE FILE *** //
+
+void R3CTextOutputFile::close() {
+    int closeResult;
+    bool flushFailed;
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+    flushFailed = false;
+    try {
+        this->flush();
+    } catch ( const char* ) {
+        flushFailed = true;
+    }
+    closeResult = ::close(this->fileDesc);
+    this->fileDesc = -1;
+    if ( flushFailed || (closeResult != 0) ) throw R3CERR_IO_EXCEPTION;
+}
@@ -0,0 +1,418 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+
+// *** CONSTANTS *** //
+
+#define BUFFER_EMPTY 0
+#define BUFFER_READING 1
+#define BUFFER_READY 2
+#define BUFFER_FAILED 3
+
+
+// *** HELPER FUNCTIONS *** //
+
+#ifdef __linux__
+
+// Enters the kernel to submit reads and/or wait for completions.
+static int enterRing(
+    int ringDesc, int toSubmit, int minComplete, unsigned flags
+) {
+    return( (int)syscall(
+        __NR_io_uring_enter, ringDesc, toSubmit, minComplete, flags,
+        NULL, 0) );
+}
+
+#endif
+
+
+// *** CONSTRUCTION *** //
+
+R3CUringFileReader::R3CUringFileReader(int bufferCount, int bufferSize) :
+    ringDesc(-1),
+    ringUnavailable(false),
+    buffersRegistered(false),
+    sqRingPtr(NULL),
+    sqRingSize(0),
+    cqRingPtr(NULL),
+    cqRingSize(0),
+    sqEntries(NULL),
+    sqEntriesSize(0),
+    sqHead(NULL),
+    sqTail(NULL),
+    sqMask(NULL),
+    sqArray(NULL),
+    cqHead(NULL),
+    cqTail(NULL),
+    cqMask(NULL),
+    cqEntries(NULL),
+    unsubmitted(0),
+    bufferCount(bufferCount),
+    bufferSize(bufferSize),
+    buffers(NULL),
+    bufferOffsets(NULL),
+    bufferLengths(NULL),
+    bufferStates(NULL),
+    bufferVecs(NULL),
+    fileDesc(-1),
+    nextOffset(0),
+    readsInFlight(0),
+    headIndex(0),
+    headHeld(false),
+    atEnd(false)
+{
+#ifndef R3C_NOERRCHECK
+    if ( (bufferCount < 1) || (bufferSize < 1) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+}
+
+
+// *** DESTRUCTION *** //
+
+R3CUringFileReader::~R3CUringFileReader() {
+    if ( this->fileDesc != -1 ) this->stop();
+#ifdef __linux__
+    if ( this->ringDesc != -1 ) {
+        munmap(this->sqEntries, this->sqEntriesSize);
+        if ( this->cqRingPtr != this->sqRingPtr ) {
+            munmap(this->cqRingPtr, this->cqRingSize);
+        }
+        munmap(this->sqRingPtr, this->sqRingSize);
+        ::close(this->ringDesc);
+    }
+#endif
+    if ( this->buffers != NULL ) {
+        for ( int i = 0; i < this->bufferCount; i++ ) {
+            delete[] this->buffers[i];
+        }
+        delete[] this->buffers;
+        delete[] this->bufferOffsets;
+        delete[] this->bufferLengths;
+        delete[] this->bufferStates;
+        delete[] (struct iovec*)this->bufferVecs;
+    }
+}
+
+
+// *** MANAGE READS *** //
+
+bool R3CUringFileReader::start(int fileDesc) {
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc != -1 ) throw R3CERR_IO_STREAMALREADYOPEN;
+#endif
+    if ( (this->ringDesc == -1) && !this->setupRing() ) return( false );
+    this->fileDesc = fileDesc;
+    this->nextOffset = 0;
+    this->headIndex = 0;
+    this->headHeld = false;
+    this->atEnd = false;
+
+    // Request the start of the file into every buffer at once
+    for ( int i = 0; i < this->bufferCount; i++ ) {
+        this->bufferOffsets[i] = this->nextOffset;
+        this->bufferLengths[i] = 0;
+        this->nextOffset += this->bufferSize;
+        this->queueRead(i);
+    }
+    try {
+        this->submitReads();
+    } catch ( const char* ) {
+        this->stop();
+        throw;
+    }
+    return( true );
+}
+
+bool R3CUringFileReader::nextBuffer(char **bufferPtr, int *length) {
+#ifndef R3C_NOERRCHECK
+    if ( this->fileDesc == -1 ) throw R3CERR_IO_STREAMNOTOPEN;
+#endif
+
+    // Resubmit the released buffer for the next part of the file, unless
+    // the end has already been seen
+    if ( this->headHeld ) {
+        this->bufferStates[this->headIndex] = BUFFER_EMPTY;
+        if ( !this->atEnd ) {
+            this->bufferOffsets[this->headIndex] = this->nextOffset;
+            this->bufferLengths[this->headIndex] = 0;
+            this->nextOffset += this->bufferSize;
+            this->queueRead(this->headIndex);
+            this->submitReads();
+        }
+        this->headIndex = (this->headIndex + 1) % this->bufferCount;
+        this->headHeld = false;
+    }
+
+    // Collect completions, in whatever order they arrive, until the head
+    // buffer is ready.  A failed read is only reported once every buffer
+    // before it has been handed out, and stays at the head from then on.
+    while ( this->bufferStates[this->headIndex] == BUFFER_READING ) {
+        this->completeRead();
+    }
+    if ( this->bufferStates[this->headIndex] == BUFFER_FAILED ) {
+        throw R3CERR_IO_EXCEPTION;
+    }
+    if (
+        (this->bufferStates[this->headIndex] != BUFFER_READY) ||
+        (this->bufferLengths[this->headIndex] == 0)
+    ) {
+        return( false );
+    }
+    this->headHeld = true;
+    *bufferPtr = this->buffers[this->headIndex];
+    *length = this->bufferLengths[this->headIndex];
+    return( true );
+}
+
+void R3CUringFileReader::stop() {
+    if ( this->fileDesc == -1 ) return;
+
+    // Buffers cannot be reused until the kernel is done with them.  Once
+    // the file descriptor is cleared, completed reads are not resubmitted.
+    this->fileDesc = -1;
+    try {
+        this->submitReads();
+        while ( this->readsInFlight > 0 ) this->completeRead();
+    } catch ( const char* ) {
+        // The ring is unusable, so it will not touch the buffers again
+    }
+    for ( int i = 0; i < this->bufferCount; i++ ) {
+        this->bufferStates[i] = BUFFER_EMPTY;
+    }
+    this->unsubmitted = 0;
+    this->readsInFlight = 0;
+}
+
+
+// *** MANAGE RING *** //
+
+// Sets up io_uring.
+bool R3CUringFileReader::setupRing() {
+#ifdef __linux__
+    struct io_uring_params ringParams;
+    struct iovec* vecs;
+    void* mapAddr;
+    char* sqRing;
+    char* cqRing;
+
+    if ( this->ringUnavailable ) return( false );
+    memset(&ringParams, 0, sizeof(ringParams));
+    this->ringDesc = (int)syscall(
+        __NR_io_uring_setup, this->bufferCount, &ringParams);
+    if ( this->ringDesc < 0 ) {
+        this->ringDesc = -1;
+        this->ringUnavailable = true;
+        return( false );
+    }
+
+    // Map the submission and completion queues, which share one mapping on
+    // newer kernels
+    this->sqRingSize =
+        ringParams.sq_off.array + ringParams.sq_entries * sizeof(unsigned);
+    this->cqRingSize =
+        ringParams.cq_off.cqes +
+        ringParams.cq_entries * sizeof(struct io_uring_cqe);
+    if ( ringParams.features & IORING_FEAT_SINGLE_MMAP ) {
+        if ( this->cqRingSize > this->sqRingSize ) {
+            this->sqRingSize = this->cqRingSize;
+        }
+        this->cqRingSize = this->sqRingSize;
+    }
+    this->sqEntriesSize = ringParams.sq_entries * sizeof(struct io_uring_sqe);
+    mapAddr = mmap(
+        NULL, this->sqRingSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, this->ringDesc, IORING_OFF_SQ_RING);
+    if ( mapAddr == MAP_FAILED ) {
+        ::close(this->ringDesc);
+        this->ringDesc = -1;
+        this->ringUnavailable = true;
+        return( false );
+    }
+    this->sqRingPtr = mapAddr;
+    if ( ringParams.features & IORING_FEAT_SINGLE_MMAP ) {
+        this->cqRingPtr = this->sqRingPtr;
+    } else {
+        mapAddr = mmap(
+            NULL, this->cqRingSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, this->ringDesc, IORING_OFF_CQ_RING);
+        if ( mapAddr == MAP_FAILED ) {
+            munmap(this->sqRingPtr, this->sqRingSize);
+            ::close(this->ringDesc);
+            this->ringDesc = -1;
+            this->ringUnavailable = true;
+            return( false );
+        }
+        this->cqRingPtr = mapAddr;
+    }
+    mapAddr = mmap(
+        NULL, this->sqEntriesSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, this->ringDesc, IORING_OFF_SQES);
+    if ( mapAddr == MAP_FAILED ) {
+        if ( this->cqRingPtr != this->sqRingPtr ) {
+            munmap(this->cqRingPtr, this->cqRingSize);
+        }
+        munmap(this->sqRingPtr, this->sqRingSize);
+        ::close(this->ringDesc);
+        this->ringDesc = -1;
+        this->ringUnavailable = true;
+        return( false );
+    }
+    this->sqEntries = mapAddr;
+    sqRing = (char*)this->sqRingPtr;
+    cqRing = (char*)this->cqRingPtr;
+    this->sqHead = (unsigned*)(sqRing + ringParams.sq_off.head);
+    this->sqTail = (unsigned*)(sqRing + ringParams.sq_off.tail);
+    this->sqMask = (unsigned*)(sqRing + ringParams.sq_off.ring_mask);
+    this->sqArray = (unsigned*)(sqRing + ringParams.sq_off.array);
+    this->cqHead = (unsigned*)(cqRing + ringParams.cq_off.head);
+    this->cqTail = (unsigned*)(cqRing + ringParams.cq_off.tail);
+    this->cqMask = (unsigned*)(cqRing + ringParams.cq_off.ring_mask);
+    this->cqEntries = cqRing + ringParams.cq_off.cqes;
+
+    // Allocate the buffers, and register them so the kernel does not have
+    // to map them for every read
+    if ( this->buffers == NULL ) {
+        this->buffers = new char* [this->bufferCount];
+        for ( int i = 0; i < this->bufferCount; i++ ) {
+            this->buffers[i] = new char [this->bufferSize + 1];
+        }
+        this->bufferOffsets = new off_t [this->bufferCount];
+        this->bufferLengths = new int [this->bufferCount];
+        this->bufferStates = new int [this->bufferCount];
+        this->bufferVecs = new struct iovec [this->bufferCount];
+        for ( int i = 0; i < this->bufferCount; i++ ) {
+            this->bufferStates[i] = BUFFER_EMPTY;
+        }
+    }
+    vecs = (struct iovec*)this->bufferVecs;
+    for ( int i = 0; i < this->bufferCount; i++ ) {
+        vecs[i].iov_base = this->buffers[i];
+        vecs[i].iov_len = this->bufferSize;
+    }
+    this->buffersRegistered = (syscall(
+        __NR_io_uring_register, this->ringDesc, IORING_REGISTER_BUFFERS,
+        vecs, this->bufferCount) == 0);
+    return( true );
+#else
+    this->ringUnavailable = true;
+    return( false );
+#endif
+}
+
+// Queues a read for the unfilled part of the given buffer.
+void R3CUringFileReader::queueRead(int bufferIndex) {
+#ifdef __linux__
+    struct io_uring_sqe* entry;
+    struct iovec* vec;
+    unsigned tail;
+    unsigned index;
+    int bytesRead;
+
+    bytesRead = this->bufferLengths[bufferIndex];
+    tail = *this->sqTail;
+    index = tail & *this->sqMask;
+    entry = (struct io_uring_sqe*)this->sqEntries + index;
+    memset(entry, 0, sizeof(*entry));
+    entry->fd = this->fileDesc;
+    entry->off = (uint64_t)(this->bufferOffsets[bufferIndex] + bytesRead);
+    entry->user_data = (uint64_t)bufferIndex;
+    if ( this->buffersRegistered ) {
+        entry->opcode = IORING_OP_READ_FIXED;
+        entry->addr = (uint64_t)(uintptr_t)(
+            this->buffers[bufferIndex] + bytesRead);
+        entry->len = this->bufferSize - bytesRead;
+        entry->buf_index = (uint16_t)bufferIndex;
+    } else {
+        vec = (struct iovec*)this->bufferVecs + bufferIndex;
+        vec->iov_base = this->buffers[bufferIndex] + bytesRead;
+        vec->iov_len = this->bufferSize - bytesRead;
+        entry->opcode = IORING_OP_READV;
+        entry->addr = (uint64_t)(uintptr_t)vec;
+        entry->len = 1;
+    }
+    this->sqArray[index] = index;
+    __atomic_store_n(this->sqTail, tail + 1, __ATOMIC_RELEASE);
+    this->bufferStates[bufferIndex] = BUFFER_READING;
+    this->unsubmitted++;
+    this->readsInFlight++;
+#endif
+}
+
+// Submits all queued reads in one system call.
+void R3CUringFileReader::submitReads() {
+#ifdef __linux__
+    int submitted;
+    while ( this->unsubmitted > 0 ) {
+        submitted = enterRing(this->ringDesc, this->unsubmitted, 0, 0);
+        if ( submitted < 0 ) {
+            if ( (errno != EINTR) && (errno != EAGAIN) ) {
+                throw R3CERR_IO_EXCEPTION;
+            }
+        } else {
+            this->unsubmitted -= submitted;
+        }
+    }
+#endif
+}
+
+// Waits for a read to complete.  A partial read that did not reach the end
+// of the file is resubmitted for the rest of its buffer.
+int R3CUringFileReader::completeRead() {
+#ifdef __linux__
+    struct io_uring_cqe* entry;
+    unsigned head;
+    int bufferIndex;
+    int readResult;
+
+    head = *this->cqHead;
+    while ( head == __atomic_load_n(this->cqTail, __ATOMIC_ACQUIRE) ) {
+        if (
+            (enterRing(this->ringDesc, 0, 1, IORING_ENTER_GETEVENTS) < 0) &&
+            (errno != EINTR)
+        ) {
+            throw R3CERR_IO_EXCEPTION;
+        }
+    }
+    entry = (struct io_uring_cqe*)this->cqEntries + (head & *this->cqMask);
+    bufferIndex = (int)entry->user_data;
+    readResult = entry->res;
+    __atomic_store_n(this->cqHead, head + 1, __ATOMIC_RELEASE);
+    this->readsInFlight--;
+
+    if ( this->fileDesc == -1 ) {
+        // Stopping, so the buffer is simply discarded
+    } else if ( (readResult == -EINTR) || (readResult == -EAGAIN) ) {
+        this->queueRead(bufferIndex);
+        this->submitReads();
+    } else if ( readResult < 0 ) {
+        this->bufferStates[bufferIndex] = BUFFER_FAILED;
+    } else if ( readResult == 0 ) {
+        this->bufferStates[bufferIndex] = BUFFER_READY;
+        this->atEnd = true;
+    } else {
+        this->bufferLengths[bufferIndex] += readResult;
+        if ( this->bufferLengths[bufferIndex] < this->bufferSize ) {
+            this->queueRead(bufferIndex);
+            this->submitReads();
+        } else {
+            this->bufferStates[bufferIndex] = BUFFER_READY;
+        }
+    }
+    return( readResult );
+#else
+    throw R3CERR_IO_EXCEPTION;
+#endif
+}
@@ -12,6 +12,10 @@ const char* R3CERR_IO_STREAMNOTFOUND = "R3CERR_IO_STREAMNOTFOUND";
 
 const char* R3CERR_IO_EXCEPTION = "R3CERR_IO_EXCEPTION";
 
+const char* R3CERR_IO_ENDOFSTREAM = "R3CERR_IO_ENDOFSTREAM";
+
+const char* R3CERR_IO_BADFORMAT = "R3CERR_IO_BADFORMAT";
+
 
 // *** INTERFACES *** //
 
@@ -20,3 +24,15 @@ R3CStream::~R3CStream() {
 
 R3CTextInputStream::~R3CTextInputStream() {
 }
+
+R3CTextOutputStream::~R3CTextOutputStream() {
+}
+
+R3CRandomAccessStream::~R3CRandomAccessStream() {
+}
+
+R3CTextLineHandler::~R3CTextLineHandler() {
+}
+
+R3CDirectoryEntryHandler::~R3CDirectoryEntryHandler() {
+}
@@ -0,0 +1,19 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+
+
+// *** DESTRUCTION *** //
+
+// Destructor.
+R3CAllocator::~R3CAllocator() {
+}
+
+
+// *** MANAGE STORAGE *** //
+
+// Returns the number of bytes that allocate actually provides when asked for
+// the given number.
+int R3CAllocator::getUsableSize(int byteCount) {
+    return( byteCount );
+}
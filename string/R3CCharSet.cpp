@@ -0,0 +1,412 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+
+#include <string.h>
+
+// Blocks of characters are scanned with SSSE3 or AVX2 where the compiler can
+// target them and the processor (as found at run time) supports them
+#if \
+    defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(R3C_NOSIMD)
+#define SIMD_SCAN
+#include <immintrin.h>
+#include <stdint.h>
+#endif
+
+
+// *** CONSTANTS *** //
+
+#ifdef SIMD_SCAN
+
+// Attributes of a function that scans blocks with the given instruction set.
+// A block is loaded whole, from an aligned address, so that it never crosses
+// into another page; it may read past the end of the string, which address
+// checking would report.
+#define SCAN_FUNCTION(isa) \
+    __attribute__((target(isa), no_sanitize_address))
+
+// Bit for each row (high nibble) of the map, indexed by the row
+#define ROW_BITS \
+    1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+
+#endif
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Finds the first character, from startPtr up to endPtr, that is in the
+// given map (or not in it, if findMember is false).  If endPtr is NULL, the
+// map must be set up so that the null-terminator stops the scan.
+typedef const char* (*ScanFunction)(
+    const unsigned char* rows, const char* startPtr, const char* endPtr,
+    bool findMember);
+
+// Returns the entry of the map that holds the given character.
+static int getRowIndex(unsigned char c) {
+    return( (c & 15) | ((c >> 3) & 16) );
+}
+
+// Returns the bit within its entry of the map of the given character.
+static unsigned char getRowBit(unsigned char c) {
+    return( (unsigned char)(1 << ((c >> 4) & 7)) );
+}
+
+// Scans one character at a time.
+static const char* scanScalar(
+    const unsigned char* rows, const char* startPtr, const char* endPtr,
+    bool findMember
+) {
+    register const char* result;
+    register unsigned char curChar;
+    result = startPtr;
+    while ( (endPtr == NULL) || (result < endPtr) ) {
+        curChar = (unsigned char)*result;
+        if (
+            ((rows[getRowIndex(curChar)] & getRowBit(curChar)) != 0) ==
+            findMember
+        ) {
+            return( result );
+        }
+        result++;
+    }
+    return( endPtr );
+}
+
+#ifdef SIMD_SCAN
+
+// Scans 16 characters at a time.  Each character's entry of the map is
+// shuffled out of the low or high half (as chosen by its top bit), and then
+// tested against the bit for its row.
+SCAN_FUNCTION("ssse3")
+static const char* scanSsse3(
+    const unsigned char* rows, const char* startPtr, const char* endPtr,
+    bool findMember
+) {
+    __m128i lowRows, highRows, rowBits, nibbleMask, topBit;
+    __m128i block, blockRows, blockBits;
+    const char* blockPtr;
+    const char* result;
+    unsigned int mask, flipMask;
+    lowRows = _mm_loadu_si128((const __m128i*)rows);
+    highRows = _mm_loadu_si128((const __m128i*)(rows + 16));
+    rowBits = _mm_setr_epi8(ROW_BITS);
+    nibbleMask = _mm_set1_epi8(15);
+    topBit = _mm_set1_epi8(-128);
+    flipMask = findMember ? 0 : 0xFFFF;
+    blockPtr = (const char*)((uintptr_t)startPtr & ~(uintptr_t)15);
+    mask = 0xFFFFu << (startPtr - blockPtr);
+    while ( true ) {
+        block = _mm_load_si128((const __m128i*)blockPtr);
+        blockRows = _mm_or_si128(
+            _mm_shuffle_epi8(lowRows, block),
+            _mm_shuffle_epi8(highRows, _mm_xor_si128(block, topBit)));
+        blockBits = _mm_shuffle_epi8(
+            rowBits, _mm_and_si128(_mm_srli_epi16(block, 4), nibbleMask));
+        mask &= flipMask ^ (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_and_si128(blockRows, blockBits), blockBits));
+        if ( mask != 0 ) {
+            result = blockPtr + __builtin_ctz(mask);
+            if ( (endPtr != NULL) && (result > endPtr) ) return( endPtr );
+            return( result );
+        }
+        blockPtr += 16;
+        if ( (endPtr != NULL) && (blockPtr >= endPtr) ) return( endPtr );
+        mask = 0xFFFF;
+    }
+}
+
+// Scans 32 characters at a time, in the same way as scanSsse3.
+SCAN_FUNCTION("avx2")
+static const char* scanAvx2(
+    const unsigned char* rows, const char* startPtr, const char* endPtr,
+    bool findMember
+) {
+    __m128i halfRows;
+    __m256i lowRows, highRows, rowBits, nibbleMask, topBit;
+    __m256i block, blockRows, blockBits;
+    const char* blockPtr;
+    const char* result;
+    unsigned int mask, flipMask;
+
+    // Shuffles stay within each 16-byte lane, so each lane needs the map
+    halfRows = _mm_loadu_si128((const __m128i*)rows);
+    lowRows = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(halfRows), halfRows, 1);
+    halfRows = _mm_loadu_si128((const __m128i*)(rows + 16));
+    highRows = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(halfRows), halfRows, 1);
+    rowBits = _mm256_setr_epi8(ROW_BITS, ROW_BITS);
+    nibbleMask = _mm256_set1_epi8(15);
+    topBit = _mm256_set1_epi8(-128);
+
+    flipMask = findMember ? 0 : 0xFFFFFFFFu;
+    blockPtr = (const char*)((uintptr_t)startPtr & ~(uintptr_t)31);
+    mask = 0xFFFFFFFFu << (startPtr - blockPtr);
+    while ( true ) {
+        block = _mm256_load_si256((const __m256i*)blockPtr);
+        blockRows = _mm256_or_si256(
+            _mm256_shuffle_epi8(lowRows, block),
+            _mm256_shuffle_epi8(highRows, _mm256_xor_si256(block, topBit)));
+        blockBits = _mm256_shuffle_epi8(
+            rowBits,
+            _mm256_and_si256(_mm256_srli_epi16(block, 4), nibbleMask));
+        mask &= flipMask ^ (unsigned int)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(
+                _mm256_and_si256(blockRows, blockBits), blockBits));
+        if ( mask != 0 ) {
+            result = blockPtr + __builtin_ctz(mask);
+            if ( (endPtr != NULL) && (result > endPtr) ) return( endPtr );
+            return( result );
+        }
+        blockPtr += 32;
+        if ( (endPtr != NULL) && (blockPtr >= endPtr) ) return( endPtr );
+        mask = 0xFFFFFFFFu;
+    }
+}
+
+#endif
+
+// Chooses the fastest scan that this processor supports.
+static ScanFunction selectScan() {
+#ifdef SIMD_SCAN
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx2") ) return( scanAvx2 );
+    if ( __builtin_cpu_supports("ssse3") ) return( scanSsse3 );
+#endif
+    return( scanScalar );
+}
+
+// Scans with the fastest scan that this processor supports.
+static const char* scan(
+    const unsigned char* rows, const char* startPtr, const char* endPtr,
+    bool findMember
+) {
+    static ScanFunction scanFunction = selectScan();
+    return( scanFunction(rows, startPtr, endPtr, findMember) );
+}
+
+
+// *** CONSTRUCTION *** //
+
+// Creates a new, empty character set.
+R3CCharSet::R3CCharSet() {
+    memset(this->rows, 0, sizeof(this->rows));
+}
+
+// Creates a new character set, holding the given characters.
+R3CCharSet::R3CCharSet(const char* chars) {
+    memset(this->rows, 0, sizeof(this->rows));
+    this->add(chars);
+}
+
+// Creates a new character set, holding the given character range
+// (inclusive).
+R3CCharSet::R3CCharSet(char firstChar, char lastChar) {
+    memset(this->rows, 0, sizeof(this->rows));
+    this->add(firstChar, lastChar);
+}
+
+// Creates a new character set, holding the given character ranges (each
+// inclusive).
+R3CCharSet::R3CCharSet(const char groups[][2], int groupCount) {
+    memset(this->rows, 0, sizeof(this->rows));
+    this->add(groups, groupCount);
+}
+
+
+// *** SHARED SETS *** //
+
+// Returns a set holding the given characters; a shared set for the common
+// whitespace strings, or else buildSet.
+R3CCharSet* R3CCharSet::getSet(const char* chars, R3CCharSet* buildSet) {
+    static R3CCharSet spaceSet(R3C_STR_SPACE);
+    static R3CCharSet lineSpaceSet(R3C_STR_LINESPACE);
+    static R3CCharSet newlineSet(R3C_STR_NEWLINE);
+    static R3CCharSet whitespaceSet(R3C_STR_WHITESPACE);
+#ifndef R3C_NOERRCHECK
+    if ( (chars == NULL) || (buildSet == NULL) ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+#endif
+    if ( chars == R3C_STR_WHITESPACE ) return( &whitespaceSet );
+    if ( chars == R3C_STR_LINESPACE ) return( &lineSpaceSet );
+    if ( chars == R3C_STR_SPACE ) return( &spaceSet );
+    if ( chars == R3C_STR_NEWLINE ) return( &newlineSet );
+    buildSet->clear();
+    buildSet->add(chars);
+    return( buildSet );
+}
+
+
+// *** UPDATE SET *** //
+
+// Adds the given character to this set.
+void R3CCharSet::add(char c) {
+    this->rows[getRowIndex((unsigned char)c)] |= getRowBit((unsigned char)c);
+}
+
+// Adds the given characters to this set.
+void R3CCharSet::add(const char* chars) {
+#ifndef R3C_NOERRCHECK
+    if ( chars == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    while ( *chars != '\0' ) {
+        this->add(*chars);
+        chars++;
+    }
+}
+
+// Adds the given character range (inclusive) to this set.
+void R3CCharSet::add(char firstChar, char lastChar) {
+    int loop;
+#ifndef R3C_NOERRCHECK
+    if ( firstChar > lastChar ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    for ( loop = firstChar; loop <= lastChar; loop++ ) {
+        this->add((char)loop);
+    }
+}
+
+// Adds the given character ranges (each inclusive) to this set.
+void R3CCharSet::add(const char groups[][2], int groupCount) {
+    int loop;
+#ifndef R3C_NOERRCHECK
+    if ( (groupCount < 0) || ((groups == NULL) && (groupCount > 0)) ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+    for ( loop = 0; loop < groupCount; loop++ ) {
+        if ( groups[loop][0] > groups[loop][1] ) throw R3CERR_ILLEGALARGUMENT;
+    }
+#endif
+    for ( loop = 0; loop < groupCount; loop++ ) {
+        this->add(groups[loop][0], groups[loop][1]);
+    }
+}
+
+// Removes the given character from this set.
+void R3CCharSet::remove(char c) {
+    this->rows[getRowIndex((unsigned char)c)] &=
+        (unsigned char)~getRowBit((unsigned char)c);
+}
+
+// Replaces this set with every character that it does not hold.
+void R3CCharSet::invert() {
+    int loop;
+    for ( loop = 0; loop < (int)sizeof(this->rows); loop++ ) {
+        this->rows[loop] = (unsigned char)~this->rows[loop];
+    }
+}
+
+// Removes all characters from this set.
+void R3CCharSet::clear() {
+    memset(this->rows, 0, sizeof(this->rows));
+}
+
+
+// *** RETRIEVE SET INFO *** //
+
+// Checks if this set holds the given character.
+bool R3CCharSet::contains(char c) {
+    return(
+        (this->rows[getRowIndex((unsigned char)c)] &
+            getRowBit((unsigned char)c)) != 0 );
+}
+
+
+// *** SCAN STRINGS *** //
+
+// Passes over all characters in the target character string that are in this
+// set.
+const char* R3CCharSet::passChars(const char* targetStr) {
+    unsigned char passRows[sizeof(this->rows)];
+    if ( targetStr == NULL ) return( targetStr );
+
+    // The null-terminator must stop the scan
+    memcpy(passRows, this->rows, sizeof(passRows));
+    passRows[0] &= (unsigned char)~1;
+    return( scan(passRows, targetStr, NULL, false) );
+}
+
+// Passes over all characters in the target character string that are in this
+// set, or until charCount characters have been passed.
+const char* R3CCharSet::passChars(const char* targetStr, int charCount) {
+    unsigned char passRows[sizeof(this->rows)];
+#ifndef R3C_NOERRCHECK
+    if ( charCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( (targetStr == NULL) || (charCount == 0) ) return( targetStr );
+    memcpy(passRows, this->rows, sizeof(passRows));
+    passRows[0] &= (unsigned char)~1;
+    return( scan(passRows, targetStr, targetStr + charCount, false) );
+}
+
+// Passes over all characters in the target character buffer that are in this
+// set, until endStr is reached.
+const char* R3CCharSet::passChars(const char* targetStr, const char* endStr) {
+#ifndef R3C_NOERRCHECK
+    if ( endStr < targetStr ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( (targetStr == NULL) || (targetStr == endStr) ) return( targetStr );
+    return( scan(this->rows, targetStr, endStr, false) );
+}
+
+// Passes over all characters in the target character string, until it finds
+// one that is in this set.
+const char* R3CCharSet::reachChars(const char* targetStr) {
+    unsigned char reachRows[sizeof(this->rows)];
+    if ( targetStr == NULL ) return( targetStr );
+
+    // The null-terminator must stop the scan
+    memcpy(reachRows, this->rows, sizeof(reachRows));
+    reachRows[0] |= 1;
+    return( scan(reachRows, targetStr, NULL, true) );
+}
+
+// Passes over all characters in the target character string, until it finds
+// one that is in this set, or until charCount characters have been passed.
+const char* R3CCharSet::reachChars(const char* targetStr, int charCount) {
+    unsigned char reachRows[sizeof(this->rows)];
+#ifndef R3C_NOERRCHECK
+    if ( charCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( (targetStr == NULL) || (charCount == 0) ) return( targetStr );
+    memcpy(reachRows, this->rows, sizeof(reachRows));
+    reachRows[0] |= 1;
+    return( scan(reachRows, targetStr, targetStr + charCount, true) );
+}
+
+// Passes over all characters in the target character buffer, until it finds
+// one that is in this set, or until endStr is reached.
+const char* R3CCharSet::reachChars(
+    const char* targetStr, const char* endStr
+) {
+#ifndef R3C_NOERRCHECK
+    if ( endStr < targetStr ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( (targetStr == NULL) || (targetStr == endStr) ) return( targetStr );
+    return( scan(this->rows, targetStr, endStr, true) );
+}
+
+// Passes backwards over all characters in the target character buffer that
+// are in this set, starting with the one just before endStr.
+const char* R3CCharSet::passCharsBack(
+    const char* targetStr, const char* endStr
+) {
+    register const char* result;
+    register unsigned char curChar;
+#ifndef R3C_NOERRCHECK
+    if ( endStr < targetStr ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    // Runs of trailing characters are short, so they are not worth scanning
+    // a block at a time
+    result = endStr;
+    while ( result > targetStr ) {
+        curChar = (unsigned char)result[-1];
+        if ( (this->rows[getRowIndex(curChar)] & getRowBit(curChar)) == 0 ) {
+            break;
+        }
+        result--;
+    }
+    return( result );
+}
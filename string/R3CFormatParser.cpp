@@ -1,8 +1,27 @@
-
 #include "../includes/r3c.hpp"
 #include "../includes/r3c-string.hpp"
 
 #include <stdio.h>
+#include <stdint.h>
+
+
+// *** CONSTANTS *** //
+
+// Number of buckets of parsed format strings kept by lookup (must be a power
+// of 2)
+#define PLAN_BUCKET_COUNT 64
+
+// Number of parsed format strings kept in each bucket
+#define PLAN_BUCKET_SIZE 4
+
+// Number of parsers that lookup may replace in the cache.  A replaced parser
+// may still be in use by another thread, so it is kept rather than deleted,
+// and once this many have been replaced, uncached format strings are left
+// to the caller to parse.
+#define PLAN_RETIRE_LIMIT 256
+
+// Number of piece values that vappend keeps on the stack
+#define LOCAL_VALUE_COUNT 16
 
 
 // *** FORMAT PIECES *** //
@@ -11,9 +30,123 @@ struct R3CFormatPiece {
 	int startPos;
 	int charCount;
 	int dataType;
+	int argType;
+	char spec[R3C_FORMAT_MAXSPEC];
+	R3CFormatSpec format;
+};
+
+// Replacement value for a conversion piece, read from an argument list.
+union R3CFormatValue {
+	long long intValue;
+	long double floatValue;
+	const void* ptrValue;
 };
 
 
+// *** HELPER FUNCTIONS *** //
+
+// Formats the given value using the conversion of the given piece.  This
+// behaves like snprintf, so passing a NULL target measures the result, but
+// the null-terminator may not be written.  The conversion kernels are used
+// where they support the conversion, and snprintf otherwise.
+static int formatValue(
+    char* target, size_t targetSize,
+    const R3CFormatPiece* piece, const R3CFormatValue* value
+) {
+    int result;
+    switch ( piece->argType ) {
+        case R3C_FORMAT_ARG_INT:
+        case R3C_FORMAT_ARG_LONG:
+        case R3C_FORMAT_ARG_LONGLONG:
+        case R3C_FORMAT_ARG_SIZE:
+            result = r3cFormatInteger(target, &piece->format, value->intValue);
+            break;
+        case R3C_FORMAT_ARG_DOUBLE:
+            result = r3cFormatDouble(
+                target, &piece->format, (double)value->floatValue);
+            break;
+        case R3C_FORMAT_ARG_POINTER:
+            result = r3cFormatPointer(target, &piece->format, value->ptrValue);
+            break;
+        default:
+            result = -1;
+    }
+    if ( result >= 0 ) return( result );
+    switch ( piece->argType ) {
+        case R3C_FORMAT_ARG_LONG:
+            result = snprintf(
+                target, targetSize, piece->spec, (long)value->intValue);
+            break;
+        case R3C_FORMAT_ARG_LONGLONG:
+            result = snprintf(
+                target, targetSize, piece->spec, value->intValue);
+            break;
+        case R3C_FORMAT_ARG_SIZE:
+            result = snprintf(
+                target, targetSize, piece->spec, (size_t)value->intValue);
+            break;
+        case R3C_FORMAT_ARG_DOUBLE:
+            result = snprintf(
+                target, targetSize, piece->spec, (double)value->floatValue);
+            break;
+        case R3C_FORMAT_ARG_LONGDOUBLE:
+            result = snprintf(
+                target, targetSize, piece->spec, value->floatValue);
+            break;
+        case R3C_FORMAT_ARG_STRING:
+            result = snprintf(
+                target, targetSize, piece->spec,
+                (const char*)value->ptrValue);
+            break;
+        case R3C_FORMAT_ARG_POINTER:
+            result = snprintf(
+                target, targetSize, piece->spec, value->ptrValue);
+            break;
+        default:
+            result = snprintf(
+                target, targetSize, piece->spec, (int)value->intValue);
+    }
+    return( result );
+}
+
+// Appends the given value, using the conversion of the given piece.
+static void appendValue(
+    R3CString* str, const R3CFormatPiece* piece, const R3CFormatValue* value
+) {
+    int valueLength;
+    char* targetPtr;
+    valueLength = formatValue(NULL, 0, piece, value);
+    if ( valueLength <= 0 ) return;
+    targetPtr = str->appendSpace(valueLength);
+    formatValue(targetPtr, valueLength + 1, piece, value);
+}
+
+// Returns the first cache slot of the bucket for the given format string
+// pointer.  Every bit of the pointer is mixed in, since string literals are
+// often packed next to each other.
+static int getPlanBucket(const char* formatString) {
+    uint64_t key;
+    key = (uint64_t)(uintptr_t)formatString * 0x9E3779B97F4A7C15ULL;
+    return(
+        (int)((key >> 32) & (PLAN_BUCKET_COUNT - 1)) * PLAN_BUCKET_SIZE );
+}
+
+
+// *** PARSED FORMAT CACHE *** //
+
+// Format parsers shared by lookup, in buckets of PLAN_BUCKET_SIZE slots.
+static R3CFormatParser* planCache[PLAN_BUCKET_COUNT * PLAN_BUCKET_SIZE];
+
+// Parsers replaced in the cache, which are kept until the program ends.
+static R3CFormatParser* retiredPlans[PLAN_RETIRE_LIMIT];
+
+// Number of parsers replaced in the cache.
+static int retiredCount = 0;
+
+// Counter used to choose which slot of a full bucket is replaced.
+static unsigned planVictim = 0;
+
+
 // *** CONSTRUCTION *** //
 
 // Creates a new format parser object.
@@ -22,7 +155,9 @@ R3CFormatParser::R3CFormatParser() :
     piecesAlloc(16),
     piecesSet(0),
     pieces(NULL),
-    stringDelimiter('\0')
+    stringDelimiter('\0'),
+    cacheKey(NULL),
+    formatCopy(NULL)
 {
     this->pieces = new R3CFormatPiece [16];
 }
@@ -33,6 +168,7 @@ R3CFormatParser::R3CFormatParser() :
 // Destructor.
 R3CFormatParser::~R3CFormatParser() {
     if ( this->pieces != NULL ) delete[] this->pieces;
+    if ( this->formatCopy != NULL ) delete[] this->formatCopy;
 }
 
 
@@ -85,7 +221,7 @@ const char* R3CFormatParser::passPrecision(const char* strPtr) {
     result = strPtr;
     if ( *result == '.' ) {
         result++;
-        result = this->passNumber(strPtr);
+        result = this->passNumber(result);
     }
     return( result );
 }
@@ -94,7 +230,12 @@ const char* R3CFormatParser::passPrecision(const char* strPtr) {
 const char* R3CFormatParser::passSize(const char* strPtr) {
     const char* result;
     result = strPtr;
-    if ( *result == 'l' ) result++;
+    if ( (*result == 'l') || (*result == 'h') ) {
+        result++;
+        if ( *result == *strPtr ) result++;
+    } else if ( (*result == 'L') || (*result == 'z') ) {
+        result++;
+    }
     return( result );
 }
 
@@ -125,11 +266,14 @@ int R3CFormatParser::resolveFormatType(char curChar) {
 			result = R3C_FORMAT_INT;
 			break;
 		case 'f':
+		case 'F':
 		case 'g':
 		case 'G':
 		case 'e':
 		case 'E':
-			result = R3C_FORMAT_FLOAT;
+		case 'a':
+		case 'A':
+			result = R3C_FORMAT_DOUBLE;
 			break;
 		case 's':
 			result = R3C_FORMAT_STRING;
@@ -143,10 +287,46 @@ int R3CFormatParser::resolveFormatType(char curChar) {
 	return( result );
 }
 
+// Resolves the type of argument taken by a conversion, from its type and the
+// size portion that precedes the conversion character.
+int R3CFormatParser::resolveArgType(int dataType, const char* sizePtr) {
+    int result;
+    switch ( dataType ) {
+        case R3C_FORMAT_INT:
+            if ( (sizePtr[0] == 'l') && (sizePtr[1] == 'l') ) {
+                result = R3C_FORMAT_ARG_LONGLONG;
+            } else if ( sizePtr[0] == 'l' ) {
+                result = R3C_FORMAT_ARG_LONG;
+            } else if ( sizePtr[0] == 'z' ) {
+                result = R3C_FORMAT_ARG_SIZE;
+            } else {
+                result = R3C_FORMAT_ARG_INT;
+            }
+            break;
+        case R3C_FORMAT_DOUBLE:
+            if ( sizePtr[0] == 'L' ) {
+                result = R3C_FORMAT_ARG_LONGDOUBLE;
+            } else {
+                result = R3C_FORMAT_ARG_DOUBLE;
+            }
+            break;
+        case R3C_FORMAT_STRING:
+            result = R3C_FORMAT_ARG_STRING;
+            break;
+        case R3C_FORMAT_POINTER:
+            result = R3C_FORMAT_ARG_POINTER;
+            break;
+        default:
+            result = R3C_FORMAT_ARG_NONE;
+    }
+    return( result );
+}
+
 // Parses the given format string into its component parts.
 void R3CFormatParser::parse(const char *formatString) {
 	const char* strPtr;
 	const char* percentPtr;
+	const char* sizePtr;
 	const char* conversionPtr;
     R3CFormatPiece* currPiece;
 	bool done;
@@ -168,6 +348,7 @@ void R3CFormatParser::parse(const char *formatString) {
             currPiece = this->pieces + this->piecesSet;
             currPiece->startPos = (int)(strPtr - formatString);
             currPiece->dataType = R3C_FORMAT_LITERAL;
+            currPiece->argType = R3C_FORMAT_ARG_NONE;
             if ( percentPtr == NULL ) {
                 // There is no % character, so this goes to the end
                 currPiece->charCount = (int)strlen(strPtr);
@@ -183,15 +364,39 @@ void R3CFormatParser::parse(const char *formatString) {
         } else {
             // Create a format piece for this conversion
             conversionPtr = this->passConversion(strPtr);
+            sizePtr = conversionPtr;
+            while ( (sizePtr > strPtr) && strchr("hlLz", sizePtr[-1]) ) {
+                sizePtr--;
+            }
             this->ensurePieceCapacity();
             currPiece = this->pieces + this->piecesSet;
             currPiece->startPos = (int)(strPtr - formatString);
+            if ( *conversionPtr == '\0' ) {
+                // An unfinished conversion at the end is kept as a literal
+                currPiece->dataType = R3C_FORMAT_LITERAL;
+                currPiece->argType = R3C_FORMAT_ARG_NONE;
+                currPiece->charCount = (int)(conversionPtr - strPtr);
+                this->piecesSet++;
+                break;
+            }
             currPiece->dataType = this->resolveFormatType(*conversionPtr);
+            currPiece->argType =
+                this->resolveArgType(currPiece->dataType, sizePtr);
             currPiece->charCount = (int)(conversionPtr - strPtr) + 1;
             if ( (*conversionPtr == '%') && (conversionPtr == (strPtr+1)) ) {
                 currPiece->charCount--;
             }
 
+            // Keep a null-terminated copy of the conversion, for snprintf
+            if ( currPiece->dataType != R3C_FORMAT_LITERAL ) {
+                if ( currPiece->charCount >= R3C_FORMAT_MAXSPEC ) {
+                    throw R3CERR_ILLEGALARGUMENT;
+                }
+                memcpy(currPiece->spec, strPtr, currPiece->charCount);
+                currPiece->spec[currPiece->charCount] = '\0';
+                r3cFormatDecodeSpec(currPiece->spec, &currPiece->format);
+            }
+
             // Move to the next piece
             strPtr = conversionPtr + 1;
             this->piecesSet++;
@@ -200,6 +405,86 @@ void R3CFormatParser::parse(const char *formatString) {
     }
 }
 
+// Returns a shared parser for the given format string.
+R3CFormatParser* R3CFormatParser::lookup(const char *formatString) {
+    R3CFormatParser** bucketPtr;
+    R3CFormatParser** slotPtr;
+    R3CFormatParser* cached;
+    R3CFormatParser* result;
+    int formatLength;
+    int retiredIndex;
+#ifndef R3C_NOERRCHECK
+    if ( formatString == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+
+    // The same address may hold a different format string than before, so
+    // the contents are checked as well.  A slot holding an older string at
+    // this address, or else an empty slot, is remembered for replacement.
+    bucketPtr = planCache + getPlanBucket(formatString);
+    slotPtr = NULL;
+    for ( int i = 0; i < PLAN_BUCKET_SIZE; i++ ) {
+        cached = __atomic_load_n(bucketPtr + i, __ATOMIC_ACQUIRE);
+        if ( cached == NULL ) {
+            if ( slotPtr == NULL ) slotPtr = bucketPtr + i;
+        } else if ( cached->cacheKey == formatString ) {
+            if ( strcmp(cached->formatString, formatString) == 0 ) {
+                return( cached );
+            }
+            slotPtr = bucketPtr + i;
+        }
+    }
+    if ( slotPtr == NULL ) {
+        slotPtr = bucketPtr + (int)(
+            __atomic_fetch_add(&planVictim, 1, __ATOMIC_RELAXED) %
+            PLAN_BUCKET_SIZE);
+    }
+
+    // Parse a private copy of the format string
+    result = new R3CFormatParser();
+    try {
+        formatLength = (int)strlen(formatString);
+        result->formatCopy = new char [formatLength + 1];
+        memcpy(result->formatCopy, formatString, formatLength + 1);
+        result->parse(result->formatCopy);
+    } catch ( ... ) {
+        delete result;
+        throw;
+    }
+    result->cacheKey = formatString;
+
+    // Publish it in the chosen slot, unless another thread has changed the
+    // slot first.  A replaced parser may still be in use, so it is retired
+    // rather than deleted, and the cache stops replacing parsers once the
+    // retirement limit is reached.
+    cached = __atomic_load_n(slotPtr, __ATOMIC_ACQUIRE);
+    if ( cached != NULL ) {
+        retiredIndex = __atomic_fetch_add(&retiredCount, 1, __ATOMIC_RELAXED);
+        if ( retiredIndex >= PLAN_RETIRE_LIMIT ) {
+            delete result;
+            return( NULL );
+        }
+    } else {
+        retiredIndex = -1;
+    }
+    if (
+        !__atomic_compare_exchange_n(
+            slotPtr, &cached, result, false,
+            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+    ) {
+        // The retirement place, if any, is left unused
+        delete result;
+        if (
+            (cached != NULL) && (cached->cacheKey == formatString) &&
+            (strcmp(cached->formatString, formatString) == 0)
+        ) {
+            return( cached );
+        }
+        return( NULL );
+    }
+    if ( retiredIndex >= 0 ) retiredPlans[retiredIndex] = cached;
+    return( result );
+}
+
 
 // *** RETRIEVE FORMAT PIECE INFORMATION *** //
 
@@ -219,17 +504,6 @@ int R3CFormatParser::getPieceType(int index) {
 
 // *** APPEND FORMAT CONVERSIONS TO A STRING *** //
 
-// Sets formatter to the format string represented by the piece at the given
-// index.
-void R3CFormatParser::setFormatter(int index) {
-    R3CFormatPiece* curPiece;
-    const char* formatStrPtr;
-    curPiece = this->pieces + index;
-    formatStrPtr = this->formatString + curPiece->startPos;
-    strncpy(this->formatter, formatStrPtr, curPiece->charCount);
-    this->formatter[curPiece->charCount] = '\0';
-}
-
 // Retrieves the delimiter character to output for string conversion.
 char R3CFormatParser::getStringDelimiter() {
     return( this->stringDelimiter );
@@ -251,11 +525,13 @@ void R3CFormatParser::appendLiteral(R3CString *str, int index) {
     }
 #endif
 	curPiece = this->pieces + index;
-	str->append(this->formatString, curPiece->startPos, curPiece->charCount);
+	str->append(
+	    this->formatString + curPiece->startPos, curPiece->charCount);
 }
 
 // Appends the integer conversion piece at the given index.
 void R3CFormatParser::appendInt(R3CString *str, int index, long int value) {
+    R3CFormatValue formatValue;
 #ifndef R3C_NOERRCHECK
     if ( str == NULL ) throw R3CERR_ILLEGALARGUMENT;
     if ( (index < 0) || (index >= this->piecesSet) ) throw R3CERR_OUTOFRANGE;
@@ -263,25 +539,24 @@ void R3CFormatParser::appendInt(R3CString *str, int index, long int value) {
         throw R3CERR_STR_BADFORMATPIECE;
     }
 #endif
-    this->setFormatter(index);
-    sprintf(this->formatResult, this->formatter, value);
-	str->append(this->formatResult);
+    formatValue.intValue = value;
+    appendValue(str, this->pieces + index, &formatValue);
 }
 
 // Appends the floating-point conversion piece at the given index.
 void R3CFormatParser::appendFloat(
     R3CString *str, int index, long double value
 ) {
+    R3CFormatValue formatValue;
 #ifndef R3C_NOERRCHECK
     if ( str == NULL ) throw R3CERR_ILLEGALARGUMENT;
     if ( (index < 0) || (index >= this->piecesSet) ) throw R3CERR_OUTOFRANGE;
-    if ( this->pieces[index].dataType != R3C_FORMAT_FLOAT ) {
+    if ( this->pieces[index].dataType != R3C_FORMAT_DOUBLE ) {
         throw R3CERR_STR_BADFORMATPIECE;
     }
 #endif
-    this->setFormatter(index);
-    sprintf(this->formatResult, this->formatter, value);
-	str->append(this->formatResult);
+    formatValue.floatValue = value;
+    appendValue(str, this->pieces + index, &formatValue);
 }
 
 // Appends the string conversion piece at the given index.
@@ -312,6 +587,7 @@ void R3CFormatParser::appendString(
 void R3CFormatParser::appendPointer(
     R3CString *str, int index, const void* value
 ) {
+    R3CFormatValue formatValue;
 #ifndef R3C_NOERRCHECK
     if ( str == NULL ) throw R3CERR_ILLEGALARGUMENT;
     if ( (index < 0) || (index >= this->piecesSet) ) throw R3CERR_OUTOFRANGE;
@@ -319,7 +595,132 @@ void R3CFormatParser::appendPointer(
         throw R3CERR_STR_BADFORMATPIECE;
     }
 #endif
-    this->setFormatter(index);
-    sprintf(this->formatResult, this->formatter, value);
-    str->append(this->formatResult);
+    formatValue.ptrValue = value;
+    appendValue(str, this->pieces + index, &formatValue);
+}
+
+// Appends the whole formatted string, taking the replacements from a
+// variable argument list.
+int R3CFormatParser::vappend(R3CString *str, va_list varArgs) {
+    R3CFormatValue localValues[LOCAL_VALUE_COUNT];
+    int localLengths[LOCAL_VALUE_COUNT];
+    R3CFormatValue* values;
+    int* lengths;
+    R3CFormatPiece* curPiece;
+    const char* strValue;
+    char* targetPtr;
+    char* valuePtr;
+    int valueLength;
+    int totalLength;
+    int loop;
+#ifndef R3C_NOERRCHECK
+    if ( str == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    values = localValues;
+    lengths = localLengths;
+    if ( this->piecesSet > LOCAL_VALUE_COUNT ) {
+        values = new R3CFormatValue [this->piecesSet];
+        lengths = new int [this->piecesSet];
+    }
+
+    // Read every replacement, and measure every piece, so that the target
+    // string only has to grow once
+    totalLength = 0;
+    for ( loop = 0; loop < this->piecesSet; loop++ ) {
+        curPiece = this->pieces + loop;
+        switch ( curPiece->argType ) {
+            case R3C_FORMAT_ARG_NONE:
+                lengths[loop] = curPiece->charCount;
+                break;
+            case R3C_FORMAT_ARG_LONG:
+                values[loop].intValue = va_arg(varArgs, long);
+                lengths[loop] = formatValue(NULL, 0, curPiece, values + loop);
+                break;
+            case R3C_FORMAT_ARG_LONGLONG:
+                values[loop].intValue = va_arg(varArgs, long long);
+                lengths[loop] = formatValue(NULL, 0, curPiece, values + loop);
+                break;
+            case R3C_FORMAT_ARG_SIZE:
+                values[loop].intValue = (long long)va_arg(varArgs, size_t);
+                lengths[loop] = formatValue(NULL, 0, curPiece, values + loop);
+                break;
+            case R3C_FORMAT_ARG_DOUBLE:
+                values[loop].floatValue = va_arg(varArgs, double);
+                lengths[loop] = formatValue(NULL, 0, curPiece, values + loop);
+                break;
+            case R3C_FORMAT_ARG_LONGDOUBLE:
+                values[loop].floatValue = va_arg(varArgs, long double);
+                lengths[loop] = formatValue(NULL, 0, curPiece, values + loop);
+                break;
+            case R3C_FORMAT_ARG_STRING:
+                strValue = va_arg(varArgs, const char*);
+                values[loop].ptrValue = strValue;
+                if ( strValue == NULL ) {
+                    lengths[loop] = (this->stringDelimiter == '\0') ? 0 : 4;
+                } else if ( curPiece->charCount == 2 ) {
+                    lengths[loop] = (int)strlen(strValue);
+                } else {
+                    lengths[loop] =
+                        formatValue(NULL, 0, curPiece, values + loop);
+                }
+                if ( (strValue != NULL) && (this->stringDelimiter != '\0') ) {
+                    lengths[loop] += 2;
+                }
+                break;
+            case R3C_FORMAT_ARG_POINTER:
+                values[loop].ptrValue = va_arg(varArgs, const void*);
+                lengths[loop] = formatValue(NULL, 0, curPiece, values + loop);
+                break;
+            default:
+                values[loop].intValue = va_arg(varArgs, int);
+                lengths[loop] = formatValue(NULL, 0, curPiece, values + loop);
+        }
+        if ( lengths[loop] < 0 ) lengths[loop] = 0;
+        totalLength += lengths[loop];
+    }
+
+    // Write every piece directly into the new space at the end of the
+    // target string; each conversion may write its null-terminator over the
+    // first character of the next piece
+    targetPtr = str->appendSpace(totalLength);
+    for ( loop = 0; loop < this->piecesSet; loop++ ) {
+        curPiece = this->pieces + loop;
+        if ( curPiece->argType == R3C_FORMAT_ARG_NONE ) {
+            memcpy(
+                targetPtr, this->formatString + curPiece->startPos,
+                curPiece->charCount);
+        } else if ( curPiece->argType == R3C_FORMAT_ARG_STRING ) {
+            strValue = (const char*)values[loop].ptrValue;
+            if ( strValue == NULL ) {
+                if ( lengths[loop] > 0 ) memcpy(targetPtr, "NULL", 4);
+            } else {
+                valuePtr = targetPtr;
+                valueLength = lengths[loop];
+                if ( this->stringDelimiter != '\0' ) {
+                    valuePtr++;
+                    valueLength -= 2;
+                }
+                if ( curPiece->charCount == 2 ) {
+                    memcpy(valuePtr, strValue, valueLength);
+                } else {
+                    formatValue(
+                        valuePtr, valueLength + 1, curPiece, values + loop);
+                }
+                if ( this->stringDelimiter != '\0' ) {
+                    targetPtr[0] = this->stringDelimiter;
+                    targetPtr[lengths[loop] - 1] = this->stringDelimiter;
+                }
+            }
+        } else if ( lengths[loop] > 0 ) {
+            formatValue(targetPtr, lengths[loop] + 1, curPiece, values + loop);
+        }
+        targetPtr += lengths[loop];
+    }
+    *targetPtr = '\0';
+
+    if ( values != localValues ) {
+        delete[] values;
+        delete[] lengths;
+    }
+    return( totalLength );
 }
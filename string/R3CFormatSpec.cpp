@@ -0,0 +1,622 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+
+#include <string.h>
+
+
+// *** CONSTANTS *** //
+
+// Largest width or precision handled by the conversion kernels
+#define MAX_FIELD 65535
+
+// Size of the buffer holding a result before padding
+#define CHAR_BUFFER_SIZE 64
+
+// Largest precision handled for integers, so that the result fits in the
+// buffer
+#define MAX_INT_PRECISION 40
+
+// Largest power of 5 that fits in 64 bits, as an exponent
+#define MAX_POW5 27
+
+// Largest precision handled for the e and g conversions, so that every
+// significant digit fits in 64 bits
+#define MAX_SIGNIFICANT 18
+
+// Every pair of decimal digits, from "00" to "99"
+static const char digitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343"
+    "53637383940414243444546474849505152535455565758596061626364656667686970"
+    "7172737475767778798081828384858687888990919293949596979899";
+
+// Hexadecimal digits, in lower-case and upper-case
+static const char hexLower[17] = "0123456789abcdef";
+static const char hexUpper[17] = "0123456789ABCDEF";
+
+// Powers of 10 that fit in 64 bits
+static const unsigned long long pow10Table[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL
+};
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Returns the number of decimal digits in the given value, which is at
+// least 1.
+static int countDecimal(unsigned long long value) {
+    int result;
+    result = 1;
+    while ( (result < 20) && (value >= pow10Table[result]) ) result++;
+    return( result );
+}
+
+// Writes the decimal digits of the given value backward, ending just before
+// the given position.
+static void writeDecimal(char* endPtr, unsigned long long value) {
+    unsigned int pairIndex;
+    while ( value >= 100 ) {
+        pairIndex = (unsigned int)(value % 100) * 2;
+        value /= 100;
+        endPtr -= 2;
+        endPtr[0] = digitPairs[pairIndex];
+        endPtr[1] = digitPairs[pairIndex + 1];
+    }
+    if ( value >= 10 ) {
+        pairIndex = (unsigned int)value * 2;
+        endPtr -= 2;
+        endPtr[0] = digitPairs[pairIndex];
+        endPtr[1] = digitPairs[pairIndex + 1];
+    } else {
+        endPtr[-1] = (char)('0' + value);
+    }
+}
+
+// Returns the number of digits in the given value, for a base that is a
+// power of 2, which is at least 1.
+static int countBinary(unsigned long long value, int shift) {
+    int result;
+    result = 1;
+    while ( (value >>= shift) != 0 ) result++;
+    return( result );
+}
+
+// Writes the digits of the given value backward, ending just before the
+// given position, for a base that is a power of 2.
+static void writeBinary(
+    char* endPtr, unsigned long long value, int shift, const char* digits
+) {
+    unsigned int mask;
+    mask = (1U << shift) - 1;
+    do {
+        *--endPtr = digits[value & mask];
+        value >>= shift;
+    } while ( value != 0 );
+}
+
+// Writes the given characters, padded to the width of the conversion.  A
+// sign or prefix at the start of the characters stays ahead of any zeros.
+static int writePadded(
+    char* target, const R3CFormatSpec* spec, const char* chars,
+    int charCount, int prefixLength, bool zeroPad
+) {
+    int padCount;
+    padCount = (spec->width > charCount) ? spec->width - charCount : 0;
+    if ( target == NULL ) return( charCount + padCount );
+    if ( (spec->flags & R3C_FORMAT_FLAG_LEFT) != 0 ) {
+        memcpy(target, chars, charCount);
+        memset(target + charCount, ' ', padCount);
+    } else if ( zeroPad ) {
+        memcpy(target, chars, prefixLength);
+        memset(target + prefixLength, '0', padCount);
+        memcpy(
+            target + prefixLength + padCount, chars + prefixLength,
+            charCount - prefixLength);
+    } else {
+        memset(target, ' ', padCount);
+        memcpy(target + padCount, chars, charCount);
+    }
+    return( charCount + padCount );
+}
+
+// Returns the character written ahead of a signed value, or '\0' for none.
+static char getSignChar(const R3CFormatSpec* spec, bool negative) {
+    if ( negative ) return( '-' );
+    if ( (spec->flags & R3C_FORMAT_FLAG_PLUS) != 0 ) return( '+' );
+    if ( (spec->flags & R3C_FORMAT_FLAG_SPACE) != 0 ) return( ' ' );
+    return( '\0' );
+}
+
+#ifdef __SIZEOF_INT128__
+
+typedef unsigned __int128 uint128;
+
+// Powers of 5 that fit in 64 bits
+static const unsigned long long pow5Table[MAX_POW5 + 1] = {
+    1ULL, 5ULL, 25ULL, 125ULL, 625ULL, 3125ULL, 15625ULL, 78125ULL,
+    390625ULL, 1953125ULL, 9765625ULL, 48828125ULL, 244140625ULL,
+    1220703125ULL, 6103515625ULL, 30517578125ULL, 152587890625ULL,
+    762939453125ULL, 3814697265625ULL, 19073486328125ULL,
+    95367431640625ULL, 476837158203125ULL, 2384185791015625ULL,
+    11920928955078125ULL, 59604644775390625ULL, 298023223876953125ULL,
+    1490116119384765625ULL, 7450580596923828125ULL
+};
+
+// Divides the given numerator, rounding exactly half-way results to even,
+// as the C library does.  Returns false if the result does not fit in 64
+// bits.
+static bool divideRounded(
+    uint128 numerator, uint128 denominator, unsigned long long* result
+) {
+    uint128 quotient;
+    uint128 remainder;
+    quotient = numerator / denominator;
+    remainder = numerator % denominator;
+    if (
+        (remainder > denominator - remainder) ||
+        ((remainder == denominator - remainder) && ((quotient & 1) != 0))
+    ) {
+        quotient++;
+    }
+    if ( (quotient >> 64) != 0 ) return( false );
+    *result = (unsigned long long)quotient;
+    return( true );
+}
+
+// Calculates mantissa * 2^binaryExp * 10^decimalExp, rounded to the nearest
+// integer.  The calculation is exact, so the digits match those of the C
+// library.  Returns false if the result cannot be calculated in 128 bits, or
+// does not fit in 64 bits.
+static bool scaleDecimal(
+    unsigned long long mantissa, int binaryExp, int decimalExp,
+    unsigned long long* result
+) {
+    uint128 numerator;
+    uint128 denominator;
+    int shift;
+    if ( mantissa == 0 ) {
+        *result = 0;
+        return( true );
+    }
+    if ( (decimalExp > MAX_POW5) || (decimalExp < -MAX_POW5) ) {
+        return( false );
+    }
+    if ( decimalExp >= 0 ) {
+        // Multiply by 5^decimalExp, leaving a power of 2 to apply
+        numerator = (uint128)mantissa * pow5Table[decimalExp];
+        shift = binaryExp + decimalExp;
+        if ( shift >= 0 ) {
+            if ( (shift >= 64) || ((numerator >> (64 - shift)) != 0) ) {
+                return( false );
+            }
+            *result = (unsigned long long)(numerator << shift);
+            return( true );
+        }
+        if ( -shift > 116 ) {
+            // The product is below 2^116, so this is below one half
+            *result = 0;
+            return( true );
+        }
+        denominator = (uint128)1 << -shift;
+    } else {
+        // Divide by 5^-decimalExp, with any power of 2 on either side
+        denominator = pow5Table[-decimalExp];
+        shift = binaryExp + decimalExp;
+        if ( shift >= 0 ) {
+            if ( shift > 74 ) return( false );
+            numerator = (uint128)mantissa << shift;
+        } else {
+            if ( -shift > 64 ) {
+                // The mantissa is below 2^53, so this is below one half
+                *result = 0;
+                return( true );
+            }
+            numerator = mantissa;
+            denominator <<= -shift;
+        }
+    }
+    return( divideRounded(numerator, denominator, result) );
+}
+
+#endif
+
+// Writes the digits of a fixed-point value, which has the given number of
+// digits after the decimal point, and returns the number of characters
+// written.
+static int writeFixed(
+    char* target, unsigned long long digits, int precision, bool forcePoint
+) {
+    char* targetPtr;
+    int digitCount;
+    int intCount;
+    targetPtr = target;
+    digitCount = countDecimal(digits);
+    if ( digitCount > precision ) {
+        intCount = digitCount - precision;
+        writeDecimal(targetPtr + digitCount + 1, digits);
+        memmove(targetPtr, targetPtr + 1, intCount);
+        targetPtr += intCount;
+        if ( (precision > 0) || forcePoint ) *targetPtr++ = '.';
+        else return( intCount );
+        targetPtr += precision;
+    } else {
+        *targetPtr++ = '0';
+        if ( (precision > 0) || forcePoint ) *targetPtr++ = '.';
+        memset(targetPtr, '0', precision - digitCount);
+        targetPtr += precision;
+        writeDecimal(targetPtr, digits);
+    }
+    return( (int)(targetPtr - target) );
+}
+
+// Writes the digits of an exponential value, which has the given number of
+// significant digits, and returns the number of characters written.
+static int writeExponent(
+    char* target, unsigned long long digits, int digitCount, int exponent,
+    char expChar, bool forcePoint
+) {
+    char* targetPtr;
+    targetPtr = target;
+    memset(targetPtr, '0', digitCount + 1);
+    writeDecimal(targetPtr + digitCount + 1, digits);
+    targetPtr[0] = targetPtr[1];
+    targetPtr++;
+    if ( (digitCount > 1) || forcePoint ) {
+        *targetPtr = '.';
+        targetPtr += digitCount;
+    }
+    *targetPtr++ = expChar;
+    if ( exponent < 0 ) {
+        *targetPtr++ = '-';
+        exponent = -exponent;
+    } else {
+        *targetPtr++ = '+';
+    }
+    if ( exponent < 10 ) *targetPtr++ = '0';
+    targetPtr += countDecimal(exponent);
+    writeDecimal(targetPtr, exponent);
+    return( (int)(targetPtr - target) );
+}
+
+// Removes trailing zeros after the decimal point, and the decimal point
+// itself if nothing follows it, from a fixed-point result.
+static int trimFraction(const char* chars, int charCount) {
+    if ( memchr(chars, '.', charCount) == NULL ) return( charCount );
+    while ( chars[charCount - 1] == '0' ) charCount--;
+    if ( chars[charCount - 1] == '.' ) charCount--;
+    return( charCount );
+}
+
+
+// *** DECODE CONVERSIONS *** //
+
+void r3cFormatDecodeSpec(const char* spec, R3CFormatSpec* result) {
+    const char* specPtr;
+    int value;
+#ifndef R3C_NOERRCHECK
+    if ( (spec == NULL) || (result == NULL) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    result->flags = 0;
+    result->width = 0;
+    result->precision = -1;
+    result->valueBits = sizeof(int) * 8;
+    specPtr = spec + 1;
+
+    // Flags, then the width, where a leading 0 asks for zero padding
+    while ( true ) {
+        if ( *specPtr == '-' ) result->flags |= R3C_FORMAT_FLAG_LEFT;
+        else if ( *specPtr == '+' ) result->flags |= R3C_FORMAT_FLAG_PLUS;
+        else if ( *specPtr == ' ' ) result->flags |= R3C_FORMAT_FLAG_SPACE;
+        else if ( *specPtr == '#' ) result->flags |= R3C_FORMAT_FLAG_ALT;
+        else break;
+        specPtr++;
+    }
+    if ( *specPtr == '0' ) result->flags |= R3C_FORMAT_FLAG_ZERO;
+    value = 0;
+    while ( (*specPtr >= '0') && (*specPtr <= '9') ) {
+        if ( value <= MAX_FIELD ) value = (value * 10) + (*specPtr - '0');
+        specPtr++;
+    }
+    result->width = value;
+
+    // Precision, where a lone . means 0
+    if ( *specPtr == '.' ) {
+        specPtr++;
+        value = 0;
+        while ( (*specPtr >= '0') && (*specPtr <= '9') ) {
+            if ( value <= MAX_FIELD ) value = (value * 10) + (*specPtr - '0');
+            specPtr++;
+        }
+        result->precision = value;
+    }
+
+    // Size
+    if ( (specPtr[0] == 'h') && (specPtr[1] == 'h') ) {
+        result->valueBits = sizeof(char) * 8;
+        specPtr += 2;
+    } else if ( specPtr[0] == 'h' ) {
+        result->valueBits = sizeof(short) * 8;
+        specPtr++;
+    } else if ( (specPtr[0] == 'l') && (specPtr[1] == 'l') ) {
+        result->valueBits = sizeof(long long) * 8;
+        specPtr += 2;
+    } else if ( specPtr[0] == 'l' ) {
+        result->valueBits = sizeof(long) * 8;
+        specPtr++;
+    } else if ( specPtr[0] == 'z' ) {
+        result->valueBits = sizeof(size_t) * 8;
+        specPtr++;
+    } else if ( specPtr[0] == 'L' ) {
+        result->valueBits = sizeof(long double) * 8;
+        specPtr++;
+    }
+    result->conversion = *specPtr;
+}
+
+
+// *** CONVERSION KERNELS *** //
+
+int r3cFormatInteger(
+    char* target, const R3CFormatSpec* spec, long long value
+) {
+    char chars[CHAR_BUFFER_SIZE];
+    unsigned long long magnitude;
+    unsigned long long mask;
+    int shift;
+    int digitCount;
+    int zeroCount;
+    int prefixLength;
+    int charCount;
+    char signChar;
+#ifndef R3C_NOERRCHECK
+    if ( spec == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if (
+        (spec->width > MAX_FIELD) || (spec->precision > MAX_INT_PRECISION) ||
+        (spec->valueBits > 64)
+    ) {
+        return( -1 );
+    }
+    mask = (spec->valueBits == 64) ? ~0ULL : (1ULL << spec->valueBits) - 1;
+    magnitude = (unsigned long long)value & mask;
+
+    // A single character
+    if ( spec->conversion == 'c' ) {
+        if (
+            (spec->valueBits != (int)(sizeof(int) * 8)) ||
+            ((spec->flags & R3C_FORMAT_FLAG_ZERO) != 0)
+        ) {
+            return( -1 );
+        }
+        chars[0] = (char)magnitude;
+        return( writePadded(target, spec, chars, 1, 0, false) );
+    }
+
+    // The sign or prefix
+    prefixLength = 0;
+    shift = 0;
+    switch ( spec->conversion ) {
+        case 'd':
+        case 'i':
+            if ( (magnitude & ~(mask >> 1)) != 0 ) {
+                magnitude = (~magnitude + 1) & mask;
+                signChar = '-';
+            } else {
+                signChar = getSignChar(spec, false);
+            }
+            if ( signChar != '\0' ) chars[prefixLength++] = signChar;
+            break;
+        case 'u':
+            break;
+        case 'x':
+        case 'X':
+            shift = 4;
+            if (
+                ((spec->flags & R3C_FORMAT_FLAG_ALT) != 0) &&
+                (magnitude != 0)
+            ) {
+                chars[prefixLength++] = '0';
+                chars[prefixLength++] = spec->conversion;
+            }
+            break;
+        case 'o':
+            shift = 3;
+            break;
+        default:
+            return( -1 );
+    }
+
+    // The digits, with any zeros required by the precision
+    if ( (magnitude == 0) && (spec->precision == 0) ) {
+        digitCount = 0;
+    } else if ( shift == 0 ) {
+        digitCount = countDecimal(magnitude);
+    } else {
+        digitCount = countBinary(magnitude, shift);
+    }
+    zeroCount = (spec->precision > digitCount) ?
+        spec->precision - digitCount : 0;
+    if (
+        (shift == 3) && ((spec->flags & R3C_FORMAT_FLAG_ALT) != 0) &&
+        (zeroCount == 0) && ((magnitude != 0) || (digitCount == 0))
+    ) {
+        zeroCount = 1;
+    }
+    charCount = prefixLength + zeroCount + digitCount;
+    memset(chars + prefixLength, '0', zeroCount);
+    if ( digitCount > 0 ) {
+        if ( shift == 0 ) {
+            writeDecimal(chars + charCount, magnitude);
+        } else {
+            writeBinary(
+                chars + charCount, magnitude, shift,
+                (spec->conversion == 'X') ? hexUpper : hexLower);
+        }
+    }
+    return(
+        writePadded(
+            target, spec, chars, charCount, prefixLength,
+            ((spec->flags & R3C_FORMAT_FLAG_ZERO) != 0) &&
+            (spec->precision < 0)) );
+}
+
+int r3cFormatDouble(char* target, const R3CFormatSpec* spec, double value) {
+#ifdef __SIZEOF_INT128__
+    char chars[CHAR_BUFFER_SIZE];
+    unsigned long long bits;
+    unsigned long long mantissa;
+    unsigned long long digits;
+    char* expPtr;
+    int binaryExp;
+    int decimalExp;
+    int log2Value;
+    int mantissaCount;
+    int precision;
+    int significant;
+    int prefixLength;
+    int charCount;
+    bool forcePoint;
+    char conversion;
+    char signChar;
+#ifndef R3C_NOERRCHECK
+    if ( spec == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( (spec->width > MAX_FIELD) || (spec->precision > MAX_POW5) ) {
+        return( -1 );
+    }
+    conversion = spec->conversion;
+    precision = (spec->precision < 0) ? 6 : spec->precision;
+    forcePoint = ((spec->flags & R3C_FORMAT_FLAG_ALT) != 0);
+
+    // Split the value into its sign, mantissa and binary exponent
+    memcpy(&bits, &value, sizeof(bits));
+    binaryExp = (int)((bits >> 52) & 0x7FF);
+    mantissa = bits & ((1ULL << 52) - 1);
+    if ( binaryExp == 0x7FF ) return( -1 );
+    if ( binaryExp == 0 ) {
+        binaryExp = -1074;
+    } else {
+        mantissa |= 1ULL << 52;
+        binaryExp -= 1075;
+    }
+    prefixLength = 0;
+    signChar = getSignChar(spec, (bits >> 63) != 0);
+    if ( signChar != '\0' ) chars[prefixLength++] = signChar;
+
+    switch ( conversion ) {
+        case 'f':
+        case 'F':
+            if ( !scaleDecimal(mantissa, binaryExp, precision, &digits) ) {
+                return( -1 );
+            }
+            charCount = prefixLength + writeFixed(
+                chars + prefixLength, digits, precision, forcePoint);
+            break;
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+            // Find the digits and exponent of the exponential form
+            significant = precision + 1;
+            if ( (conversion == 'g') || (conversion == 'G') ) {
+                significant = (precision == 0) ? 1 : precision;
+            }
+            if ( significant > MAX_SIGNIFICANT ) return( -1 );
+            // Estimate the exponent from the binary exponent, using
+            // 78913 / 2^18 as log10(2), then correct it
+            decimalExp = 0;
+            if ( mantissa != 0 ) {
+                log2Value = countBinary(mantissa, 1) + binaryExp - 1;
+                decimalExp = (int)((log2Value * 78913L) >> 18);
+            }
+            while ( true ) {
+                if (
+                    !scaleDecimal(
+                        mantissa, binaryExp, significant - 1 - decimalExp,
+                        &digits)
+                ) {
+                    return( -1 );
+                }
+                if ( digits >= pow10Table[significant] ) {
+                    decimalExp++;
+                } else if (
+                    (digits != 0) && (digits < pow10Table[significant - 1])
+                ) {
+                    decimalExp--;
+                } else {
+                    break;
+                }
+            }
+            if ( (conversion == 'e') || (conversion == 'E') ) {
+                charCount = prefixLength + writeExponent(
+                    chars + prefixLength, digits, significant, decimalExp,
+                    conversion, forcePoint);
+            } else if ( (decimalExp >= -4) && (decimalExp < significant) ) {
+                charCount = prefixLength + writeFixed(
+                    chars + prefixLength, digits,
+                    significant - 1 - decimalExp, forcePoint);
+                if ( !forcePoint ) {
+                    charCount = trimFraction(chars, charCount);
+                }
+            } else {
+                charCount = prefixLength + writeExponent(
+                    chars + prefixLength, digits, significant, decimalExp,
+                    (conversion == 'g') ? 'e' : 'E', forcePoint);
+                if ( !forcePoint ) {
+                    // Trim the zeros ahead of the exponent
+                    expPtr = (char*)memchr(
+                        chars, (conversion == 'g') ? 'e' : 'E', charCount);
+                    mantissaCount =
+                        trimFraction(chars, (int)(expPtr - chars));
+                    memmove(
+                        chars + mantissaCount, expPtr,
+                        charCount - (expPtr - chars));
+                    charCount -= (int)(expPtr - chars) - mantissaCount;
+                }
+            }
+            break;
+        default:
+            return( -1 );
+    }
+    return(
+        writePadded(
+            target, spec, chars, charCount, prefixLength,
+            (spec->flags & R3C_FORMAT_FLAG_ZERO) != 0) );
+#else
+    return( -1 );
+#endif
+}
+
+int r3cFormatPointer(
+    char* target, const R3CFormatSpec* spec, const void* value
+) {
+    char chars[CHAR_BUFFER_SIZE];
+    unsigned long long address;
+    int charCount;
+#ifndef R3C_NOERRCHECK
+    if ( spec == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if (
+        (spec->conversion != 'p') || (spec->width > MAX_FIELD) ||
+        (spec->precision >= 0) ||
+        ((spec->flags & ~R3C_FORMAT_FLAG_LEFT) != 0)
+    ) {
+        return( -1 );
+    }
+    address = (unsigned long long)(size_t)value;
+    if ( address == 0 ) {
+        memcpy(chars, "(nil)", 5);
+        charCount = 5;
+    } else {
+        chars[0] = '0';
+        chars[1] = 'x';
+        charCount = 2 + countBinary(address, 4);
+        writeBinary(chars + charCount, address, 4, hexLower);
+    }
+    return( writePadded(target, spec, chars, charCount, 0, false) );
+}
@@ -0,0 +1,291 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+
+#include <string.h>
+
+
+// *** PATTERN SEGMENTS *** //
+
+// Run of pattern characters between * wildcards.
+struct R3CPatternSegment {
+
+    // First character of the segment, within the pattern copy
+    const char* chars;
+
+    // Number of characters in the segment
+    int length;
+
+    // Flag indicating whether the segment contains a ? wildcard
+    bool hasQmark;
+
+    // For each character value, the bits of the segment positions that it
+    // matches; or NULL if the segment is not searched bit-parallel
+    unsigned long long* charMasks;
+
+};
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Checks if the given segment matches the characters at the given position,
+// which must have at least as many characters as the segment.
+static bool matchSegmentAt(const R3CPatternSegment* segment, const char* str) {
+    register int loop;
+    if ( !segment->hasQmark ) {
+        return( memcmp(str, segment->chars, segment->length) == 0 );
+    }
+    for ( loop = 0; loop < segment->length; loop++ ) {
+        if (
+            (segment->chars[loop] != '?') &&
+            (segment->chars[loop] != str[loop])
+        ) {
+            return( false );
+        }
+    }
+    return( true );
+}
+
+// Finds the earliest position, from startPtr, at which the given segment
+// matches without passing endPtr.  Returns NULL if there is none.
+static const char* findSegment(
+    const R3CPatternSegment* segment, const char* startPtr,
+    const char* endPtr
+) {
+    const char* lastPtr;
+    const char* charPtr;
+    unsigned long long state;
+    unsigned long long foundBit;
+    if ( (endPtr - startPtr) < segment->length ) return( NULL );
+    lastPtr = endPtr - segment->length;
+
+    // Literal segments use the C library's search
+    if ( !segment->hasQmark ) {
+#ifdef __GLIBC__
+        return( (const char*)memmem(
+            startPtr, endPtr - startPtr, segment->chars, segment->length) );
+#else
+        charPtr = startPtr;
+        while ( charPtr <= lastPtr ) {
+            charPtr = (const char*)memchr(
+                charPtr, segment->chars[0], (lastPtr - charPtr) + 1);
+            if ( charPtr == NULL ) return( NULL );
+            if ( matchSegmentAt(segment, charPtr) ) return( charPtr );
+            charPtr++;
+        }
+        return( NULL );
+#endif
+    }
+
+    // Segments with ? wildcards track every partial match at once, with one
+    // bit per segment position
+    if ( segment->charMasks != NULL ) {
+        state = 0;
+        foundBit = 1ULL << (segment->length - 1);
+        for ( charPtr = startPtr; charPtr < endPtr; charPtr++ ) {
+            state = ((state << 1) | 1) &
+                segment->charMasks[(unsigned char)*charPtr];
+            if ( (state & foundBit) != 0 ) {
+                return( charPtr - segment->length + 1 );
+            }
+        }
+        return( NULL );
+    }
+
+    // Long segments with ? wildcards are tried at each position
+    for ( charPtr = startPtr; charPtr <= lastPtr; charPtr++ ) {
+        if ( matchSegmentAt(segment, charPtr) ) return( charPtr );
+    }
+    return( NULL );
+}
+
+
+// *** CONSTRUCTION *** //
+
+// Creates a new pattern, which only matches the empty string.
+R3CPathPattern::R3CPathPattern() :
+    pattern(NULL),
+    segments(NULL),
+    segmentCount(0),
+    hasStar(false),
+    minLength(0)
+{
+    this->compile("");
+}
+
+// Creates a new pattern, compiled from the given filename pattern.
+R3CPathPattern::R3CPathPattern(const char* pattern) :
+    pattern(NULL),
+    segments(NULL),
+    segmentCount(0),
+    hasStar(false),
+    minLength(0)
+{
+    this->compile(pattern);
+}
+
+
+// *** DESTRUCTION *** //
+
+// Destructor.
+R3CPathPattern::~R3CPathPattern() {
+    int loop;
+    for ( loop = 0; loop < this->segmentCount; loop++ ) {
+        delete[] this->segments[loop].charMasks;
+    }
+    delete[] this->segments;
+    delete[] this->pattern;
+}
+
+
+// *** COMPILE PATTERN *** //
+
+// Replaces this pattern with one compiled from the given filename pattern.
+void R3CPathPattern::compile(const char* pattern) {
+    R3CPatternSegment* segment;
+    const char* charPtr;
+    int patternLength;
+    int starCount;
+    int loop;
+    int maskLoop;
+    int charLoop;
+#ifndef R3C_NOERRCHECK
+    if ( pattern == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    // Free the previous pattern
+    for ( loop = 0; loop < this->segmentCount; loop++ ) {
+        delete[] this->segments[loop].charMasks;
+    }
+    delete[] this->segments;
+    delete[] this->pattern;
+    this->segments = NULL;
+    this->segmentCount = 0;
+    this->pattern = NULL;
+
+    // Copy the pattern, and allow for a segment on either side of each *
+    patternLength = (int)strlen(pattern);
+    this->pattern = new char [patternLength + 1];
+    memcpy(this->pattern, pattern, patternLength + 1);
+    starCount = 0;
+    for ( loop = 0; loop < patternLength; loop++ ) {
+        if ( pattern[loop] == '*' ) starCount++;
+    }
+    this->segments = new R3CPatternSegment [starCount + 1];
+    this->hasStar = (starCount > 0);
+    this->minLength = patternLength - starCount;
+
+    // Split the pattern at each run of * wildcards.  Only the first and last
+    // segments may be empty.
+    charPtr = this->pattern;
+    while ( true ) {
+        segment = &this->segments[this->segmentCount];
+        segment->chars = charPtr;
+        segment->hasQmark = false;
+        segment->charMasks = NULL;
+        while ( (*charPtr != '*') && (*charPtr != '\0') ) {
+            if ( *charPtr == '?' ) segment->hasQmark = true;
+            charPtr++;
+        }
+        segment->length = (int)(charPtr - segment->chars);
+        if ( (segment->length > 0) || (this->segmentCount == 0) ) {
+            this->segmentCount++;
+        }
+        if ( *charPtr == '\0' ) break;
+        while ( *charPtr == '*' ) charPtr++;
+        if ( *charPtr == '\0' ) {
+            // A trailing * leaves an empty last segment
+            segment = &this->segments[this->segmentCount++];
+            segment->chars = charPtr;
+            segment->length = 0;
+            segment->hasQmark = false;
+            segment->charMasks = NULL;
+            break;
+        }
+    }
+
+    // Build the character masks for the segments that are searched
+    // bit-parallel; the first and last segments are only compared in place
+    for ( loop = 1; loop < (this->segmentCount - 1); loop++ ) {
+        segment = &this->segments[loop];
+        if (
+            !segment->hasQmark ||
+            (segment->length > R3C_PATTERN_MAXBITSEGMENT)
+        ) {
+            continue;
+        }
+        segment->charMasks = new unsigned long long [256];
+        memset(segment->charMasks, 0, 256 * sizeof(unsigned long long));
+        for ( maskLoop = 0; maskLoop < segment->length; maskLoop++ ) {
+            if ( segment->chars[maskLoop] == '?' ) continue;
+            segment->charMasks[(unsigned char)segment->chars[maskLoop]] |=
+                1ULL << maskLoop;
+        }
+        for ( maskLoop = 0; maskLoop < segment->length; maskLoop++ ) {
+            if ( segment->chars[maskLoop] != '?' ) continue;
+            for ( charLoop = 0; charLoop < 256; charLoop++ ) {
+                segment->charMasks[charLoop] |= 1ULL << maskLoop;
+            }
+        }
+    }
+}
+
+
+// *** RETRIEVE PATTERN INFO *** //
+
+// Retrieves the filename pattern that this pattern was compiled from.
+const char* R3CPathPattern::getPattern() {
+    return( this->pattern );
+}
+
+// Retrieves the number of characters that a matching string has, at least.
+int R3CPathPattern::getMinLength() {
+    return( this->minLength );
+}
+
+
+// *** MATCHING *** //
+
+// Checks if the given character string matches this pattern.
+bool R3CPathPattern::match(const char* str) {
+#ifndef R3C_NOERRCHECK
+    if ( str == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    return( this->match(str, (int)strlen(str)) );
+}
+
+// Checks if the given characters match this pattern.
+bool R3CPathPattern::match(const char* str, int strLength) {
+    R3CPatternSegment* lastSegment;
+    const char* charPtr;
+    const char* endPtr;
+    int loop;
+#ifndef R3C_NOERRCHECK
+    if ( (str == NULL) || (strLength < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( strLength < this->minLength ) return( false );
+    if ( !this->hasStar ) {
+        return(
+            (strLength == this->minLength) &&
+            matchSegmentAt(&this->segments[0], str) );
+    }
+
+    // Check the fixed prefix and suffix first, as they reject most strings;
+    // the length check above keeps them from overlapping
+    lastSegment = &this->segments[this->segmentCount - 1];
+    endPtr = str + strLength - lastSegment->length;
+    if (
+        !matchSegmentAt(&this->segments[0], str) ||
+        !matchSegmentAt(lastSegment, endPtr)
+    ) {
+        return( false );
+    }
+
+    // Find each segment between them in turn
+    charPtr = str + this->segments[0].length;
+    for ( loop = 1; loop < (this->segmentCount - 1); loop++ ) {
+        charPtr = findSegment(&this->segments[loop], charPtr, endPtr);
+        if ( charPtr == NULL ) return( false );
+        charPtr += this->segments[loop].length;
+    }
+    return( true );
+}
@@ -0,0 +1,589 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+
+#include <string.h>
+#include <sched.h>
+
+
+// *** CONSTANTS *** //
+
+// Number of patterns that memory is first allocated for
+#define INITIAL_ALLOC 16
+
+// Anchors of a literal run: it may occur anywhere in a string, or only at its
+// start, or only at its end, or it must be the whole string
+#define ANCHOR_NONE 0
+#define ANCHOR_START 1
+#define ANCHOR_END 2
+#define ANCHOR_WHOLE (ANCHOR_START | ANCHOR_END)
+
+// States of the automaton: out of date, being built by one thread, or up to
+// date
+#define PREPARE_NONE 0
+#define PREPARE_BUILDING 1
+#define PREPARE_DONE 2
+
+// Number of bits in each word of a match state
+#define BITS_PER_WORD ((int)(8 * sizeof(unsigned long)))
+
+// Number of words in a match state for the given number of patterns
+#define WORDS_FOR(count) (((count) + BITS_PER_WORD - 1) / BITS_PER_WORD)
+
+
+// *** PATTERN FRAGMENTS *** //
+
+// Literal run of a pattern that the automaton searches for.
+struct R3CPatternFragment {
+
+    // First character of the run, within the pattern's copy
+    const char* chars;
+
+    // Number of characters in the run, or 0 if the pattern has none
+    int length;
+
+    // Combination of ANCHOR_ constants
+    int anchor;
+
+    // Flag indicating whether finding the run (at its anchors) means that
+    // the pattern matches
+    bool isEnough;
+
+};
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Returns how strongly the given anchors narrow the search, for choosing
+// between runs of the same length; runs at the end are preferred, since
+// files that share a prefix are more common than files that share a suffix.
+static int rankAnchor(int anchor) {
+    switch ( anchor ) {
+        case ANCHOR_WHOLE: return( 3 );
+        case ANCHOR_END: return( 2 );
+        case ANCHOR_START: return( 1 );
+    }
+    return( 0 );
+}
+
+// Checks if the given characters are all * wildcards.
+static bool isAllStars(const char* str, int strLength) {
+    int loop;
+    for ( loop = 0; loop < strLength; loop++ ) {
+        if ( str[loop] != '*' ) return( false );
+    }
+    return( true );
+}
+
+// Chooses the literal run of the given pattern to search for: the longest
+// run, or the most strongly anchored of the longest runs.
+static void chooseFragment(const char* pattern, R3CPatternFragment* fragment) {
+    const char* charPtr;
+    const char* runPtr;
+    int runLength;
+    int anchor;
+    int patternLength;
+    fragment->chars = pattern;
+    fragment->length = 0;
+    fragment->anchor = ANCHOR_NONE;
+    fragment->isEnough = false;
+    charPtr = pattern;
+    while ( *charPtr != '\0' ) {
+        if ( (*charPtr == '*') || (*charPtr == '?') ) {
+            charPtr++;
+            continue;
+        }
+        runPtr = charPtr;
+        while (
+            (*charPtr != '\0') && (*charPtr != '*') && (*charPtr != '?')
+        ) {
+            charPtr++;
+        }
+        runLength = (int)(charPtr - runPtr);
+        anchor = ANCHOR_NONE;
+        if ( runPtr == pattern ) anchor |= ANCHOR_START;
+        if ( *charPtr == '\0' ) anchor |= ANCHOR_END;
+        if (
+            (runLength > fragment->length) ||
+            (
+                (runLength == fragment->length) &&
+                (rankAnchor(anchor) > rankAnchor(fragment->anchor))
+            )
+        ) {
+            fragment->chars = runPtr;
+            fragment->length = runLength;
+            fragment->anchor = anchor;
+        }
+    }
+
+    // An anchored run is enough when the rest of the pattern is only *
+    // wildcards, which match anything
+    patternLength = (int)(charPtr - pattern);
+    switch ( fragment->anchor ) {
+        case ANCHOR_WHOLE:
+            fragment->isEnough = true;
+            break;
+        case ANCHOR_START:
+            fragment->isEnough = isAllStars(
+                pattern + fragment->length, patternLength - fragment->length);
+            break;
+        case ANCHOR_END:
+            fragment->isEnough = isAllStars(
+                pattern, patternLength - fragment->length);
+            break;
+    }
+}
+
+// Checks if the given pattern is marked in the given match state.
+static bool isMarked(const unsigned long* bits, int patternId) {
+    return(
+        ((bits[patternId / BITS_PER_WORD] >> (patternId % BITS_PER_WORD)) &
+            1) != 0 );
+}
+
+// Returns the first pattern ID, from the given one, that is marked in either
+// of the given match states; or patternCount if there is none.
+static int nextMarked(
+    const unsigned long* matchBits, const unsigned long* checkBits,
+    int patternId, int patternCount
+) {
+    unsigned long word;
+    while ( patternId < patternCount ) {
+        word = (matchBits[patternId / BITS_PER_WORD] |
+            checkBits[patternId / BITS_PER_WORD]) >>
+            (patternId % BITS_PER_WORD);
+        if ( word == 0 ) {
+            // Skip the rest of the word at once
+            patternId += BITS_PER_WORD - (patternId % BITS_PER_WORD);
+            continue;
+        }
+        while ( (word & 1) == 0 ) {
+            word >>= 1;
+            patternId++;
+        }
+        return( patternId );
+    }
+    return( patternCount );
+}
+
+// Marks the given pattern in the given match state.
+static void mark(unsigned long* bits, int patternId) {
+    bits[patternId / BITS_PER_WORD] |= 1UL << (patternId % BITS_PER_WORD);
+}
+
+
+// *** CONSTRUCTION *** //
+
+// Creates a new, empty pattern set.
+R3CPathPatternSet::R3CPathPatternSet() :
+    patterns(NULL),
+    fragments(NULL),
+    patternCount(0),
+    patternsAlloc(0),
+    prepareState(PREPARE_NONE),
+    classCount(0),
+    stateCount(0),
+    transitions(NULL),
+    outputStates(NULL),
+    outputLinks(NULL),
+    outputStarts(NULL),
+    outputPatterns(NULL),
+    unfilteredPatterns(NULL),
+    unfilteredCount(0)
+{
+    memset(this->charClasses, 0, sizeof(this->charClasses));
+}
+
+
+// *** DESTRUCTION *** //
+
+// Destructor.
+R3CPathPatternSet::~R3CPathPatternSet() {
+    int loop;
+    this->freeAutomaton();
+    for ( loop = 0; loop < this->patternCount; loop++ ) {
+        delete this->patterns[loop];
+    }
+    delete[] this->patterns;
+    delete[] this->fragments;
+}
+
+
+// *** UPDATE SET *** //
+
+// Adds the given filename pattern to this set.
+int R3CPathPatternSet::add(const char* pattern) {
+    R3CPathPattern** newPatterns;
+    R3CPatternFragment* newFragments;
+    R3CPathPattern* newPattern;
+    int newAlloc;
+    int result;
+#ifndef R3C_NOERRCHECK
+    if ( pattern == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    newPattern = new R3CPathPattern(pattern);
+
+    // Make room for the pattern
+    if ( this->patternCount == this->patternsAlloc ) {
+        newAlloc = (this->patternsAlloc == 0) ?
+            INITIAL_ALLOC : (this->patternsAlloc * 2);
+        newPatterns = new R3CPathPattern* [newAlloc];
+        newFragments = new R3CPatternFragment [newAlloc];
+        if ( this->patternCount > 0 ) {
+            memcpy(
+                newPatterns, this->patterns,
+                this->patternCount * sizeof(R3CPathPattern*));
+            memcpy(
+                newFragments, this->fragments,
+                this->patternCount * sizeof(R3CPatternFragment));
+        }
+        delete[] this->patterns;
+        delete[] this->fragments;
+        this->patterns = newPatterns;
+        this->fragments = newFragments;
+        this->patternsAlloc = newAlloc;
+    }
+
+    // Add the pattern, and choose the run that the automaton looks for
+    result = this->patternCount++;
+    this->patterns[result] = newPattern;
+    chooseFragment(newPattern->getPattern(), &this->fragments[result]);
+    this->prepareState = PREPARE_NONE;
+    return( result );
+}
+
+// Builds the automaton for the patterns in this set, unless it is up to
+// date.  Only one thread builds it; any others wait for it.
+void R3CPathPatternSet::prepare() {
+    int expected;
+    while (
+        __atomic_load_n(&this->prepareState, __ATOMIC_ACQUIRE) !=
+        PREPARE_DONE
+    ) {
+        expected = PREPARE_NONE;
+        if (
+            __atomic_compare_exchange_n(
+                &this->prepareState, &expected, PREPARE_BUILDING, false,
+                __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)
+        ) {
+            try {
+                this->buildAutomaton();
+            } catch ( ... ) {
+                __atomic_store_n(
+                    &this->prepareState, PREPARE_NONE, __ATOMIC_RELEASE);
+                throw;
+            }
+            __atomic_store_n(
+                &this->prepareState, PREPARE_DONE, __ATOMIC_RELEASE);
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+// Builds the automaton for the patterns in this set.
+void R3CPathPatternSet::buildAutomaton() {
+    R3CPatternFragment* fragment;
+    int* endStates;
+    int* failStates;
+    int* queue;
+    int totalLength;
+    int state, nextState, charClass;
+    int queueHead, queueTail;
+    int loop, charLoop;
+    this->freeAutomaton();
+
+    // Give each character used by a run its own class, so that the
+    // transition table only needs a column for each of them
+    memset(this->charClasses, 0, sizeof(this->charClasses));
+    this->classCount = 1;
+    totalLength = 0;
+    for ( loop = 0; loop < this->patternCount; loop++ ) {
+        fragment = &this->fragments[loop];
+        for ( charLoop = 0; charLoop < fragment->length; charLoop++ ) {
+            charClass = (unsigned char)fragment->chars[charLoop];
+            if ( this->charClasses[charClass] == 0 ) {
+                this->charClasses[charClass] =
+                    (unsigned char)this->classCount++;
+            }
+        }
+        totalLength += fragment->length;
+    }
+
+    // Build a trie of the runs, noting the state at which each run ends
+    this->transitions = new int [(totalLength + 1) * this->classCount];
+    for ( loop = 0; loop < ((totalLength + 1) * this->classCount); loop++ ) {
+        this->transitions[loop] = -1;
+    }
+    this->stateCount = 1;
+    endStates = new int [this->patternCount + 1];
+    this->unfilteredPatterns = new int [this->patternCount + 1];
+    this->unfilteredCount = 0;
+    for ( loop = 0; loop < this->patternCount; loop++ ) {
+        fragment = &this->fragments[loop];
+        if ( fragment->length == 0 ) {
+            endStates[loop] = -1;
+            this->unfilteredPatterns[this->unfilteredCount++] = loop;
+            continue;
+        }
+        state = 0;
+        for ( charLoop = 0; charLoop < fragment->length; charLoop++ ) {
+            charClass = this->charClasses[
+                (unsigned char)fragment->chars[charLoop]];
+            nextState = this->transitions[
+                (state * this->classCount) + charClass];
+            if ( nextState == -1 ) {
+                nextState = this->stateCount++;
+                this->transitions[(state * this->classCount) + charClass] =
+                    nextState;
+            }
+            state = nextState;
+        }
+        endStates[loop] = state;
+    }
+
+    // Group the pattern IDs by the state at which their runs end, keeping
+    // them in order within each state
+    this->outputStarts = new int [this->stateCount + 1];
+    memset(this->outputStarts, 0, (this->stateCount + 1) * sizeof(int));
+    for ( loop = 0; loop < this->patternCount; loop++ ) {
+        if ( endStates[loop] != -1 ) this->outputStarts[endStates[loop] + 1]++;
+    }
+    for ( loop = 0; loop < this->stateCount; loop++ ) {
+        this->outputStarts[loop + 1] += this->outputStarts[loop];
+    }
+    this->outputPatterns =
+        new int [this->outputStarts[this->stateCount] + 1];
+    queue = new int [this->stateCount];
+    memcpy(queue, this->outputStarts, this->stateCount * sizeof(int));
+    for ( loop = 0; loop < this->patternCount; loop++ ) {
+        if ( endStates[loop] != -1 ) {
+            this->outputPatterns[queue[endStates[loop]]++] = loop;
+        }
+    }
+    delete[] endStates;
+
+    // Visit the states breadth first, so that each state's failure state
+    // (its longest proper suffix in the trie) is complete before it is
+    // used; missing transitions are taken from the failure state, which
+    // turns the trie into an automaton that never backs up
+    failStates = new int [this->stateCount];
+    this->outputStates = new int [this->stateCount];
+    this->outputLinks = new int [this->stateCount];
+    failStates[0] = 0;
+    this->outputStates[0] = -1;
+    this->outputLinks[0] = -1;
+    queueHead = 0;
+    queueTail = 0;
+    for ( charLoop = 0; charLoop < this->classCount; charLoop++ ) {
+        nextState = this->transitions[charLoop];
+        if ( nextState == -1 ) {
+            this->transitions[charLoop] = 0;
+        } else {
+            failStates[nextState] = 0;
+            queue[queueTail++] = nextState;
+        }
+    }
+    while ( queueHead < queueTail ) {
+        state = queue[queueHead++];
+        nextState = failStates[state];
+        this->outputLinks[state] = this->outputStates[nextState];
+        this->outputStates[state] = (
+            this->outputStarts[state] < this->outputStarts[state + 1]) ?
+            state : this->outputLinks[state];
+        for ( charLoop = 0; charLoop < this->classCount; charLoop++ ) {
+            loop = (state * this->classCount) + charLoop;
+            if ( this->transitions[loop] == -1 ) {
+                this->transitions[loop] = this->transitions[
+                    (nextState * this->classCount) + charLoop];
+            } else {
+                failStates[this->transitions[loop]] = this->transitions[
+                    (nextState * this->classCount) + charLoop];
+                queue[queueTail++] = this->transitions[loop];
+            }
+        }
+    }
+    delete[] failStates;
+    delete[] queue;
+}
+
+// Frees the automaton.
+void R3CPathPatternSet::freeAutomaton() {
+    delete[] this->transitions;
+    delete[] this->outputStates;
+    delete[] this->outputLinks;
+    delete[] this->outputStarts;
+    delete[] this->outputPatterns;
+    delete[] this->unfilteredPatterns;
+    this->transitions = NULL;
+    this->outputStates = NULL;
+    this->outputLinks = NULL;
+    this->outputStarts = NULL;
+    this->outputPatterns = NULL;
+    this->unfilteredPatterns = NULL;
+    this->unfilteredCount = 0;
+    this->stateCount = 0;
+}
+
+
+// *** RETRIEVE SET INFO *** //
+
+// Retrieves the number of patterns in this set.
+int R3CPathPatternSet::getPatternCount() {
+    return( this->patternCount );
+}
+
+// Retrieves the pattern with the given ID.
+R3CPathPattern* R3CPathPatternSet::getPattern(int patternId) {
+#ifndef R3C_NOERRCHECK
+    if ( (patternId < 0) || (patternId >= this->patternCount) ) {
+        throw R3CERR_OUTOFRANGE;
+    }
+#endif
+    return( this->patterns[patternId] );
+}
+
+
+// *** MATCHING *** //
+
+// Finds the first pattern that the given character string matches.
+int R3CPathPatternSet::matchFirst(const char* str) {
+#ifndef R3C_NOERRCHECK
+    if ( str == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    return( this->matchFirst(str, (int)strlen(str)) );
+}
+
+// Finds the first pattern that the given characters match.
+int R3CPathPatternSet::matchFirst(const char* str, int strLength) {
+    unsigned long localBits[WORDS_FOR(R3C_PATTERNSET_LOCALCOUNT) * 2];
+    unsigned long* matchBits;
+    unsigned long* checkBits;
+    int wordCount;
+    int result;
+    int loop;
+#ifndef R3C_NOERRCHECK
+    if ( (str == NULL) || (strLength < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->prepare();
+    wordCount = WORDS_FOR(this->patternCount);
+    matchBits = localBits;
+    if ( this->patternCount > R3C_PATTERNSET_LOCALCOUNT ) {
+        matchBits = new unsigned long [wordCount * 2];
+    }
+    checkBits = matchBits + wordCount;
+    memset(matchBits, 0, wordCount * 2 * sizeof(unsigned long));
+    this->findRuns(str, strLength, matchBits, checkBits);
+
+    // Take the lowest ID that matched, checking candidates in order
+    result = -1;
+    loop = nextMarked(matchBits, checkBits, 0, this->patternCount);
+    while ( loop < this->patternCount ) {
+        if (
+            isMarked(matchBits, loop) ||
+            this->patterns[loop]->match(str, strLength)
+        ) {
+            result = loop;
+            break;
+        }
+        loop = nextMarked(matchBits, checkBits, loop + 1, this->patternCount);
+    }
+    if ( matchBits != localBits ) delete[] matchBits;
+    return( result );
+}
+
+// Finds every pattern that the given characters match.
+int R3CPathPatternSet::matchAll(
+    const char* str, int strLength, int* patternIds, int maxIds
+) {
+    unsigned long localBits[WORDS_FOR(R3C_PATTERNSET_LOCALCOUNT) * 2];
+    unsigned long* matchBits;
+    unsigned long* checkBits;
+    int wordCount;
+    int result;
+    int loop;
+#ifndef R3C_NOERRCHECK
+    if (
+        (str == NULL) || (strLength < 0) || (maxIds < 0) ||
+        ((patternIds == NULL) && (maxIds > 0))
+    ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+#endif
+    this->prepare();
+    wordCount = WORDS_FOR(this->patternCount);
+    matchBits = localBits;
+    if ( this->patternCount > R3C_PATTERNSET_LOCALCOUNT ) {
+        matchBits = new unsigned long [wordCount * 2];
+    }
+    checkBits = matchBits + wordCount;
+    memset(matchBits, 0, wordCount * 2 * sizeof(unsigned long));
+    this->findRuns(str, strLength, matchBits, checkBits);
+
+    // Report each pattern that matched, checking candidates in order
+    result = 0;
+    loop = nextMarked(matchBits, checkBits, 0, this->patternCount);
+    while ( loop < this->patternCount ) {
+        if (
+            isMarked(matchBits, loop) ||
+            this->patterns[loop]->match(str, strLength)
+        ) {
+            if ( result < maxIds ) patternIds[result] = loop;
+            result++;
+        }
+        loop = nextMarked(matchBits, checkBits, loop + 1, this->patternCount);
+    }
+    if ( matchBits != localBits ) delete[] matchBits;
+    return( result );
+}
+
+// Finds the patterns whose runs occur in the given characters.
+void R3CPathPatternSet::findRuns(
+    const char* str, int strLength,
+    unsigned long* matchBits, unsigned long* checkBits
+) {
+    R3CPatternFragment* fragment;
+    int state;
+    int outState;
+    int patternId;
+    int pos;
+    int loop;
+
+    // Patterns without a run are always checked
+    for ( loop = 0; loop < this->unfilteredCount; loop++ ) {
+        mark(checkBits, this->unfilteredPatterns[loop]);
+    }
+
+    // Follow the automaton over the characters, and at each position, visit
+    // every run that ends there
+    state = 0;
+    for ( pos = 0; pos < strLength; pos++ ) {
+        state = this->transitions[(state * this->classCount) +
+            this->charClasses[(unsigned char)str[pos]]];
+        outState = this->outputStates[state];
+        while ( outState != -1 ) {
+            for (
+                loop = this->outputStarts[outState];
+                loop < this->outputStarts[outState + 1];
+                loop++
+            ) {
+                patternId = this->outputPatterns[loop];
+                fragment = &this->fragments[patternId];
+                if (
+                    ((fragment->anchor & ANCHOR_START) &&
+                        ((pos + 1) != fragment->length)) ||
+                    ((fragment->anchor & ANCHOR_END) &&
+                        ((pos + 1) != strLength))
+                ) {
+                    continue;
+                }
+                if ( fragment->isEnough ) {
+                    mark(matchBits, patternId);
+                } else {
+                    mark(checkBits, patternId);
+                }
+            }
+            outState = this->outputLinks[outState];
+        }
+    }
+}
@@ -0,0 +1,257 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+
+#include <string.h>
+
+
+// *** HELPER FUNCTIONS *** //
+
+// The path separator, as a view.
+static R3CStringView separatorView() {
+    return( R3CStringView(R3C_PATH_SEPARATORSTR, 1) );
+}
+
+
+// *** CONSTRUCTION *** //
+
+// Creates a new empty file or folder path string.
+R3CPathString::R3CPathString() :
+    R3CString()
+{
+}
+
+// Creates a new empty file or folder path string, with the given storage
+// capacity.
+R3CPathString::R3CPathString(int capacity) :
+    R3CString(capacity)
+{
+#ifndef R3C_NOERRCHECK
+    if ( capacity < 1 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+}
+
+// Creates a new file or folder path string, copied from the source character
+// string.
+R3CPathString::R3CPathString(const char* sourceStr) :
+    R3CString(sourceStr)
+{
+}
+
+// Creates a new file or folder path string, copied from the source string.
+R3CPathString::R3CPathString(R3CString* sourceStr) :
+    R3CString(sourceStr)
+{
+}
+
+// Creates a new file or folder path string, copied from the source directory
+// path and filename character strings.
+R3CPathString::R3CPathString(const char* dirPath, const char* filename) :
+    R3CString(dirPath)
+{
+    if ( filename != NULL ) this->appendPath(filename, false);
+}
+
+// Creates a new file or folder path string, copied from the source directory
+// path and filename strings.
+R3CPathString::R3CPathString(R3CString* dirPath, R3CString* filename) :
+    R3CString()
+{
+    if ( dirPath != NULL ) this->set(dirPath);
+    if ( filename != NULL ) this->appendPath(filename, false);
+}
+
+
+// *** UPDATE STRING *** //
+
+// Appends the source path character string to this string.
+void R3CPathString::appendPath(const char* path, bool trailingSlash) {
+    R3CStringView fragments[3];
+    int fragmentCount;
+    int pathLength;
+    bool endsInSeparator;
+#ifndef R3C_NOERRCHECK
+    if ( path == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    pathLength = (int)strlen(path);
+    endsInSeparator = (this->curLength > 0) &&
+        (this->str[this->curLength - 1] == R3C_PATH_SEPARATOR);
+
+    // Separate the path from this string, and end it with a separator if
+    // required, growing the string once
+    fragmentCount = 0;
+    if ( pathLength > 0 ) {
+        if (
+            (this->curLength > 0) && !endsInSeparator &&
+            (path[0] != R3C_PATH_SEPARATOR)
+        ) {
+            fragments[fragmentCount++] = separatorView();
+        }
+        fragments[fragmentCount++] = R3CStringView(path, pathLength);
+        endsInSeparator = (path[pathLength - 1] == R3C_PATH_SEPARATOR);
+    }
+    if ( trailingSlash && !endsInSeparator ) {
+        fragments[fragmentCount++] = separatorView();
+    }
+    this->appendAll(fragments, fragmentCount);
+}
+
+// Appends the source path string to this string.
+void R3CPathString::appendPath(R3CString* path, bool trailingSlash) {
+#ifndef R3C_NOERRCHECK
+    if ( path == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( path == this ) {
+        // The characters would move as this string grows
+        R3CString pathCopy(path);
+        this->appendPath(pathCopy.getChars(), trailingSlash);
+        return;
+    }
+    this->appendPath(path->getChars(), trailingSlash);
+}
+
+// Appends the given path components to this string, with a single path
+// separator between each pair.
+int R3CPathString::join(R3CStringView* components, int componentCount) {
+    R3CStringView localFragments[(R3C_PATH_LOCALJOIN * 2) + 1];
+    R3CStringView* fragments;
+    R3CStringView component;
+    int fragmentCount;
+    int result;
+    int loop;
+    bool isEmpty;
+    bool endsInSeparator;
+#ifndef R3C_NOERRCHECK
+    if (
+        (componentCount < 0) ||
+        ((components == NULL) && (componentCount > 0))
+    ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+#endif
+    fragments = localFragments;
+    if ( componentCount > R3C_PATH_LOCALJOIN ) {
+        fragments = new R3CStringView [(componentCount * 2) + 1];
+    }
+
+    // Gather each component, and a separator ahead of it where needed
+    fragmentCount = 0;
+    isEmpty = (this->curLength == 0);
+    endsInSeparator = !isEmpty &&
+        (this->str[this->curLength - 1] == R3C_PATH_SEPARATOR);
+    for ( loop = 0; loop < componentCount; loop++ ) {
+        if ( isEmpty ) {
+            // A leading separator is kept, so that absolute paths can be
+            // built from an empty string
+            component = components[loop].trimRight(R3C_PATH_SEPARATORSTR);
+            if (
+                component.isEmpty() && !components[loop].isEmpty() &&
+                (components[loop].getCharAt(0) == R3C_PATH_SEPARATOR)
+            ) {
+                fragments[fragmentCount++] = separatorView();
+                isEmpty = false;
+                endsInSeparator = true;
+                continue;
+            }
+        } else {
+            component = components[loop].trim(R3C_PATH_SEPARATORSTR);
+        }
+        if ( component.isEmpty() ) continue;
+        if ( !isEmpty && !endsInSeparator ) {
+            fragments[fragmentCount++] = separatorView();
+        }
+        fragments[fragmentCount++] = component;
+        isEmpty = false;
+        endsInSeparator = false;
+    }
+    try {
+        result = this->appendAll(fragments, fragmentCount);
+    } catch ( const char* ) {
+        if ( fragments != localFragments ) delete[] fragments;
+        throw;
+    }
+    if ( fragments != localFragments ) delete[] fragments;
+    return( result );
+}
+
+
+// *** RETRIEVE PATH COMPONENTS *** //
+
+// Retrieves the number of folders that make up this path string.
+int R3CPathString::getFolderCount() {
+    const char* charPtr;
+    const char* endPtr;
+    int result;
+    result = 0;
+    endPtr = this->str + this->curLength;
+    charPtr = this->str;
+    while ( charPtr < endPtr ) {
+        // Count each non-empty name that is followed by a separator
+        if (
+            (*charPtr == R3C_PATH_SEPARATOR) && (charPtr > this->str) &&
+            (charPtr[-1] != R3C_PATH_SEPARATOR)
+        ) {
+            result++;
+        }
+        charPtr++;
+    }
+    return( result );
+}
+
+// Retrieves the folder string at the given folder index within this path
+// string.
+void R3CPathString::getFolder(R3CString* targetStr, int folderIndex) {
+    const char* charPtr;
+    const char* endPtr;
+    const char* namePtr;
+    int curIndex;
+#ifndef R3C_NOERRCHECK
+    if ( targetStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+    if ( folderIndex < 0 ) throw R3CERR_OUTOFRANGE;
+#endif
+    curIndex = 0;
+    endPtr = this->str + this->curLength;
+    charPtr = this->str;
+    while ( charPtr < endPtr ) {
+        while ( *charPtr == R3C_PATH_SEPARATOR ) charPtr++;
+        namePtr = charPtr;
+        charPtr = r3cStrReachChar(charPtr, R3C_PATH_SEPARATOR);
+        if ( *charPtr == '\0' ) break;
+        if ( curIndex == folderIndex ) {
+            targetStr->set(namePtr, (int)(charPtr - namePtr));
+            return;
+        }
+        curIndex++;
+    }
+    throw R3CERR_OUTOFRANGE;
+}
+
+// Retrieves the full path string, not including the filename.
+void R3CPathString::getFolder(R3CString* targetStr) {
+    const char* separatorPtr;
+#ifndef R3C_NOERRCHECK
+    if ( targetStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    separatorPtr = strrchr(this->str, R3C_PATH_SEPARATOR);
+    if ( separatorPtr == NULL ) {
+        targetStr->clear();
+    } else {
+        targetStr->set(this->str, (int)(separatorPtr - this->str) + 1);
+    }
+}
+
+// Retrieves the filename from this path string.
+void R3CPathString::getFilename(R3CString* targetStr) {
+    const char* separatorPtr;
+#ifndef R3C_NOERRCHECK
+    if ( targetStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    separatorPtr = strrchr(this->str, R3C_PATH_SEPARATOR);
+    if ( separatorPtr == NULL ) {
+        targetStr->set(this->str, this->curLength);
+    } else {
+        targetStr->set(
+            separatorPtr + 1,
+            this->curLength - (int)(separatorPtr - this->str) - 1);
+    }
+}
@@ -4,29 +4,278 @@
 
 #include <string.h>
 #include <stdarg.h>
+#include <limits.h>
+#ifdef R3C_STR_THREADPOOL
+#include <pthread.h>
+#endif
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Returns how many of charCount characters, starting at startPos, are
+// available in sourceStr before its null-terminator.  Only the characters
+// up to the end of the requested range are examined.
+static int boundChars(const char* sourceStr, int startPos, int charCount) {
+    size_t availableLength;
+    if ( charCount <= 0 ) return( 0 );
+    availableLength =
+        strnlen(sourceStr, (size_t)startPos + (size_t)charCount);
+    if ( availableLength <= (size_t)startPos ) return( 0 );
+    return( (int)(availableLength - startPos) );
+}
+
+// Returns the offset of the given characters within the given string
+// storage, or -1 if they are not a part of it.  Characters that are a part
+// of a string must be found again by their offset once the string grows, as
+// its storage may have moved.
+static int findOffset(const char* chars, const char* storage, int maxLength) {
+    if ( (chars < storage) || (chars > (storage + maxLength)) ) return( -1 );
+    return( (int)(chars - storage) );
+}
+
+// Returns where the given characters are now, if they were a part of the
+// string storage at oldStorage before it grew into newStorage.  The old
+// storage is only compared with, never read.
+static const char* followChars(
+    const char* chars, const char* oldStorage, int oldMaxLength,
+    const char* newStorage
+) {
+    int offset;
+    offset = findOffset(chars, oldStorage, oldMaxLength);
+    if ( offset < 0 ) return( chars );
+    return( newStorage + offset );
+}
+
+
+// *** THREAD STORAGE CACHE *** //
+
+#ifdef R3C_STR_THREADPOOL
+
+// Size of the smallest cached buffer, as a power of 2
+#define CACHE_MIN_SHIFT 6
+
+// Number of cached buffer sizes, doubling from 64 bytes
+#define CACHE_CLASS_COUNT 7
+
+// Size of the largest cached buffer
+#define CACHE_MAX_SIZE (1 << (CACHE_MIN_SHIFT + CACHE_CLASS_COUNT - 1))
+
+// Buffers freed by the strings of one thread, by size class.  Each free
+// buffer holds a pointer to the next.
+struct R3CStringCache {
+    char* freeLists[CACHE_CLASS_COUNT];
+    int freeCounts[CACHE_CLASS_COUNT];
+    R3CStringCacheStats stats;
+};
+
+// Key through which each thread's cache is freed when the thread exits
+static pthread_key_t cacheKey;
+static pthread_once_t cacheKeyOnce = PTHREAD_ONCE_INIT;
+
+// Cache of the current thread, or NULL if it has not been created
+static __thread R3CStringCache* threadCache = NULL;
+
+// Returns the size class for the given number of bytes, or CACHE_CLASS_COUNT
+// if the buffer is too large to be cached.
+static int getCacheClass(int byteCount) {
+    int result;
+    if ( byteCount > CACHE_MAX_SIZE ) return( CACHE_CLASS_COUNT );
+    result = 0;
+    while ( byteCount > (1 << (CACHE_MIN_SHIFT + result)) ) result++;
+    return( result );
+}
+
+// Returns all buffers in the given cache to the heap.
+static void emptyCache(R3CStringCache* cache) {
+    char* buffer;
+    char* nextBuffer;
+    int loop;
+    for ( loop = 0; loop < CACHE_CLASS_COUNT; loop++ ) {
+        buffer = cache->freeLists[loop];
+        while ( buffer != NULL ) {
+            memcpy(&nextBuffer, buffer, sizeof(nextBuffer));
+            delete[] buffer;
+            buffer = nextBuffer;
+        }
+        cache->freeLists[loop] = NULL;
+        cache->freeCounts[loop] = 0;
+    }
+    cache->stats.cachedBytes = 0;
+}
+
+// Frees the cache of a thread that is exiting.
+static void destroyCache(void* cache) {
+    emptyCache((R3CStringCache*)cache);
+    delete (R3CStringCache*)cache;
+    threadCache = NULL;
+}
+
+// Creates the key through which caches are freed.
+static void createCacheKey() {
+    pthread_key_create(&cacheKey, destroyCache);
+}
+
+// Returns the cache of the current thread, creating it if necessary.
+static R3CStringCache* getCache() {
+    if ( threadCache == NULL ) {
+        pthread_once(&cacheKeyOnce, createCacheKey);
+        threadCache = new R3CStringCache;
+        memset(threadCache, 0, sizeof(R3CStringCache));
+        pthread_setspecific(cacheKey, threadCache);
+    }
+    return( threadCache );
+}
+
+// Returns the number of bytes provided when the given number is requested,
+// so that buffers are always the full size of their class.
+static int fitCacheSize(int byteCount) {
+    int sizeClass;
+    sizeClass = getCacheClass(byteCount);
+    if ( sizeClass == CACHE_CLASS_COUNT ) return( byteCount );
+    return( 1 << (CACHE_MIN_SHIFT + sizeClass) );
+}
+
+// Allocates a buffer, reusing a cached buffer of the same class if possible.
+static char* allocCached(int byteCount) {
+    R3CStringCache* cache;
+    char* result;
+    int sizeClass;
+    sizeClass = getCacheClass(byteCount);
+    if ( sizeClass == CACHE_CLASS_COUNT ) return( new char [byteCount] );
+    cache = getCache();
+    result = cache->freeLists[sizeClass];
+    if ( result == NULL ) {
+        cache->stats.misses++;
+        return( new char [1 << (CACHE_MIN_SHIFT + sizeClass)] );
+    }
+    memcpy(&cache->freeLists[sizeClass], result, sizeof(char*));
+    cache->freeCounts[sizeClass]--;
+    cache->stats.hits++;
+    cache->stats.cachedBytes -= 1 << (CACHE_MIN_SHIFT + sizeClass);
+    return( result );
+}
+
+// Frees a buffer into the cache, unless it is not exactly the size of a
+// class, or the cache for its class is full.
+static void freeCached(char* buffer, int byteCount) {
+    R3CStringCache* cache;
+    int sizeClass;
+    sizeClass = getCacheClass(byteCount);
+    if (
+        (sizeClass == CACHE_CLASS_COUNT) ||
+        (byteCount != (1 << (CACHE_MIN_SHIFT + sizeClass)))
+    ) {
+        delete[] buffer;
+        return;
+    }
+    cache = getCache();
+    if ( cache->freeCounts[sizeClass] >= R3C_STR_CACHECOUNT ) {
+        cache->stats.discarded++;
+        delete[] buffer;
+        return;
+    }
+    memcpy(buffer, &cache->freeLists[sizeClass], sizeof(char*));
+    cache->freeLists[sizeClass] = buffer;
+    cache->freeCounts[sizeClass]++;
+    cache->stats.recycled++;
+    cache->stats.cachedBytes += byteCount;
+}
+
+#endif
+
+// Retrieves the statistics of the string storage cache of the current
+// thread.
+void r3cStrGetCacheStats(R3CStringCacheStats *stats) {
+#ifndef R3C_NOERRCHECK
+    if ( stats == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+#ifdef R3C_STR_THREADPOOL
+    *stats = getCache()->stats;
+#else
+    memset(stats, 0, sizeof(R3CStringCacheStats));
+#endif
+}
+
+// Returns all storage held by the string storage cache of the current thread
+// to the heap.
+void r3cStrClearCache() {
+#ifdef R3C_STR_THREADPOOL
+    if ( threadCache != NULL ) emptyCache(threadCache);
+#endif
+}
 
 
 // *** CONSTRUCTION *** //
 
-// Initializes the storage capacity.
+// Initializes the storage capacity, and points the character string at
+// either the local storage or newly allocated storage.
 void R3CString::initMaxLength(int capacity) {
-	int remainder;
-	this->maxLength = capacity;
-	if ( this->maxLength < 127 ) {
-		this->maxLength = 127;
-	} else {
-		remainder = this->maxLength % 64;
-		this->maxLength += 64 - remainder - 1;
-	}
+    int remainder;
+    if ( capacity < R3C_STR_LOCALSIZE ) {
+        this->maxLength = R3C_STR_LOCALSIZE - 1;
+        this->str = this->localStr;
+    } else {
+        remainder = capacity % 64;
+        this->maxLength = this->fitCapacity(capacity + 64 - remainder - 1);
+        this->str = this->allocStorage(this->maxLength);
+    }
+}
+
+// Returns the storage capacity that is actually provided when storage is
+// allocated for the given capacity.
+int R3CString::fitCapacity(int capacity) {
+#ifdef R3C_STR_THREADPOOL
+    if ( this->allocator == NULL ) return( fitCacheSize(capacity + 1) - 1 );
+#else
+    if ( this->allocator == NULL ) return( capacity );
+#endif
+    return( this->allocator->getUsableSize(capacity + 1) - 1 );
+}
+
+// Allocates storage for a string of up to the given length.
+char* R3CString::allocStorage(int capacity) {
+#ifdef R3C_STR_THREADPOOL
+    if ( this->allocator == NULL ) return( allocCached(capacity + 1) );
+#else
+    if ( this->allocator == NULL ) return( new char [capacity + 1] );
+#endif
+    return( this->allocator->allocate(capacity + 1) );
+}
+
+// Frees the given storage, unless it is the local storage.
+void R3CString::freeStorage(char* storage, int capacity) {
+    if ( storage == this->localStr ) return;
+    if ( this->allocator == NULL ) {
+#ifdef R3C_STR_THREADPOOL
+        freeCached(storage, capacity + 1);
+#else
+        delete[] storage;
+#endif
+    } else {
+        this->allocator->deallocate(storage, capacity + 1);
+    }
 }
 
 // Creates a new empty string.
 R3CString::R3CString() :
     str(NULL),
     curLength(0),
-    maxLength(127)
+    maxLength(R3C_STR_LOCALSIZE - 1),
+    allocator(NULL)
 {
-    this->str = new char [128];
+    this->str = this->localStr;
+    this->str[0] = '\0';
+}
+
+// Creates a new empty string, which takes its storage from the given
+// allocator.
+R3CString::R3CString(R3CAllocator *allocator) :
+    str(NULL),
+    curLength(0),
+    maxLength(R3C_STR_LOCALSIZE - 1),
+    allocator(allocator)
+{
+    this->str = this->localStr;
     this->str[0] = '\0';
 }
 
@@ -34,12 +283,28 @@ R3CString::R3CString() :
 R3CString::R3CString(int capacity) :
     str(NULL),
     curLength(0),
-    maxLength(127)
+    maxLength(0),
+    allocator(NULL)
+{
+#ifndef R3C_NOERRCHECK
+    if ( capacity < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->initMaxLength(capacity);
+    this->str[0] = '\0';
+}
+
+// Creates a new empty string, with the given storage capacity, which takes
+// its storage from the given allocator.
+R3CString::R3CString(int capacity, R3CAllocator *allocator) :
+    str(NULL),
+    curLength(0),
+    maxLength(0),
+    allocator(allocator)
 {
 #ifndef R3C_NOERRCHECK
     if ( capacity < 0 ) throw R3CERR_ILLEGALARGUMENT;
 #endif
-    this->str = new char [this->maxLength + 1];
+    this->initMaxLength(capacity);
     this->str[0] = '\0';
 }
 
@@ -47,15 +312,15 @@ R3CString::R3CString(int capacity) :
 R3CString::R3CString(const char* sourceStr) :
     str(NULL),
     curLength(0),
-    maxLength(127)
+    maxLength(0),
+    allocator(NULL)
 {
     if ( sourceStr != NULL ) {
         this->curLength = (int)strlen(sourceStr);
-        this->initMaxLength(this->curLength);
     }
-    this->str = new char [this->maxLength + 1];
+    this->initMaxLength(this->curLength);
     if ( sourceStr != NULL ) {
-        strcpy(this->str, sourceStr);
+        memcpy(this->str, sourceStr, this->curLength + 1);
     } else {
         this->str[0] = '\0';
     }
@@ -66,7 +331,8 @@ R3CString::R3CString(const char* sourceStr) :
 R3CString::R3CString(const char* sourceStr, int capacity) :
     str(NULL),
     curLength(0),
-    maxLength(capacity)
+    maxLength(capacity),
+    allocator(NULL)
 {
 #ifndef R3C_NOERRCHECK
     if ( capacity < 0 ) throw R3CERR_ILLEGALARGUMENT;
@@ -77,9 +343,15 @@ R3CString::R3CString(const char* sourceStr, int capacity) :
     if ( capacity < this->curLength ) {
         this->maxLength = this->curLength;
     }
-    this->str = new char [this->maxLength + 1];
+    if ( this->maxLength < R3C_STR_LOCALSIZE ) {
+        this->maxLength = R3C_STR_LOCALSIZE - 1;
+        this->str = this->localStr;
+    } else {
+        this->maxLength = this->fitCapacity(this->maxLength);
+        this->str = this->allocStorage(this->maxLength);
+    }
     if ( sourceStr != NULL ) {
-        strcpy(this->str, sourceStr);
+        memcpy(this->str, sourceStr, this->curLength + 1);
     } else {
         this->str[0] = '\0';
     }
@@ -89,23 +361,134 @@ R3CString::R3CString(const char* sourceStr, int capacity) :
 R3CString::R3CString(R3CString *sourceStr) :
     str(NULL),
     curLength(0),
-    maxLength(0)
+    maxLength(0),
+    allocator(NULL)
 {
 #ifndef R3C_NOERRCHECK
     if ( sourceStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
 #endif
-    this->str = new char [sourceStr->maxLength + 1];
-    strcpy(this->str, sourceStr->str);
+    this->initMaxLength(sourceStr->curLength);
+    memcpy(this->str, sourceStr->str, sourceStr->curLength + 1);
     this->curLength = sourceStr->curLength;
-    this->maxLength = sourceStr->maxLength;
 }
 
 
+#if __cplusplus >= 201103L
+// Creates a new string, taking over the storage of the source string.
+R3CString::R3CString(R3CString&& sourceStr) noexcept :
+    str(NULL),
+    curLength(0),
+    maxLength(R3C_STR_LOCALSIZE - 1),
+    allocator(NULL)
+{
+    this->str = this->localStr;
+    this->str[0] = '\0';
+    this->swap(&sourceStr);
+}
+
+// Replaces this string, taking over the storage of the source string.
+R3CString& R3CString::operator=(R3CString&& sourceStr) noexcept {
+    if ( &sourceStr != this ) {
+        // This string's allocator is dropped with its storage, so that the
+        // source string is left on the heap, as after a move construction
+        this->freeStorage(this->str, this->maxLength);
+        this->str = this->localStr;
+        this->str[0] = '\0';
+        this->curLength = 0;
+        this->maxLength = R3C_STR_LOCALSIZE - 1;
+        this->allocator = NULL;
+        this->swap(&sourceStr);
+    }
+    return( *this );
+}
+#endif
+
+
 // *** DESTRUCTION *** //
 
 // Destructor.
 R3CString::~R3CString() {
-    if ( this->str != NULL ) delete[] this->str;
+    this->freeStorage(this->str, this->maxLength);
+}
+
+
+// *** TRANSFER STORAGE *** //
+
+// Exchanges the contents of this string and the given string.
+void R3CString::swap(R3CString *otherStr) {
+    char tempLocal[R3C_STR_LOCALSIZE];
+    char* tempStr;
+    R3CAllocator* tempAllocator;
+    int tempLength;
+    bool thisLocal;
+    bool otherLocal;
+#ifndef R3C_NOERRCHECK
+    if ( otherStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( otherStr == this ) return;
+    thisLocal = (this->str == this->localStr);
+    otherLocal = (otherStr->str == otherStr->localStr);
+
+    // Local storage is small enough to be exchanged by copying, after which
+    // any string that was stored locally is pointed at its new owner
+    memcpy(tempLocal, this->localStr, R3C_STR_LOCALSIZE);
+    memcpy(this->localStr, otherStr->localStr, R3C_STR_LOCALSIZE);
+    memcpy(otherStr->localStr, tempLocal, R3C_STR_LOCALSIZE);
+    tempStr = this->str;
+    this->str = otherLocal ? this->localStr : otherStr->str;
+    otherStr->str = thisLocal ? otherStr->localStr : tempStr;
+    tempLength = this->curLength;
+    this->curLength = otherStr->curLength;
+    otherStr->curLength = tempLength;
+    tempLength = this->maxLength;
+    this->maxLength = otherStr->maxLength;
+    otherStr->maxLength = tempLength;
+    tempAllocator = this->allocator;
+    this->allocator = otherStr->allocator;
+    otherStr->allocator = tempAllocator;
+}
+
+// Releases the character string to the caller.
+char* R3CString::release() {
+    char* releaseStr;
+    if ( (this->str == this->localStr) || (this->allocator != NULL) ) {
+        releaseStr = new char [this->curLength + 1];
+        memcpy(releaseStr, this->str, this->curLength + 1);
+        this->freeStorage(this->str, this->maxLength);
+    } else {
+        releaseStr = this->str;
+    }
+    this->str = this->localStr;
+    this->str[0] = '\0';
+    this->curLength = 0;
+    this->maxLength = R3C_STR_LOCALSIZE - 1;
+    return( releaseStr );
+}
+
+// Replaces this string with the given character string, taking ownership of
+// it.
+void R3CString::adopt(char *buffer, int length, int capacity) {
+#ifndef R3C_NOERRCHECK
+    if ( (buffer == NULL) || (length < 0) || (capacity < length) ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+#endif
+    if ( this->allocator != NULL ) {
+        // The buffer did not come from the allocator, so it is copied
+        try {
+            this->set(buffer, length);
+        } catch ( const char* ) {
+            delete[] buffer;
+            throw;
+        }
+        delete[] buffer;
+        return;
+    }
+    if ( this->str != buffer ) this->freeStorage(this->str, this->maxLength);
+    this->str = buffer;
+    this->str[length] = '\0';
+    this->curLength = length;
+    this->maxLength = capacity;
 }
 
 
@@ -126,6 +509,16 @@ int R3CString::getCapacity() {
 	return( this->maxLength );
 }
 
+// Returns the allocator this string takes its storage from.
+R3CAllocator* R3CString::getAllocator() {
+    return( this->allocator );
+}
+
+// Returns a view of the current contents of this string.
+R3CStringView R3CString::getView() {
+    return( R3CStringView(this->str, this->curLength) );
+}
+
 
 // *** FINDING SUB-STRINGS *** //
 
@@ -209,6 +602,11 @@ int R3CString::compare(R3CString *str) {
     return( result );
 }
 
+// Compares this string to the given view.
+int R3CString::compare(R3CStringView view) {
+    return( this->getView().compare(view) );
+}
+
 // Checks if this string matches the given filename pattern.
 bool R3CString::pathMatch(const char* pattern) {
     return( r3cPathMatch(this->str, pattern) );
@@ -220,16 +618,18 @@ bool R3CString::pathMatch(const char* pattern) {
 // Ensures the storage capacity can handle a string of the given length.
 void R3CString::ensureCapacity(int newLength) {
 	int remainder;
-	char* oldPtr;
+	int newMaxLength;
+	char* newPtr;
 	if ( newLength <= this->maxLength ) return;
-	this->maxLength = this->maxLength << 1;
-	if ( this->maxLength < newLength ) this->maxLength = newLength;
-	remainder = this->maxLength % 16;
-	this->maxLength += 16 - remainder - 1;
-	oldPtr = this->str;
-	this->str = new char[this->maxLength + 1];
-	strcpy(this->str, oldPtr);
-	delete[] oldPtr;
+	newMaxLength = this->maxLength << 1;
+	if ( newMaxLength < newLength ) newMaxLength = newLength;
+	remainder = newMaxLength % 16;
+	newMaxLength = this->fitCapacity(newMaxLength + 16 - remainder - 1);
+	newPtr = this->allocStorage(newMaxLength);
+	memcpy(newPtr, this->str, this->curLength + 1);
+	this->freeStorage(this->str, this->maxLength);
+	this->str = newPtr;
+	this->maxLength = newMaxLength;
 }
 
 // Resets the length of the string, based on the actual character string
@@ -239,17 +639,48 @@ int R3CString::resetLength() {
 	return( this->curLength );
 }
 
+// Extends this string by charCount characters, to be filled in by the
+// caller.
+char* R3CString::appendSpace(int charCount) {
+    char* result;
+#ifndef R3C_NOERRCHECK
+    if ( charCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->ensureCapacity(this->curLength + charCount);
+    result = this->str + this->curLength;
+    this->curLength += charCount;
+    this->str[this->curLength] = '\0';
+    return( result );
+}
+
 // Replaces this string with the source character string.
 int R3CString::set(const char* sourceStr) {
-	int newStrLength;
 	if ( sourceStr == NULL ) {
 		this->clear();
-	} else {
-		newStrLength = (int)strlen(sourceStr);
-		this->ensureCapacity(newStrLength);
-		strcpy(this->str, sourceStr);
-		this->curLength = newStrLength;
+		return( 0 );
 	}
+    return( this->set(sourceStr, (int)strlen(sourceStr)) );
+}
+
+// Replaces this string with charCount characters from sourceChars.
+int R3CString::set(const char* sourceChars, int charCount) {
+    int sourceOffset;
+#ifndef R3C_NOERRCHECK
+    if ( charCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( sourceChars == NULL ) {
+        this->clear();
+        return( 0 );
+    }
+
+    // The source characters may be a part of this string, and must be found
+    // again if the string grows
+    sourceOffset = findOffset(sourceChars, this->str, this->maxLength);
+    this->ensureCapacity(charCount);
+    if ( sourceOffset >= 0 ) sourceChars = this->str + sourceOffset;
+    memmove(this->str, sourceChars, charCount);
+    this->str[charCount] = '\0';
+    this->curLength = charCount;
     return( this->curLength );
 }
 
@@ -258,12 +689,18 @@ int R3CString::set(R3CString* sourceStr) {
 #ifndef R3C_NOERRCHECK
     if ( sourceStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
 #endif
+    if ( sourceStr == this ) return( this->curLength );
 	this->ensureCapacity(sourceStr->curLength);
-	strcpy(this->str, sourceStr->str);
+	memcpy(this->str, sourceStr->str, sourceStr->curLength + 1);
 	this->curLength = sourceStr->curLength;
     return( this->curLength );
 }
 
+// Replaces this string with the characters of the source view.
+int R3CString::set(R3CStringView sourceView) {
+    return( this->set(sourceView.getChars(), sourceView.getLength()) );
+}
+
 // Appends the given character to the end of this string.
 int R3CString::append(char charToAppend) {
     register char* charPtr;
@@ -281,34 +718,40 @@ int R3CString::append(char charToAppend) {
 
 // Appends the source character string to the end of this string.
 int R3CString::append(const char* sourceStr) {
-	int sourceStrLength;
-	char* appendPtr;
 	if ( sourceStr == NULL ) return( 0 );
-	sourceStrLength = (int)strlen(sourceStr);
-	this->ensureCapacity(this->curLength + sourceStrLength);
-	appendPtr = this->str + this->curLength;
-	strcpy(appendPtr, sourceStr);
-	this->curLength += sourceStrLength;
-    return( sourceStrLength );
+    return( this->append(sourceStr, (int)strlen(sourceStr)) );
+}
+
+// Appends charCount characters from sourceChars to the end of this string.
+int R3CString::append(const char* sourceChars, int charCount) {
+    char* appendPtr;
+    int sourceOffset;
+#ifndef R3C_NOERRCHECK
+    if ( charCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( sourceChars == NULL ) return( 0 );
+
+    // The source characters may be a part of this string, and must be found
+    // again if the string grows
+    sourceOffset = findOffset(sourceChars, this->str, this->maxLength);
+    this->ensureCapacity(this->curLength + charCount);
+    if ( sourceOffset >= 0 ) sourceChars = this->str + sourceOffset;
+    appendPtr = this->str + this->curLength;
+    memmove(appendPtr, sourceChars, charCount);
+    appendPtr[charCount] = '\0';
+    this->curLength += charCount;
+    return( charCount );
 }
 
 // Appends charCount characters, starting at startPos, from sourceStr into
 // this string.
 int R3CString::append(const char* sourceStr, int startPos, int charCount) {
-	int sourceStrLength;
-	char* appendPtr;
+#ifndef R3C_NOERRCHECK
+    if ( startPos < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
 	if ( sourceStr == NULL ) return( 0 );
-	sourceStrLength = (int)strlen(sourceStr);
-    if ( (startPos + charCount) > sourceStrLength ) {
-        charCount = sourceStrLength - startPos;
-    }
-	this->ensureCapacity(this->curLength + charCount);
-	appendPtr = this->str + this->curLength;
-	strncpy(appendPtr, sourceStr + startPos, charCount);
-	appendPtr += charCount;
-	*appendPtr = '\0';
-	this->curLength += charCount;
-    return( charCount );
+    charCount = boundChars(sourceStr, startPos, charCount);
+    return( this->append(sourceStr + startPos, charCount) );
 }
 
 // Appends the source string to the end of this string.
@@ -321,45 +764,129 @@ int R3CString::append(R3CString* sourceStr) {
     sourceStrLength = sourceStr->curLength;
 	this->ensureCapacity(this->curLength + sourceStrLength);
 	appendPtr = this->str + this->curLength;
-	strcpy(appendPtr, sourceStr->str);
+	memcpy(appendPtr, sourceStr->str, sourceStrLength);
+	appendPtr[sourceStrLength] = '\0';
 	this->curLength += sourceStrLength;
     return( sourceStrLength );
 }
 
+// Appends the characters of the source view to the end of this string.
+int R3CString::append(R3CStringView sourceView) {
+    return( this->append(sourceView.getChars(), sourceView.getLength()) );
+}
+
+// Appends every fragment, in order, to the end of this string.
+int R3CString::appendAll(R3CStringView* fragments, int fragmentCount) {
+    const char* oldStr;
+    char* appendPtr;
+    int oldMaxLength;
+    int totalLength;
+    int fragmentLength;
+    int loop;
+#ifndef R3C_NOERRCHECK
+    if (
+        (fragmentCount < 0) || ((fragments == NULL) && (fragmentCount > 0))
+    ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+#endif
+    // Measure the fragments, so that the string only has to grow once
+    totalLength = 0;
+    for ( loop = 0; loop < fragmentCount; loop++ ) {
+        fragmentLength = fragments[loop].getLength();
+        if ( fragmentLength > (INT_MAX - this->curLength - totalLength) ) {
+            throw R3CERR_OUTOFRANGE;
+        }
+        totalLength += fragmentLength;
+    }
+    oldStr = this->str;
+    oldMaxLength = this->maxLength;
+    appendPtr = this->appendSpace(totalLength);
+    for ( loop = 0; loop < fragmentCount; loop++ ) {
+        fragmentLength = fragments[loop].getLength();
+        if ( fragmentLength > 0 ) {
+            memcpy(
+                appendPtr,
+                followChars(
+                    fragments[loop].getChars(), oldStr, oldMaxLength,
+                    this->str),
+                fragmentLength);
+            appendPtr += fragmentLength;
+        }
+    }
+    return( totalLength );
+}
+
+// Appends every fragment, in order, to the end of this string, with the
+// delimiter character between each pair of fragments.
+int R3CString::appendAll(
+    R3CStringView* fragments, int fragmentCount, char delimiter
+) {
+    const char* oldStr;
+    char* appendPtr;
+    int oldMaxLength;
+    int totalLength;
+    int fragmentLength;
+    int loop;
+#ifndef R3C_NOERRCHECK
+    if (
+        (fragmentCount < 0) || ((fragments == NULL) && (fragmentCount > 0))
+    ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+    if ( delimiter == '\0' ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( fragmentCount == 0 ) return( 0 );
+    totalLength = fragmentCount - 1;
+    if ( totalLength > (INT_MAX - this->curLength) ) throw R3CERR_OUTOFRANGE;
+    for ( loop = 0; loop < fragmentCount; loop++ ) {
+        fragmentLength = fragments[loop].getLength();
+        if ( fragmentLength > (INT_MAX - this->curLength - totalLength) ) {
+            throw R3CERR_OUTOFRANGE;
+        }
+        totalLength += fragmentLength;
+    }
+    oldStr = this->str;
+    oldMaxLength = this->maxLength;
+    appendPtr = this->appendSpace(totalLength);
+    for ( loop = 0; loop < fragmentCount; loop++ ) {
+        if ( loop > 0 ) *appendPtr++ = delimiter;
+        fragmentLength = fragments[loop].getLength();
+        if ( fragmentLength > 0 ) {
+            memcpy(
+                appendPtr,
+                followChars(
+                    fragments[loop].getChars(), oldStr, oldMaxLength,
+                    this->str),
+                fragmentLength);
+            appendPtr += fragmentLength;
+        }
+    }
+    return( totalLength );
+}
+
 // Appends the formatted string to the end of this string.
 int R3CString::appendf(const char* formatString, ...) {
-	R3CFormatParser formatter;
 	va_list varArgs;
-	int loop;
-    if ( formatString == NULL ) return( 0 );
-	formatter.parse(formatString);
+	int result;
 	va_start(varArgs, formatString);
-    for ( loop = 0; loop < formatter.getPieceCount(); loop++ ) {
-        switch ( formatter.getPieceType(loop) ) {
-            case R3C_FORMAT_LITERAL:
-                formatter.appendLiteral(this, loop);
-                break;
-            case R3C_FORMAT_INT:
-                formatter.appendInt(
-                    this, loop, va_arg(varArgs, long int));
-                break;
-            case R3C_FORMAT_DOUBLE:
-                formatter.appendFloat(
-                    this, loop, va_arg(varArgs, long double));
-                break;
-            case R3C_FORMAT_STRING:
-                formatter.appendString(
-                    this, loop, va_arg(varArgs, const char*));
-                break;
-            case R3C_FORMAT_POINTER:
-                formatter.appendPointer(
-                    this, loop, va_arg(varArgs, const void*));
-                break;
-        } // TODO: test whether we need to have separate types for int vs. long int; and double vs. long double
-    }
-    va_end(varArgs);
-    // TODO: determine # chars appended
-    return( 0 );
+	result = this->vappendf(formatString, varArgs);
+	va_end(varArgs);
+	return( result );
+}
+
+// Appends the formatted string to the end of this string, taking the format
+// parameter replacements from a variable argument list.
+int R3CString::vappendf(const char* formatString, va_list varArgs) {
+    R3CFormatParser* formatter;
+    if ( formatString == NULL ) return( 0 );
+
+    // Format strings are normally parsed once, and shared from then on
+    formatter = R3CFormatParser::lookup(formatString);
+    if ( formatter != NULL ) return( formatter->vappend(this, varArgs) );
+    R3CFormatParser localFormatter;
+    localFormatter.parse(formatString);
+    return( localFormatter.vappend(this, varArgs) );
 }
 
 // Inserts the given character at the given position in this string.
@@ -379,21 +906,44 @@ int R3CString::insert(int pos, char charToInsert) {
 
 // Inserts the source character string at the given position in this string.
 int R3CString::insert(int pos, const char* sourceStr) {
-	register int sourceStrLen;
-	register char* insertPtr;
-    int charsToMove;
 #ifndef R3C_NOERRCHECK
 	if ( (pos < 0) || (pos > this->curLength) ) throw R3CERR_OUTOFRANGE;
 #endif
 	if ( sourceStr == NULL ) return( 0 );
-	sourceStrLen = (int)strlen(sourceStr);
-	this->ensureCapacity(this->curLength + sourceStrLen);
-	insertPtr = this->str + pos;
-    charsToMove = this->curLength - pos + 1;
-	memmove(insertPtr + sourceStrLen, insertPtr, charsToMove);
-	strncpy(insertPtr, sourceStr, sourceStrLen);
-	this->curLength += sourceStrLen;
-    return( sourceStrLen );
+    return( this->insert(pos, sourceStr, (int)strlen(sourceStr)) );
+}
+
+// Inserts charCount characters from sourceChars at the given position in this
+// string.
+int R3CString::insert(int pos, const char* sourceChars, int charCount) {
+    register char* insertPtr;
+    int sourceOffset;
+    int headCount;
+#ifndef R3C_NOERRCHECK
+    if ( (pos < 0) || (pos > this->curLength) ) throw R3CERR_OUTOFRANGE;
+    if ( charCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( sourceChars == NULL ) return( 0 );
+    sourceOffset = findOffset(sourceChars, this->str, this->maxLength);
+    this->ensureCapacity(this->curLength + charCount);
+    insertPtr = this->str + pos;
+    memmove(insertPtr + charCount, insertPtr, this->curLength - pos + 1);
+    if ( sourceOffset < 0 ) {
+        memcpy(insertPtr, sourceChars, charCount);
+    } else {
+        // Source characters from this string that were at or after pos
+        // have just been moved along by charCount
+        headCount = pos - sourceOffset;
+        if ( headCount < 0 ) headCount = 0;
+        if ( headCount > charCount ) headCount = charCount;
+        memmove(insertPtr, this->str + sourceOffset, headCount);
+        memmove(
+            insertPtr + headCount,
+            this->str + sourceOffset + headCount + charCount,
+            charCount - headCount);
+    }
+    this->curLength += charCount;
+    return( charCount );
 }
 
 // Inserts charCount characters, starting at startPos, from sourceStr into
@@ -401,26 +951,13 @@ int R3CString::insert(int pos, const char* sourceStr) {
 int R3CString::insert(
     int pos, const char* sourceStr, int startPos, int charCount
 ) {
-	register int sourceStrLen;
-	register char* insertPtr;
-    int charsToMove;
 #ifndef R3C_NOERRCHECK
 	if ( (pos < 0) || (pos > this->curLength) ) throw R3CERR_OUTOFRANGE;
     if ( startPos < 0 ) throw R3CERR_ILLEGALARGUMENT;
 #endif
 	if ( sourceStr == NULL ) return( 0 );
-	sourceStrLen = (int)strlen(sourceStr);
-    if ( startPos >= sourceStrLen ) return( 0 );
-    if ( (startPos + charCount ) > sourceStrLen ) {
-        charCount = sourceStrLen - startPos;
-    }
-	this->ensureCapacity(this->curLength + charCount);
-	insertPtr = this->str + pos;
-    charsToMove = this->curLength - pos + 1;
-	memmove(insertPtr + charCount, insertPtr, charsToMove);
-	strncpy(insertPtr, sourceStr + startPos, charCount);
-	this->curLength += charCount;
-    return( charCount );
+    charCount = boundChars(sourceStr, startPos, charCount);
+    return( this->insert(pos, sourceStr + startPos, charCount) );
 }
 
 // Inserts the source string into this string.
@@ -431,15 +968,24 @@ int R3CString::insert(int pos, R3CString* sourceStr) {
     if ( (pos < 0) || (pos > this->curLength) ) throw R3CERR_OUTOFRANGE;
     if ( sourceStr == NULL ) throw R3CERR_ILLEGALARGUMENT;
 #endif
+    if ( sourceStr == this ) {
+        return( this->insert(pos, this->str, this->curLength) );
+    }
 	this->ensureCapacity(this->curLength + sourceStr->curLength);
 	insertPtr = this->str + pos;
     charsToMove = this->curLength - pos + 1;
 	memmove(insertPtr + sourceStr->curLength, insertPtr, charsToMove);
-	strncpy(insertPtr, sourceStr->str, sourceStr->curLength);
+	memcpy(insertPtr, sourceStr->str, sourceStr->curLength);
 	this->curLength += sourceStr->curLength;
     return( sourceStr->curLength );
 }
 
+// Inserts the characters of the source view into this string.
+int R3CString::insert(int pos, R3CStringView sourceView) {
+    return(
+        this->insert(pos, sourceView.getChars(), sourceView.getLength()) );
+}
+
 // Removes the character at the given position from this string.
 int R3CString::deleteCharAt(int pos) {
     register char* deletePtr;
@@ -486,21 +1032,70 @@ int R3CString::clear() {
 
 // Left-trims this string.
 int R3CString::trimLeft(const char* trimChars) {
-	register char* curPtr;
-	register int result;
+    R3CCharSet buildSet;
+    const char* startPtr;
+    int result;
 #ifndef R3C_NOERRCHECK
     if ( trimChars == NULL ) throw R3CERR_ILLEGALARGUMENT;
 #endif
-	if ( this->curLength == 0 ) return( 0 );
-	curPtr = this->str;
-	while ( strchr(trimChars, *curPtr) != NULL ) {
-		curPtr++;
-	}
-	result = 0;
-	if ( curPtr > this->str ) {
-		result = (int)(curPtr - this->str);
-        memmove(this->str, curPtr, this->curLength - result + 1);
+    startPtr = R3CCharSet::getSet(trimChars, &buildSet)->passChars(
+        this->str, this->str + this->curLength);
+    result = (int)(startPtr - this->str);
+    if ( result > 0 ) {
+        memmove(this->str, startPtr, this->curLength - result + 1);
         this->curLength -= result;
-	}
-	return( result );
+    }
+    return( result );
+}
+
+// Right-trims this string.
+int R3CString::trimRight(const char* trimChars) {
+    R3CCharSet buildSet;
+    const char* endPtr;
+    int result;
+#ifndef R3C_NOERRCHECK
+    if ( trimChars == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    endPtr = R3CCharSet::getSet(trimChars, &buildSet)->passCharsBack(
+        this->str, this->str + this->curLength);
+    result = this->curLength - (int)(endPtr - this->str);
+    if ( result > 0 ) {
+        this->curLength -= result;
+        this->str[this->curLength] = '\0';
+    }
+    return( result );
+}
+
+// Fully trims this string.
+int R3CString::trim(const char* trimChars) {
+    int startPos;
+    int trimLength;
+    int result;
+#ifndef R3C_NOERRCHECK
+    if ( trimChars == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    r3cStrTrimBounds(
+        this->str, this->curLength, trimChars, &startPos, &trimLength);
+    result = this->curLength - trimLength;
+    if ( result > 0 ) {
+        if ( startPos > 0 ) {
+            memmove(this->str, this->str + startPos, trimLength);
+        }
+        this->str[trimLength] = '\0';
+        this->curLength = trimLength;
+    }
+    return( result );
+}
+
+
+// *** MANAGE CASE *** //
+
+// Converts this string to upper-case.
+int R3CString::toUpper() {
+    return( r3cStrUpper(this->str, this->curLength) );
+}
+
+// Converts this string to lower-case.
+int R3CString::toLower() {
+    return( r3cStrLower(this->str, this->curLength) );
 }
@@ -0,0 +1,148 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+
+#include <string.h>
+
+
+// *** CONSTANTS *** //
+
+#define DEFAULT_KB_PER_CHUNK 16
+#define MAX_KB_PER_CHUNK 1024
+
+
+// *** ARENA CHUNKS *** //
+
+// Header at the start of each chunk, followed by the chunk's storage.
+struct R3CArenaChunk {
+    R3CArenaChunk* next;
+    int byteCount;
+};
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Allocates a chunk with the given number of bytes of storage.
+static R3CArenaChunk* newChunk(int byteCount) {
+    R3CArenaChunk* result;
+    result = (R3CArenaChunk*)new char [sizeof(R3CArenaChunk) + byteCount];
+    result->next = NULL;
+    result->byteCount = byteCount;
+    return( result );
+}
+
+// Returns the storage of the given chunk.
+static char* getChunkStorage(R3CArenaChunk* chunk) {
+    return( (char*)chunk + sizeof(R3CArenaChunk) );
+}
+
+// Frees every chunk in the given list.
+static void deleteChunks(R3CArenaChunk* chunk) {
+    R3CArenaChunk* nextChunk;
+    while ( chunk != NULL ) {
+        nextChunk = chunk->next;
+        delete[] (char*)chunk;
+        chunk = nextChunk;
+    }
+}
+
+
+// *** CONSTRUCTION *** //
+
+// Creates a new arena, with 16 kilobytes per chunk.
+R3CStringArena::R3CStringArena() :
+    bytesPerChunk(DEFAULT_KB_PER_CHUNK << 10),
+    firstChunk(NULL),
+    currChunk(NULL),
+    largeChunks(NULL),
+    nextPtr(NULL),
+    endPtr(NULL)
+{
+}
+
+// Creates a new arena, with the given chunk size.
+R3CStringArena::R3CStringArena(int kbPerChunk) :
+    bytesPerChunk(0),
+    firstChunk(NULL),
+    currChunk(NULL),
+    largeChunks(NULL),
+    nextPtr(NULL),
+    endPtr(NULL)
+{
+#ifndef R3C_NOERRCHECK
+    if ( kbPerChunk < 1 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( kbPerChunk > MAX_KB_PER_CHUNK ) kbPerChunk = MAX_KB_PER_CHUNK;
+    this->bytesPerChunk = kbPerChunk << 10;
+}
+
+
+// *** DESTRUCTION *** //
+
+// Destructor.
+R3CStringArena::~R3CStringArena() {
+    deleteChunks(this->firstChunk);
+    deleteChunks(this->largeChunks);
+}
+
+
+// *** MANAGE STORAGE *** //
+
+// Allocates storage for the given number of bytes.
+char* R3CStringArena::allocate(int byteCount) {
+    R3CArenaChunk* chunk;
+    char* result;
+#ifndef R3C_NOERRCHECK
+    if ( byteCount < 1 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    // Large requests get a chunk of their own, so that chunks are not wasted
+    if ( byteCount > (this->bytesPerChunk >> 1) ) {
+        chunk = newChunk(byteCount);
+        chunk->next = this->largeChunks;
+        this->largeChunks = chunk;
+        return( getChunkStorage(chunk) );
+    }
+
+    // Move to the next chunk, reusing chunks kept by reset where possible
+    if ( (this->endPtr - this->nextPtr) < byteCount ) {
+        if ( (this->currChunk != NULL) && (this->currChunk->next != NULL) ) {
+            chunk = this->currChunk->next;
+        } else {
+            chunk = newChunk(this->bytesPerChunk);
+            if ( this->currChunk == NULL ) {
+                this->firstChunk = chunk;
+            } else {
+                this->currChunk->next = chunk;
+            }
+        }
+        this->currChunk = chunk;
+        this->nextPtr = getChunkStorage(chunk);
+        this->endPtr = this->nextPtr + chunk->byteCount;
+    }
+    result = this->nextPtr;
+    this->nextPtr += byteCount;
+    return( result );
+}
+
+// Gives back storage that was returned by allocate.
+void R3CStringArena::deallocate(char* storage, int byteCount) {
+    // Only the most recent allocation can be reclaimed; everything else is
+    // reclaimed by reset
+    if ( (storage != NULL) && ((storage + byteCount) == this->nextPtr) ) {
+        this->nextPtr = storage;
+    }
+}
+
+// Frees all storage allocated from this arena at once.
+void R3CStringArena::reset() {
+    deleteChunks(this->largeChunks);
+    this->largeChunks = NULL;
+    this->currChunk = this->firstChunk;
+    if ( this->firstChunk == NULL ) {
+        this->nextPtr = NULL;
+        this->endPtr = NULL;
+    } else {
+        this->nextPtr = getChunkStorage(this->firstChunk);
+        this->endPtr = this->nextPtr + this->firstChunk->byteCount;
+    }
+}
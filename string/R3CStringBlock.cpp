@@ -9,6 +9,19 @@
 
 #define MAX_KB_PER_BLOCK 64
 #define ALLOC_BLOCK_PTR_SIZE 16
+#define ALLOC_ALONE_SIZE 16
+
+
+// *** DATA TYPES *** //
+
+// String allocated in its own storage, and where it was added among the
+// strings of the storage blocks.
+struct R3CAloneString {
+    char* chars;
+    int length;
+    int blockIndex;
+    int blockPos;
+};
 
 
 // *** CONSTRUCTION *** //
@@ -30,7 +43,10 @@ R3CStringBlock::R3CStringBlock() :
     memBlock(NULL),
     currMemBlock(0),
     nextStrPtr(NULL),
-    bytesUsedInBlock(0)
+    bytesUsedInBlock(0),
+    aloneStr(NULL),
+    aloneStrCount(0),
+    aloneStrAlloc(0)
 {
     init(4);
 }
@@ -42,7 +58,10 @@ R3CStringBlock::R3CStringBlock(int kbPerBlock) :
     memBlock(NULL),
     currMemBlock(0),
     nextStrPtr(NULL),
-    bytesUsedInBlock(0)
+    bytesUsedInBlock(0),
+    aloneStr(NULL),
+    aloneStrCount(0),
+    aloneStrAlloc(0)
 {
 #ifndef R3C_NOERRCHECK
     if ( kbPerBlock < 1 ) throw R3CERR_ILLEGALARGUMENT;
@@ -64,6 +83,10 @@ R3CStringBlock::~R3CStringBlock() {
         }
         delete[] this->memBlock;
     }
+    this->freeAlone(0);
+    if ( this->aloneStr != NULL ) {
+        delete[] this->aloneStr;
+    }
 }
 
 
@@ -122,11 +145,52 @@ bool R3CStringBlock::shouldAllocAlone(int charsToAlloc) {
     return( charsToAlloc > (this->bytesPerBlock >> 1) );
 }
 
+// Allocates storage of its own for a string, and records it after the strings
+// already added.
+char* R3CStringBlock::allocAlone(int charsToAlloc) {
+    R3CAloneString* oldAloneStr;
+    R3CAloneString* entry;
+
+    // Check if we need to allocate more entries
+    if ( this->aloneStrCount >= this->aloneStrAlloc ) {
+        oldAloneStr = this->aloneStr;
+        this->aloneStrAlloc =
+            (this->aloneStrAlloc == 0) ?
+            ALLOC_ALONE_SIZE : (this->aloneStrAlloc << 1);
+        this->aloneStr = new R3CAloneString [this->aloneStrAlloc];
+        if ( oldAloneStr != NULL ) {
+            memcpy(
+                this->aloneStr, oldAloneStr,
+                this->aloneStrCount * sizeof(R3CAloneString));
+            delete[] oldAloneStr;
+        }
+    }
+
+    // Record the string at the current position in the storage blocks
+    entry = &this->aloneStr[this->aloneStrCount];
+    entry->chars = new char [charsToAlloc];
+    entry->length = charsToAlloc;
+    entry->blockIndex = this->currMemBlock;
+    entry->blockPos = this->bytesUsedInBlock;
+    this->aloneStrCount++;
+    return( entry->chars );
+}
+
+// Frees the strings allocated in their own storage, other than the first
+// keepCount.
+void R3CStringBlock::freeAlone(int keepCount) {
+    while ( this->aloneStrCount > keepCount ) {
+        this->aloneStrCount--;
+        delete[] this->aloneStr[this->aloneStrCount].chars;
+    }
+}
+
 // Inserts the given character string into this string block.
 char* R3CStringBlock::insertString(const char* str, int charsToAlloc) {
     char* result;
     if ( this->shouldAllocAlone(charsToAlloc) ) {
-        result = new char [charsToAlloc];
+        result = this->allocAlone(charsToAlloc);
+        memset(result, 0, charsToAlloc);
         strcpy(result, str);
     } else {
         this->ensureBlockCapacity(charsToAlloc);
@@ -175,3 +239,113 @@ char* R3CStringBlock::addString(R3CString* str, int maxLength) {
     charsToAlloc++;
     return( this->insertString(str->getChars(), charsToAlloc) );
 }
+
+// Adds the characters of the given view to this string block.
+char* R3CStringBlock::addString(R3CStringView view) {
+    char* result;
+
+    // The allocated space is already null-terminated
+    result = this->allocString(view.getLength());
+    memcpy(result, view.getChars(), view.getLength());
+    return( result );
+}
+
+// Allocates space in this string block for a character string of up to
+// maxLength characters.
+char* R3CStringBlock::allocString(int maxLength) {
+    char* result;
+    int charsToAlloc;
+#ifndef R3C_NOERRCHECK
+    if ( maxLength < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    charsToAlloc = maxLength + 1;
+    if ( this->shouldAllocAlone(charsToAlloc) ) {
+        result = this->allocAlone(charsToAlloc);
+        memset(result, 0, charsToAlloc);
+    } else {
+        // Storage blocks are already cleared
+        this->ensureBlockCapacity(charsToAlloc);
+        result = this->nextStrPtr;
+        this->nextStrPtr += charsToAlloc;
+        this->bytesUsedInBlock += charsToAlloc;
+    }
+    return( result );
+}
+
+
+// *** RETRIEVE STORAGE BLOCKS *** //
+
+// Returns the number of storage blocks currently in use.
+int R3CStringBlock::getBlockCount() {
+    return( this->currMemBlock + 1 );
+}
+
+// Returns the contents of the storage block at the given index.
+const char* R3CStringBlock::getBlockChars(int blockIndex) {
+#ifndef R3C_NOERRCHECK
+    if ( (blockIndex < 0) || (blockIndex > this->currMemBlock) ) {
+        throw R3CERR_OUTOFRANGE;
+    }
+#endif
+    return( this->memBlock[blockIndex] );
+}
+
+// Returns the number of bytes in use within the storage block at the given
+// index.
+int R3CStringBlock::getBlockLength(int blockIndex) {
+#ifndef R3C_NOERRCHECK
+    if ( (blockIndex < 0) || (blockIndex > this->currMemBlock) ) {
+        throw R3CERR_OUTOFRANGE;
+    }
+#endif
+    if ( blockIndex < this->currMemBlock ) return( this->bytesPerBlock );
+    return( this->bytesUsedInBlock );
+}
+
+// Returns the number of strings that were allocated in their own storage.
+int R3CStringBlock::getAloneCount() {
+    return( this->aloneStrCount );
+}
+
+// Returns the storage of a string that was allocated on its own.
+const char* R3CStringBlock::getAloneChars(int aloneIndex) {
+#ifndef R3C_NOERRCHECK
+    if ( (aloneIndex < 0) || (aloneIndex >= this->aloneStrCount) ) {
+        throw R3CERR_OUTOFRANGE;
+    }
+#endif
+    return( this->aloneStr[aloneIndex].chars );
+}
+
+// Returns the number of bytes in the storage of a string that was allocated
+// on its own.
+int R3CStringBlock::getAloneLength(int aloneIndex) {
+#ifndef R3C_NOERRCHECK
+    if ( (aloneIndex < 0) || (aloneIndex >= this->aloneStrCount) ) {
+        throw R3CERR_OUTOFRANGE;
+    }
+#endif
+    return( this->aloneStr[aloneIndex].length );
+}
+
+// Returns the index of the storage block that was current when a string was
+// allocated on its own.
+int R3CStringBlock::getAloneBlockIndex(int aloneIndex) {
+#ifndef R3C_NOERRCHECK
+    if ( (aloneIndex < 0) || (aloneIndex >= this->aloneStrCount) ) {
+        throw R3CERR_OUTOFRANGE;
+    }
+#endif
+    return( this->aloneStr[aloneIndex].blockIndex );
+}
+
+// Returns the number of bytes that were in use within the current storage
+// block when a string was allocated on its own.
+int R3CStringBlock::getAloneBlockPos(int aloneIndex) {
+#ifndef R3C_NOERRCHECK
+    if ( (aloneIndex < 0) || (aloneIndex >= this->aloneStrCount) ) {
+        throw R3CERR_OUTOFRANGE;
+    }
+#endif
+    return( this->aloneStr[aloneIndex].blockPos );
+}
@@ -16,13 +16,16 @@ void R3CStringBlockStack::init() {
     this->stackStartPtr = new char* [ALLOC_STACK_SIZE];
     memset(this->stackStartPtr, 0, ALLOC_STACK_SIZE * sizeof(char*));
     this->stackStartPtr[0] = this->nextStrPtr;
+    this->stackAloneCount = new int [ALLOC_STACK_SIZE];
+    memset(this->stackAloneCount, 0, ALLOC_STACK_SIZE * sizeof(int));
 }
 
 R3CStringBlockStack::R3CStringBlockStack() :
     R3CStringBlock(),
     stackLevel(0),
     stackStartPtr(NULL),
-    stackStartPtrAlloc(ALLOC_STACK_SIZE)
+    stackStartPtrAlloc(ALLOC_STACK_SIZE),
+    stackAloneCount(NULL)
 {
     this->init();
 }
@@ -31,7 +34,8 @@ R3CStringBlockStack::R3CStringBlockStack(int kbPerBlock) :
     R3CStringBlock(kbPerBlock),
     stackLevel(0),
     stackStartPtr(NULL),
-    stackStartPtrAlloc(ALLOC_STACK_SIZE)
+    stackStartPtrAlloc(ALLOC_STACK_SIZE),
+    stackAloneCount(NULL)
 {
     this->init();
 }
@@ -43,6 +47,9 @@ R3CStringBlockStack::~R3CStringBlockStack() {
     if ( this->stackStartPtr != NULL ) {
         delete[] this->stackStartPtr;
     }
+    if ( this->stackAloneCount != NULL ) {
+        delete[] this->stackAloneCount;
+    }
 }
 
 
@@ -56,6 +63,7 @@ int R3CStringBlockStack::getStackLevel() {
 // Pushes the stack to a new level.
 int R3CStringBlockStack::push() {
     char** oldStackStartPtr;
+    int* oldStackAloneCount;
     int oldStackStartPtrAlloc;
     size_t stackStartPtrSize;
 
@@ -83,11 +91,22 @@ int R3CStringBlockStack::push() {
 
         // Destroy the old stack start pointers
         delete[] oldStackStartPtr;
+
+        // Move the counts of strings allocated on their own in the same way
+        oldStackAloneCount = this->stackAloneCount;
+        this->stackAloneCount = new int [this->stackStartPtrAlloc];
+        memset(
+            this->stackAloneCount, 0, this->stackStartPtrAlloc * sizeof(int));
+        memcpy(
+            this->stackAloneCount, oldStackAloneCount,
+            oldStackStartPtrAlloc * sizeof(int));
+        delete[] oldStackAloneCount;
     }
 
     // Set the stack start pointer to the current position in this storage
     // block
     this->stackStartPtr[this->stackLevel] = this->nextStrPtr;
+    this->stackAloneCount[this->stackLevel] = this->aloneStrCount;
 
     // Return the new stack level
     return( this->stackLevel );
@@ -138,9 +157,13 @@ int R3CStringBlockStack::pop() {
     this->currMemBlock = foundInMemBlock;
     this->nextStrPtr = ptrToFind;
     this->bytesUsedInBlock = this->bytesPerBlock - bytesToClear;
+
+    // Free the strings this stack level allocated on their own
+    this->freeAlone(this->stackAloneCount[this->stackLevel]);
     
     // Update the stack level
     this->stackStartPtr[this->stackLevel] = NULL;
+    this->stackAloneCount[this->stackLevel] = 0;
     this->stackLevel--;
 
     // Return the new stack level
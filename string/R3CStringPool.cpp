@@ -0,0 +1,128 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+
+#include <string.h>
+
+
+// *** CONSTANTS *** //
+
+// Size of the smallest size class, as a power of 2
+#define MIN_CLASS_SHIFT 6
+
+// Size of the largest size class
+#define MAX_CLASS_SIZE (1 << (MIN_CLASS_SHIFT + R3C_POOL_CLASSCOUNT - 1))
+
+// Number of bytes in each slab, including the link to the next slab
+#define SLAB_SIZE 65536
+
+// Number of bytes at the start of each slab, holding the link to the next
+// slab; this keeps the storage that follows aligned to its size class
+#define SLAB_HEADER (1 << MIN_CLASS_SHIFT)
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Reads the link stored at the start of the given free storage or slab.
+static char* getLink(char* storage) {
+    char* result;
+    memcpy(&result, storage, sizeof(result));
+    return( result );
+}
+
+// Stores a link at the start of the given free storage or slab.
+static void setLink(char* storage, char* link) {
+    memcpy(storage, &link, sizeof(link));
+}
+
+
+// *** CONSTRUCTION *** //
+
+// Creates a new, empty string pool.
+R3CStringPool::R3CStringPool() :
+    slabs(NULL),
+    nextPtr(NULL),
+    endPtr(NULL)
+{
+    memset(this->freeLists, 0, sizeof(this->freeLists));
+}
+
+
+// *** DESTRUCTION *** //
+
+// Destructor.
+R3CStringPool::~R3CStringPool() {
+    char* nextSlab;
+    while ( this->slabs != NULL ) {
+        nextSlab = getLink(this->slabs);
+        delete[] this->slabs;
+        this->slabs = nextSlab;
+    }
+}
+
+
+// *** MANAGE STORAGE *** //
+
+// Returns the size class for the given number of bytes.
+int R3CStringPool::getSizeClass(int byteCount) {
+    int result;
+    if ( byteCount > MAX_CLASS_SIZE ) return( R3C_POOL_CLASSCOUNT );
+    result = 0;
+    while ( byteCount > (1 << (MIN_CLASS_SHIFT + result)) ) result++;
+    return( result );
+}
+
+// Allocates storage for the given number of bytes.
+char* R3CStringPool::allocate(int byteCount) {
+    char* result;
+    char* slab;
+    int sizeClass;
+    int classSize;
+#ifndef R3C_NOERRCHECK
+    if ( byteCount < 1 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    sizeClass = this->getSizeClass(byteCount);
+    if ( sizeClass == R3C_POOL_CLASSCOUNT ) return( new char [byteCount] );
+
+    // Reuse storage of the same class if there is any
+    result = this->freeLists[sizeClass];
+    if ( result != NULL ) {
+        this->freeLists[sizeClass] = getLink(result);
+        return( result );
+    }
+
+    // Otherwise carve new storage from the current slab
+    classSize = 1 << (MIN_CLASS_SHIFT + sizeClass);
+    if ( (this->endPtr - this->nextPtr) < classSize ) {
+        slab = new char [SLAB_SIZE];
+        setLink(slab, this->slabs);
+        this->slabs = slab;
+        this->nextPtr = slab + SLAB_HEADER;
+        this->endPtr = slab + SLAB_SIZE;
+    }
+    result = this->nextPtr;
+    this->nextPtr += classSize;
+    return( result );
+}
+
+// Gives back storage that was returned by allocate.
+void R3CStringPool::deallocate(char* storage, int byteCount) {
+    int sizeClass;
+    if ( storage == NULL ) return;
+    sizeClass = this->getSizeClass(byteCount);
+    if ( sizeClass == R3C_POOL_CLASSCOUNT ) {
+        delete[] storage;
+        return;
+    }
+    setLink(storage, this->freeLists[sizeClass]);
+    this->freeLists[sizeClass] = storage;
+}
+
+// Returns the number of bytes that allocate actually provides when asked for
+// the given number.
+int R3CStringPool::getUsableSize(int byteCount) {
+    int sizeClass;
+    sizeClass = this->getSizeClass(byteCount);
+    if ( sizeClass == R3C_POOL_CLASSCOUNT ) return( byteCount );
+    return( 1 << (MIN_CLASS_SHIFT + sizeClass) );
+}
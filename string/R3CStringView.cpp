@@ -0,0 +1,252 @@
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+
+#include <string.h>
+
+
+// *** CONSTRUCTION *** //
+
+// Creates a new empty view.
+R3CStringView::R3CStringView() :
+    chars(R3C_STR_EMPTY),
+    length(0)
+{
+}
+
+// Creates a new view of the given character string.
+R3CStringView::R3CStringView(const char* str) :
+    chars(R3C_STR_EMPTY),
+    length(0)
+{
+    if ( str != NULL ) {
+        this->chars = str;
+        this->length = (int)strlen(str);
+    }
+}
+
+// Creates a new view of charCount characters, starting at chars.
+R3CStringView::R3CStringView(const char* chars, int charCount) :
+    chars(chars),
+    length(charCount)
+{
+#ifndef R3C_NOERRCHECK
+    if ( (charCount < 0) || ((chars == NULL) && (charCount > 0)) ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+#endif
+    if ( chars == NULL ) this->chars = R3C_STR_EMPTY;
+}
+
+// Creates a new view of the current contents of the given string.
+R3CStringView::R3CStringView(R3CString* str) :
+    chars(R3C_STR_EMPTY),
+    length(0)
+{
+#ifndef R3C_NOERRCHECK
+    if ( str == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    this->chars = str->getChars();
+    this->length = str->getLength();
+}
+
+
+// *** RETRIEVE VIEW INFORMATION *** //
+
+// Returns the first character of this view.
+const char* R3CStringView::getChars() {
+    return( this->chars );
+}
+
+// Returns the number of characters in this view.
+int R3CStringView::getLength() {
+    return( this->length );
+}
+
+// Checks if this view contains no characters.
+bool R3CStringView::isEmpty() {
+    return( this->length == 0 );
+}
+
+
+// *** FINDING SUB-STRINGS *** //
+
+// Returns the character at the given character position.
+char R3CStringView::getCharAt(int pos) {
+#ifndef R3C_NOERRCHECK
+    if ( (pos < 0) || (pos >= this->length) ) throw R3CERR_OUTOFRANGE;
+#endif
+    return( this->chars[pos] );
+}
+
+// Finds the first occurrence of the given character.
+int R3CStringView::find(char charToFind) {
+    const char* charPtr;
+    charPtr = (const char*)memchr(this->chars, charToFind, this->length);
+    if ( charPtr == NULL ) return( -1 );
+    return( (int)(charPtr - this->chars) );
+}
+
+// Finds the first occurrence of the given sub-string.
+int R3CStringView::find(const char* strToFind) {
+#ifndef R3C_NOERRCHECK
+    if ( strToFind == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    return( this->find(R3CStringView(strToFind)) );
+}
+
+// Finds the first occurrence of the given sub-string view.
+int R3CStringView::find(R3CStringView viewToFind) {
+    const char* searchPtr;
+    const char* lastStartPtr;
+    if ( viewToFind.length == 0 ) return( 0 );
+    if ( viewToFind.length > this->length ) return( -1 );
+
+    // Look for the first character of the sub-string, then compare the rest
+    searchPtr = this->chars;
+    lastStartPtr = this->chars + this->length - viewToFind.length;
+    while ( searchPtr <= lastStartPtr ) {
+        searchPtr = (const char*)memchr(
+            searchPtr, viewToFind.chars[0], lastStartPtr - searchPtr + 1);
+        if ( searchPtr == NULL ) return( -1 );
+        if (
+            memcmp(
+                searchPtr + 1, viewToFind.chars + 1,
+                viewToFind.length - 1) == 0
+        ) {
+            return( (int)(searchPtr - this->chars) );
+        }
+        searchPtr++;
+    }
+    return( -1 );
+}
+
+// Finds the last occurrence of the given character.
+int R3CStringView::findReverse(char charToFind) {
+    register const char* charPtr;
+    charPtr = this->chars + this->length;
+    while ( charPtr > this->chars ) {
+        charPtr--;
+        if ( *charPtr == charToFind ) return( (int)(charPtr - this->chars) );
+    }
+    return( -1 );
+}
+
+// Returns a view of up to charCount characters, starting at startPos.
+R3CStringView R3CStringView::subView(int startPos, int charCount) {
+#ifndef R3C_NOERRCHECK
+    if ( (startPos < 0) || (startPos > this->length) ) {
+        throw R3CERR_OUTOFRANGE;
+    }
+    if ( charCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( charCount > (this->length - startPos) ) {
+        charCount = this->length - startPos;
+    }
+    return( R3CStringView(this->chars + startPos, charCount) );
+}
+
+
+// *** COMPARING STRINGS *** //
+
+// Compares this view to the given character string.
+int R3CStringView::compare(const char* str) {
+    return( this->compare(R3CStringView(str)) );
+}
+
+// Compares this view to the given view.
+int R3CStringView::compare(R3CStringView view) {
+    int result;
+    int commonLength;
+    commonLength = (this->length < view.length) ? this->length : view.length;
+    result = memcmp(this->chars, view.chars, commonLength);
+    if ( result == 0 ) result = this->length - view.length;
+    return( result );
+}
+
+// Compares this view to the given view, ignoring the case of letters.
+int R3CStringView::compareNoCase(R3CStringView view) {
+    return( r3cStrCompareNoCase(
+        this->chars, this->length, view.chars, view.length) );
+}
+
+// Computes a hash of this view, ignoring the case of letters.
+unsigned int R3CStringView::hashNoCase() {
+    return( r3cStrHashNoCase(this->chars, this->length) );
+}
+
+// Checks if this view matches the given filename pattern.
+bool R3CStringView::pathMatch(const char* pattern) {
+    return( r3cPathMatch(this->chars, this->length, pattern) );
+}
+
+
+// *** TRIM WHITESPACE *** //
+
+// Returns this view without any leading trimmable characters.
+R3CStringView R3CStringView::trimLeft(const char* trimChars) {
+    R3CCharSet buildSet;
+    const char* startPtr;
+    const char* endPtr;
+#ifndef R3C_NOERRCHECK
+    if ( trimChars == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    endPtr = this->chars + this->length;
+    startPtr = R3CCharSet::getSet(trimChars, &buildSet)->passChars(
+        this->chars, endPtr);
+    return( R3CStringView(startPtr, (int)(endPtr - startPtr)) );
+}
+
+// Returns this view without any trailing trimmable characters.
+R3CStringView R3CStringView::trimRight(const char* trimChars) {
+    R3CCharSet buildSet;
+    const char* endPtr;
+#ifndef R3C_NOERRCHECK
+    if ( trimChars == NULL ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    endPtr = R3CCharSet::getSet(trimChars, &buildSet)->passCharsBack(
+        this->chars, this->chars + this->length);
+    return( R3CStringView(this->chars, (int)(endPtr - this->chars)) );
+}
+
+// Returns this view without any leading or trailing trimmable characters.
+R3CStringView R3CStringView::trim(const char* trimChars) {
+    int startPos;
+    int trimLength;
+    r3cStrTrimBounds(
+        this->chars, this->length, trimChars, &startPos, &trimLength);
+    return( R3CStringView(this->chars + startPos, trimLength) );
+}
+
+
+// *** SPLIT VIEWS *** //
+
+// Splits this view into pieces separated by the given delimiter.
+int R3CStringView::split(
+    char delimiter, R3CStringView* pieces, int maxPieces
+) {
+    const char* piecePtr;
+    const char* delimPtr;
+    const char* endPtr;
+    int pieceCount;
+#ifndef R3C_NOERRCHECK
+    if ( (pieces == NULL) || (maxPieces < 1) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    piecePtr = this->chars;
+    endPtr = this->chars + this->length;
+    pieceCount = 0;
+    while ( pieceCount < (maxPieces - 1) ) {
+        delimPtr = (const char*)memchr(piecePtr, delimiter, endPtr - piecePtr);
+        if ( delimPtr == NULL ) break;
+        pieces[pieceCount].chars = piecePtr;
+        pieces[pieceCount].length = (int)(delimPtr - piecePtr);
+        pieceCount++;
+        piecePtr = delimPtr + 1;
+    }
+
+    // The last piece holds whatever remains
+    pieces[pieceCount].chars = piecePtr;
+    pieces[pieceCount].length = (int)(endPtr - piecePtr);
+    pieceCount++;
+    return( pieceCount );
+}
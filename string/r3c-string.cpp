@@ -4,6 +4,16 @@
 
 #include <string.h>
 
+// Case conversion and comparison use SSE2, AVX2 or AVX-512 where the
+// compiler can target them and the processor (as found at run time) supports
+// them
+#if \
+    defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(R3C_NOSIMD)
+#define SIMD_CASE
+#include <immintrin.h>
+#endif
+
 
 // *** EXCEPTIONS *** //
 
@@ -24,170 +34,479 @@ const char* R3C_STR_NEWLINE = "\n\r\v\f";
 
 const char* R3C_STR_WHITESPACE = " \t\n\r\v\f";
 
+// Bit mask of the characters in R3C_STR_NEWLINE, plus the null-terminator
+#define NEWLINE_MASK \
+    ((1 << '\0') | (1 << '\n') | (1 << '\r') | (1 << '\v') | (1 << '\f'))
 
-// *** COMMON STRING FUNCTIONS *** //
+// All characters in NEWLINE_MASK are below this value
+#define NEWLINE_LIMIT 14
 
-// Converts the given character string to upper-case.
-int r3cStrUpper(char* str) {
-	register char curChar;
-	register char* curPtr;
+// Word with every byte set to NEWLINE_LIMIT
+#define LIMIT_WORD ((~0UL / 255) * NEWLINE_LIMIT)
+
+// Word with the high bit of every byte set
+#define HIGH_BITS_WORD ((~0UL / 255) * 128)
+
+// Checks if the given character is a newline character or null-terminator
+#define IS_NEWLINE(c) \
+    ( ((unsigned char)(c) < NEWLINE_LIMIT) && \
+      ((NEWLINE_MASK >> (unsigned char)(c)) & 1) )
+
+// Number of letters in each case
+#define LETTER_COUNT 26
+
+// Bit that differs between the upper-case and lower-case forms of a letter
+#define CASE_BIT 32
+
+// Word with every byte set to 127
+#define LOW_BITS_WORD ((~0ULL / 255) * 127)
+
+// Multiplier used to mix each word into a hash
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+#ifdef SIMD_CASE
+
+// Attributes of a function that uses the given instruction set
+#define SIMD_FUNCTION(isa) __attribute__((target(isa)))
+
+#endif
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Converts the characters from firstChar to (firstChar + 25), in the given
+// characters, to the other case; one character at a time.  Returns the
+// number of characters converted.
+static int flipCaseScalar(char* str, int strLength, char firstChar) {
+    register char* curPtr;
+    register char* endPtr;
     register int result;
     result = 0;
-	if ( str != NULL ) {
-		curPtr = str;
-		curChar = *curPtr;
-		while ( curChar != 0 ) {
-			if ( (curChar >= 97) && (curChar <= 122) ) {
-				(*curPtr) -= 32;
-                result++;
-			}
-			curPtr++;
-			curChar = *curPtr;
-		}
-	}
+    endPtr = str + strLength;
+    for ( curPtr = str; curPtr < endPtr; curPtr++ ) {
+        if ( (unsigned char)(*curPtr - firstChar) < LETTER_COUNT ) {
+            *curPtr ^= CASE_BIT;
+            result++;
+        }
+    }
     return( result );
 }
 
-// Converts the given character string to lower-case.
-int r3cStrLower(char* str) {
-	register char curChar;
-	register char* curPtr;
+// Returns the given character in lower-case, as an unsigned value.
+static int lowerChar(char c) {
+    if ( (unsigned char)(c - 'A') < LETTER_COUNT ) c ^= CASE_BIT;
+    return( (unsigned char)c );
+}
+
+// Compares the given characters as lower-case, one character at a time.
+// Returns the difference between the first pair that differs, or 0.
+static int compareNoCaseScalar(
+    const char* str1, const char* str2, int strLength
+) {
+    register int loop;
     register int result;
+    for ( loop = 0; loop < strLength; loop++ ) {
+        result = lowerChar(str1[loop]) - lowerChar(str2[loop]);
+        if ( result != 0 ) return( result );
+    }
+    return( 0 );
+}
+
+#ifdef SIMD_CASE
+
+// Each block below is tested for letters by adding a bias that moves the
+// first letter to -128, so that the letters are the only characters below
+// (-128 + LETTER_COUNT) in a signed comparison.
+
+// Converts 16 characters at a time; see flipCaseScalar.
+SIMD_FUNCTION("sse2")
+static int flipCaseSse2(char* str, int strLength, char firstChar) {
+    __m128i bias, limit, caseBit, block, letters;
+    int result;
+    int pos;
+    unsigned int mask;
+    bias = _mm_set1_epi8((char)(128 - firstChar));
+    limit = _mm_set1_epi8(-128 + LETTER_COUNT);
+    caseBit = _mm_set1_epi8(CASE_BIT);
+    result = 0;
+    for ( pos = 0; pos <= (strLength - 16); pos += 16 ) {
+        block = _mm_loadu_si128((const __m128i*)(str + pos));
+        letters = _mm_cmplt_epi8(_mm_add_epi8(block, bias), limit);
+        mask = (unsigned int)_mm_movemask_epi8(letters);
+        if ( mask != 0 ) {
+            // Only write back blocks that change
+            result += __builtin_popcount(mask);
+            _mm_storeu_si128(
+                (__m128i*)(str + pos),
+                _mm_xor_si128(block, _mm_and_si128(letters, caseBit)));
+        }
+    }
+    return(
+        result + flipCaseScalar(str + pos, strLength - pos, firstChar) );
+}
+
+// Converts 32 characters at a time; see flipCaseScalar.
+SIMD_FUNCTION("avx2")
+static int flipCaseAvx2(char* str, int strLength, char firstChar) {
+    __m256i bias, limit, caseBit, block, letters;
+    int result;
+    int pos;
+    unsigned int mask;
+    bias = _mm256_set1_epi8((char)(128 - firstChar));
+    limit = _mm256_set1_epi8(-128 + LETTER_COUNT);
+    caseBit = _mm256_set1_epi8(CASE_BIT);
     result = 0;
-	if ( str != NULL ) {
-		curPtr = str;
-		curChar = *curPtr;
-		while ( curChar != 0 ) {
-			if ( (curChar >= 65) && (curChar <= 90) ) {
-				(*curPtr) += 32;
-                result++;
-			}
-			curPtr++;
-			curChar = *curPtr;
-		}
-	}
+    for ( pos = 0; pos <= (strLength - 32); pos += 32 ) {
+        block = _mm256_loadu_si256((const __m256i*)(str + pos));
+        letters = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(block, bias));
+        mask = (unsigned int)_mm256_movemask_epi8(letters);
+        if ( mask != 0 ) {
+            result += __builtin_popcount(mask);
+            _mm256_storeu_si256(
+                (__m256i*)(str + pos),
+                _mm256_xor_si256(block, _mm256_and_si256(letters, caseBit)));
+        }
+    }
+    return(
+        result + flipCaseScalar(str + pos, strLength - pos, firstChar) );
+}
+
+// Converts 64 characters at a time; see flipCaseScalar.  The last block is
+// loaded and stored through a mask, so that no characters past the end are
+// touched.
+SIMD_FUNCTION("avx512bw")
+static int flipCaseAvx512(char* str, int strLength, char firstChar) {
+    __m512i bias, limit, caseBit, block;
+    __mmask64 charMask, letters;
+    int result;
+    int pos;
+    bias = _mm512_set1_epi8((char)(128 - firstChar));
+    limit = _mm512_set1_epi8(-128 + LETTER_COUNT);
+    caseBit = _mm512_set1_epi8(CASE_BIT);
+    result = 0;
+    for ( pos = 0; pos < strLength; pos += 64 ) {
+        charMask = ~0ULL;
+        if ( (strLength - pos) < 64 ) {
+            charMask = (1ULL << (strLength - pos)) - 1;
+        }
+        block = _mm512_maskz_loadu_epi8(charMask, str + pos);
+        letters = charMask &
+            _mm512_cmplt_epi8_mask(_mm512_add_epi8(block, bias), limit);
+        if ( letters != 0 ) {
+            result += __builtin_popcountll(letters);
+            _mm512_mask_storeu_epi8(
+                str + pos, letters, _mm512_xor_si512(block, caseBit));
+        }
+    }
     return( result );
 }
 
+// Compares 16 characters at a time; see compareNoCaseScalar.
+SIMD_FUNCTION("sse2")
+static int compareNoCaseSse2(
+    const char* str1, const char* str2, int strLength
+) {
+    __m128i bias, limit, caseBit, block1, block2;
+    int pos;
+    unsigned int mask;
+    bias = _mm_set1_epi8((char)(128 - 'A'));
+    limit = _mm_set1_epi8(-128 + LETTER_COUNT);
+    caseBit = _mm_set1_epi8(CASE_BIT);
+    for ( pos = 0; pos <= (strLength - 16); pos += 16 ) {
+        block1 = _mm_loadu_si128((const __m128i*)(str1 + pos));
+        block2 = _mm_loadu_si128((const __m128i*)(str2 + pos));
+        block1 = _mm_xor_si128(block1, _mm_and_si128(caseBit,
+            _mm_cmplt_epi8(_mm_add_epi8(block1, bias), limit)));
+        block2 = _mm_xor_si128(block2, _mm_and_si128(caseBit,
+            _mm_cmplt_epi8(_mm_add_epi8(block2, bias), limit)));
+        mask = 0xFFFF ^
+            (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block1, block2));
+        if ( mask != 0 ) {
+            pos += __builtin_ctz(mask);
+            return( lowerChar(str1[pos]) - lowerChar(str2[pos]) );
+        }
+    }
+    return( compareNoCaseScalar(str1 + pos, str2 + pos, strLength - pos) );
+}
+
+// Compares 32 characters at a time; see compareNoCaseScalar.
+SIMD_FUNCTION("avx2")
+static int compareNoCaseAvx2(
+    const char* str1, const char* str2, int strLength
+) {
+    __m256i bias, limit, caseBit, block1, block2;
+    int pos;
+    unsigned int mask;
+    bias = _mm256_set1_epi8((char)(128 - 'A'));
+    limit = _mm256_set1_epi8(-128 + LETTER_COUNT);
+    caseBit = _mm256_set1_epi8(CASE_BIT);
+    for ( pos = 0; pos <= (strLength - 32); pos += 32 ) {
+        block1 = _mm256_loadu_si256((const __m256i*)(str1 + pos));
+        block2 = _mm256_loadu_si256((const __m256i*)(str2 + pos));
+        block1 = _mm256_xor_si256(block1, _mm256_and_si256(caseBit,
+            _mm256_cmpgt_epi8(limit, _mm256_add_epi8(block1, bias))));
+        block2 = _mm256_xor_si256(block2, _mm256_and_si256(caseBit,
+            _mm256_cmpgt_epi8(limit, _mm256_add_epi8(block2, bias))));
+        mask = ~(unsigned int)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(block1, block2));
+        if ( mask != 0 ) {
+            pos += __builtin_ctz(mask);
+            return( lowerChar(str1[pos]) - lowerChar(str2[pos]) );
+        }
+    }
+    return( compareNoCaseScalar(str1 + pos, str2 + pos, strLength - pos) );
+}
+
+#endif
+
+#ifdef SIMD_CASE
+
+// Case conversion and comparison functions, as chosen for this processor
+typedef int (*FlipCaseFunction)(char* str, int strLength, char firstChar);
+typedef int (*CompareFunction)(
+    const char* str1, const char* str2, int strLength);
+
+// Chooses the fastest case conversion that this processor supports.
+static FlipCaseFunction selectFlipCase() {
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx512bw") ) return( flipCaseAvx512 );
+    if ( __builtin_cpu_supports("avx2") ) return( flipCaseAvx2 );
+    if ( __builtin_cpu_supports("sse2") ) return( flipCaseSse2 );
+    return( flipCaseScalar );
+}
+
+// Chooses the fastest comparison that this processor supports.
+static CompareFunction selectCompare() {
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx2") ) return( compareNoCaseAvx2 );
+    if ( __builtin_cpu_supports("sse2") ) return( compareNoCaseSse2 );
+    return( compareNoCaseScalar );
+}
+
+#endif
+
+// Converts the characters from firstChar to (firstChar + 25), in the given
+// characters, to the other case; using the fastest conversion that this
+// processor supports.  Returns the number of characters converted.
+static int flipCase(char* str, int strLength, char firstChar) {
+#ifdef SIMD_CASE
+    static FlipCaseFunction flipCaseFunction = selectFlipCase();
+    if ( strLength >= 16 ) {
+        return( flipCaseFunction(str, strLength, firstChar) );
+    }
+#endif
+    return( flipCaseScalar(str, strLength, firstChar) );
+}
+
+// Compares the given characters as lower-case, using the fastest comparison
+// that this processor supports.  Returns the difference between the first
+// pair that differs, or 0.
+static int compareNoCase(const char* str1, const char* str2, int strLength) {
+#ifdef SIMD_CASE
+    static CompareFunction compareFunction = selectCompare();
+    if ( strLength >= 16 ) {
+        return( compareFunction(str1, str2, strLength) );
+    }
+#endif
+    return( compareNoCaseScalar(str1, str2, strLength) );
+}
+
+// Converts the letters in the given word of characters to lower-case.  Bytes
+// with the high bit set are left alone; in the rest, the high bit of each sum
+// shows whether the byte is at least 'A', or more than 'Z'.
+static unsigned long long lowerWord(unsigned long long word) {
+    unsigned long long lowBits;
+    unsigned long long upperMask;
+    lowBits = word & LOW_BITS_WORD;
+    upperMask =
+        (lowBits + ((~0ULL / 255) * (128 - 'A'))) &
+        ~(lowBits + ((~0ULL / 255) * (127 - 'Z'))) &
+        ~word & ((~0ULL / 255) * 128);
+    return( word | (upperMask >> 2) );
+}
+
+
+// *** COMMON STRING FUNCTIONS *** //
+
+// Converts the given character string to upper-case.
+int r3cStrUpper(char* str) {
+    if ( str == NULL ) return( 0 );
+    return( flipCase(str, (int)strlen(str), 'a') );
+}
+
+// Converts the given character string to lower-case.
+int r3cStrLower(char* str) {
+    if ( str == NULL ) return( 0 );
+    return( flipCase(str, (int)strlen(str), 'A') );
+}
+
+// Converts the given characters to upper-case.
+int r3cStrUpper(char* str, int strLength) {
+#ifndef R3C_NOERRCHECK
+    if ( strLength < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( str == NULL ) return( 0 );
+    return( flipCase(str, strLength, 'a') );
+}
+
+// Converts the given characters to lower-case.
+int r3cStrLower(char* str, int strLength) {
+#ifndef R3C_NOERRCHECK
+    if ( strLength < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( str == NULL ) return( 0 );
+    return( flipCase(str, strLength, 'A') );
+}
+
+// Compares the given characters, ignoring the case of letters.
+int r3cStrCompareNoCase(
+    const char* str1, int length1, const char* str2, int length2
+) {
+    int result;
+#ifndef R3C_NOERRCHECK
+    if ( (length1 < 0) || (length2 < 0) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    result = compareNoCase(
+        str1, str2, (length1 < length2) ? length1 : length2);
+    if ( result == 0 ) result = length1 - length2;
+    return( result );
+}
+
+// Computes a hash of the given characters, ignoring the case of letters.
+unsigned int r3cStrHashNoCase(const char* str, int strLength) {
+    unsigned long long result;
+    unsigned long long word;
+    int pos;
+#ifndef R3C_NOERRCHECK
+    if ( strLength < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    // Mix in a word (8 characters) at a time, with the last word padded with
+    // zeros
+    result = (unsigned long long)strLength * HASH_MULTIPLIER;
+    for ( pos = 0; pos < strLength; pos += 8 ) {
+        word = 0;
+        memcpy(
+            &word, str + pos, ((strLength - pos) < 8) ? (strLength - pos) : 8);
+        result = (result ^ lowerWord(word)) * HASH_MULTIPLIER;
+        result ^= result >> 29;
+    }
+    result ^= result >> 32;
+    return( (unsigned int)result );
+}
+
 // Left-trims the given character string.
 int r3cStrLTrim(char* str, const char* trimChars) {
-	char* curPtr;
-	int strLength, result;
-
-    // If a NULL or empty string, return 0.
-	if ( (str == NULL) || (trimChars == NULL) ) return( 0 );
-	curPtr = str;
-	if ( (*curPtr) == '\0' ) return( 0 );
+    R3CCharSet buildSet;
+    const char* startPtr;
+    int result;
+    if ( (str == NULL) || (trimChars == NULL) ) return( 0 );
 
-    // Pass over characters that should be trimmed.
-	while ( strchr(trimChars, *curPtr) != NULL ) {
-		curPtr++;
-	}
+    // Pass over characters that should be trimmed, stopping at the
+    // null-terminator
+    startPtr = R3CCharSet::getSet(trimChars, &buildSet)->passChars(str);
 
     // If any characters were passed over, move the remaining string (and its
-    // null-terminator) to the front.
-	result = 0;
-	if ( curPtr > str ) {
-		result = (int)(curPtr - str);
-		strLength = (int)strlen(curPtr);
-		memmove(str, curPtr, strLength + 1);
-	}
-
-    // Return the number of characters trimmed.
-	return( result );
+    // null-terminator) to the front
+    result = (int)(startPtr - str);
+    if ( result > 0 ) memmove(str, startPtr, strlen(startPtr) + 1);
+    return( result );
 }
 
 // Right-trims the given character string.
 int r3cStrRTrim(char* str, const char* trimChars) {
-	char* curPtr;
-	char* endPtr;
-	int strLength, result;
-	char curChar;
-	bool done;
-
-    // If a NULL or empty string, return 0.
-	if ( (str == NULL) || (trimChars == NULL) ) return( 0 );
-	strLength = (int)strlen(str);
-	if ( strLength == 0 ) return( 0 );
-
-    // Starting with the last character, and moving backwards, pass over
-    // characters that should be trimmed.
-	curPtr = endPtr = str + strLength - 1;
-	done = false;
-	while ( !done ) {
-		curChar = *curPtr;
-		if ( strchr(trimChars, curChar) != NULL ) {
-			curPtr--;
-			if ( curPtr < str ) done = true;
-		} else {
-			done = true;
-		}
-	}
-
-    // If any characters were passed over, terminate the string.
-	result = 0;
-	if ( curPtr < endPtr ) {
-		curPtr[1] = 0;
-		result = (int)(endPtr - curPtr);
-	}
-
-    // Return the number of characters trimmed.
-	return( result );
+    if ( (str == NULL) || (trimChars == NULL) ) return( 0 );
+    return( r3cStrRTrim(str, (int)strlen(str), trimChars) );
 }
 
 // Fully trims the given character string.
 int r3cStrTrim(char* str, const char* trimChars) {
-	int strLength, charsTrimmed, result;
-	char* curPtr;
-	char* endPtr;
-	char curChar;
-	bool done;
-
-    // If a NULL or empty string, return 0.
-	if ( (str == NULL) || (trimChars == NULL) ) return( 0 );
-	strLength = (int)strlen(str);
-	if ( strLength == 0 ) return( 0 );
-
-    // Starting with the last character, and moving backwards, pass over
-    // characters that should be trimmed.
-	result = 0;
-	curPtr = endPtr = str + strLength - 1;
-	done = false;
-	while ( !done ) {
-		curChar = *curPtr;
-		if ( strchr(trimChars, curChar) ) {
-			curPtr--;
-			if ( curPtr < str ) done = true;
-		} else {
-			done = true;
-		}
-	}
-
-    // If any characters were passed over, terminate the string.
-	if ( curPtr < endPtr ) {
-		curPtr[1] = 0;
-		result = (int)(endPtr - curPtr);
-		strLength -= result;
-	}
-
-    // Pass over characters that should be trimmed.
-	curPtr = str;
-	if ( (*curPtr) != '\0' ) {
-		while ( strchr(trimChars, *curPtr) != NULL ) {
-			curPtr++;
-		}
-	}
+    if ( (str == NULL) || (trimChars == NULL) ) return( 0 );
+    return( r3cStrTrim(str, (int)strlen(str), trimChars) );
+}
 
-    // If any characters were passed over, move the remaining string (and its
-    // null-terminator) to the front.
-	if ( curPtr > str ) {
-		charsTrimmed = (int)(curPtr - str);
-		result += charsTrimmed;
-		memmove(str, curPtr, strLength - charsTrimmed + 1);
-	}
+// Left-trims the given characters, whose length is already known.
+int r3cStrLTrim(char* str, int strLength, const char* trimChars) {
+    R3CCharSet buildSet;
+    const char* startPtr;
+    int result;
+#ifndef R3C_NOERRCHECK
+    if ( strLength < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( (str == NULL) || (trimChars == NULL) ) return( 0 );
+    startPtr = R3CCharSet::getSet(trimChars, &buildSet)->passChars(
+        str, str + strLength);
+    result = (int)(startPtr - str);
+    if ( result > 0 ) {
+        memmove(str, startPtr, strLength - result);
+        str[strLength - result] = '\0';
+    }
+    return( result );
+}
 
-    // Return the number of characters trimmed.
-	return( result );
+// Right-trims the given characters, whose length is already known.
+int r3cStrRTrim(char* str, int strLength, const char* trimChars) {
+    R3CCharSet buildSet;
+    const char* endPtr;
+    int result;
+#ifndef R3C_NOERRCHECK
+    if ( strLength < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( (str == NULL) || (trimChars == NULL) ) return( 0 );
+    endPtr = R3CCharSet::getSet(trimChars, &buildSet)->passCharsBack(
+        str, str + strLength);
+    result = strLength - (int)(endPtr - str);
+    if ( result > 0 ) str[strLength - result] = '\0';
+    return( result );
+}
+
+// Fully trims the given characters, whose length is already known.
+int r3cStrTrim(char* str, int strLength, const char* trimChars) {
+    int startPos;
+    int trimLength;
+#ifndef R3C_NOERRCHECK
+    if ( strLength < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    if ( (str == NULL) || (trimChars == NULL) ) return( 0 );
+    r3cStrTrimBounds(str, strLength, trimChars, &startPos, &trimLength);
+
+    // Move the remaining characters once, and only if they need to move
+    if ( trimLength < strLength ) {
+        if ( startPos > 0 ) memmove(str, str + startPos, trimLength);
+        str[trimLength] = '\0';
+    }
+    return( strLength - trimLength );
+}
+
+// Finds the characters that would remain if the given characters were fully
+// trimmed.
+void r3cStrTrimBounds(
+    const char* str, int strLength, const char* trimChars,
+    int* startPos, int* trimLength
+) {
+    R3CCharSet buildSet;
+    R3CCharSet* trimSet;
+    const char* startPtr;
+    const char* endPtr;
+#ifndef R3C_NOERRCHECK
+    if (
+        (trimChars == NULL) || (startPos == NULL) || (trimLength == NULL) ||
+        (strLength < 0)
+    ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
+#endif
+    if ( (str == NULL) || (strLength == 0) ) {
+        *startPos = 0;
+        *trimLength = 0;
+        return;
+    }
+
+    // Scan from the front, then (if anything remains) from the back
+    trimSet = R3CCharSet::getSet(trimChars, &buildSet);
+    startPtr = trimSet->passChars(str, str + strLength);
+    endPtr = trimSet->passCharsBack(startPtr, str + strLength);
+    *startPos = (int)(startPtr - str);
+    *trimLength = (int)(endPtr - startPtr);
 }
 
 // Passes over the given passable character in the target character string,
@@ -235,13 +554,9 @@ const char* r3cStrPassChar(
 // Passes over all characters in the target character string that match the
 // given passable characters.
 const char* r3cStrPassChars(const char* targetStr, const char* passChars) {
-    register const char* result;
+    R3CCharSet buildSet;
     if ( (targetStr == NULL) || (passChars == NULL) ) return( targetStr );
-    result = targetStr;
-    while ( strchr(passChars, *result) != NULL ) {
-        result++;
-    }
-    return( result );
+    return( R3CCharSet::getSet(passChars, &buildSet)->passChars(targetStr) );
 }
 
 // Passes over all characters in the target character string that match the
@@ -249,31 +564,13 @@ const char* r3cStrPassChars(const char* targetStr, const char* passChars) {
 const char* r3cStrPassChars(
     const char* targetStr, const char* passChars, int charCount
 ) {
-    register const char* result;
-    register char curChar;
-    register int charLoop;
+    R3CCharSet buildSet;
 #ifndef R3C_NOERRCHECK
     if ( charCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
 #endif
     if ( (targetStr == NULL) || (passChars == NULL) ) return( targetStr );
-    result = targetStr;
-    charLoop = 0;
-    if ( passChars == NULL ) {
-        while ( (*result != '\0') && (charLoop < charCount) ) {
-            result++;
-            charLoop++;
-        }
-    } else {
-        curChar = *result;
-        while (
-            (strchr(passChars, curChar) != NULL) && (charLoop < charCount)
-        ) {
-            result++;
-            charLoop++;
-            curChar = *result;
-        }
-    }
-    return( result );
+    return( R3CCharSet::getSet(passChars, &buildSet)->passChars(
+        targetStr, charCount) );
 }
 
 // Passes over all characters in the target character string that are within
@@ -281,22 +578,8 @@ const char* r3cStrPassChars(
 const char* r3cStrPassChars(
     const char* targetStr, char firstPassChar, char lastPassChar
 ) {
-    register const char* result;
-    register char curChar;
-#ifndef R3C_NOERRCHECK
-    if ( firstPassChar > lastPassChar ) throw R3CERR_ILLEGALARGUMENT;
-#endif
-    if ( targetStr == NULL ) return( targetStr );
-    result = targetStr;
-    curChar = *result;
-    while (
-        (curChar >= firstPassChar) && (curChar <= lastPassChar) &&
-        (curChar != '\0')
-    ) {
-        result++;
-        curChar = *result;
-    }
-    return( result );
+    R3CCharSet passSet(firstPassChar, lastPassChar);
+    return( passSet.passChars(targetStr) );
 }
 
 // Passes over all characters in the target character string that are within
@@ -307,27 +590,8 @@ const char* r3cStrPassChars(
     char firstPassChar, char lastPassChar,
     int charCount
 ) {
-    register const char* result;
-    register char curChar;
-    register int charLoop;
-#ifndef R3C_NOERRCHECK
-    if ( firstPassChar > lastPassChar ) throw R3CERR_ILLEGALARGUMENT;
-    if ( charCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
-#endif
-    if ( targetStr == NULL ) return( targetStr );
-    result = targetStr;
-    curChar = *result;
-    charLoop = 0;
-    while (
-        (curChar >= firstPassChar) && (curChar <= lastPassChar) &&
-        (curChar != '\0') &&
-        (charLoop < charCount)
-    ) {
-        result++;
-        curChar = *result;
-        charLoop++;
-    }
-    return( result );
+    R3CCharSet passSet(firstPassChar, lastPassChar);
+    return( passSet.passChars(targetStr, charCount) );
 }
 
 // Passes over all characters in the target character string that are within
@@ -336,59 +600,13 @@ const char* r3cStrPassChars(
     const char* targetStr,
     const char passGroups[][2], int groupCount
 ) {
-    const char* result;
-    int groupLoop;
-    char curChar;
-    bool groupsDone, done;
-
+    R3CCharSet passSet;
 #ifndef R3C_NOERRCHECK
-    // Check for illegal arguments
     if ( groupCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
-    if ( passGroups != NULL ) {
-        for ( groupLoop = 0; groupLoop < groupCount; groupLoop++ ) {
-            if ( passGroups[groupLoop][0] > passGroups[groupLoop][1] ) {
-                throw R3CERR_ILLEGALARGUMENT;
-            }
-        }
-    }
 #endif
-
-    // Check if no characters need to be passed over
-    if (
-        (targetStr == NULL) ||
-        (passGroups == NULL) ||
-        (groupCount == 0)
-    ) {
-        return( targetStr );
-    }
-
-    // Pass over all characters in any of the passable character groups
-    result = targetStr;
-    done = false;
-    while ( !done ) {
-        curChar = *result;
-        if ( curChar == '\0' ) {
-            done = true;
-        } else {
-            groupLoop = 0;
-            groupsDone = false;
-            while ( !groupsDone && !done ) {
-                if (
-                    (curChar >= passGroups[groupLoop][0]) &&
-                    (curChar <= passGroups[groupLoop][1])
-                ) {
-                    result++;
-                    groupsDone = true;
-                } else {
-                    groupLoop++;
-                    if ( groupLoop >= groupCount ) done = true;
-                }
-            }
-        }
-    }
-
-    // Return a pointer to the next character
-    return( result );
+    if ( passGroups == NULL ) return( targetStr );
+    passSet.add(passGroups, groupCount);
+    return( passSet.passChars(targetStr) );
 }
 
 // Passes over all characters in the target character string that are within
@@ -399,60 +617,18 @@ const char* r3cStrPassChars(
     const char passGroups[][2], int groupCount,
     int charCount
 ) {
-    const char* result;
-    int groupLoop, charLoop;
-    char curChar;
-    bool groupsDone, done;
-
+    R3CCharSet passSet;
 #ifndef R3C_NOERRCHECK
-    // Check for illegal arguments
     if ( groupCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
-    if ( passGroups != NULL ) {
-        for ( groupLoop = 0; groupLoop < groupCount; groupLoop++ ) {
-            if ( passGroups[groupLoop][0] > passGroups[groupLoop][1] ) {
-                throw R3CERR_ILLEGALARGUMENT;
-            }
-        }
-    }
-    if ( charCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
 #endif
-
-    // Check if no characters need to be passed over
-    if (
-        (targetStr == NULL) ||
-        (passGroups == NULL) ||
-        (groupCount == 0)
-    ) {
+    if ( passGroups == NULL ) {
+#ifndef R3C_NOERRCHECK
+        if ( charCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
+#endif
         return( targetStr );
     }
-
-    // Pass over all characters in any of the passable character groups
-    result = targetStr;
-    charLoop = 0;
-    done = false;
-    while ( !done ) {
-        curChar = *result;
-        if ( (curChar == '\0') || (charLoop >= charCount) ) {
-            done = true;
-        } else {
-            groupLoop = 0;
-            groupsDone = false;
-            while ( !groupsDone && !done ) {
-                if (
-                    (curChar >= passGroups[groupLoop][0]) &&
-                    (curChar <= passGroups[groupLoop][1])
-                ) {
-                    result++;
-                    charLoop++;
-                    groupsDone = true;
-                } else {
-                    groupLoop++;
-                    if ( groupLoop >= groupCount ) done = true;
-                }
-            }
-        }
-    }
-    return( result );
+    passSet.add(passGroups, groupCount);
+    return( passSet.passChars(targetStr, charCount) );
 }
 
 // Passes over all characters in the target character string, until it finds
@@ -473,13 +649,9 @@ const char* r3cStrReachChar(const char* targetStr, char reachChar) {
 // Passes over all characters in the target character string, until it finds
 // one of the reachable characters.
 const char* r3cStrReachChars(const char* targetStr, const char* reachChars) {
-    register const char* result;
+    R3CCharSet buildSet;
     if ( (targetStr == NULL) || (reachChars == NULL) ) return( targetStr );
-    result = targetStr;
-    while ( strchr(reachChars, *result) == NULL ) {
-        result++;
-    }
-    return( result );
+    return( R3CCharSet::getSet(reachChars, &buildSet)->reachChars(targetStr) );
 }
 
 // Passes over all characters in the target character string, until it finds
@@ -488,27 +660,8 @@ const char* r3cStrReachChars(
     const char* targetStr,
     char firstReachChar, char lastReachChar
 ) {
-    register const char* result;
-    register char curChar;
-    bool done;
-#ifndef R3C_NOERRCHECK
-    if ( firstReachChar > lastReachChar ) throw R3CERR_ILLEGALARGUMENT;
-#endif
-    if ( targetStr == NULL ) return( targetStr );
-    result = targetStr;
-    done = false;
-    while ( !done ) {
-        curChar = *result;
-        if (
-            ( (curChar >= firstReachChar) && (curChar <= lastReachChar) ) ||
-            (curChar == '\0')
-        ) {
-            done = true;
-        } else {
-            result++;
-        }
-    }
-    return( result );
+    R3CCharSet reachSet(firstReachChar, lastReachChar);
+    return( reachSet.reachChars(targetStr) );
 }
 
 // Passes over all characters in the target character string, until it finds a
@@ -517,167 +670,113 @@ const char* r3cStrReachChars(
     const char* targetStr,
     const char reachGroups[][2], int groupCount
 ) {
-    const char* result;
-    int groupLoop;
-    char curChar;
-    bool groupsDone, done;
-
+    R3CCharSet reachSet;
 #ifndef R3C_NOERRCHECK
-    // Check for illegal arguments
     if ( groupCount < 0 ) throw R3CERR_ILLEGALARGUMENT;
-    if ( reachGroups != NULL ) {
-        for ( groupLoop = 0; groupLoop < groupCount; groupLoop++ ) {
-            if ( reachGroups[groupLoop][0] > reachGroups[groupLoop][1] ) {
-                throw R3CERR_ILLEGALARGUMENT;
-            }
-        }
-    }
 #endif
+    if ( (reachGroups == NULL) || (groupCount == 0) ) return( targetStr );
+    reachSet.add(reachGroups, groupCount);
+    return( reachSet.reachChars(targetStr) );
+}
 
-    // Check if no characters need to be passed over
-    if (
-        (targetStr == NULL) ||
-        (reachGroups == NULL) ||
-        (groupCount == 0)
-    ) {
-        return( targetStr );
-    }
-
-    // Pass over all characters until a reachable character is found
+// Passes over all newline characters and null-terminators in the target
+// character buffer.
+const char* r3cStrPassNewlines(const char* targetStr, const char* endStr) {
+    register const char* result;
+    if ( targetStr == NULL ) return( targetStr );
     result = targetStr;
-    done = false;
-    while ( !done ) {
-        curChar = *result;
-        if ( curChar == '\0' ) {
-            done = true;
-        } else {
-            groupLoop = 0;
-            groupsDone = false;
-            while ( !groupsDone && !done ) {
-                if (
-                    (curChar >= reachGroups[groupLoop][0]) &&
-                    (curChar <= reachGroups[groupLoop][1])
-                ) {
-                    done = true;
-                } else {
-                    groupLoop++;
-                    if ( groupLoop >= groupCount ) groupsDone = true;
-                }
-            }
-            if ( !done ) result++;
-        }
+    while ( (result < endStr) && IS_NEWLINE(*result) ) {
+        result++;
     }
-
-    // Return a pointer to the next character
     return( result );
 }
 
-// Match ? wildcards between strings. This function is used internally.
-// Returns true if charCount characters from str match the pattern.
-bool r3cQmarkMatch(const char* str, const char* pattern, int charCount) {
-	int loop;
-	char patternChar, strChar;
-	for ( loop = 0; loop < charCount; loop++ ) {
-		patternChar = *pattern;
-		strChar = *str;
-		if ( (patternChar == 0) || (strChar == 0) ) return( false );
-		if ( patternChar != '?' ) {
-			if ( patternChar != strChar ) return( false );
-		}
-		pattern++;
-		str++;
-	}
-	return( true );
-}
-
-// Finds the first character string from str that matches charCount characters
-// in pattern.
-int r3cFindQmarkMatch(const char* str, const char* pattern, int charCount) {
-    const char* nonQmarkPatternPtr;
-    int qmarkCount, nonQmarkCount;
-    char matchChar;
-    const char* searchStrPtr;
-    int result;
-    bool done;
-
-    // Find first non-? character in str
-    nonQmarkPatternPtr = r3cStrPassChar(str, '?', charCount);
-    qmarkCount = (int)(nonQmarkPatternPtr - pattern);
-
-    // If all ? characters, automatically match
-    if ( qmarkCount == charCount ) return( charCount );
+// Passes over all characters in the target character buffer, until it finds a
+// newline character or null-terminator.
+const char* r3cStrReachNewline(const char* targetStr, const char* endStr) {
+    register const char* result;
+    unsigned long curWord;
+    int charLoop;
+    if ( targetStr == NULL ) return( targetStr );
+    result = targetStr;
 
-    // Match the first non-? character from pattern in str
-    nonQmarkCount = charCount - qmarkCount;
-    matchChar = *nonQmarkPatternPtr;
-    if ( matchChar == '\0' ) return( 0 );
-    searchStrPtr = str + qmarkCount;
-    result = 0;
-    do {
-        searchStrPtr = strchr(searchStrPtr, matchChar);
-        if ( searchStrPtr == NULL ) {
-            done = true;
-        } else {
-            done = r3cQmarkMatch(
-                searchStrPtr, nonQmarkPatternPtr, nonQmarkCount);
-            if ( done ) {
-                result = (int)(searchStrPtr - str) + charCount;
+    // Check a whole word at a time; every newline character and the
+    // null-terminator is below NEWLINE_LIMIT, so words without any character
+    // below that limit are skipped without checking each character
+    while ( result < endStr ) {
+        if ( (endStr - result) >= (int)sizeof(unsigned long) ) {
+            memcpy(&curWord, result, sizeof(unsigned long));
+            if ( ((curWord - LIMIT_WORD) & ~curWord & HIGH_BITS_WORD) == 0 ) {
+                result += sizeof(unsigned long);
+            } else {
+                for ( charLoop = 0; charLoop < (int)sizeof(unsigned long);
+                    charLoop++ )
+                {
+                    if ( IS_NEWLINE(result[charLoop]) ) {
+                        return( result + charLoop );
+                    }
+                }
+                result += sizeof(unsigned long);
             }
+        } else {
+            if ( IS_NEWLINE(*result) ) return( result );
+            result++;
         }
-    } while ( !done );
-
-    // Return the number of characters passed
+    }
     return( result );
 }
 
 // Checks if the given character string matches a filename pattern.
 bool r3cPathMatch(const char* str, const char* pattern) {
-	const char* strPtr;
+#ifndef R3C_NOERRCHECK
+    if ( (str == NULL) || (pattern == NULL) ) throw R3CERR_ILLEGALARGUMENT;
+#endif
+    return( r3cPathMatch(str, (int)strlen(str), pattern) );
+}
+
+// Checks if the given characters match a filename pattern.
+bool r3cPathMatch(const char* str, int strLength, const char* pattern) {
+    const char* strPtr;
+    const char* endPtr;
     const char* patternPtr;
-    const char* starPtr;
-    int charCount;
-    bool done, result;
+    const char* starPatternPtr;
+    const char* starStrPtr;
 
 #ifndef R3C_NOERRCHECK
     // Check for illegal arguments
-	if ( (str == NULL) || (pattern == NULL) ) throw R3CERR_ILLEGALARGUMENT;
+    if ( (str == NULL) || (pattern == NULL) || (strLength < 0) ) {
+        throw R3CERR_ILLEGALARGUMENT;
+    }
 #endif
 
+    // Match characters one at a time, remembering the last * seen; on a
+    // mismatch, let that * absorb one more character and try again
     strPtr = str;
+    endPtr = str + strLength;
     patternPtr = pattern;
-    done = false;
-    while ( !done ) {
-        starPtr = strchr(patternPtr, '*');
-        if ( starPtr == NULL ) {
-            // Pattern contains no *, so match the remaining string
-            charCount = (int)strlen(strPtr);
-            result = r3cQmarkMatch(strPtr, patternPtr, charCount);
-            done = true;
-        } else if ( starPtr != patternPtr ) {
-            // Pattern contains a * ahead, so match up to that *
-            charCount = (int)(starPtr - patternPtr);
-            result = r3cQmarkMatch(strPtr, patternPtr, charCount);
-            if ( result ) {
-                strPtr += charCount;
-                patternPtr += charCount;
-            } else {
-                done = true;
-            }
-        } else {
-            // We are at a *, so search ahead for matching non-star section
+    starPatternPtr = NULL;
+    starStrPtr = NULL;
+    while ( strPtr < endPtr ) {
+        if ( *patternPtr == '*' ) {
             patternPtr++;
-            starPtr = r3cStrReachChar(patternPtr, '*');
-            if ( starPtr != patternPtr ) {
-                charCount = r3cFindQmarkMatch(
-                    strPtr, patternPtr, (int)(starPtr - patternPtr));
-                if ( charCount > 0 ) {
-                    strPtr += charCount;
-                    patternPtr += charCount;
-                } else {
-                    done = true;
-                }
-            }
+            starPatternPtr = patternPtr;
+            starStrPtr = strPtr;
+        } else if (
+            (*patternPtr != '\0') &&
+            ((*patternPtr == '?') || (*patternPtr == *strPtr))
+        ) {
+            patternPtr++;
+            strPtr++;
+        } else if ( starPatternPtr != NULL ) {
+            patternPtr = starPatternPtr;
+            starStrPtr++;
+            strPtr = starStrPtr;
+        } else {
+            return( false );
         }
     }
-    return( result );
+
+    // Any trailing * characters match the empty string
+    while ( *patternPtr == '*' ) patternPtr++;
+    return( *patternPtr == '\0' );
 }
@@ -0,0 +1,179 @@
+/*! \file format-benchmark.cpp
+ *
+ *  Times R3CString::appendf, which formats through the conversion kernels,
+ *  against the snprintf path it replaced: formatting into a stack buffer
+ *  with snprintf, then appending the result.  Each format is appended to a
+ *  string that is cleared every 1000 calls, so growth is not measured, and
+ *  the total output of both paths is compared as a sanity check.
+ *
+ *  Build and run from the repository root:
+ *  \code
+ *  g++ -O2 -I. tests/format-benchmark.cpp string/R3C*.cpp \
+ *      string/r3c-string.cpp r3c.cpp -lpthread -o format-benchmark
+ *  ./format-benchmark [callCount]
+ *  \endcode
+ */
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+// *** CONSTANTS *** //
+
+// Default number of calls timed for each format
+#define DEFAULT_CALL_COUNT 2000000
+
+// Number of values cycled through, so that no single value is measured
+#define VALUE_COUNT 1024
+
+// Arguments taken by a format
+#define ARGS_INT 0
+#define ARGS_DOUBLE 1
+#define ARGS_INT_DOUBLE 2
+
+
+// *** BENCHMARK FORMATS *** //
+
+// Format being timed.
+struct BenchmarkFormat {
+
+    // Format string
+    const char* format;
+
+    // Arguments taken by the format
+    int args;
+
+};
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Integer values being formatted.
+static int intValues[VALUE_COUNT];
+
+// Floating-point values being formatted.
+static double doubleValues[VALUE_COUNT];
+
+// Returns the current time in seconds.
+static double getSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return( now.tv_sec + (now.tv_nsec * 1e-9) );
+}
+
+// Appends the formatted values through appendf.
+static void appendAppendf(
+    R3CString* str, const BenchmarkFormat* format, int index
+) {
+    switch ( format->args ) {
+        case ARGS_INT:
+            str->appendf(format->format, intValues[index]);
+            break;
+        case ARGS_DOUBLE:
+            str->appendf(format->format, doubleValues[index]);
+            break;
+        default:
+            str->appendf(
+                format->format, intValues[index], doubleValues[index]);
+    }
+}
+
+// Appends the formatted values through snprintf, as appendf once did.
+static void appendSnprintf(
+    R3CString* str, const BenchmarkFormat* format, int index
+) {
+    char buffer[256];
+    int length;
+    switch ( format->args ) {
+        case ARGS_INT:
+            length = snprintf(
+                buffer, sizeof(buffer), format->format, intValues[index]);
+            break;
+        case ARGS_DOUBLE:
+            length = snprintf(
+                buffer, sizeof(buffer), format->format, doubleValues[index]);
+            break;
+        default:
+            length = snprintf(
+                buffer, sizeof(buffer), format->format, intValues[index],
+                doubleValues[index]);
+    }
+    str->append(buffer, length);
+}
+
+// Times the given format through both paths, and prints the results.
+static void timeFormat(const BenchmarkFormat* format, long callCount) {
+    R3CString str;
+    double startTime;
+    double appendfTime;
+    double snprintfTime;
+    long appendfChars;
+    long snprintfChars;
+
+    appendfChars = 0;
+    startTime = getSeconds();
+    for ( long i = 0; i < callCount; i++ ) {
+        if ( (i % 1000) == 0 ) {
+            appendfChars += str.getLength();
+            str.clear();
+        }
+        appendAppendf(&str, format, (int)(i % VALUE_COUNT));
+    }
+    appendfTime = getSeconds() - startTime;
+    appendfChars += str.getLength();
+    str.clear();
+
+    snprintfChars = 0;
+    startTime = getSeconds();
+    for ( long i = 0; i < callCount; i++ ) {
+        if ( (i % 1000) == 0 ) {
+            snprintfChars += str.getLength();
+            str.clear();
+        }
+        appendSnprintf(&str, format, (int)(i % VALUE_COUNT));
+    }
+    snprintfTime = getSeconds() - startTime;
+    snprintfChars += str.getLength();
+
+    printf(
+        "%-24s appendf %7.1f ns   snprintf %7.1f ns   speedup %5.2fx%s\n",
+        format->format, (appendfTime * 1e9) / callCount,
+        (snprintfTime * 1e9) / callCount, snprintfTime / appendfTime,
+        (appendfChars == snprintfChars) ? "" : "   (OUTPUT DIFFERS)");
+}
+
+
+// *** MAIN PROGRAM *** //
+
+int main(int argc, char** argv) {
+    static const BenchmarkFormat formats[] = {
+        { "%d", ARGS_INT },
+        { "%8d", ARGS_INT },
+        { "%x", ARGS_INT },
+        { "%08X", ARGS_INT },
+        { "%.0f", ARGS_DOUBLE },
+        { "%.2f", ARGS_DOUBLE },
+        { "%10.3f", ARGS_DOUBLE },
+        { "%e", ARGS_DOUBLE },
+        { "%.17g", ARGS_DOUBLE },
+        { "%g", ARGS_DOUBLE },
+        { "id=%d value=%.3f", ARGS_INT_DOUBLE },
+        { "[%-6d|%+.4e]", ARGS_INT_DOUBLE }
+    };
+    long callCount;
+    callCount = DEFAULT_CALL_COUNT;
+    if ( argc > 1 ) callCount = atol(argv[1]);
+    srand(1);
+    for ( int i = 0; i < VALUE_COUNT; i++ ) {
+        intValues[i] = rand() - (RAND_MAX / 2);
+        doubleValues[i] = ((double)rand() / RAND_MAX) * 1e6 - 5e5;
+    }
+    for ( unsigned i = 0; i < sizeof(formats) / sizeof(formats[0]); i++ ) {
+        timeFormat(&formats[i], callCount);
+    }
+    return( 0 );
+}
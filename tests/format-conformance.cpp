@@ -0,0 +1,340 @@
+/*! \file format-conformance.cpp
+ *
+ *  Checks R3CString::appendf against snprintf, over randomly built
+ *  conversions: every supported conversion character and size, every flag
+ *  that the C standard defines for it, and random widths, precisions and
+ *  values, including edge cases such as 0, the limits of each type, and
+ *  floating-point values that fall on rounding boundaries.
+ *
+ *  Build and run from the repository root:
+ *  \code
+ *  g++ -O2 -I. tests/format-conformance.cpp string/R3C*.cpp \
+ *      string/r3c-string.cpp r3c.cpp -lpthread -o format-conformance
+ *  ./format-conformance [caseCount] [seed]
+ *  \endcode
+ *
+ *  The program prints the first mismatches found, and exits with status 1
+ *  if there were any.
+ *
+ *  One known glibc defect is counted separately rather than as a mismatch:
+ *  for the # flag with g or G, where rounding carries into a new power of
+ *  ten, glibc drops the trailing zeros (printing "1.e+02" for %#.2g of
+ *  99.7), while the C standard, and appendf, keep them ("1.0e+02").
+ */
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <float.h>
+
+
+// *** CONSTANTS *** //
+
+// Default number of random conversions checked
+#define DEFAULT_CASE_COUNT 1000000
+
+// Number of mismatches printed before the rest are only counted
+#define MAX_REPORTED 20
+
+// Argument kinds
+#define ARG_INT 0
+#define ARG_LONG 1
+#define ARG_LONGLONG 2
+#define ARG_SIZE 3
+#define ARG_DOUBLE 4
+#define ARG_POINTER 5
+#define ARG_STRING 6
+
+
+// *** HELPER FUNCTIONS *** //
+
+// State of the random number generator.
+static uint64_t randomState = 88172645463325252ULL;
+
+// Returns the next random number.
+static uint64_t nextRandom() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+    return( randomState );
+}
+
+// Returns a random number from 0 up to, but not including, limit.
+static int randomBelow(int limit) {
+    return( (int)(nextRandom() % (uint64_t)limit) );
+}
+
+// Returns a random integer, favoring small values and the limits of each
+// type.
+static long long randomInteger() {
+    static const long long edges[] = {
+        0, 1, -1, 9, 10, -10, 99, 100, 127, 128, -128, 255, 256, 32767,
+        -32768, 65535, 65536, INT_MAX, INT_MIN, UINT_MAX, LLONG_MAX,
+        LLONG_MIN, 1000000000LL, 9999999999LL, 1000000000000000000LL
+    };
+    switch ( randomBelow(4) ) {
+        case 0:
+            return( edges[randomBelow(sizeof(edges) / sizeof(edges[0]))] );
+        case 1:
+            return( (long long)randomBelow(2001) - 1000 );
+        default:
+            return( (long long)(nextRandom() >> randomBelow(64)) *
+                (randomBelow(2) ? 1 : -1) );
+    }
+}
+
+// Returns a random finite double, favoring values whose digits end on a
+// rounding boundary.
+static double randomDouble() {
+    static const double edges[] = {
+        0.0, -0.0, 0.5, 1.5, 2.5, -2.5, 0.125, 0.05, 0.15, 0.25, 0.35,
+        9.5, 99.5, 999.5, 1e15, 1e16, 1e17, 1e22, 1e23, 123456789.0,
+        0.1, 0.2, 0.3, 1.0 / 3.0, 2.0 / 3.0, DBL_MAX, -DBL_MAX, DBL_MIN,
+        DBL_MIN / 4, DBL_EPSILON, 9.999999999999999e22, 5e-324
+    };
+    uint64_t bits;
+    double result;
+    switch ( randomBelow(5) ) {
+        case 0:
+            return( edges[randomBelow(sizeof(edges) / sizeof(edges[0]))] );
+        case 1:
+            // Multiples of a power of 2 fall exactly halfway between digits
+            return( (double)((long long)randomBelow(200001) - 100000) /
+                (double)(1LL << randomBelow(20)) );
+        case 2:
+            return( (double)randomInteger() );
+        default:
+            do {
+                bits = nextRandom();
+                memcpy(&result, &bits, sizeof(result));
+            } while ( (result != result) || (result - result != 0.0) );
+            return( result );
+    }
+}
+
+// Appends the given character to the given conversion.
+static void addChar(char* spec, char charToAdd) {
+    int specLength;
+    specLength = (int)strlen(spec);
+    spec[specLength] = charToAdd;
+    spec[specLength + 1] = '\0';
+}
+
+// Appends a random selection of the given flags to the given conversion.
+static void addFlags(char* spec, const char* flags) {
+    int flagCount;
+    flagCount = (int)strlen(flags);
+    for ( int i = 0; i < flagCount; i++ ) {
+        if ( randomBelow(4) == 0 ) addChar(spec, flags[i]);
+    }
+}
+
+// Appends a random width and precision to the given conversion.
+static void addWidthPrecision(char* spec, bool allowPrecision) {
+    char number[16];
+    if ( randomBelow(2) == 0 ) {
+        snprintf(number, sizeof(number), "%d", 1 + randomBelow(30));
+        strcat(spec, number);
+    }
+    if ( allowPrecision && (randomBelow(2) == 0) ) {
+        if ( randomBelow(8) == 0 ) {
+            strcat(spec, ".");
+        } else {
+            snprintf(number, sizeof(number), ".%d", randomBelow(25));
+            strcat(spec, number);
+        }
+    }
+}
+
+// Number of differences due to the known glibc defect.
+static long libcDefectCount = 0;
+
+// Copies the given characters, leaving out zeros and spaces.
+static void stripZeros(char* target, const char* source) {
+    for ( ; *source != '\0'; source++ ) {
+        if ( (*source != '0') && (*source != ' ') ) *target++ = *source;
+    }
+    *target = '\0';
+}
+
+// Checks if the given difference is glibc dropping the trailing zeros of a
+// %#g conversion that rounded up into a new power of ten.  Padding makes up
+// for the dropped zeros, so both results are the same length.
+static bool isLibcDefect(
+    const char* formatString, const char* expected, const char* actual
+) {
+    char expectedStripped[1024];
+    char actualStripped[1024];
+    int formatLength;
+    formatLength = (int)strlen(formatString);
+    if (
+        (strchr(formatString, '#') == NULL) ||
+        (strpbrk(formatString + formatLength - 2, "gG") == NULL)
+    ) {
+        return( false );
+    }
+    stripZeros(expectedStripped, expected);
+    stripZeros(actualStripped, actual);
+    return( strcmp(expectedStripped, actualStripped) == 0 );
+}
+
+// Formats the arguments with both appendf and vsnprintf, and reports any
+// difference.  Returns true if they match.
+static bool checkFormat(const char* formatString, ...) {
+    static int reportCount = 0;
+    R3CString actual;
+    va_list varArgs;
+    char expected[1024];
+    int expectedLength;
+    int actualLength;
+    va_start(varArgs, formatString);
+    expectedLength = vsnprintf(
+        expected, sizeof(expected), formatString, varArgs);
+    va_end(varArgs);
+    va_start(varArgs, formatString);
+    actualLength = actual.vappendf(formatString, varArgs);
+    va_end(varArgs);
+    if (
+        (expectedLength == actualLength) &&
+        (expectedLength == actual.getLength()) &&
+        (memcmp(expected, actual.getChars(), expectedLength) == 0)
+    ) {
+        return( true );
+    }
+    if ( isLibcDefect(formatString, expected, actual.getChars()) ) {
+        libcDefectCount++;
+        return( true );
+    }
+    if ( reportCount < MAX_REPORTED ) {
+        printf(
+            "MISMATCH %s\n  expected (%d) [%s]\n  actual   (%d) [%s]\n",
+            formatString, expectedLength, expected, actualLength,
+            actual.getChars());
+    }
+    reportCount++;
+    return( false );
+}
+
+// Builds and checks one random conversion, between literal text.  Returns
+// true if appendf matched snprintf.
+static bool checkRandomCase() {
+    static const char* signedChars = "di";
+    static const char* unsignedChars = "uxXo";
+    static const char* floatChars = "fFeEgG";
+    static const char* sizes[] = { "", "hh", "h", "l", "ll", "z" };
+    static const char* strings[] = { "", "a", "hello", "a longer string" };
+    char format[64];
+    char spec[32];
+    int argKind;
+    int sizeIndex;
+    char conversion;
+    long long intValue;
+
+    strcpy(spec, "%");
+    sizeIndex = 0;
+    switch ( randomBelow(10) ) {
+        case 0: case 1: case 2:
+            addFlags(spec, "-+ 0");
+            addWidthPrecision(spec, true);
+            sizeIndex = randomBelow(6);
+            conversion = signedChars[randomBelow(2)];
+            break;
+        case 3: case 4:
+            addFlags(spec, "-#0");
+            addWidthPrecision(spec, true);
+            sizeIndex = randomBelow(6);
+            conversion = unsignedChars[randomBelow(4)];
+            break;
+        case 5: case 6: case 7:
+            addFlags(spec, "-+ #0");
+            addWidthPrecision(spec, true);
+            conversion = floatChars[randomBelow(6)];
+            break;
+        case 8:
+            addFlags(spec, "-");
+            addWidthPrecision(spec, false);
+            conversion = randomBelow(2) ? 'c' : 'p';
+            break;
+        default:
+            addFlags(spec, "-");
+            addWidthPrecision(spec, true);
+            conversion = 's';
+    }
+    strcat(spec, sizes[sizeIndex]);
+    addChar(spec, conversion);
+    snprintf(format, sizeof(format), "<%s>", spec);
+
+    // Pass each value as the type that its conversion reads
+    if ( strchr("diuxXo", conversion) != NULL ) {
+        argKind = (sizeIndex == 3) ? ARG_LONG :
+            (sizeIndex == 4) ? ARG_LONGLONG :
+            (sizeIndex == 5) ? ARG_SIZE : ARG_INT;
+    } else if ( conversion == 'c' ) {
+        argKind = ARG_INT;
+    } else if ( conversion == 'p' ) {
+        argKind = ARG_POINTER;
+    } else if ( conversion == 's' ) {
+        argKind = ARG_STRING;
+    } else {
+        argKind = ARG_DOUBLE;
+    }
+    intValue = randomInteger();
+    switch ( argKind ) {
+        case ARG_INT:
+            if ( conversion == 'c' ) intValue = 32 + randomBelow(95);
+            return( checkFormat(format, (int)intValue) );
+        case ARG_LONG:
+            return( checkFormat(format, (long)intValue) );
+        case ARG_LONGLONG:
+            return( checkFormat(format, intValue) );
+        case ARG_SIZE:
+            return( checkFormat(format, (size_t)intValue) );
+        case ARG_DOUBLE:
+            return( checkFormat(format, randomDouble()) );
+        case ARG_POINTER:
+            return( checkFormat(
+                format, (const void*)(uintptr_t)(randomBelow(4) ?
+                    (unsigned long long)intValue : 0)) );
+        default:
+            return( checkFormat(format, strings[randomBelow(4)]) );
+    }
+}
+
+
+// *** MAIN PROGRAM *** //
+
+int main(int argc, char** argv) {
+    long caseCount;
+    long failCount;
+    caseCount = DEFAULT_CASE_COUNT;
+    if ( argc > 1 ) caseCount = atol(argv[1]);
+    if ( argc > 2 ) randomState = strtoull(argv[2], NULL, 10) | 1;
+    failCount = 0;
+
+    // A fixed format with several conversions goes through the shared
+    // parser cache rather than a local parse
+    for ( int i = 0; i < 1000; i++ ) {
+        if (
+            !checkFormat(
+                "%s=%d (%5.2f%%) [%08x] %-6s|%+.3e|%g", "name",
+                (int)randomInteger(), randomDouble(),
+                (unsigned)randomInteger(), "end", randomDouble(),
+                randomDouble())
+        ) {
+            failCount++;
+        }
+    }
+    for ( long i = 0; i < caseCount; i++ ) {
+        if ( !checkRandomCase() ) failCount++;
+    }
+    printf(
+        "%ld conversions checked, %ld mismatches, %ld known glibc %%#g "
+        "differences\n", caseCount + 1000, failCount, libcDefectCount);
+    return( (failCount == 0) ? 0 : 1 );
+}
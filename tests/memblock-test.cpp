@@ -0,0 +1,242 @@
+/*! \file memblock-test.cpp
+ *
+ *  Checks that R3CTextInputMemBlock reads every string of an R3CStringBlock
+ *  as a line, in the order the strings were added.  This includes strings
+ *  too large to share a storage block, which the block allocates in their
+ *  own storage, and strings added to and popped from an
+ *  R3CStringBlockStack.
+ *
+ *  Build and run from the repository root:
+ *  \code
+ *  g++ -O2 -I. tests/memblock-test.cpp io/R3C*.cpp io/r3c-io.cpp \
+ *      string/R3C*.cpp string/r3c-string.cpp r3c.cpp -lpthread \
+ *      -o memblock-test
+ *  ./memblock-test
+ *  \endcode
+ *
+ *  The program prints each failed check, and exits with status 1 if there
+ *  were any.
+ */
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// *** CONSTANTS *** //
+
+// Size of the storage blocks used by the checks, in kilobytes
+#define BLOCK_KB 1
+
+// Size of the storage blocks used by the checks, in bytes
+#define BLOCK_BYTES (BLOCK_KB << 10)
+
+// Number of strings added by each random check
+#define RANDOM_STRING_COUNT 2000
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Number of failed checks.
+static int failCount = 0;
+
+// Reports a failed check.
+static void fail(const char* check, int seed) {
+    printf("FAILED %s (seed %d)\n", check, seed);
+    failCount++;
+}
+
+// Builds a string of the given length, without newlines.
+static void buildString(R3CString* str, int length) {
+    str->clear();
+    for ( int i = 0; i < length; i++ ) {
+        str->append((char)('!' + (rand() % 94)));
+    }
+}
+
+// Adds a string of the given length to the given block, in one of the ways
+// a string block can be filled, and appends it to the expected lines.
+static void addString(R3CStringBlock* block, int length, R3CString* lines) {
+    R3CString str;
+    char* storage;
+    buildString(&str, length);
+    switch ( rand() % 4 ) {
+        case 0:
+            block->addString(str.getChars());
+            break;
+        case 1:
+            block->addString(&str, length + (rand() % 64));
+            break;
+        case 2:
+            block->addString(R3CStringView(str.getChars(), length));
+            break;
+        default:
+            storage = block->allocString(length + (rand() % 64));
+            memcpy(storage, str.getChars(), length);
+    }
+    lines->append(&str);
+    lines->append('\n');
+}
+
+// Returns a random string length, with some strings too large to share a
+// storage block.
+static int getRandomLength() {
+    switch ( rand() % 8 ) {
+        case 0:
+            return( (BLOCK_BYTES >> 1) + (rand() % (2 * BLOCK_BYTES)) );
+        case 1:
+            return( (BLOCK_BYTES >> 1) - 2 + (rand() % 4) );
+        default:
+            return( 1 + (rand() % 80) );
+    }
+}
+
+// Reads every line of the given block with each readLine overload, and with
+// readChar, and checks the lines against the given lines.
+static void checkBlock(
+    R3CStringBlock* block, R3CString* lines, const char* check, int seed
+) {
+    R3CTextInputMemBlock input;
+    R3CString line;
+    R3CString result;
+    R3CStringView lineView;
+    const char* linePtr;
+    int lineLength;
+    int curChar;
+    bool inLine;
+    char name[64];
+
+    // Read into strings
+    input.open(block);
+    while ( input.readLine(&line) != EOF ) {
+        result.append(&line);
+        result.append('\n');
+        line.clear();
+    }
+    input.close();
+    if ( result.compare(lines) != 0 ) {
+        snprintf(name, sizeof(name), "%s readLine(R3CString*)", check);
+        fail(name, seed);
+    }
+
+    // Read without copying
+    result.clear();
+    input.open(block);
+    while ( (lineLength = input.readLine(&linePtr)) != EOF ) {
+        result.append(linePtr, lineLength);
+        result.append('\n');
+    }
+    if ( input.readLine(&lineView) != EOF ) {
+        snprintf(name, sizeof(name), "%s end of stream", check);
+        fail(name, seed);
+    }
+    input.close();
+    if ( result.compare(lines) != 0 ) {
+        snprintf(name, sizeof(name), "%s readLine(const char**)", check);
+        fail(name, seed);
+    }
+
+    // Read a character at a time, where null-terminators end each string
+    result.clear();
+    inLine = false;
+    input.open(block);
+    while ( (curChar = input.readChar()) != EOF ) {
+        if ( curChar != '\0' ) {
+            result.append((char)curChar);
+            inLine = true;
+        } else if ( inLine ) {
+            result.append('\n');
+            inLine = false;
+        }
+    }
+    input.close();
+    if ( inLine ) result.append('\n');
+    if ( result.compare(lines) != 0 ) {
+        snprintf(name, sizeof(name), "%s readChar", check);
+        fail(name, seed);
+    }
+}
+
+// Checks a block holding a string too large to share a storage block,
+// between two small strings.
+static void checkOversized() {
+    R3CStringBlock block(BLOCK_KB);
+    R3CString large;
+    R3CString lines;
+    block.addString("first");
+    buildString(&large, 800);
+    block.addString(&large);
+    block.addString("third");
+    lines.set("first\n");
+    lines.append(&large);
+    lines.append("\nthird\n");
+    if ( block.getAloneCount() != 1 ) fail("oversized alone count", 0);
+    checkBlock(&block, &lines, "oversized", 0);
+}
+
+// Checks a block filled with strings of random lengths.
+static void checkRandom(int seed) {
+    R3CStringBlock block(BLOCK_KB);
+    R3CString lines;
+    srand(seed);
+    for ( int i = 0; i < RANDOM_STRING_COUNT; i++ ) {
+        addString(&block, getRandomLength(), &lines);
+    }
+    checkBlock(&block, &lines, "random", seed);
+}
+
+// Checks a stack that pops levels holding strings of random lengths, so
+// that the strings of popped levels are no longer read.
+static void checkStack(int seed) {
+    R3CStringBlockStack stack(BLOCK_KB);
+    R3CString lines[8];
+    R3CString discarded;
+    int level;
+    srand(seed);
+    level = 0;
+    for ( int i = 0; i < RANDOM_STRING_COUNT; i++ ) {
+        if ( (rand() % 16 == 0) && (level < 7) ) {
+            level = stack.push();
+            lines[level].set(&lines[level - 1]);
+        } else if ( (rand() % 24 == 0) && (level > 0) ) {
+            level = stack.pop();
+        }
+        addString(&stack, getRandomLength(), &lines[level]);
+        if ( rand() % 100 == 0 ) {
+            checkBlock(&stack, &lines[level], "stack", seed);
+        }
+    }
+    while ( level > 0 ) {
+        level = stack.pop();
+        checkBlock(&stack, &lines[level], "popped stack", seed);
+    }
+    addString(&stack, BLOCK_BYTES, &discarded);
+    if ( stack.getAloneCount() < 1 ) fail("stack alone count", seed);
+    lines[0].append(&discarded);
+    checkBlock(&stack, &lines[0], "stack after pop", seed);
+}
+
+
+// *** MAIN PROGRAM *** //
+
+int main() {
+    R3CStringBlock emptyBlock(BLOCK_KB);
+    R3CString noLines;
+    try {
+        checkBlock(&emptyBlock, &noLines, "empty", 0);
+        checkOversized();
+        for ( int seed = 1; seed <= 20; seed++ ) {
+            checkRandom(seed);
+            checkStack(seed);
+        }
+    } catch ( const char* error ) {
+        printf("FAILED with error: %s\n", error);
+        failCount++;
+    }
+    printf("%d failures\n", failCount);
+    return( (failCount == 0) ? 0 : 1 );
+}
@@ -0,0 +1,240 @@
+/*! \file textinput-benchmark.cpp
+ *
+ *  Measures lines per second for R3CTextInputFile::readLine, with both read
+ *  methods, against the getc path that it replaced.  The getc path is kept
+ *  here, as it was, so the comparison can be repeated.  Every path must
+ *  return the same lines, which is checked by counting lines and characters
+ *  and hashing their contents.
+ *
+ *  Build and run from the repository root:
+ *  \code
+ *  g++ -O2 -I. tests/textinput-benchmark.cpp io/R3C*.cpp io/r3c-io.cpp \
+ *      string/R3C*.cpp string/r3c-string.cpp r3c.cpp -lpthread \
+ *      -o textinput-benchmark
+ *  ./textinput-benchmark [inputFile | megabytes]
+ *  \endcode
+ *
+ *  Without an input file, a temporary file of mixed line lengths (128 MB by
+ *  default) is written first.  The file is read once before timing starts,
+ *  so that every path reads it from the page cache.
+ */
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// *** CONSTANTS *** //
+
+// Default size of the generated input file, in megabytes
+#define DEFAULT_MEGABYTES 128
+
+
+// *** READ RESULTS *** //
+
+// Lines read by one path, used to check that every path agrees.
+struct ReadResult {
+
+    // Number of lines read
+    long lineCount;
+
+    // Number of characters in the lines
+    long long charCount;
+
+    // Hash of the characters of every line
+    unsigned long long hash;
+
+    // Seconds taken
+    double seconds;
+
+};
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Returns the current time in seconds.
+static double getSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return( now.tv_sec + (now.tv_nsec * 1e-9) );
+}
+
+// Adds the given line to the given result.
+static void addLine(ReadResult* result, R3CString* line) {
+    const char* charPtr;
+    result->lineCount++;
+    result->charCount += line->getLength();
+    for ( charPtr = line->getChars(); *charPtr != '\0'; charPtr++ ) {
+        result->hash = (result->hash ^ (unsigned char)*charPtr) *
+            1099511628211ULL;
+    }
+    result->hash = (result->hash ^ '\n') * 1099511628211ULL;
+}
+
+// Reads the next non-blank line one character at a time with getc, exactly
+// as R3CTextInputFile::readLine did before it read in blocks.
+static int readLineGetc(FILE* fileHandle, R3CString* targetStr) {
+    int charsRead;
+    int curChar;
+    bool done;
+    bool pastNewlines;
+    charsRead = 0;
+    done = false;
+    pastNewlines = false;
+    while ( !done ) {
+        curChar = getc(fileHandle);
+        if ( ferror(fileHandle) != 0 ) throw R3CERR_IO_EXCEPTION;
+        if ( curChar == EOF ) {
+            if ( charsRead == 0 ) charsRead = EOF;
+            done = true;
+        } else {
+            if (
+                (curChar == '\0') ||
+                (strchr(R3C_STR_NEWLINE, curChar) != NULL)
+            ) {
+                if ( pastNewlines ) done = true;
+            } else {
+                pastNewlines = true;
+                targetStr->append((char)curChar);
+                charsRead++;
+            }
+        }
+    }
+    return( charsRead );
+}
+
+// Reads every line of the given file with the getc path.
+static ReadResult readWithGetc(const char* filename) {
+    ReadResult result;
+    R3CString line;
+    FILE* fileHandle;
+    double startTime;
+    memset(&result, 0, sizeof(result));
+    result.hash = 14695981039346656037ULL;
+    startTime = getSeconds();
+    fileHandle = fopen(filename, "rb");
+    if ( fileHandle == NULL ) throw R3CERR_IO_STREAMNOTFOUND;
+    while ( readLineGetc(fileHandle, &line) != EOF ) {
+        addLine(&result, &line);
+        line.clear();
+    }
+    fclose(fileHandle);
+    result.seconds = getSeconds() - startTime;
+    return( result );
+}
+
+// Reads every line of the given file with R3CTextInputFile, using the given
+// read method.
+static ReadResult readWithInputFile(const char* filename, int method) {
+    ReadResult result;
+    R3CString line;
+    R3CTextInputFile inputFile;
+    double startTime;
+    memset(&result, 0, sizeof(result));
+    result.hash = 14695981039346656037ULL;
+    startTime = getSeconds();
+    inputFile.open(filename, method);
+    while ( inputFile.readLine(&line) != EOF ) {
+        addLine(&result, &line);
+        line.clear();
+    }
+    inputFile.close();
+    result.seconds = getSeconds() - startTime;
+    return( result );
+}
+
+// Writes a file of the given size, with lines of mixed lengths, some blank
+// lines, and a mix of line endings.
+static void writeInputFile(const char* filename, long long byteCount) {
+    static const char* endings[] = { "\n", "\n", "\n", "\r\n", "\n\n" };
+    FILE* fileHandle;
+    char line[512];
+    long long written;
+    int lineLength;
+    fileHandle = fopen(filename, "wb");
+    if ( fileHandle == NULL ) throw R3CERR_IO_EXCEPTION;
+    srand(1);
+    written = 0;
+    while ( written < byteCount ) {
+        lineLength = (rand() % 4 == 0) ? (rand() % 400) : (rand() % 100);
+        for ( int i = 0; i < lineLength; i++ ) {
+            line[i] = (char)(' ' + (rand() % 95));
+        }
+        line[lineLength] = '\0';
+        written += fprintf(fileHandle, "%s%s", line, endings[rand() % 5]);
+    }
+    fclose(fileHandle);
+}
+
+// Prints the given result, compared with the getc path.
+static void printResult(
+    const char* name, ReadResult* result, ReadResult* baseline
+) {
+    bool matches;
+    matches =
+        (result->lineCount == baseline->lineCount) &&
+        (result->charCount == baseline->charCount) &&
+        (result->hash == baseline->hash);
+    printf(
+        "%-22s %8.3f s  %12.0f lines/s  %6.2fx%s\n", name, result->seconds,
+        result->lineCount / result->seconds,
+        baseline->seconds / result->seconds,
+        matches ? "" : "  (LINES DIFFER)");
+}
+
+
+// *** MAIN PROGRAM *** //
+
+int main(int argc, char** argv) {
+    ReadResult getcResult;
+    ReadResult stdioResult;
+    ReadResult uringResult;
+    char tempName[64];
+    const char* filename;
+    long long megabytes;
+    bool isTemporary;
+
+    // Use the given file, or write a temporary one of the given size
+    isTemporary = true;
+    megabytes = DEFAULT_MEGABYTES;
+    if ( argc > 1 ) {
+        megabytes = atoll(argv[1]);
+        if ( megabytes <= 0 ) isTemporary = false;
+    }
+    if ( isTemporary ) {
+        snprintf(
+            tempName, sizeof(tempName), "/tmp/r3c-textinput-%d.txt",
+            (int)getpid());
+        writeInputFile(tempName, megabytes << 20);
+        filename = tempName;
+    } else {
+        filename = argv[1];
+    }
+
+    try {
+        readWithInputFile(filename, R3C_IO_READ_STDIO);
+        getcResult = readWithGetc(filename);
+        stdioResult = readWithInputFile(filename, R3C_IO_READ_STDIO);
+        uringResult = readWithInputFile(filename, R3C_IO_READ_URING);
+    } catch ( const char* error ) {
+        printf("Error: %s\n", error);
+        if ( isTemporary ) unlink(tempName);
+        return( 1 );
+    }
+    printf(
+        "%s: %ld lines, %lld characters\n", filename, getcResult.lineCount,
+        getcResult.charCount);
+    printResult("getc", &getcResult, &getcResult);
+    printResult("readLine (stdio)", &stdioResult, &getcResult);
+    printResult("readLine (io_uring)", &uringResult, &getcResult);
+    if ( isTemporary ) unlink(tempName);
+    return(
+        ((stdioResult.hash == getcResult.hash) &&
+            (uringResult.hash == getcResult.hash)) ? 0 : 1 );
+}
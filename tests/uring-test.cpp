@@ -0,0 +1,407 @@
+/*! \file uring-test.cpp
+ *
+ *  Checks that files read through io_uring come back exactly as plain reads
+ *  return them.  Temporary files of sizes around the buffer boundaries, and
+ *  of several line layouts, are read:
+ *
+ *  - through R3CUringFileReader, with several buffer counts and sizes,
+ *    against the bytes returned by read();
+ *  - through R3CTextInputFile::readLine with the R3C_IO_READ_URING and
+ *    R3C_IO_READ_STDIO read methods, with and without read-ahead, against
+ *    lines split from those bytes.
+ *
+ *  A read that fails is checked to be reported, and to keep being reported.
+ *  The fallback to plain reads is checked in a child process in which
+ *  io_uring_setup is refused through a seccomp filter.
+ *
+ *  Build and run from the repository root:
+ *  \code
+ *  g++ -O2 -I. tests/uring-test.cpp io/R3C*.cpp io/r3c-io.cpp \
+ *      string/R3C*.cpp string/r3c-string.cpp r3c.cpp -lpthread \
+ *      -o uring-test
+ *  ./uring-test
+ *  \endcode
+ *
+ *  The program prints each failed check, and exits with status 1 if there
+ *  were any.  If io_uring is unavailable, the checks that need it are
+ *  skipped, and only the fallback is checked.
+ */
+
+#include "../includes/r3c.hpp"
+#include "../includes/r3c-string.hpp"
+#include "../includes/r3c-io.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+
+
+// *** CONSTANTS *** //
+
+// Size of the buffers used by most checks, in kilobytes
+#define BUFFER_KB 1
+
+// Size of the buffers used by most checks, in bytes
+#define BUFFER_BYTES (BUFFER_KB << 10)
+
+// Line layouts of the generated files
+#define LAYOUT_MIXED 0
+#define LAYOUT_BLANK 1
+#define LAYOUT_LONG 2
+#define LAYOUT_UNTERMINATED 3
+#define LAYOUT_COUNT 4
+
+
+// *** HELPER FUNCTIONS *** //
+
+// Number of failed checks.
+static int failCount = 0;
+
+// Reports a failed check.
+static void fail(const char* check, const char* filename, long size) {
+    printf("FAILED %s (%s, %ld bytes)\n", check, filename, size);
+    failCount++;
+}
+
+// Checks if the given character ends a line.
+static bool isLineEnd(char curChar) {
+    return( (curChar == '\0') || (strchr(R3C_STR_NEWLINE, curChar) != NULL) );
+}
+
+// Builds file contents of the given size and line layout.
+static void buildContents(R3CString* contents, long size, int layout) {
+    static const char* endings[] = { "\n", "\r\n", "\r", "\n\n", "\f" };
+    long lineLength;
+    contents->clear();
+    while ( contents->getLength() < size ) {
+        switch ( layout ) {
+            case LAYOUT_BLANK:
+                lineLength = (rand() % 8 == 0) ? 1 : 0;
+                break;
+            case LAYOUT_LONG:
+                lineLength = BUFFER_BYTES + (rand() % (3 * BUFFER_BYTES));
+                break;
+            default:
+                lineLength = rand() % 120;
+        }
+        for ( long i = 0; i < lineLength; i++ ) {
+            contents->append((char)(' ' + (rand() % 95)));
+        }
+        if ( rand() % 50 == 0 ) {
+            contents->append("", 1);
+        } else {
+            contents->append(endings[rand() % 5]);
+        }
+    }
+    if ( contents->getLength() > size ) {
+        contents->deleteChars((int)size, contents->getLength());
+    }
+    if ( (layout == LAYOUT_UNTERMINATED) && (size > 0) ) {
+        contents->getChars()[size - 1] = 'x';
+    }
+}
+
+// Writes the given contents to the given file.
+static void writeContents(const char* filename, R3CString* contents) {
+    FILE* fileHandle;
+    fileHandle = fopen(filename, "wb");
+    if ( fileHandle == NULL ) throw R3CERR_IO_EXCEPTION;
+    if (
+        fwrite(
+            contents->getChars(), 1, contents->getLength(), fileHandle) !=
+        (size_t)contents->getLength()
+    ) {
+        throw R3CERR_IO_EXCEPTION;
+    }
+    fclose(fileHandle);
+}
+
+// Reads the given file with read().
+static void readPlain(const char* filename, R3CString* contents) {
+    char buffer[4096];
+    ssize_t bytesRead;
+    int fileDesc;
+    contents->clear();
+    fileDesc = open(filename, O_RDONLY);
+    if ( fileDesc < 0 ) throw R3CERR_IO_STREAMNOTFOUND;
+    while ( (bytesRead = read(fileDesc, buffer, sizeof(buffer))) > 0 ) {
+        contents->append(buffer, (int)bytesRead);
+    }
+    close(fileDesc);
+    if ( bytesRead < 0 ) throw R3CERR_IO_EXCEPTION;
+}
+
+// Splits the given contents into lines by the rules of readLine, each
+// followed by a single newline.
+static void splitLines(R3CString* contents, R3CString* lines) {
+    const char* charPtr;
+    const char* endPtr;
+    bool inLine;
+    lines->clear();
+    inLine = false;
+    charPtr = contents->getChars();
+    endPtr = charPtr + contents->getLength();
+    for ( ; charPtr < endPtr; charPtr++ ) {
+        if ( !isLineEnd(*charPtr) ) {
+            lines->append(*charPtr);
+            inLine = true;
+        } else if ( inLine ) {
+            lines->append('\n');
+            inLine = false;
+        }
+    }
+    if ( inLine ) lines->append('\n');
+}
+
+// Checks if two strings hold the same characters.
+static bool isSame(R3CString* first, R3CString* second) {
+    return(
+        (first->getLength() == second->getLength()) &&
+        (memcmp(
+            first->getChars(), second->getChars(), first->getLength()) == 0) );
+}
+
+// Reads the given file through R3CUringFileReader, and checks the bytes
+// against the given contents.  Every buffer but the last must be full.
+// Returns false if io_uring is unavailable.
+static bool checkReader(
+    const char* filename, R3CString* contents, int bufferCount,
+    int bufferSize
+) {
+    R3CUringFileReader reader(bufferCount, bufferSize);
+    R3CString result;
+    char* buffer;
+    int length;
+    int fileDesc;
+    bool isShort;
+    fileDesc = open(filename, O_RDONLY);
+    if ( fileDesc < 0 ) throw R3CERR_IO_STREAMNOTFOUND;
+    if ( !reader.start(fileDesc) ) {
+        close(fileDesc);
+        return( false );
+    }
+    isShort = false;
+    while ( reader.nextBuffer(&buffer, &length) ) {
+        if ( isShort ) fail("reader buffer order", filename, length);
+        if ( length < bufferSize ) isShort = true;
+        result.append(buffer, length);
+    }
+
+    // The end of the file keeps being reported
+    if ( reader.nextBuffer(&buffer, &length) ) {
+        fail("reader end of file", filename, contents->getLength());
+    }
+    reader.stop();
+    close(fileDesc);
+    if ( !isSame(&result, contents) ) {
+        fail("reader contents", filename, contents->getLength());
+    }
+    return( true );
+}
+
+// Reads the given file through R3CTextInputFile with the given read method
+// and read-ahead, and checks the lines against the given lines.  Returns
+// the read method that was used.
+static int checkInputFile(
+    const char* filename, R3CString* lines, int method, int readAhead
+) {
+    R3CTextInputFile inputFile;
+    R3CString line;
+    R3CString result;
+    char check[64];
+    int usedMethod;
+    inputFile.setBufferSize(BUFFER_KB);
+    inputFile.setReadAhead(readAhead);
+    inputFile.open(filename, method);
+    usedMethod = inputFile.getReadMethod();
+    while ( inputFile.readLine(&line) != EOF ) {
+        result.append(&line);
+        result.append('\n');
+        line.clear();
+    }
+    if ( inputFile.readLine(&line) != EOF ) {
+        fail("readLine end of file", filename, lines->getLength());
+    }
+    inputFile.close();
+    if ( !isSame(&result, lines) ) {
+        snprintf(
+            check, sizeof(check), "readLine method %d read-ahead %d", method,
+            readAhead);
+        fail(check, filename, lines->getLength());
+    }
+    return( usedMethod );
+}
+
+// Checks that a read that fails is reported, and keeps being reported.  A
+// directory can be opened, but reading it fails.
+static void checkFailure() {
+    R3CUringFileReader reader(4, BUFFER_BYTES);
+    char* buffer;
+    int length;
+    int fileDesc;
+    int throwCount;
+    fileDesc = open("/tmp", O_RDONLY);
+    if ( fileDesc < 0 ) throw R3CERR_IO_STREAMNOTFOUND;
+    if ( reader.start(fileDesc) ) {
+        throwCount = 0;
+        for ( int i = 0; i < 3; i++ ) {
+            try {
+                reader.nextBuffer(&buffer, &length);
+            } catch ( const char* error ) {
+                if ( strcmp(error, R3CERR_IO_EXCEPTION) == 0 ) throwCount++;
+            }
+        }
+        if ( throwCount != 3 ) fail("failed read", "/tmp", 0);
+        reader.stop();
+    }
+    close(fileDesc);
+}
+
+// Refuses io_uring_setup in this process, so that io_uring appears to be
+// unavailable.  Returns false if that is not possible.
+static bool refuseUring() {
+    struct sock_filter filter[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr)),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, __NR_io_uring_setup, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | ENOSYS),
+        BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW)
+    };
+    struct sock_fprog program;
+    program.len = (unsigned short)(sizeof(filter) / sizeof(filter[0]));
+    program.filter = filter;
+    if ( prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0 ) return( false );
+    return( prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program) == 0 );
+}
+
+
+// *** MAIN PROGRAM *** //
+
+int main() {
+    static const long sizes[] = {
+        0, 1, 2, BUFFER_BYTES - 1, BUFFER_BYTES, BUFFER_BYTES + 1,
+        4 * BUFFER_BYTES - 1, 4 * BUFFER_BYTES, 4 * BUFFER_BYTES + 1,
+        10 * BUFFER_BYTES + 7, 3 << 20
+    };
+    static const int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+    R3CString contents;
+    R3CString plainContents;
+    R3CString lines;
+    char filenames[LAYOUT_COUNT][sizeCount][64];
+    char* filename;
+    bool uringAvailable;
+    pid_t childId;
+    int childStatus;
+    int fileCount;
+
+    // Write every file first, so the fallback child can read them too
+    srand(1);
+    fileCount = 0;
+    for ( int layout = 0; layout < LAYOUT_COUNT; layout++ ) {
+        for ( int i = 0; i < sizeCount; i++ ) {
+            filename = filenames[layout][i];
+            snprintf(
+                filename, 64, "/tmp/r3c-uring-%d-%d.txt", (int)getpid(),
+                fileCount++);
+            buildContents(&contents, sizes[i], layout);
+            writeContents(filename, &contents);
+        }
+    }
+
+    try {
+        // Read through io_uring, and with stdio
+        uringAvailable = true;
+        for ( int layout = 0; layout < LAYOUT_COUNT; layout++ ) {
+            for ( int i = 0; i < sizeCount; i++ ) {
+                filename = filenames[layout][i];
+                readPlain(filename, &plainContents);
+                if ( plainContents.getLength() != sizes[i] ) {
+                    fail("plain read", filename, sizes[i]);
+                }
+                splitLines(&plainContents, &lines);
+                uringAvailable =
+                    checkReader(filename, &plainContents, 4, BUFFER_BYTES) &&
+                    checkReader(filename, &plainContents, 1, BUFFER_BYTES) &&
+                    checkReader(filename, &plainContents, 3, 1000) &&
+                    checkReader(filename, &plainContents, 2, 4096);
+                if (
+                    (checkInputFile(filename, &lines, R3C_IO_READ_URING, 0) !=
+                        R3C_IO_READ_URING) &&
+                    uringAvailable
+                ) {
+                    fail("io_uring read method", filename, sizes[i]);
+                }
+                checkInputFile(filename, &lines, R3C_IO_READ_URING, 2);
+                checkInputFile(filename, &lines, R3C_IO_READ_STDIO, 0);
+                checkInputFile(filename, &lines, R3C_IO_READ_STDIO, 3);
+            }
+        }
+        if ( uringAvailable ) {
+            checkFailure();
+        } else {
+            printf("io_uring is unavailable, so only fallback is checked\n");
+        }
+    } catch ( const char* error ) {
+        printf("FAILED with error: %s\n", error);
+        failCount++;
+    }
+
+    // Read again with io_uring refused, which must fall back to stdio
+    fflush(stdout);
+    childId = fork();
+    if ( childId == 0 ) {
+        failCount = 0;
+        if ( !refuseUring() ) {
+            printf("io_uring could not be refused, fallback unchecked\n");
+            _exit(0);
+        }
+        try {
+            for ( int layout = 0; layout < LAYOUT_COUNT; layout++ ) {
+                for ( int i = 0; i < sizeCount; i++ ) {
+                    filename = filenames[layout][i];
+                    readPlain(filename, &plainContents);
+                    splitLines(&plainContents, &lines);
+                    if ( checkReader(filename, &plainContents, 4, 1024) ) {
+                        fail("refused io_uring started", filename, sizes[i]);
+                    }
+                    if (
+                        checkInputFile(
+                            filename, &lines, R3C_IO_READ_URING, 0) !=
+                        R3C_IO_READ_STDIO
+                    ) {
+                        fail("fallback read method", filename, sizes[i]);
+                    }
+                    checkInputFile(filename, &lines, R3C_IO_READ_URING, 2);
+                }
+            }
+        } catch ( const char* error ) {
+            printf("FAILED fallback with error: %s\n", error);
+            failCount++;
+        }
+        fflush(stdout);
+        _exit((failCount == 0) ? 0 : 1);
+    }
+    if (
+        (childId < 0) || (waitpid(childId, &childStatus, 0) != childId) ||
+        !WIFEXITED(childStatus) || (WEXITSTATUS(childStatus) != 0)
+    ) {
+        printf("FAILED fallback\n");
+        failCount++;
+    }
+
+    for ( int layout = 0; layout < LAYOUT_COUNT; layout++ ) {
+        for ( int i = 0; i < sizeCount; i++ ) unlink(filenames[layout][i]);
+    }
+    printf(
+        "%d files checked, %d failures\n", LAYOUT_COUNT * sizeCount,
+        failCount);
+    return( (failCount == 0) ? 0 : 1 );
+}